@@ -0,0 +1,504 @@
+#include "animation_sampler.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ANIMATION_X86 1
+#endif
+
+#define ANIMATION_TRACK_FIELDS 6u
+
+// slerp correction for nlerp's parameter, fitted against the cosine of the
+// half angle between the keys (zeux, "Approximating slerp")
+#define SLERP_K0 0.931872f
+#define SLERP_K1 -1.25654f
+#define SLERP_K2 0.331442f
+
+// the SIMD slot math shifts by log2 of these
+_Static_assert(ANIMATION_KEY_BLOCK == 4u && ANIMATION_CHANNEL_COUNT == 8u, "key block layout");
+
+static int g_isa = -1;  // active ISA, resolved on first use
+
+// ------------------------------------------------------------
+// Build
+// ------------------------------------------------------------
+
+bool animation_set_build(AnimationSet* set, const Animation* animations, uint32_t count, const TransformStore* store,
+                         Scene* scene)
+{
+    memset(set, 0, sizeof(*set));
+
+    uint32_t tracks = 0, keys = 0;
+    for(uint32_t i = 0; i < count; i++)
+    {
+        if(arrlen(animations[i].keyframes) == 0 || !(animations[i].period > 0.0f))
+            continue;
+        tracks++;
+        keys += (uint32_t)arrlen(animations[i].keyframes);
+    }
+
+    // padding tracks read key 0, so there is always one
+    uint32_t track_cap  = (MAX(tracks, 1u) + 7u) & ~7u;
+    uint32_t key_blocks = (MAX(keys, 1u) + ANIMATION_KEY_BLOCK - 1u) / ANIMATION_KEY_BLOCK;
+
+    size_t key_bytes  = (size_t)key_blocks * ANIMATION_KEY_BLOCK * ANIMATION_CHANNEL_COUNT * sizeof(float);
+    size_t track_lane = (size_t)track_cap * sizeof(float);
+    size_t bytes      = key_bytes + track_lane * ANIMATION_TRACK_FIELDS;
+
+    void* block = NULL;
+    if(posix_memalign(&block, 64, bytes) != 0)
+        return false;
+    memset(block, 0, bytes);
+
+    uint8_t* p = (uint8_t*)block;
+
+    set->keyData   = (float*)p;
+    p += key_bytes;
+    set->entry     = (uint32_t*)(p + track_lane * 0);
+    set->objectId  = (uint32_t*)(p + track_lane * 1);
+    set->keyOffset = (uint32_t*)(p + track_lane * 2);
+    set->length    = (uint32_t*)(p + track_lane * 3);
+    set->startTime = (float*)(p + track_lane * 4);
+    set->rate      = (float*)(p + track_lane * 5);
+
+    uint32_t t = 0, k = 0;
+    for(uint32_t i = 0; i < count; i++)
+    {
+        const Animation* a = &animations[i];
+        uint32_t         n = (uint32_t)arrlen(a->keyframes);
+        if(n == 0 || !(a->period > 0.0f))
+            continue;
+
+        if(scene && a->objectId)
+        {
+            set->entry[t]    = transform_store_object_entry(store, scene, a->objectId);
+            set->objectId[t] = a->objectId;
+        }
+        else
+        {
+            set->entry[t]    = a->drawIndex;
+            set->objectId[t] = 0;
+        }
+        set->keyOffset[t] = k;
+        set->length[t]    = n;
+        set->startTime[t] = a->startTime;
+        set->rate[t]      = 1.0f / a->period;
+        t++;
+
+        for(uint32_t j = 0; j < n; j++, k++)
+        {
+            const Keyframe* key = &a->keyframes[j];
+            float*          dst = set->keyData;
+
+            dst[animation_key_slot(k, ANIMATION_TX)]    = key->translation[0];
+            dst[animation_key_slot(k, ANIMATION_TY)]    = key->translation[1];
+            dst[animation_key_slot(k, ANIMATION_TZ)]    = key->translation[2];
+            dst[animation_key_slot(k, ANIMATION_SCALE)] = key->scale;
+            dst[animation_key_slot(k, ANIMATION_QX)]    = key->rotation[0];
+            dst[animation_key_slot(k, ANIMATION_QY)]    = key->rotation[1];
+            dst[animation_key_slot(k, ANIMATION_QZ)]    = key->rotation[2];
+            dst[animation_key_slot(k, ANIMATION_QW)]    = key->rotation[3];
+        }
+    }
+
+    for(; t < track_cap; t++)
+    {
+        set->entry[t]  = UINT32_MAX;
+        set->length[t] = 1;
+    }
+
+    set->keyCount   = keys;
+    set->trackCount = tracks;
+    set->block      = block;
+    return true;
+}
+
+void animation_set_destroy(AnimationSet* set)
+{
+    free(set->block);
+    memset(set, 0, sizeof(*set));
+}
+
+// ------------------------------------------------------------
+// Sample
+// ------------------------------------------------------------
+
+static inline bool store_write(TransformStore* store, const AnimationSet* s, uint32_t track, float tx, float ty,
+                               float tz, float scale, float qx, float qy, float qz, float qw)
+{
+    uint32_t e = s->entry[track];
+    if(e >= store->count || store->objectId[e] != s->objectId[track])
+        return false;
+
+    store->px[e]    = tx;
+    store->py[e]    = ty;
+    store->pz[e]    = tz;
+    store->scale[e] = scale;
+    store->qx[e]    = qx;
+    store->qy[e]    = qy;
+    store->qz[e]    = qz;
+    store->qw[e]    = qw;
+    transform_store_mark_dirty(store, e);
+    return true;
+}
+
+static bool sample_scalar(const AnimationSet* s, uint32_t i, float time, bool slerp, TransformStore* store)
+{
+    float local = (time - s->startTime[i]) * s->rate[i];
+    if(local < 0.0f)
+        return false;
+
+    // same key math as the SIMD paths: wrap, truncate, clamp against rounding
+    float n = (float)s->length[i];
+    local   = MAX(local - (float)(int32_t)(local / n) * n, 0.0f);
+
+    uint32_t k0 = (uint32_t)(int32_t)local;
+    float    f  = local - (float)k0;
+    k0          = MIN(k0, s->length[i] - 1u);
+
+    uint32_t k1 = k0 + 1u < s->length[i] ? k0 + 1u : 0u;
+    uint32_t a  = s->keyOffset[i] + k0;
+    uint32_t b  = s->keyOffset[i] + k1;
+
+    float va[ANIMATION_CHANNEL_COUNT], vb[ANIMATION_CHANNEL_COUNT];
+    for(uint32_t c = 0; c < ANIMATION_CHANNEL_COUNT; c++)
+    {
+        va[c] = animation_key(s, a, c);
+        vb[c] = animation_key(s, b, c);
+    }
+
+    float d    = va[4] * vb[4] + va[5] * vb[5] + va[6] * vb[6] + va[7] * vb[7];
+    float sign = d < 0.0f ? -1.0f : 1.0f;
+    float fq   = f;
+    if(slerp)
+    {
+        float ad = d * sign;
+        fq       = f + f * (f - 0.5f) * (f - 1.0f) * (SLERP_K0 + ad * (SLERP_K1 + ad * SLERP_K2));
+    }
+
+    float r[ANIMATION_CHANNEL_COUNT];
+    for(uint32_t c = 0; c < 4; c++)
+        r[c] = va[c] + (vb[c] - va[c]) * f;
+    for(uint32_t c = 4; c < 8; c++)
+        r[c] = va[c] + (vb[c] * sign - va[c]) * fq;
+
+    float len2 = r[4] * r[4] + r[5] * r[5] + r[6] * r[6] + r[7] * r[7];
+    float inv  = len2 > 0.0f ? 1.0f / sqrtf(len2) : 0.0f;
+
+    return store_write(store, s, i, r[0], r[1], r[2], r[3], r[4] * inv, r[5] * inv, r[6] * inv, r[7] * inv);
+}
+
+#ifdef ANIMATION_X86
+
+// Per-lane results go through aligned scratch and are scattered to the store;
+// draws of neighbouring tracks are rarely neighbours in the store.
+static uint32_t scatter_lanes(const AnimationSet* s, uint32_t i, uint32_t lanes, uint32_t valid, float out[8][8],
+                              TransformStore* store)
+{
+    uint32_t written = 0;
+    for(uint32_t l = 0; l < lanes; l++)
+    {
+        if(valid & (1u << l))
+            written += store_write(store, s, i + l, out[0][l], out[1][l], out[2][l], out[3][l], out[4][l],
+                                   out[5][l], out[6][l], out[7][l]);
+    }
+    return written;
+}
+
+static uint32_t sample_sse4(const AnimationSet* s, uint32_t i, float time, bool slerp, TransformStore* store)
+{
+    __m128 local = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(time), _mm_load_ps(s->startTime + i)), _mm_load_ps(s->rate + i));
+    uint32_t valid = (uint32_t)_mm_movemask_ps(_mm_cmpge_ps(local, _mm_setzero_ps()));
+    if(!valid)
+        return 0;
+
+    // lanes not started yet clamp to key 0 so every load stays in range
+    __m128i keys = _mm_load_si128((const __m128i*)(s->length + i));
+    __m128  n    = _mm_cvtepi32_ps(keys);
+    local        = _mm_max_ps(local, _mm_setzero_ps());
+    local        = _mm_sub_ps(local, _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_div_ps(local, n))), n));
+    local        = _mm_max_ps(local, _mm_setzero_ps());
+
+    __m128i one = _mm_set1_epi32(1);
+    __m128i k0  = _mm_cvttps_epi32(local);
+    __m128  f   = _mm_sub_ps(local, _mm_cvtepi32_ps(k0));
+    k0          = _mm_sub_epi32(_mm_sub_epi32(k0, one), _mm_cmplt_epi32(k0, keys));  // k0 = min(k0, keys - 1)
+    __m128i k1  = _mm_add_epi32(k0, one);
+    k1          = _mm_and_si128(k1, _mm_cmplt_epi32(k1, keys));
+
+    // key slot of channel 0; channel c is c * ANIMATION_KEY_BLOCK further
+    __m128i offset = _mm_load_si128((const __m128i*)(s->keyOffset + i));
+    __m128i ka     = _mm_add_epi32(offset, k0);
+    __m128i kb     = _mm_add_epi32(offset, k1);
+    __m128i lo     = _mm_set1_epi32(ANIMATION_KEY_BLOCK - 1u);
+
+    uint32_t a[4], b[4];
+    _mm_storeu_si128((__m128i*)a, _mm_add_epi32(_mm_slli_epi32(_mm_srli_epi32(ka, 2), 5), _mm_and_si128(ka, lo)));
+    _mm_storeu_si128((__m128i*)b, _mm_add_epi32(_mm_slli_epi32(_mm_srli_epi32(kb, 2), 5), _mm_and_si128(kb, lo)));
+
+    __m128 va[8], vb[8];
+    for(int c = 0; c < 8; c++)
+    {
+        const float* ch = s->keyData + c * ANIMATION_KEY_BLOCK;
+        va[c]           = _mm_setr_ps(ch[a[0]], ch[a[1]], ch[a[2]], ch[a[3]]);
+        vb[c]           = _mm_setr_ps(ch[b[0]], ch[b[1]], ch[b[2]], ch[b[3]]);
+    }
+
+    // shortest arc: flip b's sign bit where the dot is negative
+    __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(va[4], vb[4]), _mm_mul_ps(va[5], vb[5])),
+                          _mm_add_ps(_mm_mul_ps(va[6], vb[6]), _mm_mul_ps(va[7], vb[7])));
+    __m128 sign = _mm_and_ps(d, _mm_set1_ps(-0.0f));
+    for(int c = 4; c < 8; c++)
+        vb[c] = _mm_xor_ps(vb[c], sign);
+
+    __m128 fq = f;
+    if(slerp)
+    {
+        __m128 ad = _mm_xor_ps(d, sign);
+        __m128 k  = _mm_add_ps(_mm_set1_ps(SLERP_K0),
+                               _mm_mul_ps(ad, _mm_add_ps(_mm_set1_ps(SLERP_K1), _mm_mul_ps(ad, _mm_set1_ps(SLERP_K2)))));
+        __m128 w  = _mm_mul_ps(_mm_mul_ps(f, _mm_sub_ps(f, _mm_set1_ps(0.5f))), _mm_sub_ps(f, _mm_set1_ps(1.0f)));
+        fq        = _mm_add_ps(f, _mm_mul_ps(w, k));
+    }
+
+    __m128 r[8];
+    for(int c = 0; c < 8; c++)
+        r[c] = _mm_add_ps(va[c], _mm_mul_ps(_mm_sub_ps(vb[c], va[c]), c < 4 ? f : fq));
+
+    // rsqrt plus one Newton step
+    __m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r[4], r[4]), _mm_mul_ps(r[5], r[5])),
+                             _mm_add_ps(_mm_mul_ps(r[6], r[6]), _mm_mul_ps(r[7], r[7])));
+    __m128 y    = _mm_rsqrt_ps(len2);
+    y = _mm_mul_ps(y, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), len2), _mm_mul_ps(y, y))));
+
+    _Alignas(32) float out[8][8];
+    for(int c = 0; c < 8; c++)
+        _mm_store_ps(out[c], c < 4 ? r[c] : _mm_mul_ps(r[c], y));
+
+    return scatter_lanes(s, i, 4, valid, out, store);
+}
+
+__attribute__((target("avx2"))) static uint32_t sample_avx8(const AnimationSet* s, uint32_t i, float time, bool slerp,
+                                                            TransformStore* store)
+{
+    __m256 zero  = _mm256_setzero_ps();
+    __m256 local = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(time), _mm256_load_ps(s->startTime + i)),
+                                 _mm256_load_ps(s->rate + i));
+    uint32_t valid = (uint32_t)_mm256_movemask_ps(_mm256_cmp_ps(local, zero, _CMP_GE_OQ));
+    if(!valid)
+        return 0;
+
+    __m256i keys = _mm256_load_si256((const __m256i*)(s->length + i));
+    __m256  n    = _mm256_cvtepi32_ps(keys);
+    local        = _mm256_max_ps(local, zero);
+    local        = _mm256_sub_ps(local, _mm256_mul_ps(_mm256_round_ps(_mm256_div_ps(local, n), _MM_FROUND_TRUNC), n));
+    local        = _mm256_max_ps(local, zero);
+
+    __m256i one = _mm256_set1_epi32(1);
+    __m256i k0  = _mm256_cvttps_epi32(local);
+    __m256  f   = _mm256_sub_ps(local, _mm256_cvtepi32_ps(k0));
+    k0          = _mm256_min_epi32(k0, _mm256_sub_epi32(keys, one));
+    __m256i k1  = _mm256_add_epi32(k0, one);
+    k1          = _mm256_and_si256(k1, _mm256_cmpgt_epi32(keys, k1));
+
+    __m256i offset = _mm256_load_si256((const __m256i*)(s->keyOffset + i));
+    __m256i ka     = _mm256_add_epi32(offset, k0);
+    __m256i kb     = _mm256_add_epi32(offset, k1);
+    __m256i lo     = _mm256_set1_epi32(ANIMATION_KEY_BLOCK - 1u);
+    __m256i a = _mm256_add_epi32(_mm256_slli_epi32(_mm256_srli_epi32(ka, 2), 5), _mm256_and_si256(ka, lo));
+    __m256i b = _mm256_add_epi32(_mm256_slli_epi32(_mm256_srli_epi32(kb, 2), 5), _mm256_and_si256(kb, lo));
+
+    __m256 va[8], vb[8];
+    for(int c = 0; c < 8; c++)
+    {
+        va[c] = _mm256_i32gather_ps(s->keyData + c * ANIMATION_KEY_BLOCK, a, 4);
+        vb[c] = _mm256_i32gather_ps(s->keyData + c * ANIMATION_KEY_BLOCK, b, 4);
+    }
+
+    __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(va[4], vb[4]), _mm256_mul_ps(va[5], vb[5])),
+                             _mm256_add_ps(_mm256_mul_ps(va[6], vb[6]), _mm256_mul_ps(va[7], vb[7])));
+    __m256 sign = _mm256_and_ps(d, _mm256_set1_ps(-0.0f));
+    for(int c = 4; c < 8; c++)
+        vb[c] = _mm256_xor_ps(vb[c], sign);
+
+    __m256 fq = f;
+    if(slerp)
+    {
+        __m256 ad = _mm256_xor_ps(d, sign);
+        __m256 k  = _mm256_add_ps(_mm256_set1_ps(SLERP_K0),
+                                  _mm256_mul_ps(ad, _mm256_add_ps(_mm256_set1_ps(SLERP_K1),
+                                                                  _mm256_mul_ps(ad, _mm256_set1_ps(SLERP_K2)))));
+        __m256 w  = _mm256_mul_ps(_mm256_mul_ps(f, _mm256_sub_ps(f, _mm256_set1_ps(0.5f))),
+                                  _mm256_sub_ps(f, _mm256_set1_ps(1.0f)));
+        fq        = _mm256_add_ps(f, _mm256_mul_ps(w, k));
+    }
+
+    __m256 r[8];
+    for(int c = 0; c < 8; c++)
+        r[c] = _mm256_add_ps(va[c], _mm256_mul_ps(_mm256_sub_ps(vb[c], va[c]), c < 4 ? f : fq));
+
+    __m256 len2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[4], r[4]), _mm256_mul_ps(r[5], r[5])),
+                                _mm256_add_ps(_mm256_mul_ps(r[6], r[6]), _mm256_mul_ps(r[7], r[7])));
+    __m256 y    = _mm256_rsqrt_ps(len2);
+    y = _mm256_mul_ps(y, _mm256_sub_ps(_mm256_set1_ps(1.5f),
+                                       _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), len2), _mm256_mul_ps(y, y))));
+
+    _Alignas(32) float out[8][8];
+    for(int c = 0; c < 8; c++)
+        _mm256_store_ps(out[c], c < 4 ? r[c] : _mm256_mul_ps(r[c], y));
+
+    return scatter_lanes(s, i, 8, valid, out, store);
+}
+
+#endif
+
+static AnimationIsa detect_isa(void)
+{
+#ifdef ANIMATION_X86
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? ANIMATION_ISA_AVX2 : ANIMATION_ISA_SSE;
+#else
+    return ANIMATION_ISA_SCALAR;
+#endif
+}
+
+AnimationIsa animation_isa(void)
+{
+    if(g_isa < 0)
+        g_isa = (int)detect_isa();
+    return (AnimationIsa)g_isa;
+}
+
+AnimationIsa animation_set_isa(AnimationIsa isa)
+{
+    g_isa = (int)MIN(isa, detect_isa());
+    return (AnimationIsa)g_isa;
+}
+
+uint32_t animation_set_sample(const AnimationSet* set, float time, bool slerp, TransformStore* store)
+{
+    AnimationIsa isa     = animation_isa();
+    uint32_t     written = 0;
+    uint32_t     i       = 0;
+
+    // track arrays are padded to 8, and padding tracks never write
+#ifdef ANIMATION_X86
+    if(isa >= ANIMATION_ISA_AVX2)
+    {
+        for(; i < set->trackCount; i += 8)
+            written += sample_avx8(set, i, time, slerp, store);
+    }
+    else if(isa >= ANIMATION_ISA_SSE)
+    {
+        for(; i < set->trackCount; i += 4)
+            written += sample_sse4(set, i, time, slerp, store);
+    }
+#else
+    (void)isa;
+#endif
+
+    for(; i < set->trackCount; i++)
+        written += sample_scalar(set, i, time, slerp, store);
+
+    return written;
+}
+
+// ------------------------------------------------------------
+// Resampling
+// ------------------------------------------------------------
+
+// Value of c at time t. cursor only moves forward, so sampling a channel at
+// increasing times walks its keys once.
+static void channel_sample(const AnimationChannel* c, uint32_t components, float t, uint32_t* cursor, float* out)
+{
+    const float* v = c->values;
+    uint32_t     n = c->count;
+
+    if(n == 1 || t <= c->times[0])
+    {
+        memcpy(out, v, sizeof(float) * components);
+        return;
+    }
+    if(t >= c->times[n - 1])
+    {
+        memcpy(out, v + (size_t)(n - 1) * components, sizeof(float) * components);
+        return;
+    }
+
+    while(*cursor + 2u < n && c->times[*cursor + 1u] <= t)
+        (*cursor)++;
+
+    uint32_t     k    = *cursor;
+    const float* a    = v + (size_t)k * components;
+    const float* b    = a + components;
+    float        span = c->times[k + 1u] - c->times[k];
+    float        f    = span > 0.0f ? (t - c->times[k]) / span : 0.0f;
+
+    if(c->step)
+        memcpy(out, a, sizeof(float) * components);
+    else if(components == 4)
+        glm_quat_slerp((float*)a, (float*)b, f, out);
+    else
+        for(uint32_t i = 0; i < components; i++)
+            out[i] = a[i] + (b[i] - a[i]) * f;
+}
+
+static bool channel_valid(const AnimationChannel* c)
+{
+    return c && c->count && c->times && c->values;
+}
+
+bool animation_resample(Animation* out, uint32_t drawIndex, const SceneObjectTransform* rest,
+                        const AnimationChannel* translation, const AnimationChannel* rotation,
+                        const AnimationChannel* scale, float rate)
+{
+    memset(out, 0, sizeof(*out));
+    if(!(rate > 0.0f))
+        return false;
+
+    const AnimationChannel* channels[3] = {translation, rotation, scale};
+
+    float duration = 0.0f;
+    for(int c = 0; c < 3; c++)
+    {
+        if(channel_valid(channels[c]))
+            duration = MAX(duration, channels[c]->times[channels[c]->count - 1u]);
+    }
+
+    uint32_t keys = duration > 0.0f ? (uint32_t)ceilf(duration * rate) : 1u;
+    keys          = MAX(keys, 1u);
+
+    out->drawIndex = drawIndex;
+    out->startTime = 0.0f;
+    out->period    = duration > 0.0f ? duration / (float)keys : 1.0f / rate;
+    arrsetlen(out->keyframes, keys);
+
+    uint32_t cursor[3] = {0};
+    for(uint32_t k = 0; k < keys; k++)
+    {
+        Keyframe* key = &out->keyframes[k];
+        float     t   = (float)k * out->period;
+
+        glm_vec3_copy((float*)rest->position, key->translation);
+        glm_quat_copy((float*)rest->rotation, key->rotation);
+        key->scale = rest->scale;
+
+        if(channel_valid(translation))
+            channel_sample(translation, 3, t, &cursor[0], key->translation);
+        if(channel_valid(rotation))
+        {
+            channel_sample(rotation, 4, t, &cursor[1], key->rotation);
+            glm_quat_normalize(key->rotation);
+        }
+        if(channel_valid(scale))
+        {
+            float s[3];
+            channel_sample(scale, 3, t, &cursor[2], s);
+            key->scale = fmaxf(s[0], fmaxf(s[1], s[2]));
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "scene.h"
+#include "transform_store.h"
+
+// Batched sampling of Scene.animations straight into a TransformStore.
+//
+// Every Animation is a fixed-rate track: key k sits at startTime + k * period,
+// and the last key blends back into the first, so the clip loops every
+// period * keyCount seconds. Key lookup is a multiply and a truncate, no search.
+//
+// animation_set_build() copies the keys into per-channel SoA blocks of
+// ANIMATION_KEY_BLOCK keys: a block holds every channel of 4 consecutive keys,
+// so the two keys a sample blends usually share 128 bytes instead of sitting
+// on 8 separate channel arrays. animation_set_sample() then runs 8 (AVX2) or
+// 4 (SSE) tracks per step: key math, lerp of translation/scale and nlerp of
+// rotation in registers, and writes the results into the store entries of
+// each track's draw, marking them dirty for the next transform_store_flush().
+//
+// Tracks with an objectId (glTF imports through scene_load_gltf_at) write the
+// store entry of that SceneObject, resolved at build time; the others write
+// entry drawIndex. A track whose entry no longer holds its object (removed or
+// moved by transform_store_remove_object) is skipped until the set is rebuilt.
+
+typedef enum AnimationIsa
+{
+    ANIMATION_ISA_SCALAR = 0,
+    ANIMATION_ISA_SSE,   // 4 tracks per step
+    ANIMATION_ISA_AVX2,  // 8 tracks per step, gathered key loads
+} AnimationIsa;
+
+#define ANIMATION_KEY_BLOCK 4u
+
+typedef enum AnimationChannelIndex
+{
+    ANIMATION_TX = 0,
+    ANIMATION_TY,
+    ANIMATION_TZ,
+    ANIMATION_SCALE,
+    ANIMATION_QX,
+    ANIMATION_QY,
+    ANIMATION_QZ,
+    ANIMATION_QW,
+    ANIMATION_CHANNEL_COUNT,
+} AnimationChannelIndex;
+
+typedef struct AnimationSet
+{
+    // every track's keys back to back (global key index k), stored as
+    // [k / 4][channel][k % 4]; see animation_key()
+    float*   keyData;
+    uint32_t keyCount;
+
+    // tracks, padded to a multiple of 8 with tracks that never write
+    uint32_t* entry;     // store entry, UINT32_MAX when unresolved
+    uint32_t* objectId;  // expected store->objectId[entry]
+    uint32_t* keyOffset;
+    uint32_t* length;     // keys per track
+    float*    startTime;
+    float*    rate;       // keys per second, 1 / Animation.period
+    uint32_t  trackCount;
+
+    void* block;  // single allocation backing every array above
+} AnimationSet;
+
+static inline uint32_t animation_key_slot(uint32_t key, uint32_t channel)
+{
+    return (key / ANIMATION_KEY_BLOCK) * (ANIMATION_KEY_BLOCK * ANIMATION_CHANNEL_COUNT) + channel * ANIMATION_KEY_BLOCK
+           + key % ANIMATION_KEY_BLOCK;
+}
+
+static inline float animation_key(const AnimationSet* set, uint32_t key, uint32_t channel)
+{
+    return set->keyData[animation_key_slot(key, channel)];
+}
+
+// Animations without keyframes or with a non-positive period are dropped.
+// store and scene resolve Animation.objectId; with a NULL scene every track
+// writes entry drawIndex.
+bool animation_set_build(AnimationSet* set, const Animation* animations, uint32_t count, const TransformStore* store,
+                         Scene* scene);
+void animation_set_destroy(AnimationSet* set);
+
+// Samples every track at time (seconds) into store and marks its entry dirty.
+// Tracks whose startTime is still ahead, or whose entry is outside the store or
+// holds another object, are skipped. slerp bends the nlerp parameter to follow slerp's constant
+// angular velocity, for sparse keys where plain nlerp visibly eases.
+// Returns the number of tracks written.
+uint32_t animation_set_sample(const AnimationSet* set, float time, bool slerp, TransformStore* store);
+
+// Best ISA the CPU supports unless lowered with animation_set_isa (benchmarks).
+AnimationIsa animation_isa(void);
+AnimationIsa animation_set_isa(AnimationIsa isa);
+
+// ------------------------------------------------------------
+// Resampling
+// ------------------------------------------------------------
+
+// One keyed channel as glTF stores it: ascending times, and per key 3 floats
+// (translation, scale xyz) or 4 (rotation xyzw). step holds each value until
+// the next key instead of interpolating.
+typedef struct AnimationChannel
+{
+    const float* times;
+    const float* values;
+    uint32_t     count;
+    bool         step;
+} AnimationChannel;
+
+// Resamples keyed channels into a fixed-rate track for drawIndex at about
+// rate keys per second. The clip runs to the last key of any channel; period
+// is adjusted so keyCount periods cover it exactly, the last one blending
+// back into key 0 as the sampler wraps. A NULL or empty channel holds the
+// rest value. Scale is reduced to its largest axis, as MeshDraw only has
+// uniform scale. out->keyframes is a new stb_ds array.
+bool animation_resample(Animation* out, uint32_t drawIndex, const SceneObjectTransform* rest,
+                        const AnimationChannel* translation, const AnimationChannel* rotation,
+                        const AnimationChannel* scale, float rate);
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "vk_defaults.h"
+
+// Tiny benchmark helpers shared by the bench/ programs.
+// Every benchmark is a `int bench_xxx(int argc, char** argv)` registered in bench_main.c.
+
+typedef struct BenchStats
+{
+    double   min_ms;
+    double   max_ms;
+    double   total_ms;
+    uint32_t runs;
+} BenchStats;
+
+static inline void bench_stats_add(BenchStats* s, double ms)
+{
+    if(s->runs == 0 || ms < s->min_ms)
+        s->min_ms = ms;
+    if(s->runs == 0 || ms > s->max_ms)
+        s->max_ms = ms;
+    s->total_ms += ms;
+    s->runs++;
+}
+
+static inline double bench_stats_mean(const BenchStats* s)
+{
+    return s->runs ? s->total_ms / (double)s->runs : 0.0;
+}
+
+static inline void bench_stats_print(const char* label, const BenchStats* s)
+{
+    printf("  %-28s runs=%-4u mean=%9.3f ms  min=%9.3f ms  max=%9.3f ms\n", label, s->runs, bench_stats_mean(s), s->min_ms,
+           s->max_ms);
+}
+
+static inline uint32_t bench_arg_u32(int argc, char** argv, int index, uint32_t fallback)
+{
+    return (index < argc) ? (uint32_t)strtoul(argv[index], NULL, 10) : fallback;
+}
+
+int bench_scene_cache(int argc, char** argv);
+int bench_scene_import(int argc, char** argv);
+int bench_meshlet_cull(int argc, char** argv);
+int bench_scene_objects(int argc, char** argv);
+int bench_transform_store(int argc, char** argv);
+int bench_scene_bvh(int argc, char** argv);
+int bench_geometry_codec(int argc, char** argv);
+int bench_animation(int argc, char** argv);
+int bench_instancing(int argc, char** argv);
+int bench_texture_file(int argc, char** argv);
+int bench_staging(int argc, char** argv);
+int bench_texture_mips(int argc, char** argv);
+int bench_procedural(int argc, char** argv);
+int bench_pipeline_cache(int argc, char** argv);
+int bench_pipeline_compile(int argc, char** argv);
+int bench_shader_reflect(int argc, char** argv);
+int bench_slang_compile(int argc, char** argv);
@@ -0,0 +1,165 @@
+#include "bench.h"
+#include "animation_sampler.h"
+
+// Per-frame animation sampling for N animated draws (default 50k): the plain
+// loop over Scene.animations (Keyframe AoS, cglm lerp/slerp, one MeshDraw at a
+// time) against AnimationSet sampling at each ISA with nlerp and with the slerp
+// correction, plus the TransformStore flush that follows. Synthetic tracks,
+// 32 keys at 30 Hz each, draws in random order so stores scatter.
+
+#define BENCH_KEYS 32u
+#define BENCH_RATE 30.0f
+
+static const char* g_isa_names[] = {"scalar", "sse", "avx2"};
+
+static uint32_t xorshift32(uint32_t* state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static float frand(uint32_t* state)
+{
+    return (float)(xorshift32(state) >> 8) / 16777216.0f;
+}
+
+static void sample_aos(const Animation* animations, uint32_t count, float time, MeshDraw* draws)
+{
+    for(uint32_t i = 0; i < count; i++)
+    {
+        const Animation* a     = &animations[i];
+        float            local = (time - a->startTime) / a->period;
+        if(local < 0.0f)
+            continue;
+
+        uint32_t n  = (uint32_t)arrlen(a->keyframes);
+        local       = fmodf(local, (float)n);
+        uint32_t k0 = MIN((uint32_t)local, n - 1u);
+        uint32_t k1 = (k0 + 1u) % n;
+        float    f  = local - (float)k0;
+
+        const Keyframe* ka = &a->keyframes[k0];
+        const Keyframe* kb = &a->keyframes[k1];
+        MeshDraw*       d  = &draws[a->drawIndex];
+
+        glm_vec3_lerp((float*)ka->translation, (float*)kb->translation, f, d->position);
+        d->scale = ka->scale + (kb->scale - ka->scale) * f;
+        glm_quat_slerp((float*)ka->rotation, (float*)kb->rotation, f, d->orientation);
+    }
+}
+
+int bench_animation(int argc, char** argv)
+{
+    uint32_t count      = bench_arg_u32(argc, argv, 1, 50000);
+    uint32_t iterations = bench_arg_u32(argc, argv, 2, 100);
+
+    MeshDraw*      draws      = (MeshDraw*)calloc(MAX(count, 1u), sizeof(MeshDraw));
+    MeshDrawGpu*   dst        = (MeshDrawGpu*)malloc(sizeof(MeshDrawGpu) * MAX(count, 1u));
+    uint32_t*      order      = (uint32_t*)malloc(sizeof(uint32_t) * MAX(count, 1u));
+    Animation*     animations = NULL;
+    AnimationSet   set        = {0};
+    TransformStore store      = {0};
+
+    if(!draws || !dst || !order || !transform_store_init(&store, count))
+    {
+        printf("animation: out of memory\n");
+        free(draws);
+        free(dst);
+        free(order);
+        return 1;
+    }
+
+    uint32_t seed = 0x9e3779b9u;
+    for(uint32_t i = 0; i < count; i++)
+        order[i] = i;
+    for(uint32_t i = count; i > 1; i--)
+    {
+        uint32_t j    = xorshift32(&seed) % i;
+        uint32_t t    = order[i - 1u];
+        order[i - 1u] = order[j];
+        order[j]      = t;
+    }
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        Animation a = {.drawIndex = order[i], .startTime = frand(&seed), .period = 1.0f / BENCH_RATE};
+        arrsetlen(a.keyframes, BENCH_KEYS);
+
+        for(uint32_t k = 0; k < BENCH_KEYS; k++)
+        {
+            Keyframe* key       = &a.keyframes[k];
+            key->translation[0] = frand(&seed) * 4096.0f;
+            key->translation[1] = frand(&seed) * 8.0f;
+            key->translation[2] = frand(&seed) * 4096.0f;
+            key->scale          = 0.5f + frand(&seed);
+
+            versor q = {frand(&seed) - 0.5f, frand(&seed) - 0.5f, frand(&seed) - 0.5f, frand(&seed) - 0.5f};
+            glm_quat_normalize(q);
+            glm_quat_copy(q, key->rotation);
+        }
+        arrpush(animations, a);
+
+        draws[i].orientation[3] = 1.0f;
+        draws[i].scale          = 1.0f;
+    }
+    transform_store_from_draws(&store, draws, count);
+
+    uint64_t t0 = time_now_ns();
+    animation_set_build(&set, animations, count, &store, NULL);
+    printf("\nanimation: %u animated draws, %u keys each, %u iterations (active isa: %s)\n", count, BENCH_KEYS,
+           iterations, g_isa_names[animation_isa()]);
+    printf("  set build %.3f ms\n", time_ns_to_ms(time_now_ns() - t0));
+
+    // ~60 fps frame times, starting after every track has started
+    BenchStats aos = {0};
+    for(uint32_t it = 0; it < iterations; it++)
+    {
+        float time = 1.0f + (float)it / 60.0f;
+        t0         = time_now_ns();
+        sample_aos(animations, count, time, draws);
+        bench_stats_add(&aos, time_ns_to_ms(time_now_ns() - t0));
+    }
+    bench_stats_print("aos loop (slerp)", &aos);
+
+    AnimationIsa best = animation_isa();
+    for(uint32_t isa = ANIMATION_ISA_SCALAR; isa <= (uint32_t)best; isa++)
+    {
+        animation_set_isa((AnimationIsa)isa);
+
+        for(uint32_t slerp = 0; slerp < 2; slerp++)
+        {
+            BenchStats sample = {0}, flush = {0};
+            for(uint32_t it = 0; it < iterations; it++)
+            {
+                float time = 1.0f + (float)it / 60.0f;
+                t0         = time_now_ns();
+                animation_set_sample(&set, time, slerp != 0, &store);
+                bench_stats_add(&sample, time_ns_to_ms(time_now_ns() - t0));
+
+                t0 = time_now_ns();
+                transform_store_flush(&store, dst);
+                bench_stats_add(&flush, time_ns_to_ms(time_now_ns() - t0));
+            }
+
+            char label[64];
+            snprintf(label, sizeof(label), "sample %s (%s)", g_isa_names[isa], slerp ? "slerp" : "nlerp");
+            bench_stats_print(label, &sample);
+            if(isa == (uint32_t)best && slerp)
+                bench_stats_print("  then flush (all dirty)", &flush);
+        }
+    }
+    animation_set_isa(best);
+
+    for(uint32_t i = 0; i < (uint32_t)arrlen(animations); i++)
+        arrfree(animations[i].keyframes);
+    arrfree(animations);
+    animation_set_destroy(&set);
+    transform_store_destroy(&store);
+    free(order);
+    free(dst);
+    free(draws);
+    return 0;
+}
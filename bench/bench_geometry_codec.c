@@ -0,0 +1,194 @@
+#include "bench.h"
+#include "geometry_codec.h"
+#include "scene_cache.h"
+
+#include <sys/stat.h>
+
+// meshopt vertex/index codec over a glTF's geometry: compression ratio, decode
+// throughput (decoded bytes per second, serial and on all cores, against a plain
+// memcpy of the same bytes), then .scache size and cached load time with the
+// raw and the compressed geometry sections.
+//
+// Doubles as the codec round-trip check: every decode, and every load from
+// either kind of cache, is compared with the uncached import (vertices
+// bitwise, indices up to triangle rotation). Any mismatch fails the bench.
+
+// Same geometry as the uncached import.
+static bool geometry_matches(const Geometry* ref, const Geometry* g)
+{
+    uint32_t vertex_count = (uint32_t)arrlen(ref->vertices);
+    uint32_t index_count  = (uint32_t)arrlen(ref->indices);
+    uint32_t mesh_count   = (uint32_t)arrlen(ref->meshes);
+
+    return (uint32_t)arrlen(g->vertices) == vertex_count && (uint32_t)arrlen(g->indices) == index_count
+           && (uint32_t)arrlen(g->meshes) == mesh_count
+           && memcmp(g->vertices, ref->vertices, (size_t)vertex_count * sizeof(VertexPacked)) == 0
+           && geometry_indices_equivalent(g->indices, ref->indices, index_count)
+           && memcmp(g->meshes, ref->meshes, (size_t)mesh_count * sizeof(Mesh)) == 0;
+}
+
+static double gb_per_s(uint64_t bytes, double ms)
+{
+    return ms > 0.0 ? (double)bytes / (ms * 1e6) : 0.0;
+}
+
+static uint64_t file_size(const char* path)
+{
+    struct stat st;
+    return stat(path, &st) == 0 ? (uint64_t)st.st_size : 0u;
+}
+
+static bool bench_cache_mode(const Geometry* ref, const char* path, const char* cache_path, bool compressed,
+                             uint32_t iterations)
+{
+    scene_cache_set_compression(compressed);
+    remove(cache_path);
+
+    Scene scene = {0};
+    bool  ok    = scene_load_gltf(&scene, path);  // writes the cache
+    scene_free(&scene);
+    if(!ok)
+        return false;
+
+    BenchStats load = {0};
+    for(uint32_t i = 0; i < iterations; i++)
+    {
+        uint64_t t0 = time_now_ns();
+        ok          = scene_load_gltf(&scene, path) && ok;
+        bench_stats_add(&load, time_ns_to_ms(time_now_ns() - t0));
+        ok = ok && geometry_matches(ref, &scene.geometry);
+        scene_free(&scene);
+    }
+
+    char label[64];
+    snprintf(label, sizeof(label), "cached load (%s)", compressed ? "meshopt" : "raw");
+    bench_stats_print(label, &load);
+    printf("    .scache size: %.2f MB%s\n", (double)file_size(cache_path) / (1024.0 * 1024.0),
+           ok ? "" : "  MISMATCH");
+    return ok;
+}
+
+int bench_geometry_codec(int argc, char** argv)
+{
+    if(argc < 2)
+    {
+        printf("geometry_codec: missing <file.glb>\n");
+        return 1;
+    }
+
+    const char* path       = argv[1];
+    uint32_t    iterations = bench_arg_u32(argc, argv, 2, 10);
+
+    Scene scene = {0};
+    scene_cache_set_enabled(false);
+    if(!scene_load_gltf(&scene, path))
+    {
+        printf("geometry_codec: failed to load '%s'\n", path);
+        return 1;
+    }
+
+    bool            ok           = true;
+    const Geometry* g            = &scene.geometry;
+    uint32_t        vertex_count = (uint32_t)arrlen(g->vertices);
+    uint32_t        index_count  = (uint32_t)arrlen(g->indices);
+    uint64_t        vertex_bytes = (uint64_t)vertex_count * sizeof(VertexPacked);
+    uint64_t        index_bytes  = (uint64_t)index_count * sizeof(uint32_t);
+    uint64_t        raw_bytes    = vertex_bytes + index_bytes;
+
+    JobPool pool = {0};
+    job_pool_init(&pool, 0);
+
+    GeometryPack pack   = {0};
+    BenchStats   encode = {0};
+    for(uint32_t i = 0; i < iterations; i++)
+    {
+        geometry_pack_free(&pack);
+        uint64_t t0 = time_now_ns();
+        bool     encoded = geometry_pack_encode(&pack, g, 0, (uint32_t)arrlen(g->meshes), 0, vertex_count, 0, index_count, &pool);
+        bench_stats_add(&encode, time_ns_to_ms(time_now_ns() - t0));
+        if(!encoded)
+        {
+            printf("geometry_codec: encode failed\n");
+            job_pool_destroy(&pool);
+            scene_free(&scene);
+            return 1;
+        }
+    }
+
+    uint64_t enc_vertex = 0, enc_index = 0;
+    for(uint32_t i = 0; i < (uint32_t)arrlen(pack.streams); i++)
+    {
+        enc_vertex += pack.streams[i].vertexBytes;
+        enc_index += pack.streams[i].indexBytes;
+    }
+
+    printf("\ngeometry_codec: %s\n", path);
+    printf("  %u meshes, %u vertices, %u indices\n", (uint32_t)arrlen(g->meshes), vertex_count, index_count);
+    printf("  vertices %.2f MB -> %.2f MB (%.2fx), indices %.2f MB -> %.2f MB (%.2fx), total %.2fx\n",
+           (double)vertex_bytes / (1024.0 * 1024.0), (double)enc_vertex / (1024.0 * 1024.0),
+           enc_vertex ? (double)vertex_bytes / (double)enc_vertex : 0.0, (double)index_bytes / (1024.0 * 1024.0),
+           (double)enc_index / (1024.0 * 1024.0), enc_index ? (double)index_bytes / (double)enc_index : 0.0,
+           arrlen(pack.data) ? (double)raw_bytes / (double)arrlen(pack.data) : 0.0);
+    bench_stats_print("encode (all cores)", &encode);
+
+    // destination pages touched up front so page faults don't count as decode time
+    VertexPacked* dst_vertices = (VertexPacked*)malloc(MAX(vertex_bytes, 1u));
+    uint32_t*     dst_indices  = (uint32_t*)malloc(MAX(index_bytes, 1u));
+    memset(dst_vertices, 0, (size_t)vertex_bytes);
+    memset(dst_indices, 0, (size_t)index_bytes);
+
+    BenchStats copy = {0};
+    for(uint32_t i = 0; i < iterations; i++)
+    {
+        uint64_t t0 = time_now_ns();
+        memcpy(dst_vertices, g->vertices, (size_t)vertex_bytes);
+        memcpy(dst_indices, g->indices, (size_t)index_bytes);
+        bench_stats_add(&copy, time_ns_to_ms(time_now_ns() - t0));
+    }
+    bench_stats_print("memcpy (raw)", &copy);
+    printf("    %.2f GB/s\n", gb_per_s(raw_bytes, bench_stats_mean(&copy)));
+
+    for(uint32_t parallel = 0; parallel < 2; parallel++)
+    {
+        BenchStats decode  = {0};
+        bool       decoded = true;
+        for(uint32_t i = 0; i < iterations; i++)
+        {
+            memset(dst_vertices, 0, (size_t)vertex_bytes);
+            memset(dst_indices, 0, (size_t)index_bytes);
+
+            uint64_t t0 = time_now_ns();
+            decoded     = geometry_pack_decode(pack.streams, (uint32_t)arrlen(pack.streams), pack.data, dst_vertices,
+                                               dst_indices, parallel ? &pool : NULL) && decoded;
+            bench_stats_add(&decode, time_ns_to_ms(time_now_ns() - t0));
+
+            decoded = decoded && memcmp(dst_vertices, g->vertices, (size_t)vertex_bytes) == 0
+                      && geometry_indices_equivalent(dst_indices, g->indices, index_count);
+        }
+        ok = ok && decoded;
+
+        char label[64];
+        snprintf(label, sizeof(label), "decode (%s)", parallel ? "all cores" : "serial");
+        bench_stats_print(label, &decode);
+        printf("    %.2f GB/s decoded%s\n", gb_per_s(raw_bytes, bench_stats_mean(&decode)), decoded ? "" : "  MISMATCH");
+    }
+
+    free(dst_vertices);
+    free(dst_indices);
+    geometry_pack_free(&pack);
+    job_pool_destroy(&pool);
+
+    char* cache_path = scene_cache_path(path);
+    scene_cache_set_enabled(true);
+    if(cache_path)
+    {
+        ok = bench_cache_mode(g, path, cache_path, false, iterations) && ok;
+        ok = bench_cache_mode(g, path, cache_path, true, iterations) && ok;
+    }
+    scene_cache_set_compression(false);
+    free(cache_path);
+    scene_free(&scene);
+
+    printf("  round trip: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,135 @@
+#include "bench.h"
+#include "meshlet_cull.h"
+#include "scene.h"
+
+#include <float.h>
+
+// Automatic instancing on the CPU reference: the scene's draws are repeated on
+// a grid (copies of the whole scene side by side), culled from a camera that
+// sees the whole grid, and the surviving ranges merged with meshlet_cull_batch.
+// Reports indirect commands before and after merging and the merge cost.
+
+static void scene_bounds(const Scene* scene, vec3 out_lo, vec3 out_hi)
+{
+    glm_vec3_copy((vec3){FLT_MAX, FLT_MAX, FLT_MAX}, out_lo);
+    glm_vec3_copy((vec3){-FLT_MAX, -FLT_MAX, -FLT_MAX}, out_hi);
+
+    for(uint32_t i = 0; i < (uint32_t)arrlen(scene->draws); i++)
+    {
+        const MeshDraw* d = &scene->draws[i];
+        const Mesh*     m = &scene->geometry.meshes[d->meshIndex];
+        float           r = m->radius * d->scale;
+
+        for(int k = 0; k < 3; k++)
+        {
+            out_lo[k] = fminf(out_lo[k], d->position[k] - r);
+            out_hi[k] = fmaxf(out_hi[k], d->position[k] + r);
+        }
+    }
+}
+
+int bench_instancing(int argc, char** argv)
+{
+    if(argc < 2)
+    {
+        printf("instancing: missing <file.glb>\n");
+        return 1;
+    }
+
+    const char* path       = argv[1];
+    uint32_t    copies     = MAX(bench_arg_u32(argc, argv, 2, 64), 1u);
+    uint32_t    iterations = bench_arg_u32(argc, argv, 3, 10);
+
+    scene_import_set_meshlets(true);
+
+    Scene scene = {0};
+    if(!scene_load_gltf(&scene, path))
+    {
+        printf("instancing: failed to load '%s'\n", path);
+        return 1;
+    }
+
+    uint32_t source_draws = (uint32_t)arrlen(scene.draws);
+    if(source_draws == 0)
+    {
+        printf("instancing: '%s' has no draws\n", path);
+        scene_free(&scene);
+        return 1;
+    }
+
+    vec3 lo, hi;
+    scene_bounds(&scene, lo, hi);
+
+    // copies laid out on an XZ grid, one scene extent apart
+    uint32_t side   = (uint32_t)ceilf(sqrtf((float)copies));
+    float    step_x = (hi[0] - lo[0]) * 1.1f + 1e-3f;
+    float    step_z = (hi[2] - lo[2]) * 1.1f + 1e-3f;
+    for(uint32_t c = 1; c < copies; c++)
+    {
+        float dx = (float)(c % side) * step_x;
+        float dz = (float)(c / side) * step_z;
+        for(uint32_t i = 0; i < source_draws; i++)
+        {
+            MeshDraw d = scene.draws[i];
+            d.position[0] += dx;
+            d.position[2] += dz;
+            arrpush(scene.draws, d);
+        }
+    }
+
+    scene_bounds(&scene, lo, hi);
+    vec3 center;
+    glm_vec3_center(lo, hi, center);
+    float radius = fmaxf(glm_vec3_distance(lo, hi) * 0.5f, 1e-3f);
+
+    // above and behind the grid, looking at its center
+    vec3       eye = {center[0], center[1] + radius, center[2] + radius * 1.5f};
+    CullParams p   = {0};
+    glm_lookat(eye, center, (vec3){0.0f, 1.0f, 0.0f}, p.view);
+    p.tanHalfY       = tanf(glm_rad(60.0f) * 0.5f);
+    p.tanHalfX       = p.tanHalfY * 16.0f / 9.0f;
+    p.znear          = 0.1f;
+    p.zfar           = radius * 8.0f;
+    p.lodTargetPx    = 1.0f;
+    p.viewportHeight = 1080.0f;
+    p.lodEnabled     = true;
+
+    MeshletCullStats  stats       = {0};
+    MeshletDrawRange* ranges      = NULL;
+    MeshletDrawBatch* batches     = NULL;
+    uint32_t*         instances   = NULL;
+    uint32_t          batch_count = 0;
+    BenchStats        cull_time = {0}, batch_time = {0};
+
+    for(uint32_t it = 0; it < iterations; it++)
+    {
+        arrsetlen(ranges, 0);
+
+        uint64_t t0 = time_now_ns();
+        meshlet_cull_scene(&p, &scene, &stats, &ranges);
+        bench_stats_add(&cull_time, time_ns_to_ms(time_now_ns() - t0));
+
+        t0          = time_now_ns();
+        batch_count = meshlet_cull_batch(ranges, (uint32_t)arrlen(ranges), &batches, &instances);
+        bench_stats_add(&batch_time, time_ns_to_ms(time_now_ns() - t0));
+    }
+
+    uint32_t range_count = (uint32_t)arrlen(ranges);
+    uint32_t largest     = 0;
+    for(uint32_t b = 0; b < batch_count; b++)
+        largest = MAX(largest, batches[b].instanceCount);
+
+    printf("\ninstancing: %s x%u (%u draws, %u meshlets)\n", path, copies, (uint32_t)arrlen(scene.draws),
+           (uint32_t)arrlen(scene.geometry.meshlets));
+    printf("  draws visible      %u / %u\n", stats.drawsVisible, stats.drawsTested);
+    printf("  indirect commands  %u -> %u (%.1f instances per command, largest %u)\n", range_count, batch_count,
+           batch_count ? (double)range_count / (double)batch_count : 0.0, largest);
+    bench_stats_print("cpu cull", &cull_time);
+    bench_stats_print("cpu batch", &batch_time);
+
+    arrfree(ranges);
+    arrfree(batches);
+    arrfree(instances);
+    scene_free(&scene);
+    return 0;
+}
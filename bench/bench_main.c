@@ -0,0 +1,59 @@
+#include "bench.h"
+#include "scene.h"
+
+typedef struct BenchEntry
+{
+    const char* name;
+    int (*fn)(int argc, char** argv);
+    const char* usage;
+} BenchEntry;
+
+static const BenchEntry g_benches[] = {
+    {"scene_cache", bench_scene_cache, "<file.glb> [iterations]"},
+    {"scene_import", bench_scene_import, "<file.glb> [iterations]"},
+    {"meshlet_cull", bench_meshlet_cull, "<file.glb> [iterations]"},
+    {"scene_objects", bench_scene_objects, "[iterations]"},
+    {"transform_store", bench_transform_store, "[draws] [iterations]"},
+    {"scene_bvh", bench_scene_bvh, "[iterations]"},
+    {"geometry_codec", bench_geometry_codec, "<file.glb> [iterations]"},
+    {"animation", bench_animation, "[draws] [iterations]"},
+    {"instancing", bench_instancing, "<file.glb> [copies] [iterations]"},
+    {"texture_file", bench_texture_file, "<file.dds|.ktx|.png> [iterations]"},
+    {"staging", bench_staging, "[megabytes] [chunk_kb]"},
+    {"texture_mips", bench_texture_mips, "[size] [iterations]"},
+    {"procedural", bench_procedural, "[size] [iterations]"},
+    {"pipeline_cache", bench_pipeline_cache, "[permutations] [iterations]"},
+    {"pipeline_compile", bench_pipeline_compile, "[permutations] [threads]"},
+    {"shader_reflect", bench_shader_reflect, "[spv dir] [iterations]"},
+    {"slang_compile", bench_slang_compile, "[iterations]"},
+};
+
+static void print_usage(const char* exe)
+{
+    printf("usage: %s <bench> [args]\n", exe);
+    for(uint32_t i = 0; i < (uint32_t)(sizeof(g_benches) / sizeof(g_benches[0])); i++)
+        printf("  %-16s %s\n", g_benches[i].name, g_benches[i].usage);
+}
+
+int main(int argc, char** argv)
+{
+    if(argc < 2)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    for(uint32_t i = 0; i < (uint32_t)(sizeof(g_benches) / sizeof(g_benches[0])); i++)
+    {
+        if(strcmp(argv[1], g_benches[i].name) == 0)
+        {
+            int result = g_benches[i].fn(argc - 1, argv + 1);
+            scene_import_shutdown();
+            return result;
+        }
+    }
+
+    printf("unknown bench '%s'\n", argv[1]);
+    print_usage(argv[0]);
+    return 1;
+}
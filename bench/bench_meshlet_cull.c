@@ -0,0 +1,148 @@
+#include "bench.h"
+#include "meshlet_cull.h"
+#include "scene.h"
+
+#include <float.h>
+
+// Triangles submitted with draw-level culling (cull.comp) vs. after the meshlet
+// stage (meshlet_cull.comp), using the CPU reference from a ring of cameras
+// around the scene. The second pass adds a synthetic occluder: a wall covering
+// the lower half of the screen at the scene center distance.
+
+#define VIEW_COUNT 8
+
+static void scene_bounds(const Scene* scene, vec3 out_center, float* out_radius)
+{
+    vec3 lo = {FLT_MAX, FLT_MAX, FLT_MAX};
+    vec3 hi = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+
+    for(uint32_t i = 0; i < (uint32_t)arrlen(scene->draws); i++)
+    {
+        const MeshDraw* d = &scene->draws[i];
+        const Mesh*     m = &scene->geometry.meshes[d->meshIndex];
+        float           r = m->radius * d->scale;
+
+        for(int k = 0; k < 3; k++)
+        {
+            lo[k] = fminf(lo[k], d->position[k] - r);
+            hi[k] = fmaxf(hi[k], d->position[k] + r);
+        }
+    }
+
+    glm_vec3_center(lo, hi, out_center);
+    *out_radius = fmaxf(glm_vec3_distance(lo, hi) * 0.5f, 1e-3f);
+}
+
+static void accumulate(MeshletCullStats* total, const MeshletCullStats* s)
+{
+    total->drawsTested += s->drawsTested;
+    total->drawsVisible += s->drawsVisible;
+    total->meshletsTested += s->meshletsTested;
+    total->meshletsVisible += s->meshletsVisible;
+    total->culledFrustum += s->culledFrustum;
+    total->culledCone += s->culledCone;
+    total->culledOcclusion += s->culledOcclusion;
+    total->trianglesDrawCull += s->trianglesDrawCull;
+    total->trianglesMeshletCull += s->trianglesMeshletCull;
+}
+
+static void print_pass(const char* label, const MeshletCullStats* t, const BenchStats* time)
+{
+    double reduction = t->trianglesDrawCull
+                           ? 100.0 * (1.0 - (double)t->trianglesMeshletCull / (double)t->trianglesDrawCull)
+                           : 0.0;
+
+    printf("  %s\n", label);
+    printf("    draws visible      %u / %u\n", t->drawsVisible, t->drawsTested);
+    printf("    meshlets visible   %llu / %llu (frustum %llu, cone %llu, occlusion %llu)\n",
+           (unsigned long long)t->meshletsVisible, (unsigned long long)t->meshletsTested,
+           (unsigned long long)t->culledFrustum, (unsigned long long)t->culledCone,
+           (unsigned long long)t->culledOcclusion);
+    printf("    triangles          %llu -> %llu (%.1f%% fewer)\n", (unsigned long long)t->trianglesDrawCull,
+           (unsigned long long)t->trianglesMeshletCull, reduction);
+    bench_stats_print("cpu cull", time);
+}
+
+int bench_meshlet_cull(int argc, char** argv)
+{
+    if(argc < 2)
+    {
+        printf("meshlet_cull: missing <file.glb>\n");
+        return 1;
+    }
+
+    const char* path       = argv[1];
+    uint32_t    iterations = bench_arg_u32(argc, argv, 2, 10);
+
+    scene_import_set_meshlets(true);
+
+    Scene scene = {0};
+    if(!scene_load_gltf(&scene, path))
+    {
+        printf("meshlet_cull: failed to load '%s'\n", path);
+        return 1;
+    }
+
+    if(arrlen(scene.draws) == 0 || arrlen(scene.geometry.meshlets) == 0)
+    {
+        printf("meshlet_cull: '%s' has no draws or meshlets\n", path);
+        scene_free(&scene);
+        return 1;
+    }
+
+    vec3  center;
+    float radius;
+    scene_bounds(&scene, center, &radius);
+
+    float  fov_y  = glm_rad(60.0f);
+    float  aspect = 16.0f / 9.0f;
+    float* wall   = (float*)malloc(sizeof(float) * OCCLUSION_GRID_W * OCCLUSION_GRID_H);
+
+    MeshletCullStats totals[2] = {0};
+    BenchStats       times[2]  = {0};
+
+    for(uint32_t v = 0; v < VIEW_COUNT; v++)
+    {
+        float angle = (float)v / VIEW_COUNT * 2.0f * GLM_PIf;
+        float dist  = radius * 2.0f;
+        vec3  eye   = {center[0] + cosf(angle) * dist, center[1] + radius * 0.5f, center[2] + sinf(angle) * dist};
+
+        CullParams p = {0};
+        glm_lookat(eye, center, (vec3){0.0f, 1.0f, 0.0f}, p.view);
+        p.tanHalfY       = tanf(fov_y * 0.5f);
+        p.tanHalfX       = p.tanHalfY * aspect;
+        p.znear          = 0.1f;
+        p.zfar           = 10000.0f;
+        p.lodTargetPx    = 1.0f;
+        p.viewportHeight = 1080.0f;
+        p.lodEnabled     = true;
+
+        // lower half of the screen occluded at the center distance (tiles store reverse-Z depth)
+        float wall_depth = p.znear / glm_vec3_distance(eye, center);
+        for(uint32_t y = 0; y < OCCLUSION_GRID_H; y++)
+            for(uint32_t x = 0; x < OCCLUSION_GRID_W; x++)
+                wall[y * OCCLUSION_GRID_W + x] = (y >= OCCLUSION_GRID_H / 2) ? wall_depth : 0.0f;
+
+        for(uint32_t pass = 0; pass < 2; pass++)
+        {
+            p.occlusion = pass == 1 ? wall : NULL;
+
+            MeshletCullStats s = {0};
+            for(uint32_t i = 0; i < iterations; i++)
+            {
+                uint64_t t0 = time_now_ns();
+                meshlet_cull_scene(&p, &scene, &s, NULL);
+                bench_stats_add(&times[pass], time_ns_to_ms(time_now_ns() - t0));
+            }
+            accumulate(&totals[pass], &s);
+        }
+    }
+
+    printf("\nmeshlet_cull: %s (%u meshlets, %d views)\n", path, (uint32_t)arrlen(scene.geometry.meshlets), VIEW_COUNT);
+    print_pass("frustum + cone", &totals[0], &times[0]);
+    print_pass("frustum + cone + occlusion (synthetic wall)", &totals[1], &times[1]);
+
+    free(wall);
+    scene_free(&scene);
+    return 0;
+}
@@ -0,0 +1,252 @@
+#include "bench.h"
+#include "file_utils.h"
+#include "vk_startup.h"
+#include "vk_pipelines.h"
+
+// PSO cache with N graphics pipeline permutations (default 5000): the shader
+// pairs in compiledshaders/ times raster/depth/blend/format states.
+//   cold        every permutation misses and creates its pipeline
+//   hit         get_or_create_graphics_pipeline over all of them, per lookup
+//   linear      the memcmp scan the cache used to do, over the same keys
+//   load+refl   reading both SPIR-V files and reflecting the layout, which
+//               every lookup used to pay on top of the scan
+// Headless: no window or surface, first GPU with a graphics queue.
+
+typedef struct PipelineBenchGpu
+{
+    renderer_context ctx;
+    VkPhysicalDevice gpu;
+    VkDevice         device;
+    queue_families   qf;
+} PipelineBenchGpu;
+
+static const char* g_shader_pairs[][2] = {
+    {"compiledshaders/tri.vert.spv", "compiledshaders/tri.frag.spv"},
+    {"compiledshaders/toon.vert.spv", "compiledshaders/toon.frag.spv"},
+    {"compiledshaders/toon.vert.spv", "compiledshaders/toon_outline.frag.spv"},
+    {"compiledshaders/terrain.vert.spv", "compiledshaders/terrain.frag.spv"},
+    {"compiledshaders/water.vert.spv", "compiledshaders/water.frag.spv"},
+    {"compiledshaders/grass.vert.spv", "compiledshaders/grass.frag.spv"},
+    {"compiledshaders/sky.vert.spv", "compiledshaders/sky.frag.spv"},
+    {"compiledshaders/fullscreen.vert.spv", "compiledshaders/fullscreen.frag.spv"},
+    {"compiledshaders/tonemap.vert.spv", "compiledshaders/tonemap.frag.spv"},
+};
+
+static const VkFormat g_color_formats[] = {VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_R16G16B16A16_SFLOAT};
+
+#define PIPELINE_BENCH_PAIRS (uint32_t)(sizeof(g_shader_pairs) / sizeof(g_shader_pairs[0]))
+
+// 3 cull * 2 winding * 2 topology * 2 depth test * 2 depth write * 4 compare * 2 blend * 2 formats
+#define PIPELINE_BENCH_STATES 768u
+
+static bool pipeline_bench_init(PipelineBenchGpu* g)
+{
+    memset(g, 0, sizeof(*g));
+    if(volkInitialize() != VK_SUCCESS)
+        return false;
+
+    // VK_KHR_get_surface_capabilities2 is always requested and depends on it
+    const char*           inst_exts[] = {VK_KHR_SURFACE_EXTENSION_NAME};
+    renderer_context_desc desc        = {
+        .app_name                 = "bench_pipeline_cache",
+        .instance_extensions      = inst_exts,
+        .instance_extension_count = 1,
+    };
+    vk_create_instance(&g->ctx, &desc);
+    volkLoadInstanceOnly(g->ctx.instance);
+
+    uint32_t gpu_count = 1;
+    vkEnumeratePhysicalDevices(g->ctx.instance, &gpu_count, &g->gpu);
+    if(gpu_count == 0)
+        return false;
+
+    uint32_t family_count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(g->gpu, &family_count, NULL);
+    VkQueueFamilyProperties families[16];
+    family_count = MIN(family_count, 16u);
+    vkGetPhysicalDeviceQueueFamilyProperties(g->gpu, &family_count, families);
+    for(uint32_t i = 0; i < family_count && !g->qf.has_graphics; i++)
+    {
+        if(families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)
+        {
+            g->qf.graphics_family = g->qf.present_family = i;
+            g->qf.has_graphics = g->qf.has_present = 1;
+        }
+    }
+    if(!g->qf.has_graphics)
+        return false;
+
+    create_device(g->gpu, VK_NULL_HANDLE, &desc, g->qf, &g->device);
+    if(!g->device)
+        return false;
+    volkLoadDevice(g->device);
+    init_device_queues(g->device, &g->qf);
+    return true;
+}
+
+static void pipeline_bench_shutdown(PipelineBenchGpu* g)
+{
+    if(g->device)
+    {
+        vkDeviceWaitIdle(g->device);
+        vkDestroyDevice(g->device, NULL);
+    }
+    if(g->ctx.instance)
+        vkDestroyInstance(g->ctx.instance, NULL);
+}
+
+// State permutation i (mixed radix over the fields above).
+static GraphicsPipelineConfig permutation_config(uint32_t i)
+{
+    static const VkCullModeFlags culls[]    = {VK_CULL_MODE_NONE, VK_CULL_MODE_BACK_BIT, VK_CULL_MODE_FRONT_BIT};
+    static const VkCompareOp     compares[] = {VK_COMPARE_OP_GREATER_OR_EQUAL, VK_COMPARE_OP_LESS, VK_COMPARE_OP_EQUAL,
+                                               VK_COMPARE_OP_ALWAYS};
+
+    GraphicsPipelineConfig cfg = graphics_pipeline_config_default();
+    cfg.cull_mode              = culls[i % 3];
+    i /= 3;
+    cfg.front_face = (i % 2) ? VK_FRONT_FACE_CLOCKWISE : VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    i /= 2;
+    cfg.topology = (i % 2) ? VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP : VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    i /= 2;
+    cfg.depth_test_enable = (i % 2) != 0;
+    i /= 2;
+    cfg.depth_write_enable = (i % 2) != 0;
+    i /= 2;
+    cfg.depth_compare_op = compares[i % 4];
+    i /= 4;
+    cfg.blend_enable = (i % 2) != 0;
+    i /= 2;
+    cfg.color_formats = &g_color_formats[i % 2];
+    cfg.depth_format  = VK_FORMAT_D32_SFLOAT;
+    return cfg;
+}
+
+int bench_pipeline_cache(int argc, char** argv)
+{
+    uint32_t permutations = MAX(bench_arg_u32(argc, argv, 1, 5000), 1u);
+    uint32_t iterations   = MAX(bench_arg_u32(argc, argv, 2, 20), 1u);
+
+    uint32_t pairs[PIPELINE_BENCH_PAIRS];
+    uint32_t pair_count = 0;
+    for(uint32_t i = 0; i < PIPELINE_BENCH_PAIRS; i++)
+    {
+        if(file_exists(g_shader_pairs[i][0]) && file_exists(g_shader_pairs[i][1]))
+            pairs[pair_count++] = i;
+    }
+    if(pair_count == 0)
+    {
+        printf("pipeline_cache: no shaders in compiledshaders/ (run from the repo root)\n");
+        return 1;
+    }
+    permutations = MIN(permutations, pair_count * PIPELINE_BENCH_STATES);
+
+    PipelineBenchGpu g = {0};
+    if(!pipeline_bench_init(&g))
+    {
+        printf("pipeline_cache: no Vulkan device\n");
+        pipeline_bench_shutdown(&g);
+        return 1;
+    }
+
+    DescriptorLayoutCache desc_cache = {0};
+    PipelineLayoutCache   pipe_cache = {0};
+    GraphicsPipelineCache pso_cache  = {0};
+    descriptor_layout_cache_init(&desc_cache, g.device);
+    pipeline_layout_cache_init(&pipe_cache);
+
+    VkPipelineCacheCreateInfo vk_cache_ci = {.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+    VkPipelineCache           vk_cache    = VK_NULL_HANDLE;
+    VK_CHECK(vkCreatePipelineCache(g.device, &vk_cache_ci, NULL, &vk_cache));
+
+    GraphicsPipelineConfig* configs   = malloc(permutations * sizeof(*configs));
+    VkPipeline*             pipelines = malloc(permutations * sizeof(*pipelines));
+    for(uint32_t i = 0; i < permutations; i++)
+        configs[i] = permutation_config(i / pair_count);
+
+    printf("\npipeline_cache: %u permutations (%u shader pairs x %u states), %u iterations\n", permutations, pair_count,
+           PIPELINE_BENCH_STATES, iterations);
+
+    // cold: every permutation creates its pipeline
+    uint64_t t0 = time_now_ns();
+    for(uint32_t i = 0; i < permutations; i++)
+    {
+        const char* const* pair = g_shader_pairs[pairs[i % pair_count]];
+        pipelines[i] = get_or_create_graphics_pipeline(&pso_cache, g.device, vk_cache, &desc_cache, &pipe_cache, pair[0],
+                                                       pair[1], &configs[i], VK_NULL_HANDLE, NULL);
+    }
+    double cold_ms = time_ns_to_ms(time_now_ns() - t0);
+    printf("  %-12s %10.2f ms  %9.3f ms/pipeline  (%zu cached, %d set layouts, %d pipeline layouts)\n", "cold", cold_ms,
+           cold_ms / permutations, pso_cache.count, (int)arrlen(desc_cache.entries), (int)arrlen(pipe_cache.entries));
+
+    // hit: all lookups, no file reads or reflection
+    BenchStats hit        = {0};
+    uint32_t   mismatched = 0;
+    for(uint32_t it = 0; it < iterations; it++)
+    {
+        t0 = time_now_ns();
+        for(uint32_t i = 0; i < permutations; i++)
+        {
+            const char* const* pair = g_shader_pairs[pairs[i % pair_count]];
+            VkPipeline         p = get_or_create_graphics_pipeline(&pso_cache, g.device, vk_cache, &desc_cache, &pipe_cache,
+                                                                   pair[0], pair[1], &configs[i], VK_NULL_HANDLE, NULL);
+            mismatched += p != pipelines[i];
+        }
+        bench_stats_add(&hit, time_ns_to_ms(time_now_ns() - t0));
+    }
+    printf("  %-12s %10.1f ns/lookup  (%u lookups returned another pipeline)\n", "hit",
+           bench_stats_mean(&hit) * 1e6 / permutations, mismatched);
+
+    // linear: the old scan over the same keys
+    BenchStats linear = {0};
+    size_t     found  = 0;
+    for(uint32_t it = 0; it < iterations; it++)
+    {
+        t0 = time_now_ns();
+        for(size_t i = 0; i < pso_cache.count; i++)
+        {
+            const GraphicsPipelineKey* key = &pso_cache.entries[i].key;
+            for(size_t j = 0; j < pso_cache.count; j++)
+            {
+                if(memcmp(&pso_cache.entries[j].key, key, sizeof(*key)) == 0)
+                {
+                    found += j;
+                    break;
+                }
+            }
+        }
+        bench_stats_add(&linear, time_ns_to_ms(time_now_ns() - t0));
+    }
+    printf("  %-12s %10.1f ns/lookup  (scan only, mean depth %zu)\n", "linear",
+           bench_stats_mean(&linear) * 1e6 / MAX(pso_cache.count, (size_t)1), found / MAX(pso_cache.count * iterations, (size_t)1));
+
+    // load+refl: what every lookup paid before the scan
+    BenchStats reflect = {0};
+    for(uint32_t it = 0; it < iterations; it++)
+    {
+        t0 = time_now_ns();
+        for(uint32_t p = 0; p < pair_count; p++)
+        {
+            void*  codes[2] = {NULL, NULL};
+            size_t sizes[2] = {0, 0};
+            if(read_file(g_shader_pairs[pairs[p]][0], &codes[0], &sizes[0])
+               && read_file(g_shader_pairs[pairs[p]][1], &codes[1], &sizes[1]))
+            {
+                shader_reflect_build_pipeline_layout(g.device, &desc_cache, &pipe_cache, (const void* const*)codes, sizes, 2);
+            }
+            free(codes[0]);
+            free(codes[1]);
+        }
+        bench_stats_add(&reflect, time_ns_to_ms(time_now_ns() - t0));
+    }
+    printf("  %-12s %10.1f ns/lookup\n", "load+refl", bench_stats_mean(&reflect) * 1e6 / pair_count);
+
+    graphics_pipeline_cache_destroy(g.device, &pso_cache);
+    vkDestroyPipelineCache(g.device, vk_cache, NULL);
+    pipeline_layout_cache_destroy(g.device, &pipe_cache);
+    descriptor_layout_cache_destroy(&desc_cache);
+    free(configs);
+    free(pipelines);
+    pipeline_bench_shutdown(&g);
+    return 0;
+}
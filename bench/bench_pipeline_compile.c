@@ -0,0 +1,254 @@
+#include "bench.h"
+#include "file_utils.h"
+#include "vk_startup.h"
+#include "render_object.h"
+
+// RenderObject pipeline creation for N state permutations (default 192) of
+// the shader pairs in compiledshaders/:
+//   async cold  render_pipeline_create_async on a PipelineCompiler, then
+//               render_pipeline_wait on every pipeline, starting without a
+//               cache file; closing saves one
+//   async warm  the same, loading that file (creation feedback should report
+//               every pipeline as a hit)
+//   serial      render_pipeline_create, one after another, empty cache
+// "submit" is the main thread time until the last job is queued (shader
+// loading, reflection, layouts); the rest is the wait for the workers.
+// Drivers with their own on-disk shader cache make later cold runs cheaper, so
+// async cold runs first.
+
+#define COMPILE_BENCH_CACHE "bench_pipeline_cache.bin"
+
+typedef struct CompileBenchGpu
+{
+    renderer_context ctx;
+    VkPhysicalDevice gpu;
+    VkDevice         device;
+    queue_families   qf;
+} CompileBenchGpu;
+
+static const char* g_compile_pairs[][2] = {
+    {"compiledshaders/tri.vert.spv", "compiledshaders/tri.frag.spv"},
+    {"compiledshaders/toon.vert.spv", "compiledshaders/toon.frag.spv"},
+    {"compiledshaders/terrain.vert.spv", "compiledshaders/terrain.frag.spv"},
+    {"compiledshaders/grass.vert.spv", "compiledshaders/grass.frag.spv"},
+    {"compiledshaders/fullscreen.vert.spv", "compiledshaders/fullscreen.frag.spv"},
+};
+
+static const VkFormat g_compile_format = VK_FORMAT_R16G16B16A16_SFLOAT;
+
+#define COMPILE_BENCH_PAIRS (uint32_t)(sizeof(g_compile_pairs) / sizeof(g_compile_pairs[0]))
+
+// 3 cull * 2 winding * 4 compare * 2 blend * 2 depth write
+#define COMPILE_BENCH_STATES 96u
+
+static bool compile_bench_init(CompileBenchGpu* g)
+{
+    memset(g, 0, sizeof(*g));
+    if(volkInitialize() != VK_SUCCESS)
+        return false;
+
+    // VK_KHR_get_surface_capabilities2 is always requested and depends on it
+    const char*           inst_exts[] = {VK_KHR_SURFACE_EXTENSION_NAME};
+    renderer_context_desc desc        = {
+        .app_name                 = "bench_pipeline_compile",
+        .instance_extensions      = inst_exts,
+        .instance_extension_count = 1,
+    };
+    vk_create_instance(&g->ctx, &desc);
+    volkLoadInstanceOnly(g->ctx.instance);
+
+    uint32_t gpu_count = 1;
+    vkEnumeratePhysicalDevices(g->ctx.instance, &gpu_count, &g->gpu);
+    if(gpu_count == 0)
+        return false;
+
+    uint32_t family_count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(g->gpu, &family_count, NULL);
+    VkQueueFamilyProperties families[16];
+    family_count = MIN(family_count, 16u);
+    vkGetPhysicalDeviceQueueFamilyProperties(g->gpu, &family_count, families);
+    for(uint32_t i = 0; i < family_count && !g->qf.has_graphics; i++)
+    {
+        if(families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)
+        {
+            g->qf.graphics_family = g->qf.present_family = i;
+            g->qf.has_graphics = g->qf.has_present = 1;
+        }
+    }
+    if(!g->qf.has_graphics)
+        return false;
+
+    create_device(g->gpu, VK_NULL_HANDLE, &desc, g->qf, &g->device);
+    if(!g->device)
+        return false;
+    volkLoadDevice(g->device);
+    init_device_queues(g->device, &g->qf);
+    return true;
+}
+
+static void compile_bench_shutdown(CompileBenchGpu* g)
+{
+    if(g->device)
+    {
+        vkDeviceWaitIdle(g->device);
+        vkDestroyDevice(g->device, NULL);
+    }
+    if(g->ctx.instance)
+        vkDestroyInstance(g->ctx.instance, NULL);
+}
+
+static RenderObjectSpec permutation_spec(const char* const* pair, uint32_t i)
+{
+    static const VkCullModeFlags culls[]    = {VK_CULL_MODE_NONE, VK_CULL_MODE_BACK_BIT, VK_CULL_MODE_FRONT_BIT};
+    static const VkCompareOp     compares[] = {VK_COMPARE_OP_GREATER_OR_EQUAL, VK_COMPARE_OP_LESS, VK_COMPARE_OP_EQUAL,
+                                               VK_COMPARE_OP_ALWAYS};
+
+    RenderObjectSpec spec       = render_object_spec_default();
+    spec.vert_spv               = pair[0];
+    spec.frag_spv               = pair[1];
+    spec.color_attachment_count = 1;
+    spec.color_formats          = &g_compile_format;
+    spec.depth_format           = VK_FORMAT_D32_SFLOAT;
+    spec.cull_mode              = culls[i % 3];
+    i /= 3;
+    spec.front_face = (i % 2) ? VK_FRONT_FACE_CLOCKWISE : VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    i /= 2;
+    spec.depth_compare = compares[i % 4];
+    i /= 4;
+    spec.blend_enable = (i % 2) != 0;
+    i /= 2;
+    spec.depth_write = (i % 2) != 0;
+    return spec;
+}
+
+typedef struct CompileBenchRun
+{
+    CompileBenchGpu*        g;
+    DescriptorLayoutCache*  desc_cache;
+    PipelineLayoutCache*    pipe_cache;
+    const RenderObjectSpec* specs;
+    RenderPipeline*         pipelines;
+    uint32_t                permutations;
+    uint32_t                threads;
+} CompileBenchRun;
+
+static double compile_bench_async(const CompileBenchRun* r, const char* label)
+{
+    uint32_t threads = r->threads ? r->threads : job_pool_default_threads();
+
+    PipelineCacheFile cache = {0};
+    pipeline_cache_file_open(&cache, r->g->device, r->g->gpu, COMPILE_BENCH_CACHE, threads + 1, 0);
+    PipelineCompiler compiler = {0};
+    pipeline_compiler_init(&compiler, r->g->device, &cache, threads);
+
+    uint64_t t0 = time_now_ns();
+    for(uint32_t i = 0; i < r->permutations; i++)
+        r->pipelines[i] = render_pipeline_create_async(r->g->device, &compiler, r->desc_cache, r->pipe_cache, &r->specs[i]);
+    uint64_t t_submit = time_now_ns();
+
+    uint32_t failed = 0;
+    for(uint32_t i = 0; i < r->permutations; i++)
+        failed += !render_pipeline_wait(&r->pipelines[i]);
+    double ms        = time_ns_to_ms(time_now_ns() - t0);
+    double submit_ms = time_ns_to_ms(t_submit - t0);
+
+    printf("  %-10s %10.2f ms  %8.3f ms/pipeline  (submit %.2f ms, %u failed)\n", label, ms, ms / r->permutations,
+           submit_ms, failed);
+    printf("    ");
+    pipeline_compiler_print_stats(&compiler);
+
+    for(uint32_t i = 0; i < r->permutations; i++)
+        render_pipeline_destroy(r->g->device, &r->pipelines[i]);
+    pipeline_compiler_destroy(&compiler);
+
+    pipeline_cache_file_save(&cache);
+    printf("    ");
+    pipeline_cache_file_print_stats(&cache);
+    pipeline_cache_file_close(&cache);
+    return ms;
+}
+
+int bench_pipeline_compile(int argc, char** argv)
+{
+    uint32_t permutations = MAX(bench_arg_u32(argc, argv, 1, 192), 1u);
+    uint32_t threads      = bench_arg_u32(argc, argv, 2, 0);
+
+    uint32_t pairs[COMPILE_BENCH_PAIRS];
+    uint32_t pair_count = 0;
+    for(uint32_t i = 0; i < COMPILE_BENCH_PAIRS; i++)
+    {
+        if(file_exists(g_compile_pairs[i][0]) && file_exists(g_compile_pairs[i][1]))
+            pairs[pair_count++] = i;
+    }
+    if(pair_count == 0)
+    {
+        printf("pipeline_compile: no shaders in compiledshaders/ (run from the repo root)\n");
+        return 1;
+    }
+    permutations = MIN(permutations, pair_count * COMPILE_BENCH_STATES);
+
+    CompileBenchGpu g = {0};
+    if(!compile_bench_init(&g))
+    {
+        printf("pipeline_compile: no Vulkan device\n");
+        compile_bench_shutdown(&g);
+        return 1;
+    }
+
+    DescriptorLayoutCache desc_cache = {0};
+    PipelineLayoutCache   pipe_cache = {0};
+    descriptor_layout_cache_init(&desc_cache, g.device);
+    pipeline_layout_cache_init(&pipe_cache);
+
+    RenderObjectSpec* specs     = malloc(permutations * sizeof(*specs));
+    RenderPipeline*   pipelines = malloc(permutations * sizeof(*pipelines));
+    for(uint32_t i = 0; i < permutations; i++)
+        specs[i] = permutation_spec(g_compile_pairs[pairs[i % pair_count]], i / pair_count);
+
+    printf("\npipeline_compile: %u permutations (%u shader pairs), %u workers\n", permutations, pair_count,
+           (threads ? threads : job_pool_default_threads()) + 1u);
+
+    CompileBenchRun run = {
+        .g            = &g,
+        .desc_cache   = &desc_cache,
+        .pipe_cache   = &pipe_cache,
+        .specs        = specs,
+        .pipelines    = pipelines,
+        .permutations = permutations,
+        .threads      = threads,
+    };
+
+    remove(COMPILE_BENCH_CACHE);
+    double cold_ms = compile_bench_async(&run, "async cold");
+    double warm_ms = compile_bench_async(&run, "async warm");
+    remove(COMPILE_BENCH_CACHE);
+
+    // serial
+    VkPipelineCacheCreateInfo serial_ci    = {.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+    VkPipelineCache           serial_cache = VK_NULL_HANDLE;
+    VK_CHECK(vkCreatePipelineCache(g.device, &serial_ci, NULL, &serial_cache));
+
+    uint64_t t0     = time_now_ns();
+    uint32_t failed = 0;
+    for(uint32_t i = 0; i < permutations; i++)
+    {
+        pipelines[i] = render_pipeline_create(g.device, serial_cache, &desc_cache, &pipe_cache, &specs[i]);
+        failed += pipelines[i].pipeline == VK_NULL_HANDLE;
+    }
+    double serial_ms = time_ns_to_ms(time_now_ns() - t0);
+
+    printf("  %-10s %10.2f ms  %8.3f ms/pipeline  (%u failed)\n", "serial", serial_ms, serial_ms / permutations, failed);
+    printf("  speedup    %10.2fx async cold, %.2fx async warm\n", serial_ms / MAX(cold_ms, 1e-6),
+           serial_ms / MAX(warm_ms, 1e-6));
+
+    for(uint32_t i = 0; i < permutations; i++)
+        render_pipeline_destroy(g.device, &pipelines[i]);
+    vkDestroyPipelineCache(g.device, serial_cache, NULL);
+
+    pipeline_layout_cache_destroy(g.device, &pipe_cache);
+    descriptor_layout_cache_destroy(&desc_cache);
+    free(specs);
+    free(pipelines);
+    compile_bench_shutdown(&g);
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include "bench.h"
+#include "proceduraltextures.h"
+
+// Procedural RGBA8 generators at 4096x4096 (default): the patterns, then each
+// noise as one octave and as 6-octave fBm, per ISA, on the calling thread and
+// on a JobPool, plus the whole mip chain written directly. MPix/s counts
+// written texels.
+
+static const char* g_isa_names[]   = {"scalar", "avx2"};
+static const char* g_noise_names[] = {"value", "perlin", "simplex", "worley"};
+
+typedef void (*FillFn)(uint8_t* out, uint32_t size, const ProceduralNoiseDesc* desc, JobPool* pool);
+
+static void fill_checker(uint8_t* out, uint32_t size, const ProceduralNoiseDesc* desc, JobPool* pool)
+{
+    (void)desc;
+    (void)pool;
+    procedural_fill_checker_rgba8(out, size, size, 16, 32, 32, 32, 220, 220, 220);
+}
+
+static void fill_gradient(uint8_t* out, uint32_t size, const ProceduralNoiseDesc* desc, JobPool* pool)
+{
+    (void)desc;
+    (void)pool;
+    procedural_fill_gradient_rgba8(out, size, size);
+}
+
+static void fill_solid(uint8_t* out, uint32_t size, const ProceduralNoiseDesc* desc, JobPool* pool)
+{
+    (void)desc;
+    (void)pool;
+    procedural_fill_solid_rgba8(out, size, size, 10, 20, 30, 255);
+}
+
+static void fill_noise(uint8_t* out, uint32_t size, const ProceduralNoiseDesc* desc, JobPool* pool)
+{
+    procedural_fill_noise_rgba8(out, size, size, desc, pool);
+}
+
+static double mpix_per_s(FillFn fn, uint8_t* out, uint32_t size, const ProceduralNoiseDesc* desc, JobPool* pool,
+                         uint32_t iterations, BenchStats* stats)
+{
+    for(uint32_t it = 0; it < iterations; it++)
+    {
+        uint64_t t0 = time_now_ns();
+        fn(out, size, desc, pool);
+        bench_stats_add(stats, time_ns_to_ms(time_now_ns() - t0));
+    }
+    return (double)size * size * 1e-3 / bench_stats_mean(stats);
+}
+
+int bench_procedural(int argc, char** argv)
+{
+    uint32_t size       = MAX(bench_arg_u32(argc, argv, 1, 4096), 1u);
+    uint32_t iterations = MAX(bench_arg_u32(argc, argv, 2, 3), 1u);
+
+    // chain layout, level 0 first
+    TextureFileLevel levels[TEXTURE_FILE_MAX_LEVELS];
+    uint32_t         level_count = 0;
+    VkDeviceSize     bytes       = 0;
+    uint64_t         texels      = 0;
+    for(uint32_t w = size, h = size; level_count < TEXTURE_FILE_MAX_LEVELS; w = MAX(w >> 1, 1u), h = MAX(h >> 1, 1u))
+    {
+        levels[level_count++] = (TextureFileLevel){.width = w, .height = h, .offset = bytes, .size = (VkDeviceSize)w * h * 4};
+        bytes += (VkDeviceSize)w * h * 4;
+        texels += (uint64_t)w * h;
+        if(w == 1 && h == 1)
+            break;
+    }
+
+    uint8_t* out = (uint8_t*)malloc((size_t)bytes);
+    if(!out)
+    {
+        printf("procedural: out of memory\n");
+        return 1;
+    }
+
+    JobPool pool = {0};
+    job_pool_init(&pool, 0);
+
+    ProceduralIsa best = procedural_isa();
+    printf("\nprocedural: %ux%u RGBA8, %u iterations, %u workers (best isa: %s)\n", size, size, iterations,
+           pool.thread_count + 1u, g_isa_names[best]);
+
+    struct
+    {
+        const char* name;
+        FillFn      fn;
+    } patterns[] = {{"checker", fill_checker}, {"gradient", fill_gradient}, {"solid", fill_solid}};
+
+    for(uint32_t i = 0; i < 3; i++)
+    {
+        BenchStats stats = {0};
+        double     rate  = mpix_per_s(patterns[i].fn, out, size, NULL, NULL, iterations, &stats);
+        printf("  %-22s %9.1f MPix/s\n", patterns[i].name, rate);
+    }
+
+    for(uint32_t type = 0; type < PROCEDURAL_NOISE_COUNT; type++)
+    {
+        for(uint32_t octaves = 1; octaves <= 6; octaves += 5)
+        {
+            ProceduralNoiseDesc desc = {
+                .type      = (ProceduralNoise)type,
+                .seed      = 1,
+                .frequency = 8,
+                .octaves   = octaves,
+                .gain      = 0.5f,
+                .color0    = {0, 0, 0, 255},
+                .color1    = {255, 255, 255, 255},
+            };
+
+            for(uint32_t isa = PROCEDURAL_ISA_SCALAR; isa <= (uint32_t)best; isa++)
+            {
+                procedural_set_isa((ProceduralIsa)isa);
+
+                BenchStats single = {0}, pooled = {0};
+                double     st     = mpix_per_s(fill_noise, out, size, &desc, NULL, iterations, &single);
+                double     mt     = mpix_per_s(fill_noise, out, size, &desc, &pool, iterations, &pooled);
+
+                char label[64];
+                snprintf(label, sizeof(label), "%s%s %s", g_noise_names[type], octaves > 1 ? " fbm6" : "", g_isa_names[isa]);
+                printf("  %-22s %9.1f MPix/s   pool %9.1f MPix/s\n", label, st, mt);
+            }
+
+            // every level evaluated at its size, best ISA, pool
+            procedural_set_isa(best);
+            BenchStats chain = {0};
+            for(uint32_t it = 0; it < iterations; it++)
+            {
+                uint64_t t0 = time_now_ns();
+                procedural_fill_noise_mips_rgba8(out, levels, level_count, &desc, &pool);
+                bench_stats_add(&chain, time_ns_to_ms(time_now_ns() - t0));
+            }
+            printf("  %-22s %9.1f MPix/s   (%u levels, pool)\n", "  mip chain", (double)texels * 1e-3 / bench_stats_mean(&chain),
+                   level_count);
+        }
+    }
+
+    procedural_set_isa(best);
+    job_pool_destroy(&pool);
+    free(out);
+    return 0;
+}
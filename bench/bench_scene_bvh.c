@@ -0,0 +1,131 @@
+#include "bench.h"
+#include "scene_bvh.h"
+
+// Scene BVH build, refit and query cost at 100k and 1M draws. Synthetic
+// spheres: clustered "props" scattered over a 4 km square, like a large
+// outdoor scene. No glTF needed.
+
+#define WORLD_SIZE 4096.0f
+#define CLUSTER_SIZE 64u
+#define RAY_COUNT 10000u
+#define VIEW_COUNT 8u
+
+static const uint32_t g_sizes[] = {100000, 1000000};
+
+static uint32_t g_seed = 0x2545f491u;
+
+static float frand(void)
+{
+    g_seed ^= g_seed << 13;
+    g_seed ^= g_seed >> 17;
+    g_seed ^= g_seed << 5;
+    return (float)(g_seed >> 8) / 16777216.0f;
+}
+
+static void make_spheres(vec4* spheres, uint32_t count)
+{
+    float cx = 0.0f, cz = 0.0f;
+    for(uint32_t i = 0; i < count; i++)
+    {
+        if(i % CLUSTER_SIZE == 0)
+        {
+            cx = frand() * WORLD_SIZE;
+            cz = frand() * WORLD_SIZE;
+        }
+        spheres[i][0] = cx + (frand() - 0.5f) * 64.0f;
+        spheres[i][1] = frand() * 8.0f;
+        spheres[i][2] = cz + (frand() - 0.5f) * 64.0f;
+        spheres[i][3] = 0.25f + frand() * 2.0f;
+    }
+}
+
+static void view_for(uint32_t v, mat4 out)
+{
+    float angle = (float)v / VIEW_COUNT * 2.0f * GLM_PIf;
+    vec3  eye   = {WORLD_SIZE * 0.5f, 20.0f, WORLD_SIZE * 0.5f};
+    vec3  at    = {eye[0] + cosf(angle), 20.0f, eye[2] + sinf(angle)};
+    glm_lookat(eye, at, (vec3){0.0f, 1.0f, 0.0f}, out);
+}
+
+static void run_size(uint32_t n, uint32_t iterations)
+{
+    vec4*     spheres = (vec4*)malloc(sizeof(vec4) * n);
+    uint32_t* out     = (uint32_t*)malloc(sizeof(uint32_t) * n);
+    make_spheres(spheres, n);
+
+    BenchStats build = {0}, refit = {0}, update = {0}, frustum = {0}, rays = {0};
+    SceneBvh   bvh   = {0};
+    uint64_t   visible = 0, hits = 0;
+
+    for(uint32_t it = 0; it < iterations; it++)
+    {
+        uint64_t t0 = time_now_ns();
+        scene_bvh_build_spheres(&bvh, spheres, n);
+        bench_stats_add(&build, time_ns_to_ms(time_now_ns() - t0));
+
+        // everything moves a little: full refit
+        for(uint32_t i = 0; i < n; i++)
+            bvh.spheres[i][1] += 0.5f;
+        t0 = time_now_ns();
+        scene_bvh_refit(&bvh);
+        bench_stats_add(&refit, time_ns_to_ms(time_now_ns() - t0));
+
+        // 1% moves: incremental path refits
+        t0 = time_now_ns();
+        for(uint32_t i = 0; i < n / 100u; i++)
+        {
+            uint32_t     di  = (uint32_t)(frand() * (float)(n - 1u));
+            const float* cur = bvh.spheres[bvh.primSlot[di]];
+            vec4         s   = {cur[0] + 1.0f, cur[1], cur[2], cur[3]};
+            scene_bvh_update(&bvh, di, s);
+        }
+        bench_stats_add(&update, time_ns_to_ms(time_now_ns() - t0));
+
+        t0      = time_now_ns();
+        visible = 0;
+        for(uint32_t v = 0; v < VIEW_COUNT; v++)
+        {
+            mat4 view;
+            vec4 planes[6];
+            view_for(v, view);
+            scene_bvh_frustum_planes(view, tanf(glm_rad(30.0f)) * 16.0f / 9.0f, tanf(glm_rad(30.0f)), 0.1f, 1000.0f, planes);
+            visible += scene_bvh_query_frustum(&bvh, planes, out, n);
+        }
+        bench_stats_add(&frustum, time_ns_to_ms(time_now_ns() - t0) / VIEW_COUNT);
+
+        t0   = time_now_ns();
+        hits = 0;
+        for(uint32_t r = 0; r < RAY_COUNT; r++)
+        {
+            vec3 o = {frand() * WORLD_SIZE, 50.0f, frand() * WORLD_SIZE};
+            vec3 d = {frand() - 0.5f, -1.0f, frand() - 0.5f};
+            glm_vec3_normalize(d);
+            hits += scene_bvh_raycast(&bvh, o, d, 1000.0f, NULL, NULL) ? 1u : 0u;
+        }
+        bench_stats_add(&rays, time_ns_to_ms(time_now_ns() - t0));
+    }
+
+    printf("\n  %u draws, %u nodes\n", n, bvh.nodeCount);
+    bench_stats_print("build (sah)", &build);
+    bench_stats_print("refit (all)", &refit);
+    bench_stats_print("update (1% of draws)", &update);
+    bench_stats_print("frustum query (per view)", &frustum);
+    bench_stats_print("raycast x10k", &rays);
+    printf("    pre-cull keeps %.1f%% of draws per view, %llu / %u rays hit\n",
+           100.0 * (double)visible / ((double)n * VIEW_COUNT), (unsigned long long)hits, RAY_COUNT);
+
+    scene_bvh_destroy(&bvh);
+    free(out);
+    free(spheres);
+}
+
+int bench_scene_bvh(int argc, char** argv)
+{
+    uint32_t iterations = bench_arg_u32(argc, argv, 1, 5);
+
+    printf("\nscene_bvh: %u iterations\n", iterations);
+    for(uint32_t i = 0; i < sizeof(g_sizes) / sizeof(g_sizes[0]); i++)
+        run_size(g_sizes[i], iterations);
+
+    return 0;
+}
@@ -0,0 +1,65 @@
+#include "bench.h"
+#include "scene.h"
+#include "scene_cache.h"
+
+// Cold glTF import (cgltf + append_mesh pipeline) vs. mapping the .scache back in.
+int bench_scene_cache(int argc, char** argv)
+{
+    if(argc < 2)
+    {
+        printf("scene_cache: missing <file.glb>\n");
+        return 1;
+    }
+
+    const char* path       = argv[1];
+    uint32_t    iterations = bench_arg_u32(argc, argv, 2, 5);
+
+    BenchStats cold   = {0};
+    BenchStats cached = {0};
+
+    scene_cache_set_enabled(false);
+    for(uint32_t i = 0; i < iterations; i++)
+    {
+        Scene    scene = {0};
+        uint64_t t0    = time_now_ns();
+        bool     ok    = scene_load_gltf(&scene, path);
+        bench_stats_add(&cold, time_ns_to_ms(time_now_ns() - t0));
+        scene_free(&scene);
+
+        if(!ok)
+        {
+            printf("scene_cache: failed to load '%s'\n", path);
+            return 1;
+        }
+    }
+
+    // one load with the cache on (re)writes the .scache
+    char* cache_path = scene_cache_path(path);
+    if(cache_path)
+        remove(cache_path);
+
+    scene_cache_set_enabled(true);
+    {
+        Scene scene = {0};
+        scene_load_gltf(&scene, path);
+        scene_free(&scene);
+    }
+
+    for(uint32_t i = 0; i < iterations; i++)
+    {
+        Scene    scene = {0};
+        uint64_t t0    = time_now_ns();
+        scene_load_gltf(&scene, path);
+        bench_stats_add(&cached, time_ns_to_ms(time_now_ns() - t0));
+        scene_free(&scene);
+    }
+
+    printf("\nscene_cache: %s\n", path);
+    bench_stats_print("cold import", &cold);
+    bench_stats_print("cached load", &cached);
+    if(bench_stats_mean(&cached) > 0.0)
+        printf("  speedup: %.1fx\n", bench_stats_mean(&cold) / bench_stats_mean(&cached));
+
+    free(cache_path);
+    return 0;
+}
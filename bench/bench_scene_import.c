@@ -0,0 +1,59 @@
+#include "bench.h"
+#include "job_pool.h"
+#include "scene.h"
+#include "scene_cache.h"
+
+// Cold glTF import time vs. import worker count (cache disabled).
+int bench_scene_import(int argc, char** argv)
+{
+    if(argc < 2)
+    {
+        printf("scene_import: missing <file.glb>\n");
+        return 1;
+    }
+
+    const char* path        = argv[1];
+    uint32_t    iterations  = bench_arg_u32(argc, argv, 2, 3);
+    uint32_t    max_threads = job_pool_default_threads() + 1u;
+
+    scene_cache_set_enabled(false);
+
+    printf("\nscene_import: %s\n", path);
+
+    double serial_ms = 0.0;
+    for(uint32_t threads = 1;; threads = MIN(threads * 2u, max_threads))
+    {
+        scene_import_set_threads(threads);
+
+        BenchStats stats = {0};
+        for(uint32_t i = 0; i < iterations; i++)
+        {
+            Scene    scene = {0};
+            uint64_t t0    = time_now_ns();
+            bool     ok    = scene_load_gltf(&scene, path);
+            bench_stats_add(&stats, time_ns_to_ms(time_now_ns() - t0));
+            scene_free(&scene);
+
+            if(!ok)
+            {
+                printf("scene_import: failed to load '%s'\n", path);
+                return 1;
+            }
+        }
+
+        if(threads == 1)
+            serial_ms = bench_stats_mean(&stats);
+
+        char label[64];
+        snprintf(label, sizeof(label), "%u thread(s)", threads);
+        bench_stats_print(label, &stats);
+        printf("    scaling vs serial: %.2fx\n", serial_ms / bench_stats_mean(&stats));
+
+        if(threads == max_threads)
+            break;
+    }
+
+    scene_import_set_threads(0);
+    scene_cache_set_enabled(true);
+    return 0;
+}
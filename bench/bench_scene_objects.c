@@ -0,0 +1,136 @@
+#include "bench.h"
+#include "scene.h"
+
+// SceneObject handle churn: create (bulk and one at a time), lookup and mutate
+// in random order, then remove in random order. No glTF needed; the spawn
+// templates are synthetic draws.
+
+#define TEMPLATE_COUNT 4
+
+static const uint32_t g_sizes[] = {1000, 100000, 1000000};
+
+static uint32_t xorshift32(uint32_t* state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static void shuffle(uint32_t* ids, uint32_t count, uint32_t seed)
+{
+    for(uint32_t i = count; i > 1; i--)
+    {
+        uint32_t j   = xorshift32(&seed) % i;
+        uint32_t tmp = ids[i - 1];
+        ids[i - 1]   = ids[j];
+        ids[j]       = tmp;
+    }
+}
+
+static double ns_per_op(uint64_t ns, uint32_t ops)
+{
+    return ops ? (double)ns / (double)ops : 0.0;
+}
+
+static void run_size(uint32_t n, uint32_t iterations)
+{
+    BenchStats create_bulk = {0}, create_single = {0}, lookup = {0}, mutate = {0}, remove = {0};
+
+    SceneObjectTransform* xforms = (SceneObjectTransform*)malloc(sizeof(SceneObjectTransform) * (n / TEMPLATE_COUNT + 1));
+    uint32_t*             ids    = (uint32_t*)malloc(sizeof(uint32_t) * n);
+
+    uint32_t seed = 0x9e3779b9u;
+    for(uint32_t i = 0; i < n / TEMPLATE_COUNT + 1; i++)
+    {
+        glm_vec3_copy((vec3){(float)(xorshift32(&seed) % 1024u), 0.0f, (float)(xorshift32(&seed) % 1024u)},
+                      xforms[i].position);
+        glm_quat_identity(xforms[i].rotation);
+        xforms[i].scale = 1.0f;
+    }
+
+    for(uint32_t it = 0; it < iterations; it++)
+    {
+        Scene scene = {0};
+        for(uint32_t t = 0; t < TEMPLATE_COUNT; t++)
+        {
+            MeshDraw d = {0};
+            d.meshIndex     = t;
+            d.materialIndex = t;
+            glm_quat_identity(d.orientation);
+            d.scale = 1.0f;
+            arrpush(scene.draws, d);
+        }
+
+        // bulk spawn: n / TEMPLATE_COUNT transforms x TEMPLATE_COUNT templates
+        uint32_t transforms = n / TEMPLATE_COUNT;
+        uint64_t t0         = time_now_ns();
+        uint32_t created    = scene_spawn_from_draws_bulk(&scene, 0, TEMPLATE_COUNT, xforms, transforms, ids);
+        bench_stats_add(&create_bulk, ns_per_op(time_now_ns() - t0, created));
+
+        // the remainder one at a time, into the same scene
+        t0 = time_now_ns();
+        for(uint32_t i = created; i < n; i++)
+            ids[i] = scene_object_create(&scene, i % TEMPLATE_COUNT, i % TEMPLATE_COUNT, i % TEMPLATE_COUNT,
+                                         xforms[i / TEMPLATE_COUNT].position, xforms[i / TEMPLATE_COUNT].rotation, 1.0f);
+        if(n > created)
+            bench_stats_add(&create_single, ns_per_op(time_now_ns() - t0, n - created));
+
+        shuffle(ids, n, seed + it);
+
+        float checksum = 0.0f;
+        t0             = time_now_ns();
+        for(uint32_t i = 0; i < n; i++)
+        {
+            SceneObject* obj = scene_object_get(&scene, ids[i]);
+            checksum += obj ? obj->position[0] : 0.0f;
+        }
+        bench_stats_add(&lookup, ns_per_op(time_now_ns() - t0, n));
+
+        t0 = time_now_ns();
+        for(uint32_t i = 0; i < n; i++)
+            scene_object_translate(&scene, ids[i], (vec3){0.0f, 1.0f, 0.0f});
+        bench_stats_add(&mutate, ns_per_op(time_now_ns() - t0, n));
+
+        shuffle(ids, n, seed ^ (it + 1u));
+
+        t0 = time_now_ns();
+        for(uint32_t i = 0; i < n; i++)
+            scene_object_remove(&scene, ids[i]);
+        bench_stats_add(&remove, ns_per_op(time_now_ns() - t0, n));
+
+        if(arrlen(scene.objects) != 0 || checksum < 0.0f)
+            printf("  warning: %d objects left after remove\n", (int)arrlen(scene.objects));
+
+        scene_free(&scene);
+    }
+
+    // BenchStats carries ms; here every sample is ns/op
+    printf("\n  %u objects (ns/op)\n", n);
+    printf("    %-16s mean=%8.1f  min=%8.1f  max=%8.1f\n", "create bulk", bench_stats_mean(&create_bulk),
+           create_bulk.min_ms, create_bulk.max_ms);
+    if(create_single.runs)
+        printf("    %-16s mean=%8.1f  min=%8.1f  max=%8.1f\n", "create single", bench_stats_mean(&create_single),
+               create_single.min_ms, create_single.max_ms);
+    printf("    %-16s mean=%8.1f  min=%8.1f  max=%8.1f\n", "lookup random", bench_stats_mean(&lookup), lookup.min_ms,
+           lookup.max_ms);
+    printf("    %-16s mean=%8.1f  min=%8.1f  max=%8.1f\n", "mutate random", bench_stats_mean(&mutate), mutate.min_ms,
+           mutate.max_ms);
+    printf("    %-16s mean=%8.1f  min=%8.1f  max=%8.1f\n", "remove random", bench_stats_mean(&remove), remove.min_ms,
+           remove.max_ms);
+
+    free(ids);
+    free(xforms);
+}
+
+int bench_scene_objects(int argc, char** argv)
+{
+    uint32_t iterations = bench_arg_u32(argc, argv, 1, 5);
+
+    printf("\nscene_objects: %u iterations\n", iterations);
+    for(uint32_t i = 0; i < sizeof(g_sizes) / sizeof(g_sizes[0]); i++)
+        run_size(g_sizes[i], iterations);
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+#include "bench.h"
+#include "vk_shader_reflect.h"
+
+#include <dirent.h>
+
+// Reflection of every .spv in compiledshaders/ (or the directory given),
+// the way render_pipeline_prepare does it at start-up:
+//   spirv-reflect  shader_reflect_create: SPIRV-Reflect on each module
+//   sidecar        shader_reflect_create_cached, loading the ".refl" files the
+//                  first (untimed) pass wrote
+// Both include the logging start-up pays (per binding for SPIRV-Reflect, one
+// line per sidecar). The SPIR-V is read once up front; only reflection is timed.
+
+#define REFLECT_BENCH_MAX_FILES 256
+
+typedef struct ReflectBenchShader
+{
+    char   path[512];
+    void*  code;
+    size_t size;
+} ReflectBenchShader;
+
+static bool reflect_bench_read(const char* path, void** out_data, size_t* out_size)
+{
+    FILE* f = fopen(path, "rb");
+    if(!f)
+        return false;
+
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    rewind(f);
+
+    void* data = (len > 0) ? malloc((size_t)len) : NULL;
+    bool  ok   = data && fread(data, 1, (size_t)len, f) == (size_t)len;
+    fclose(f);
+    if(!ok)
+    {
+        free(data);
+        return false;
+    }
+
+    *out_data = data;
+    *out_size = (size_t)len;
+    return true;
+}
+
+static uint32_t reflect_bench_load(const char* dir, ReflectBenchShader* shaders)
+{
+    DIR* d = opendir(dir);
+    if(!d)
+        return 0;
+
+    uint32_t       count = 0;
+    struct dirent* e;
+    while((e = readdir(d)) != NULL && count < REFLECT_BENCH_MAX_FILES)
+    {
+        size_t n = strlen(e->d_name);
+        if(n < 4 || strcmp(e->d_name + n - 4, ".spv") != 0)
+            continue;
+
+        ReflectBenchShader* s = &shaders[count];
+        snprintf(s->path, sizeof(s->path), "%s/%s", dir, e->d_name);
+        if(reflect_bench_read(s->path, &s->code, &s->size))
+            count++;
+    }
+    closedir(d);
+    return count;
+}
+
+static uint32_t reflect_bench_pass(const ReflectBenchShader* shaders, uint32_t count, bool cached, uint32_t* out_bindings)
+{
+    uint32_t ok       = 0;
+    uint32_t bindings = 0;
+    for(uint32_t i = 0; i < count; i++)
+    {
+        ShaderReflection r;
+        bool created = cached ? shader_reflect_create_cached(&r, shaders[i].code, shaders[i].size, shaders[i].path)
+                              : shader_reflect_create(&r, shaders[i].code, shaders[i].size);
+        if(!created)
+            continue;
+
+        for(uint32_t s = 0; s < r.set_count; s++)
+            bindings += r.sets[s].binding_count;
+        shader_reflect_destroy(&r);
+        ok++;
+    }
+    if(out_bindings)
+        *out_bindings = bindings;
+    return ok;
+}
+
+int bench_shader_reflect(int argc, char** argv)
+{
+    const char* dir        = (argc > 1) ? argv[1] : "compiledshaders";
+    uint32_t    iterations = MAX(bench_arg_u32(argc, argv, 2, 20), 1u);
+
+    ReflectBenchShader* shaders = calloc(REFLECT_BENCH_MAX_FILES, sizeof(*shaders));
+    uint32_t            count   = reflect_bench_load(dir, shaders);
+    if(count == 0)
+    {
+        printf("shader_reflect: no .spv files in %s\n", dir);
+        free(shaders);
+        return 1;
+    }
+
+    size_t spirv_bytes = 0;
+    for(uint32_t i = 0; i < count; i++)
+        spirv_bytes += shaders[i].size;
+
+    // writes (or refreshes) the sidecars
+    uint32_t bindings  = 0;
+    uint32_t reflected = reflect_bench_pass(shaders, count, true, &bindings);
+
+    BenchStats spirv   = {0};
+    BenchStats sidecar = {0};
+    for(uint32_t it = 0; it < iterations; it++)
+    {
+        uint64_t t0 = time_now_ns();
+        reflect_bench_pass(shaders, count, false, NULL);
+        bench_stats_add(&spirv, time_ns_to_ms(time_now_ns() - t0));
+
+        t0 = time_now_ns();
+        reflect_bench_pass(shaders, count, true, NULL);
+        bench_stats_add(&sidecar, time_ns_to_ms(time_now_ns() - t0));
+    }
+
+    printf("\nshader_reflect: %u of %u modules (%.1f KB SPIR-V, %u bindings), %u iterations\n", reflected, count,
+           (double)spirv_bytes / 1024.0, bindings, iterations);
+    bench_stats_print("spirv-reflect", &spirv);
+    bench_stats_print("sidecar", &sidecar);
+    printf("  speedup    %10.2fx\n", bench_stats_mean(&spirv) / MAX(bench_stats_mean(&sidecar), 1e-6));
+
+    for(uint32_t i = 0; i < count; i++)
+        free(shaders[i].code);
+    free(shaders);
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include "bench.h"
+#include "vk_slang_bridge.h"
+
+#include <sys/stat.h>
+
+// In-process Slang compiles of the stock shaders, vsMain+psMain (or
+// computeMain) per file, the way RenderObject start-up and hot reload ask:
+//   cold         empty VK_SLANG_CACHE_DIR; the first pass also creates the session
+//   module hit   disk cache cleared again, cached IModules reused
+//   disk hit     SPIR-V straight from VK_SLANG_CACHE_DIR, no Slang calls
+// "per stage" is the old path: one program per entry point. It still gets
+// cached modules, so the gap to "module hit" is the saved link and codegen
+// setup only, not the parse slangc paid per stage.
+
+typedef struct SlangBenchShader
+{
+    const char* path;
+    bool        compute;
+} SlangBenchShader;
+
+static const SlangBenchShader g_slang_shaders[] = {
+    {"shaders/water.slang", false},
+    {"shaders/sky.slang", false},
+    {"shaders/postprocess.slang", true},
+};
+
+#define SLANG_BENCH_SHADERS (uint32_t)(sizeof(g_slang_shaders) / sizeof(g_slang_shaders[0]))
+
+static void slang_bench_clear_disk_cache(void)
+{
+    char cmd[256];
+    snprintf(cmd, sizeof(cmd), "rm -rf \"%s\"", VK_SLANG_CACHE_DIR);
+    if(system(cmd) != 0)
+        printf("slang_compile: could not clear %s\n", VK_SLANG_CACHE_DIR);
+}
+
+// one program per file, or one per entry point
+static uint32_t slang_bench_pass(bool per_stage)
+{
+    static const char* gfx_entries[2] = {"vsMain", "psMain"};
+    static const int   gfx_stages[2]  = {0x1, 0x10};  // VK_SHADER_STAGE_VERTEX_BIT, _FRAGMENT_BIT
+    static const char* comp_entry     = "computeMain";
+    static const int   comp_stage     = 0x20;  // VK_SHADER_STAGE_COMPUTE_BIT
+
+    uint32_t failed = 0;
+    for(uint32_t i = 0; i < SLANG_BENCH_SHADERS; i++)
+    {
+        const SlangBenchShader* s       = &g_slang_shaders[i];
+        const char* const*      entries = s->compute ? &comp_entry : gfx_entries;
+        const int*              stages  = s->compute ? &comp_stage : gfx_stages;
+        uint32_t                count   = s->compute ? 1u : 2u;
+
+        void*  code[2] = {0};
+        size_t size[2] = {0};
+        if(per_stage)
+        {
+            for(uint32_t e = 0; e < count; e++)
+                failed += !vk_slang_compile_entries(s->path, &entries[e], &stages[e], 1, &code[e], &size[e]);
+        }
+        else
+        {
+            failed += !vk_slang_compile_entries(s->path, entries, stages, count, code, size);
+        }
+
+        for(uint32_t e = 0; e < count; e++)
+            free(code[e]);
+    }
+    return failed;
+}
+
+static double slang_bench_time(bool per_stage, bool clear_disk, uint32_t iterations, BenchStats* stats, uint32_t* failed)
+{
+    for(uint32_t it = 0; it < iterations; it++)
+    {
+        if(clear_disk)
+            slang_bench_clear_disk_cache();
+
+        uint64_t t0 = time_now_ns();
+        *failed += slang_bench_pass(per_stage);
+        bench_stats_add(stats, time_ns_to_ms(time_now_ns() - t0));
+    }
+    return bench_stats_mean(stats);
+}
+
+int bench_slang_compile(int argc, char** argv)
+{
+    uint32_t iterations = MAX(bench_arg_u32(argc, argv, 1, 5), 1u);
+
+    for(uint32_t i = 0; i < SLANG_BENCH_SHADERS; i++)
+    {
+        struct stat st;
+        if(stat(g_slang_shaders[i].path, &st) != 0)
+        {
+            printf("slang_compile: %s missing (run from the repo root)\n", g_slang_shaders[i].path);
+            return 1;
+        }
+    }
+
+    printf("\nslang_compile: %u shaders, %u iterations\n", SLANG_BENCH_SHADERS, iterations);
+
+    uint32_t   failed    = 0;
+    BenchStats cold      = {0};
+    BenchStats per_stage = {0};
+    BenchStats module    = {0};
+    BenchStats disk      = {0};
+
+    slang_bench_time(false, true, 1, &cold, &failed);
+    slang_bench_time(true, true, iterations, &per_stage, &failed);
+    slang_bench_time(false, true, iterations, &module, &failed);
+    slang_bench_time(false, false, iterations, &disk, &failed);
+
+    bench_stats_print("cold (session + modules)", &cold);
+    bench_stats_print("per stage, module hit", &per_stage);
+    bench_stats_print("linked, module hit", &module);
+    bench_stats_print("disk hit", &disk);
+    printf("  failed compiles: %u\n  ", failed);
+    vk_slang_print_stats();
+
+    vk_slang_shutdown();
+    return failed ? 1 : 0;
+}
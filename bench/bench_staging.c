@@ -0,0 +1,206 @@
+#include "bench.h"
+#include "vk_startup.h"
+#include "vk_queue.h"
+#include "vk_cmd.h"
+#include "vk_sync.h"
+#include "vk_resources.h"
+#include "vk_staging.h"
+
+// Streams N MB of buffer uploads into a device-local buffer three ways:
+//   upload_to_gpu_buffer  one staging buffer + submit + queue idle per chunk
+//   ring immediate        chunks batched in the ring, one submit per ring fill
+//   ring frames           two frames in flight, each stages up to half the ring
+// Headless: no window or surface, first GPU with a graphics queue.
+
+#define STAGING_BENCH_RING_MB 64
+#define STAGING_BENCH_DST_MB 256
+#define STAGING_BENCH_FRAMES 2
+
+typedef struct StagingBenchGpu
+{
+    renderer_context  ctx;
+    VkPhysicalDevice  gpu;
+    VkDevice          device;
+    queue_families    qf;
+    ResourceAllocator allocator;
+} StagingBenchGpu;
+
+static bool staging_bench_init(StagingBenchGpu* g)
+{
+    memset(g, 0, sizeof(*g));
+    if(volkInitialize() != VK_SUCCESS)
+        return false;
+
+    // VK_KHR_get_surface_capabilities2 is always requested and depends on it
+    const char*           inst_exts[] = {VK_KHR_SURFACE_EXTENSION_NAME};
+    renderer_context_desc desc        = {
+        .app_name                 = "bench_staging",
+        .instance_extensions      = inst_exts,
+        .instance_extension_count = 1,
+    };
+    vk_create_instance(&g->ctx, &desc);
+    volkLoadInstanceOnly(g->ctx.instance);
+
+    uint32_t gpu_count = 1;
+    vkEnumeratePhysicalDevices(g->ctx.instance, &gpu_count, &g->gpu);
+    if(gpu_count == 0)
+        return false;
+
+    uint32_t family_count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(g->gpu, &family_count, NULL);
+    VkQueueFamilyProperties families[16];
+    family_count = MIN(family_count, 16u);
+    vkGetPhysicalDeviceQueueFamilyProperties(g->gpu, &family_count, families);
+    for(uint32_t i = 0; i < family_count && !g->qf.has_graphics; i++)
+    {
+        if(families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)
+        {
+            g->qf.graphics_family = g->qf.present_family = i;
+            g->qf.has_graphics = g->qf.has_present = 1;
+        }
+    }
+    if(!g->qf.has_graphics)
+        return false;
+
+    create_device(g->gpu, VK_NULL_HANDLE, &desc, g->qf, &g->device);
+    if(!g->device)
+        return false;
+    volkLoadDevice(g->device);
+    init_device_queues(g->device, &g->qf);
+
+    VmaAllocatorCreateInfo info = {.physicalDevice = g->gpu, .device = g->device, .instance = g->ctx.instance};
+    res_init(g->ctx.instance, g->device, g->gpu, &g->allocator, info);
+    return true;
+}
+
+static void staging_bench_shutdown(StagingBenchGpu* g)
+{
+    if(g->device)
+    {
+        vkDeviceWaitIdle(g->device);
+        res_deinit(&g->allocator);
+        vkDestroyDevice(g->device, NULL);
+    }
+    if(g->ctx.instance)
+        vkDestroyInstance(g->ctx.instance, NULL);
+}
+
+static void staging_bench_report(const char* label, double ms, uint64_t bytes, const StagingStats* stats)
+{
+    double gb = (double)bytes / (1024.0 * 1024.0 * 1024.0);
+    printf("  %-24s %9.2f ms  %6.2f GB/s", label, ms, gb / (ms * 1e-3));
+    if(stats)
+        printf("  (%u submits, %u refused)", stats->flushes, stats->full);
+    printf("\n");
+}
+
+int bench_staging(int argc, char** argv)
+{
+    uint32_t megabytes = MAX(bench_arg_u32(argc, argv, 1, 1024), 1u);
+    uint32_t chunk_kb  = MAX(bench_arg_u32(argc, argv, 2, 4096), 4u);
+
+    StagingBenchGpu g = {0};
+    if(!staging_bench_init(&g))
+    {
+        printf("staging: no Vulkan device\n");
+        staging_bench_shutdown(&g);
+        return 1;
+    }
+
+    VkDeviceSize total    = (VkDeviceSize)megabytes * 1024 * 1024;
+    VkDeviceSize chunk    = MIN((VkDeviceSize)chunk_kb * 1024, (VkDeviceSize)STAGING_BENCH_RING_MB * 1024 * 1024 / 2);
+    VkDeviceSize dst_size = (VkDeviceSize)STAGING_BENCH_DST_MB * 1024 * 1024;
+    uint32_t     chunks   = (uint32_t)((total + chunk - 1) / chunk);
+
+    uint8_t* src = malloc((size_t)chunk);
+    for(VkDeviceSize i = 0; i < chunk; i++)
+        src[i] = (uint8_t)(i * 131u);
+
+    Buffer dst = {0};
+    res_create_buffer(&g.allocator, dst_size, VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT,
+                      VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE, 0, 0, &dst);
+
+    VkCommandPool upload_pool = VK_NULL_HANDLE;
+    vk_cmd_create_pool(g.device, g.qf.graphics_family, false, true, &upload_pool);
+
+    printf("\nstaging: %u MB in %u chunks of %llu KB, %u MB ring\n", megabytes, chunks,
+           (unsigned long long)(chunk / 1024), STAGING_BENCH_RING_MB);
+
+    // current path: a staging buffer, a submit and a queue idle per call
+    uint64_t t0 = time_now_ns();
+    for(uint32_t i = 0; i < chunks; i++)
+    {
+        VkDeviceSize offset = ((VkDeviceSize)i * chunk) % (dst_size - chunk + 1);
+        upload_to_gpu_buffer(&g.allocator, g.qf.graphics_queue, upload_pool, dst.buffer, offset, src, chunk);
+    }
+    staging_bench_report("upload_to_gpu_buffer", time_ns_to_ms(time_now_ns() - t0), (uint64_t)chunks * chunk, NULL);
+
+    StagingRing ring = {0};
+    staging_ring_init(&ring, &g.allocator, (VkDeviceSize)STAGING_BENCH_RING_MB * 1024 * 1024, STAGING_BENCH_FRAMES);
+
+    t0 = time_now_ns();
+    staging_ring_begin_immediate(&ring, g.qf.graphics_queue, upload_pool);
+    for(uint32_t i = 0; i < chunks; i++)
+    {
+        VkDeviceSize offset = ((VkDeviceSize)i * chunk) % (dst_size - chunk + 1);
+        staging_upload_buffer(&ring, dst.buffer, offset, src, chunk);
+    }
+    staging_ring_end_immediate(&ring);
+    staging_bench_report("ring immediate", time_ns_to_ms(time_now_ns() - t0), ring.stats.bytes, &ring.stats);
+
+    // frame mode: the GPU copies one frame while the CPU stages the next
+    VkCommandPool   frame_pools[STAGING_BENCH_FRAMES];
+    VkCommandBuffer frame_cmds[STAGING_BENCH_FRAMES];
+    VkFence         frame_fences[STAGING_BENCH_FRAMES];
+    vk_cmd_create_many_pools(g.device, g.qf.graphics_family, true, false, STAGING_BENCH_FRAMES, frame_pools);
+    vk_create_fences(g.device, STAGING_BENCH_FRAMES, true, frame_fences);
+    for(uint32_t f = 0; f < STAGING_BENCH_FRAMES; f++)
+        vk_cmd_alloc(g.device, frame_pools[f], true, &frame_cmds[f]);
+
+    ring.stats          = (StagingStats){0};
+    VkDeviceSize budget = ring.capacity / STAGING_BENCH_FRAMES;
+    uint32_t     next   = 0;
+    uint32_t     frames = 0;
+
+    t0 = time_now_ns();
+    while(next < chunks)
+    {
+        uint32_t f = frames % STAGING_BENCH_FRAMES;
+        vk_wait_fence(g.device, frame_fences[f], UINT64_MAX);
+        vk_reset_fence(g.device, frame_fences[f]);
+        vk_cmd_reset_pool(g.device, frame_pools[f]);
+
+        vk_cmd_begin(frame_cmds[f], true);
+        staging_ring_begin_frame(&ring, f, frame_cmds[f]);
+
+        for(VkDeviceSize staged = 0; next < chunks && staged + chunk <= budget; staged += chunk, next++)
+        {
+            VkDeviceSize offset = ((VkDeviceSize)next * chunk) % (dst_size - chunk + 1);
+            if(!staging_upload_buffer(&ring, dst.buffer, offset, src, chunk))
+                break;
+        }
+
+        vk_cmd_end(frame_cmds[f]);
+
+        VkCommandBufferSubmitInfo cmd_info = {.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO, .commandBuffer = frame_cmds[f]};
+        VkSubmitInfo2 submit = {.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2, .commandBufferInfoCount = 1, .pCommandBufferInfos = &cmd_info};
+        vk_queue_lock();
+        VK_CHECK(vkQueueSubmit2(g.qf.graphics_queue, 1, &submit, frame_fences[f]));
+        vk_queue_unlock();
+        frames++;
+    }
+    vk_wait_fences(g.device, STAGING_BENCH_FRAMES, frame_fences, true, UINT64_MAX);
+    staging_bench_report("ring frames", time_ns_to_ms(time_now_ns() - t0), ring.stats.bytes, &ring.stats);
+    printf("  %u frames, %.1f MB staged per frame\n", frames,
+           (double)ring.stats.bytes / (1024.0 * 1024.0) / (double)MAX(frames, 1u));
+
+    vk_destroy_fences(g.device, STAGING_BENCH_FRAMES, frame_fences);
+    vk_cmd_destroy_many_pools(g.device, STAGING_BENCH_FRAMES, frame_pools);
+    vk_cmd_destroy_pool(g.device, upload_pool);
+    staging_ring_destroy(&ring);
+    res_destroy_buffer(&g.allocator, &dst);
+    free(src);
+
+    staging_bench_shutdown(&g);
+    return 0;
+}
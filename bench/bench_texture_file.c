@@ -0,0 +1,61 @@
+#include "bench.h"
+#include "texture_file.h"
+
+// Texture file loading on the CPU side of the upload: read + parse (+ decode
+// for non-DDS files) down to the bytes that get staged. Also reports the image
+// memory the file takes against the RGBA8 + blit mips path it replaces.
+
+static VkDeviceSize rgba8_chain_bytes(uint32_t w, uint32_t h)
+{
+    VkDeviceSize bytes = 0;
+    for(;;)
+    {
+        bytes += (VkDeviceSize)w * h * 4;
+        if(w == 1 && h == 1)
+            return bytes;
+        w = (w > 1) ? (w >> 1) : 1;
+        h = (h > 1) ? (h >> 1) : 1;
+    }
+}
+
+int bench_texture_file(int argc, char** argv)
+{
+    if(argc < 2)
+    {
+        printf("texture_file: missing <file>\n");
+        return 1;
+    }
+
+    const char* path       = argv[1];
+    uint32_t    iterations = MAX(bench_arg_u32(argc, argv, 2, 10), 1u);
+
+    TextureFile file = {0};
+    BenchStats  load = {0};
+    for(uint32_t it = 0; it < iterations; it++)
+    {
+        texture_file_free(&file);
+
+        uint64_t t0 = time_now_ns();
+        if(!texture_file_load(path, &file))
+        {
+            printf("texture_file: failed to load '%s'\n", path);
+            return 1;
+        }
+        bench_stats_add(&load, time_ns_to_ms(time_now_ns() - t0));
+    }
+
+    VkDeviceSize gpu   = texture_file_gpu_bytes(&file);
+    VkDeviceSize rgba8 = rgba8_chain_bytes(file.width, file.height);
+    double       mb    = 1.0 / (1024.0 * 1024.0);
+
+    printf("\ntexture_file: %s %ux%u format %d, %u stored levels%s\n", path, file.width, file.height, (int)file.format,
+           file.level_count, file.generate_mips ? " (blit mips)" : "");
+    printf("  staged      %.2f MB (%.1f MB/s)\n", (double)file.size * mb,
+           (double)file.size * mb / (bench_stats_mean(&load) * 1e-3));
+    printf("  image       %.2f MB vs %.2f MB as RGBA8 + mips (%.1fx)\n", (double)gpu * mb, (double)rgba8 * mb,
+           gpu ? (double)rgba8 / (double)gpu : 0.0);
+    bench_stats_print("load", &load);
+
+    texture_file_free(&file);
+    return 0;
+}
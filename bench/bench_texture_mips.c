@@ -0,0 +1,127 @@
+#include "bench.h"
+#include "texture_mips.h"
+
+// CPU mip chain generation for one RGBA8 texture (default 2048x2048): every
+// ISA, linear and sRGB filtering, on the calling thread and on a JobPool.
+// Throughput is source texels read per second over the whole chain (about
+// 4/3 of level 0). Each ISA's chain is checked against the scalar one.
+
+static const char* g_isa_names[] = {"scalar", "sse", "avx2"};
+
+static uint32_t xorshift32(uint32_t* state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static uint32_t chain_layout(uint32_t w, uint32_t h, TextureFileLevel* levels, VkDeviceSize* out_bytes, uint64_t* out_texels)
+{
+    uint32_t     count  = 0;
+    VkDeviceSize bytes  = 0;
+    uint64_t     texels = 0;
+    for(;;)
+    {
+        levels[count] = (TextureFileLevel){.width = w, .height = h, .offset = bytes, .size = (VkDeviceSize)w * h * 4};
+        bytes += levels[count].size;
+        count++;
+        if((w == 1 && h == 1) || count == TEXTURE_FILE_MAX_LEVELS)
+            break;
+        texels += (uint64_t)w * h;  // read to make the next level
+        w = (w > 1) ? (w >> 1) : 1;
+        h = (h > 1) ? (h >> 1) : 1;
+    }
+    *out_bytes  = bytes;
+    *out_texels = texels;
+    return count;
+}
+
+static double run(uint8_t* chain, const TextureFileLevel* levels, uint32_t count, bool srgb, JobPool* pool,
+                  uint32_t iterations, BenchStats* stats)
+{
+    for(uint32_t it = 0; it < iterations; it++)
+    {
+        uint64_t t0 = time_now_ns();
+        texture_mips_build_rgba8(chain, levels, count, srgb, pool);
+        bench_stats_add(stats, time_ns_to_ms(time_now_ns() - t0));
+    }
+    return bench_stats_mean(stats);
+}
+
+int bench_texture_mips(int argc, char** argv)
+{
+    uint32_t size       = MAX(bench_arg_u32(argc, argv, 1, 2048), 1u);
+    uint32_t iterations = MAX(bench_arg_u32(argc, argv, 2, 20), 1u);
+
+    TextureFileLevel levels[TEXTURE_FILE_MAX_LEVELS];
+    VkDeviceSize     bytes  = 0;
+    uint64_t         texels = 0;
+    uint32_t         count  = chain_layout(size, size, levels, &bytes, &texels);
+
+    uint8_t* chain = (uint8_t*)malloc((size_t)bytes);
+    uint8_t* ref   = (uint8_t*)malloc((size_t)bytes);
+    if(!chain || !ref)
+    {
+        printf("texture_mips: out of memory\n");
+        free(chain);
+        free(ref);
+        return 1;
+    }
+
+    // smooth gradients plus noise, so neither filter sees flat blocks
+    uint32_t seed = 0x9e3779b9u;
+    for(uint32_t y = 0; y < size; y++)
+    {
+        for(uint32_t x = 0; x < size; x++)
+        {
+            uint8_t* t = chain + ((size_t)y * size + x) * 4;
+            t[0]       = (uint8_t)((x * 255u) / size + (xorshift32(&seed) & 15u));
+            t[1]       = (uint8_t)((y * 255u) / size + (xorshift32(&seed) & 15u));
+            t[2]       = (uint8_t)(xorshift32(&seed) >> 24);
+            t[3]       = (uint8_t)(255u - (xorshift32(&seed) & 63u));
+        }
+    }
+    memcpy(ref, chain, (size_t)levels[0].size);
+
+    JobPool pool = {0};
+    job_pool_init(&pool, 0);
+
+    TextureMipsIsa best = texture_mips_isa();
+    printf("\ntexture_mips: %ux%u RGBA8, %u levels, %.1f MPix read per chain, %u iterations, %u workers (best isa: %s)\n",
+           size, size, count, (double)texels * 1e-6, iterations, pool.thread_count + 1u, g_isa_names[best]);
+
+    for(int srgb = 0; srgb < 2; srgb++)
+    {
+        texture_mips_set_isa(TEXTURE_MIPS_ISA_SCALAR);
+        texture_mips_build_rgba8(ref, levels, count, srgb != 0, NULL);
+
+        for(uint32_t isa = TEXTURE_MIPS_ISA_SCALAR; isa <= (uint32_t)best; isa++)
+        {
+            texture_mips_set_isa((TextureMipsIsa)isa);
+
+            BenchStats single = {0}, pooled = {0};
+            double     st_ms  = run(chain, levels, count, srgb != 0, NULL, iterations, &single);
+            double     mt_ms  = run(chain, levels, count, srgb != 0, &pool, iterations, &pooled);
+
+            // same arithmetic on every path; -ffast-math builds may move sRGB texels by one
+            uint32_t mismatched = 0;
+            for(VkDeviceSize i = levels[0].size; i < bytes; i++)
+                mismatched += chain[i] != ref[i];
+
+            char label[64];
+            snprintf(label, sizeof(label), "%s %s", srgb ? "srgb" : "linear", g_isa_names[isa]);
+            printf("  %-14s 1 thread %8.1f MPix/s   pool %8.1f MPix/s   %u bytes differ from scalar\n", label,
+                   (double)texels * 1e-3 / st_ms, (double)texels * 1e-3 / mt_ms, mismatched);
+            bench_stats_print("  1 thread", &single);
+            bench_stats_print("  pool", &pooled);
+        }
+    }
+
+    texture_mips_set_isa(best);
+    job_pool_destroy(&pool);
+    free(chain);
+    free(ref);
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include "bench.h"
+#include "transform_store.h"
+
+// Per-frame draw record conversion for N animated objects: the old AoS loop
+// (MeshDraw -> MeshDrawGpu, every entry) against TransformStore flushes at each
+// ISA, with every entry dirty and with a random 10% dirty. The destination is
+// ordinary heap memory here, not a mapped (write-combined) buffer.
+
+static const char* g_isa_names[] = {"scalar", "sse", "avx"};
+
+static void convert_aos(const MeshDraw* draws, uint32_t count, MeshDrawGpu* dst)
+{
+    for(uint32_t i = 0; i < count; i++)
+    {
+        const MeshDraw* src = &draws[i];
+
+        dst[i].position_scale[0] = src->position[0];
+        dst[i].position_scale[1] = src->position[1];
+        dst[i].position_scale[2] = src->position[2];
+        dst[i].position_scale[3] = src->scale;
+        dst[i].orientation[0]    = src->orientation[0];
+        dst[i].orientation[1]    = src->orientation[1];
+        dst[i].orientation[2]    = src->orientation[2];
+        dst[i].orientation[3]    = src->orientation[3];
+        dst[i].meshIndex         = src->meshIndex;
+        dst[i].postPass          = src->postPass;
+        dst[i].materialIndex     = src->materialIndex;
+        dst[i].pad               = 0;
+    }
+}
+
+static uint32_t xorshift32(uint32_t* state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+int bench_transform_store(int argc, char** argv)
+{
+    uint32_t count      = bench_arg_u32(argc, argv, 1, 100000);
+    uint32_t iterations = bench_arg_u32(argc, argv, 2, 100);
+
+    MeshDraw*      draws = (MeshDraw*)calloc(count, sizeof(MeshDraw));
+    MeshDrawGpu*   dst   = (MeshDrawGpu*)malloc(sizeof(MeshDrawGpu) * count);
+    TransformStore store = {0};
+
+    if(!draws || !dst || !transform_store_init(&store, count))
+    {
+        printf("transform_store: out of memory\n");
+        free(draws);
+        free(dst);
+        return 1;
+    }
+
+    uint32_t seed = 0x1234567u;
+    for(uint32_t i = 0; i < count; i++)
+    {
+        draws[i].position[0]    = (float)(xorshift32(&seed) % 4096u);
+        draws[i].position[2]    = (float)(xorshift32(&seed) % 4096u);
+        draws[i].orientation[3] = 1.0f;
+        draws[i].scale          = 1.0f;
+        draws[i].meshIndex      = i & 255u;
+        draws[i].materialIndex  = i & 63u;
+    }
+    transform_store_from_draws(&store, draws, count);
+
+    printf("\ntransform_store: %u draws, %u iterations (active isa: %s)\n", count, iterations,
+           g_isa_names[transform_store_isa()]);
+
+    BenchStats aos = {0};
+    for(uint32_t it = 0; it < iterations; it++)
+    {
+        uint64_t t0 = time_now_ns();
+        convert_aos(draws, count, dst);
+        bench_stats_add(&aos, time_ns_to_ms(time_now_ns() - t0));
+    }
+    bench_stats_print("aos loop (all)", &aos);
+
+    TransformStoreIsa best = transform_store_isa();
+    for(uint32_t isa = TRANSFORM_ISA_SCALAR; isa <= (uint32_t)best; isa++)
+    {
+        transform_store_set_isa((TransformStoreIsa)isa);
+
+        BenchStats all = {0}, sparse = {0};
+        for(uint32_t it = 0; it < iterations; it++)
+        {
+            // animate: a write through the SoA arrays, then mark
+            for(uint32_t i = 0; i < count; i++)
+                store.py[i] += 0.01f;
+            transform_store_mark_all_dirty(&store);
+
+            uint64_t t0 = time_now_ns();
+            transform_store_flush(&store, dst);
+            bench_stats_add(&all, time_ns_to_ms(time_now_ns() - t0));
+
+            for(uint32_t n = 0; n < count / 10u; n++)
+            {
+                uint32_t i = xorshift32(&seed) % count;
+                store.py[i] += 0.01f;
+                transform_store_mark_dirty(&store, i);
+            }
+
+            t0 = time_now_ns();
+            transform_store_flush(&store, dst);
+            bench_stats_add(&sparse, time_ns_to_ms(time_now_ns() - t0));
+        }
+
+        char label[64];
+        snprintf(label, sizeof(label), "flush %s (all)", g_isa_names[isa]);
+        bench_stats_print(label, &all);
+        snprintf(label, sizeof(label), "flush %s (10%% dirty)", g_isa_names[isa]);
+        bench_stats_print(label, &sparse);
+    }
+    transform_store_set_isa(best);
+
+    transform_store_destroy(&store);
+    free(dst);
+    free(draws);
+    return 0;
+}
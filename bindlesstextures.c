@@ -20,6 +20,16 @@ static uint32_t calc_mip_count(uint32_t w, uint32_t h)
     return levels;
 }
 
+static bool slot_retiring(const BindlessTextures* bt, uint32_t slot)
+{
+    for(uint32_t i = 0; i < (uint32_t)arrlen(bt->retired); i++)
+    {
+        if(bt->retired[i].slot == slot)
+            return true;
+    }
+    return false;
+}
+
 static bool resolve_slot(BindlessTextures* bt, uint32_t slot_hint, uint32_t* out_slot)
 {
     if(!bt || !out_slot)
@@ -38,7 +48,7 @@ static bool resolve_slot(BindlessTextures* bt, uint32_t slot_hint, uint32_t* out
     if(slot_hint >= bt->max_textures)
         return false;
 
-    if(bt->textures[slot_hint].image.image != VK_NULL_HANDLE)
+    if(bt->textures[slot_hint].image.image != VK_NULL_HANDLE || slot_retiring(bt, slot_hint))
         return false;
 
     *out_slot = slot_hint;
@@ -65,6 +75,121 @@ static void write_dummy_if_available(BindlessTextures* bt, VkDevice device, uint
                                 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
     }
 }
+
+static TextureContentEntry* find_content(const BindlessTextures* bt, uint64_t hash)
+{
+    uint32_t probe = 0;
+    for(uint32_t i; (i = hash_index_next(&bt->content_index, hash, &probe)) != HASH_INDEX_NONE;)
+    {
+        // the index keeps mappings of freed entries, the entry hash decides
+        if(bt->contents[i].hash == hash)
+            return &bt->contents[i];
+    }
+    return NULL;
+}
+
+static void add_content(BindlessTextures* bt, const TextureContentEntry* e)
+{
+    uint32_t at;
+    if(arrlen(bt->content_free) > 0)
+    {
+        at               = arrpop(bt->content_free);
+        bt->contents[at] = *e;
+    }
+    else
+    {
+        at = (uint32_t)arrlen(bt->contents);
+        arrpush(bt->contents, *e);
+    }
+    hash_index_insert(&bt->content_index, e->hash, at);
+}
+
+static void remove_content(BindlessTextures* bt, TextureContentEntry* e)
+{
+    arrfree(e->aliases);
+    *e = (TextureContentEntry){0};
+    arrpush(bt->content_free, (uint32_t)(e - bt->contents));
+
+    // HashIndex is insert only: rebuild once stale mappings outnumber live ones
+    uint32_t live = (uint32_t)(arrlen(bt->contents) - arrlen(bt->content_free));
+    if(bt->content_index.count > 2u * live + 64u)
+    {
+        hash_index_free(&bt->content_index);
+        for(uint32_t i = 0; i < (uint32_t)arrlen(bt->contents); i++)
+        {
+            if(bt->contents[i].hash)
+                hash_index_insert(&bt->content_index, bt->contents[i].hash, i);
+        }
+    }
+}
+
+static void count_duplicate(BindlessTextures* bt, const TextureContentEntry* e)
+{
+    bt->dedup.duplicates++;
+    bt->dedup.bytes_saved += e->gpu_bytes;
+}
+
+// Clears slot. out gets what is left to destroy: the texture when no other
+// slot samples its image, nothing otherwise.
+static void detach_slot(BindlessTextures* bt, uint32_t slot, TextureResource* out)
+{
+    TextureResource*     tex = &bt->textures[slot];
+    TextureContentEntry* e   = tex->content_hash ? find_content(bt, tex->content_hash) : NULL;
+
+    *out = (TextureResource){0};
+    if(e && arrlen(e->aliases) > 0)
+    {
+        if(e->slot == slot)
+        {
+            // owner leaving: an alias takes the image over
+            e->slot = arrpop(e->aliases);
+        }
+        else
+        {
+            for(uint32_t i = 0; i < (uint32_t)arrlen(e->aliases); i++)
+            {
+                if(e->aliases[i] == slot)
+                {
+                    arrdelswap(e->aliases, i);
+                    break;
+                }
+            }
+        }
+    }
+    else
+    {
+        if(e)
+            remove_content(bt, e);
+        *out = *tex;
+    }
+
+    *tex = (TextureResource){0};
+}
+
+// Loaded content for tex_create_*: TEX_SLOT_AUTO (or the owner itself) takes
+// another reference on the owner slot, a free explicit slot becomes an alias.
+static bool share_content(BindlessTextures* bt, VkDevice device, uint64_t hash, uint32_t slot_hint, uint32_t* out_slot)
+{
+    TextureContentEntry* e = find_content(bt, hash);
+    if(!e)
+        return false;
+
+    if(slot_hint == TEX_SLOT_AUTO || slot_hint == e->slot)
+    {
+        bt->textures[e->slot].refs++;
+        count_duplicate(bt, e);
+        *out_slot = e->slot;
+        return true;
+    }
+
+    if(slot_hint >= bt->max_textures || bt->textures[slot_hint].image.image != VK_NULL_HANDLE || slot_retiring(bt, slot_hint))
+        return false;
+
+    bindless_textures_alias(bt, device, slot_hint, e->slot);
+    *out_slot = slot_hint;
+    return true;
+}
+
 void bindless_textures_init(BindlessTextures* bt, VkDevice device, DescriptorAllocator* alloc, DescriptorLayoutCache* cache, uint32_t max_textures)
 {
     memset(bt, 0, sizeof(*bt));
@@ -80,8 +205,12 @@ void bindless_textures_init(BindlessTextures* bt, VkDevice device, DescriptorAll
         .pImmutableSamplers = NULL,
     };
 
+    // slots no pending frame samples (fresh installs, retired slots whose
+    // frames are done) are rewritten while other frames are in flight; a slot
+    // a pending frame may sample never is, whatever the flags
     VkDescriptorBindingFlags flags[1] = {VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT
-                                         | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT};
+                                         | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT
+                                         | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT};
 
     bt->layout = get_or_create_set_layout(cache, &binding, 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT, flags);
 
@@ -97,9 +226,26 @@ void bindless_textures_destroy(BindlessTextures* bt, ResourceAllocator* allocato
     for(uint32_t i = 0; i < bt->max_textures; i++)
     {
         if(bt->textures[i].image.image)
-            bindless_textures_destroy_texture(allocator, device, &bt->textures[i]);
+        {
+            TextureResource dead;
+            detach_slot(bt, i, &dead);
+            if(dead.image.image)
+                bindless_textures_destroy_texture(allocator, device, &dead);
+        }
+    }
+
+    for(uint32_t i = 0; i < (uint32_t)arrlen(bt->retired); i++)
+    {
+        if(bt->retired[i].tex.image.image)
+            bindless_textures_destroy_texture(allocator, device, &bt->retired[i].tex);
     }
 
+    arrfree(bt->retired);
+    for(uint32_t i = 0; i < (uint32_t)arrlen(bt->contents); i++)
+        arrfree(bt->contents[i].aliases);
+    arrfree(bt->contents);
+    arrfree(bt->content_free);
+    hash_index_free(&bt->content_index);
     *bt = (BindlessTextures){0};
 }
 
@@ -135,6 +281,186 @@ uint32_t bindless_textures_alloc_slot(BindlessTextures* bt)
     return bt->next_free++;
 }
 
+uint64_t bindless_textures_content_hash(VkFormat format, uint32_t w, uint32_t h, const void* data, size_t size)
+{
+    uint64_t seed = ((uint64_t)format << 40) ^ ((uint64_t)w << 20) ^ (uint64_t)h;
+    uint64_t hash = XXH64(data, size, seed);
+    return hash ? hash : 1;
+}
+
+bool bindless_textures_find_content(const BindlessTextures* bt, uint64_t hash, uint32_t* out_slot)
+{
+    const TextureContentEntry* e = find_content(bt, hash);
+    if(!e)
+        return false;
+
+    *out_slot = e->slot;
+    return true;
+}
+
+void bindless_textures_register_content(BindlessTextures* bt, ResourceAllocator* allocator, uint32_t slot, uint64_t hash)
+{
+    TextureResource* tex = &bt->textures[slot];
+
+    VmaAllocationInfo info = {0};
+    vmaGetAllocationInfo(allocator->allocator, tex->image.allocation, &info);
+
+    TextureContentEntry e = {
+        .hash      = hash,
+        .slot      = slot,
+        .gpu_bytes = info.size,
+    };
+    add_content(bt, &e);
+
+    tex->content_hash = hash;
+    tex->refs         = 1;
+    bt->dedup.unique++;
+}
+
+void bindless_textures_alias(BindlessTextures* bt, VkDevice device, uint32_t slot, uint32_t src_slot)
+{
+    const TextureResource* src = &bt->textures[src_slot];
+    TextureContentEntry*   e   = find_content(bt, src->content_hash);
+
+    TextureResource* dst = &bt->textures[slot];
+    *dst                 = *src;
+    dst->bindless_index  = slot;
+    dst->refs            = 1;
+
+    arrpush(e->aliases, slot);
+    count_duplicate(bt, e);
+    bindless_textures_write(bt, device, slot, dst->image.view, dst->image.sampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+void bindless_textures_print_dedup_stats(const BindlessTextures* bt, ResourceAllocator* allocator)
+{
+    pthread_mutex_lock(&allocator->sampler_mutex);
+    uint32_t samplers = (uint32_t)arrlen(allocator->samplers);
+    uint32_t requests = allocator->sampler_requests;
+    pthread_mutex_unlock(&allocator->sampler_mutex);
+
+    printf("textures dedup: %u unique, %u duplicates removed, %.1f MB VRAM saved, %u samplers for %u requests\n",
+           bt->dedup.unique, bt->dedup.duplicates, (double)bt->dedup.bytes_saved / (1024.0 * 1024.0), samplers, requests);
+}
+
+void bindless_textures_begin_frame(BindlessTextures* bt, ResourceAllocator* allocator, VkDevice device, uint64_t frame,
+                                   uint64_t completed)
+{
+    bt->frame = frame;
+
+    uint32_t done = 0;
+    while(done < (uint32_t)arrlen(bt->retired) && bt->retired[done].value <= completed)
+    {
+        TextureRetire* r = &bt->retired[done];
+        if(r->tex.image.image)
+            bindless_textures_destroy_texture(allocator, device, &r->tex);
+        if(r->slot != 0)
+        {
+            write_dummy_if_available(bt, device, r->slot);
+            release_slot(bt, r->slot);
+        }
+        done++;
+    }
+
+    if(done > 0)
+        arrdeln(bt->retired, 0, done);
+}
+
+// The replaced slot keeps its descriptor until the frames recorded so far are
+// done. It leaves the content registry first, as in tex_destroy, so
+// bindless_textures_find_content never hands out a slot that is retiring.
+static void retire_replaced(BindlessTextures* bt, uint32_t slot)
+{
+    TextureRetire retire = {.value = bt->frame, .slot = slot};
+    detach_slot(bt, slot, &retire.tex);
+    arrpush(bt->retired, retire);
+    bt->generation[slot]++;
+}
+
+uint32_t bindless_textures_replace(BindlessTextures* bt, VkDevice device, uint32_t slot, const TextureResource* tex)
+{
+    // a fresh slot is sampled by no frame in flight: its descriptor may change
+    uint32_t fresh = bindless_textures_alloc_slot(bt);
+    if(fresh == 0)
+        return 0;
+
+    TextureResource* dst = &bt->textures[fresh];
+    *dst                 = *tex;
+    dst->bindless_index  = fresh;
+    dst->content_hash    = 0;
+    dst->refs            = 1;
+    bindless_textures_write(bt, device, fresh, dst->image.view, dst->image.sampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    retire_replaced(bt, slot);
+    return fresh;
+}
+
+uint32_t bindless_textures_replace_content(BindlessTextures* bt, ResourceAllocator* allocator, VkDevice device,
+                                           uint32_t slot, const TextureResource* tex, uint64_t hash)
+{
+    uint32_t fresh = bindless_textures_replace(bt, device, slot, tex);
+    if(fresh != 0)
+        bindless_textures_register_content(bt, allocator, fresh, hash);
+    return fresh;
+}
+
+uint32_t bindless_textures_replace_alias(BindlessTextures* bt, VkDevice device, uint32_t slot, uint32_t src_slot)
+{
+    uint32_t fresh = bindless_textures_alloc_slot(bt);
+    if(fresh == 0)
+        return 0;
+
+    bindless_textures_alias(bt, device, fresh, src_slot);
+    retire_replaced(bt, slot);
+    return fresh;
+}
+
+TextureHandle bindless_textures_handle(const BindlessTextures* bt, uint32_t slot)
+{
+    return tex_handle_make(slot, bt->generation[slot]);
+}
+
+bool bindless_textures_handle_valid(const BindlessTextures* bt, TextureHandle h)
+{
+    uint32_t slot = tex_handle_slot(h);
+    return slot < bt->max_textures && bt->generation[slot] == tex_handle_generation(h);
+}
+
+uint32_t bindless_textures_resolve(const BindlessTextures* bt, TextureHandle h)
+{
+    return bindless_textures_handle_valid(bt, h) ? tex_handle_slot(h) : 0;
+}
+
+// levels [baseMip, baseMip + levelCount): TRANSFER_DST -> SHADER_READ
+static void cmd_levels_to_shader_read(VkCommandBuffer cmd, VkImage image, uint32_t baseMip, uint32_t levelCount)
+{
+    VkImageMemoryBarrier2 b = {
+        .sType         = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+        .srcStageMask  = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+        .dstStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+        .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT,
+        .oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        .newLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        .image         = image,
+        .subresourceRange =
+            {
+                .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+                .baseMipLevel   = baseMip,
+                .levelCount     = levelCount,
+                .baseArrayLayer = 0,
+                .layerCount     = 1,
+            },
+    };
+
+    VkDependencyInfo dep = {
+        .sType                   = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .imageMemoryBarrierCount = 1,
+        .pImageMemoryBarriers    = &b,
+    };
+    vkCmdPipelineBarrier2(cmd, &dep);
+}
+
 static void cmd_generate_mips(VkCommandBuffer cmd, VkImage image, uint32_t w, uint32_t h, uint32_t mipCount)
 {
     uint32_t mipW = w;
@@ -210,54 +536,26 @@ static void cmd_generate_mips(VkCommandBuffer cmd, VkImage image, uint32_t w, ui
     }
 
     // last mip: DST -> SHADER_READ
-    VkImageMemoryBarrier2 last = {
-        .sType         = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
-        .srcStageMask  = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-        .dstStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
-        .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
-        .dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT,
-        .oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        .newLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-        .image         = image,
-        .subresourceRange =
-            {
-                .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
-                .baseMipLevel   = mipCount - 1,
-                .levelCount     = 1,
-                .baseArrayLayer = 0,
-                .layerCount     = 1,
-            },
-    };
-
-    VkDependencyInfo depLast = {
-        .sType                   = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-        .imageMemoryBarrierCount = 1,
-        .pImageMemoryBarriers    = &last,
-    };
-    vkCmdPipelineBarrier2(cmd, &depLast);
+    cmd_levels_to_shader_read(cmd, image, mipCount - 1, 1);
 }
-bool bindless_textures_create_rgba8(ResourceAllocator* allocator,
-                                    VkDevice           device,
-                                    VkQueue            queue,
-                                    VkCommandPool      pool,
-                                    uint32_t           w,
-                                    uint32_t           h,
-                                    const uint8_t*     pixels,
-                                    TextureResource*   out_tex)
+bool bindless_textures_create_image(ResourceAllocator* allocator, VkDevice device, VkFormat format, uint32_t w, uint32_t h,
+                                    uint32_t mipCount, TextureResource* out_tex)
 {
-    VkDeviceSize      size     = (VkDeviceSize)w * (VkDeviceSize)h * 4u;
-    uint32_t          mipCount = calc_mip_count(w, h);
+    // block-compressed chains come with their mips, only RGBA8 is blitted
+    VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    if(format == VK_FORMAT_R8G8B8A8_UNORM)
+        usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;  // REQUIRED for blit mipgen
+
     VkImageCreateInfo img_info = {
-        .sType       = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
-        .imageType   = VK_IMAGE_TYPE_2D,
-        .format      = VK_FORMAT_R8G8B8A8_UNORM,
-        .extent      = {w, h, 1},
-        .mipLevels   = mipCount,
-        .arrayLayers = 1,
-        .samples     = VK_SAMPLE_COUNT_1_BIT,
-        .tiling      = VK_IMAGE_TILING_OPTIMAL,
-        .usage       = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |  // REQUIRED for blit mipgen
-                 VK_IMAGE_USAGE_SAMPLED_BIT,
+        .sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .imageType     = VK_IMAGE_TYPE_2D,
+        .format        = format,
+        .extent        = {w, h, 1},
+        .mipLevels     = mipCount,
+        .arrayLayers   = 1,
+        .samples       = VK_SAMPLE_COUNT_1_BIT,
+        .tiling        = VK_IMAGE_TILING_OPTIMAL,
+        .usage         = usage,
         .sharingMode   = VK_SHARING_MODE_EXCLUSIVE,
         .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
     };
@@ -277,7 +575,7 @@ bool bindless_textures_create_rgba8(ResourceAllocator* allocator,
         .sType    = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
         .image    = out_tex->image.image,
         .viewType = VK_IMAGE_VIEW_TYPE_2D,
-        .format   = VK_FORMAT_R8G8B8A8_UNORM,
+        .format   = format,
         .subresourceRange =
             {
                 .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
@@ -319,18 +617,26 @@ bool bindless_textures_create_rgba8(ResourceAllocator* allocator,
         .unnormalizedCoordinates = VK_FALSE,
     };
 
-    VK_CHECK(vkCreateSampler(device, &sampler_info, NULL, &out_tex->image.sampler));
-    Buffer staging = {0};
-    res_create_buffer(allocator, size, VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_AUTO,
-                      VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, 0, &staging);
+    // every texture asks for the same one
+    out_tex->image.sampler = res_get_sampler(allocator, &sampler_info);
 
-    memcpy(staging.mapping, pixels, (size_t)size);
+    out_tex->width  = w;
+    out_tex->height = h;
+    return true;
+}
 
-    VkCommandBuffer cmd = begin_one_time_cmd(device, pool);
-    image_to_transfer_dst(cmd, &out_tex->image);
+bool bindless_textures_create_image_rgba8(ResourceAllocator* allocator, VkDevice device, uint32_t w, uint32_t h,
+                                          TextureResource* out_tex)
+{
+    return bindless_textures_create_image(allocator, device, VK_FORMAT_R8G8B8A8_UNORM, w, h, calc_mip_count(w, h), out_tex);
+}
+
+void bindless_textures_cmd_upload_rgba8(VkCommandBuffer cmd, TextureResource* tex, VkBuffer staging, VkDeviceSize staging_offset)
+{
+    image_to_transfer_dst(cmd, &tex->image);
 
     VkBufferImageCopy region = {
-        .bufferOffset      = 0,
+        .bufferOffset      = staging_offset,
         .bufferRowLength   = 0,
         .bufferImageHeight = 0,
         .imageSubresource =
@@ -341,28 +647,109 @@ bool bindless_textures_create_rgba8(ResourceAllocator* allocator,
                 .layerCount     = 1,
             },
         .imageOffset = {0, 0, 0},
-        .imageExtent = {w, h, 1},
+        .imageExtent = {tex->width, tex->height, 1},
     };
 
-    vkCmdCopyBufferToImage(cmd, staging.buffer, out_tex->image.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    vkCmdCopyBufferToImage(cmd, staging, tex->image.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+    cmd_generate_mips(cmd, tex->image.image, tex->width, tex->height, tex->image.mipLevels);
+
+    tex->image.state.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    tex->image.state.stage  = VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    tex->image.state.access = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+}
+
+void bindless_textures_cmd_upload_file(VkCommandBuffer cmd, TextureResource* tex, const TextureFile* file, VkBuffer staging,
+                                       VkDeviceSize staging_offset)
+{
+    image_to_transfer_dst(cmd, &tex->image);
+
+    VkBufferImageCopy regions[TEXTURE_FILE_MAX_LEVELS];
+    for(uint32_t l = 0; l < file->level_count; l++)
+    {
+        regions[l] = (VkBufferImageCopy){
+            .bufferOffset      = staging_offset + file->levels[l].offset,
+            .bufferRowLength   = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource =
+                {
+                    .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+                    .mipLevel       = l,
+                    .baseArrayLayer = 0,
+                    .layerCount     = 1,
+                },
+            .imageOffset = {0, 0, 0},
+            .imageExtent = {file->levels[l].width, file->levels[l].height, 1},
+        };
+    }
+
+    vkCmdCopyBufferToImage(cmd, staging, tex->image.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, file->level_count, regions);
 
-    cmd_generate_mips(cmd, out_tex->image.image, w, h, mipCount);
+    if(file->generate_mips)
+        cmd_generate_mips(cmd, tex->image.image, tex->width, tex->height, tex->image.mipLevels);
+    else
+        cmd_levels_to_shader_read(cmd, tex->image.image, 0, tex->image.mipLevels);
+
+    tex->image.state.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    tex->image.state.stage  = VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    tex->image.state.access = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+}
+
+bool bindless_textures_create_from_file(ResourceAllocator* allocator,
+                                        VkDevice           device,
+                                        VkQueue            queue,
+                                        VkCommandPool      pool,
+                                        const TextureFile* file,
+                                        TextureResource*   out_tex)
+{
+    if(!bindless_textures_create_image(allocator, device, file->format, file->width, file->height,
+                                       texture_file_image_levels(file), out_tex))
+        return false;
+
+    Buffer staging = {0};
+    res_create_buffer(allocator, file->size, VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_AUTO,
+                      VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, 0, &staging);
+
+    memcpy(staging.mapping, file->data, (size_t)file->size);
+
+    VkCommandBuffer cmd = begin_one_time_cmd(device, pool);
+    bindless_textures_cmd_upload_file(cmd, out_tex, file, staging.buffer, 0);
     end_one_time_cmd(device, queue, pool, cmd);
 
     res_destroy_buffer(allocator, &staging);
+    return true;
+}
 
-    out_tex->width  = w;
-    out_tex->height = h;
-    out_tex->image.state.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    out_tex->image.state.stage  = VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
-    out_tex->image.state.access = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+bool bindless_textures_create_rgba8(ResourceAllocator* allocator,
+                                    VkDevice           device,
+                                    VkQueue            queue,
+                                    VkCommandPool      pool,
+                                    uint32_t           w,
+                                    uint32_t           h,
+                                    const uint8_t*     pixels,
+                                    TextureResource*   out_tex)
+{
+    VkDeviceSize size = (VkDeviceSize)w * (VkDeviceSize)h * 4u;
+    if(!bindless_textures_create_image_rgba8(allocator, device, w, h, out_tex))
+        return false;
+
+    Buffer staging = {0};
+    res_create_buffer(allocator, size, VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_AUTO,
+                      VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, 0, &staging);
+
+    memcpy(staging.mapping, pixels, (size_t)size);
+
+    VkCommandBuffer cmd = begin_one_time_cmd(device, pool);
+    bindless_textures_cmd_upload_rgba8(cmd, out_tex, staging.buffer, 0);
+    end_one_time_cmd(device, queue, pool, cmd);
+
+    res_destroy_buffer(allocator, &staging);
     return true;
 }
 
 void bindless_textures_destroy_texture(ResourceAllocator* allocator, VkDevice device, TextureResource* tex)
 {
-    if(tex->image.sampler)
-        vkDestroySampler(device, tex->image.sampler, NULL);
+    // the sampler belongs to the allocator's cache
     if(tex->image.view)
         vkDestroyImageView(device, tex->image.view, NULL);
     if(tex->image.image)
@@ -380,12 +767,19 @@ bool tex_create_from_rgba8_cpu(BindlessTextures* bindless,
                                uint32_t h,
                                const uint8_t* pixels,
                                uint32_t slot_hint,
-                               uint32_t* out_slot)
+                               TextureHandle* out_handle)
 {
-    if(!bindless || !allocator || !pixels || !out_slot)
+    if(!bindless || !allocator || !pixels || !out_handle)
         return false;
 
     uint32_t slot = 0;
+    uint64_t hash = bindless_textures_content_hash(VK_FORMAT_R8G8B8A8_UNORM, w, h, pixels, (size_t)w * h * 4u);
+    if(share_content(bindless, device, hash, slot_hint, &slot))
+    {
+        *out_handle = bindless_textures_handle(bindless, slot);
+        return true;
+    }
+
     if(!resolve_slot(bindless, slot_hint, &slot))
         return false;
 
@@ -399,8 +793,9 @@ bool tex_create_from_rgba8_cpu(BindlessTextures* bindless,
 
     tex.bindless_index         = slot;
     bindless->textures[slot]   = tex;
+    bindless_textures_register_content(bindless, allocator, slot, hash);
     bindless_textures_write(bindless, device, slot, tex.image.view, tex.image.sampler, tex.image.state.layout);
-    *out_slot = slot;
+    *out_handle = bindless_textures_handle(bindless, slot);
     return true;
 }
 
@@ -411,7 +806,7 @@ bool tex_create_from_file_rgba8(BindlessTextures* bindless,
                                 VkCommandPool pool,
                                 const char* path,
                                 uint32_t slot_hint,
-                                uint32_t* out_slot)
+                                TextureHandle* out_handle)
 {
     if(!path)
         return false;
@@ -422,24 +817,81 @@ bool tex_create_from_file_rgba8(BindlessTextures* bindless,
         return false;
 
     bool ok = tex_create_from_rgba8_cpu(bindless, allocator, device, queue, pool, (uint32_t)w, (uint32_t)h, pixels,
-                                        slot_hint, out_slot);
+                                        slot_hint, out_handle);
     stbi_image_free(pixels);
     return ok;
 }
 
-bool tex_destroy(BindlessTextures* bindless, ResourceAllocator* allocator, VkDevice device, uint32_t slot)
+bool tex_create_from_file(BindlessTextures* bindless,
+                          ResourceAllocator* allocator,
+                          VkDevice           device,
+                          VkQueue            queue,
+                          VkCommandPool      pool,
+                          const char*        path,
+                          uint32_t           slot_hint,
+                          TextureHandle*     out_handle)
+{
+    if(!bindless || !allocator || !path || !out_handle)
+        return false;
+
+    TextureFile file = {0};
+    if(!texture_file_load(path, &file))
+        return false;
+
+    uint32_t slot = 0;
+    uint64_t hash = bindless_textures_content_hash(file.format, file.width, file.height, file.data, (size_t)file.size);
+    if(share_content(bindless, device, hash, slot_hint, &slot))
+    {
+        texture_file_free(&file);
+        *out_handle = bindless_textures_handle(bindless, slot);
+        return true;
+    }
+
+    if(!resolve_slot(bindless, slot_hint, &slot))
+    {
+        texture_file_free(&file);
+        return false;
+    }
+
+    TextureResource tex = {0};
+    bool            ok  = bindless_textures_create_from_file(allocator, device, queue, pool, &file, &tex);
+    texture_file_free(&file);
+    if(!ok)
+    {
+        if(slot_hint == TEX_SLOT_AUTO)
+            release_slot(bindless, slot);
+        return false;
+    }
+
+    tex.bindless_index       = slot;
+    bindless->textures[slot] = tex;
+    bindless_textures_register_content(bindless, allocator, slot, hash);
+    bindless_textures_write(bindless, device, slot, tex.image.view, tex.image.sampler, tex.image.state.layout);
+    *out_handle = bindless_textures_handle(bindless, slot);
+    return true;
+}
+
+bool tex_destroy(BindlessTextures* bindless, TextureHandle handle)
 {
-    if(!bindless || slot >= bindless->max_textures)
+    if(!bindless || !bindless_textures_handle_valid(bindless, handle))
         return false;
 
-    if(bindless->textures[slot].image.image == VK_NULL_HANDLE)
+    uint32_t         slot = tex_handle_slot(handle);
+    TextureResource* tex  = &bindless->textures[slot];
+    if(tex->image.image == VK_NULL_HANDLE)
         return false;
 
-    bindless_textures_destroy_texture(allocator, device, &bindless->textures[slot]);
-    if(slot != 0)
+    if(tex->refs > 1)
     {
-        release_slot(bindless, slot);
-        write_dummy_if_available(bindless, device, slot);
+        tex->refs--;
+        return true;
     }
+
+    // frames already recorded may still sample the slot: it keeps its
+    // descriptor until bindless_textures_begin_frame sees them done
+    TextureRetire retire = {.value = bindless->frame, .slot = slot};
+    detach_slot(bindless, slot, &retire.tex);
+    arrpush(bindless->retired, retire);
+    bindless->generation[slot]++;
     return true;
 }
@@ -3,9 +3,36 @@
 #include "vk_defaults.h"
 #include "vk_descriptor.h"
 #include "vk_resources.h"
+#include "texture_file.h"
 #include <stdint.h>
 #include <stdbool.h>
 
+// Texture handle: bindless slot in the low 16 bits, the slot's generation in
+// the high 16. A slot's generation moves on when its texture is destroyed, so
+// handles kept past tex_destroy stop resolving instead of aliasing whatever
+// lands in the slot next. The GPU side (MaterialGpu etc.) keeps plain slots.
+typedef uint32_t TextureHandle;
+
+#define TEX_HANDLE_SLOT_BITS 16u
+#define TEX_HANDLE_SLOT_MASK ((1u << TEX_HANDLE_SLOT_BITS) - 1u)
+
+_Static_assert(MAX_BINDLESS_TEXTURES <= (1u << TEX_HANDLE_SLOT_BITS), "bindless slots must fit a TextureHandle");
+
+static inline TextureHandle tex_handle_make(uint32_t slot, uint32_t generation)
+{
+    return (generation << TEX_HANDLE_SLOT_BITS) | (slot & TEX_HANDLE_SLOT_MASK);
+}
+
+static inline uint32_t tex_handle_slot(TextureHandle h)
+{
+    return h & TEX_HANDLE_SLOT_MASK;
+}
+
+static inline uint32_t tex_handle_generation(TextureHandle h)
+{
+    return h >> TEX_HANDLE_SLOT_BITS;
+}
+
 typedef struct TextureResource
 {
     Image image;
@@ -13,8 +40,38 @@ typedef struct TextureResource
 
     // bindless slot index == TextureID
     uint32_t bindless_index;
+
+    uint64_t content_hash;  // 0: not in the content registry
+    uint32_t refs;          // tex_* handles on this slot, freed at zero
 } TextureResource;
 
+// Content registry: one image per distinct content hash
+// (bindless_textures_content_hash). The owner slot holds the image, alias
+// slots copy its handles; the image is destroyed with the last slot.
+typedef struct TextureContentEntry
+{
+    uint64_t     hash;     // 0: free entry
+    uint32_t     slot;     // owner
+    uint32_t*    aliases;  // stb_ds, the other slots sampling the image
+    VkDeviceSize gpu_bytes;
+} TextureContentEntry;
+
+typedef struct TextureDedupStats
+{
+    uint32_t     unique;      // images registered
+    uint32_t     duplicates;  // loads that reused one
+    VkDeviceSize bytes_saved; // VRAM the duplicates would have taken
+} TextureDedupStats;
+
+// Destroyed texture waiting for the GPU: the slot comes back, and the image
+// (when no other slot samples it) goes, once frame `value` has completed.
+typedef struct TextureRetire
+{
+    uint64_t        value;
+    uint32_t        slot;
+    TextureResource tex;
+} TextureRetire;
+
 typedef struct BindlessTextures
 {
     VkDescriptorSetLayout layout;
@@ -26,6 +83,15 @@ typedef struct BindlessTextures
     TextureResource textures[MAX_BINDLESS_TEXTURES];
     uint32_t        free_list[MAX_BINDLESS_TEXTURES];
     uint32_t        free_count;
+    uint16_t        generation[MAX_BINDLESS_TEXTURES];
+
+    uint64_t       frame;    // stamped on destroyed textures
+    TextureRetire* retired;  // stb_ds, oldest first
+
+    TextureContentEntry* contents;       // stb_ds, entries never move
+    uint32_t*            content_free;   // stb_ds, free entries of contents
+    HashIndex            content_index;  // content hash -> contents
+    TextureDedupStats    dedup;
 } BindlessTextures;
 
 #define TEX_SLOT_AUTO UINT32_MAX
@@ -35,6 +101,40 @@ void bindless_textures_init(BindlessTextures* bt, VkDevice device, DescriptorAll
 void bindless_textures_destroy(BindlessTextures* bt, ResourceAllocator* allocator, VkDevice device);
 
 uint32_t bindless_textures_alloc_slot(BindlessTextures* bt);
+
+// Once per frame after its fence wait. frame is the value the work recorded
+// from now on completes with (a frame counter or timeline value, increasing),
+// completed the highest value known to be done on the GPU. Textures destroyed
+// in frames up to completed are freed: image destroyed, slot back to the dummy
+// and the free list.
+void bindless_textures_begin_frame(BindlessTextures* bt, ResourceAllocator* allocator, VkDevice device, uint64_t frame,
+                                   uint64_t completed);
+
+// Installs tex in a free slot and retires slot, with its image if any, like a
+// destroyed texture. Frames in flight may sample slot, so its descriptor is
+// not rewritten until they are done: the caller points every GPU-side
+// reference (MaterialGpu etc.) at the returned slot before recording the next
+// frame. 0 when no slot is free; tex is left to the caller then. For slots
+// outside the content registry (texture_streamer.c).
+uint32_t bindless_textures_replace(BindlessTextures* bt, VkDevice device, uint32_t slot, const TextureResource* tex);
+// Same, registering tex's image under hash in the fresh slot (texture_loader.c).
+uint32_t bindless_textures_replace_content(BindlessTextures* bt, ResourceAllocator* allocator, VkDevice device,
+                                           uint32_t slot, const TextureResource* tex, uint64_t hash);
+// Same, with the fresh slot an alias of src_slot's image.
+uint32_t bindless_textures_replace_alias(BindlessTextures* bt, VkDevice device, uint32_t slot, uint32_t src_slot);
+
+// A texture moved from bindless slot `from` to `to` (the replace calls above).
+typedef struct TextureSlotMove
+{
+    uint32_t from;
+    uint32_t to;
+} TextureSlotMove;
+
+// Current handle of slot.
+TextureHandle bindless_textures_handle(const BindlessTextures* bt, uint32_t slot);
+bool          bindless_textures_handle_valid(const BindlessTextures* bt, TextureHandle h);
+// Slot of h for the GPU side, 0 (the dummy) when h is stale.
+uint32_t bindless_textures_resolve(const BindlessTextures* bt, TextureHandle h);
 void bindless_textures_write(BindlessTextures* bt, VkDevice device, uint32_t slot, VkImageView view, VkSampler sampler,
                              VkImageLayout layout);
 
@@ -42,6 +142,43 @@ bool bindless_textures_create_rgba8(ResourceAllocator* allocator, VkDevice devic
                                     uint32_t w, uint32_t h, const uint8_t* pixels, TextureResource* out_tex);
 void bindless_textures_destroy_texture(ResourceAllocator* allocator, VkDevice device, TextureResource* tex);
 
+// Content registry. The hash covers format, size and texel data (decoded
+// pixels or the stored levels of a TextureFile), never 0.
+uint64_t bindless_textures_content_hash(VkFormat format, uint32_t w, uint32_t h, const void* data, size_t size);
+// Owner slot of hash, false when it is not loaded.
+bool bindless_textures_find_content(const BindlessTextures* bt, uint64_t hash, uint32_t* out_slot);
+// Registers the image just created in slot (refs 1).
+void bindless_textures_register_content(BindlessTextures* bt, ResourceAllocator* allocator, uint32_t slot, uint64_t hash);
+// Points the empty slot at src_slot's image and counts the duplicate.
+void bindless_textures_alias(BindlessTextures* bt, VkDevice device, uint32_t slot, uint32_t src_slot);
+
+// "textures dedup: N unique, N duplicates removed, X MB VRAM saved, N samplers for N requests"
+void bindless_textures_print_dedup_stats(const BindlessTextures* bt, ResourceAllocator* allocator);
+
+// The two halves of bindless_textures_create_rgba8, for callers that batch
+// uploads themselves (texture_loader.c). create_image makes the image with a
+// full mip chain, its view and sampler. cmd_upload records the copy of w*h
+// RGBA8 texels at staging_offset plus blit mip generation, leaving the image
+// in SHADER_READ_ONLY_OPTIMAL once cmd has executed.
+bool bindless_textures_create_image_rgba8(ResourceAllocator* allocator, VkDevice device, uint32_t w, uint32_t h,
+                                          TextureResource* out_tex);
+void bindless_textures_cmd_upload_rgba8(VkCommandBuffer cmd, TextureResource* tex, VkBuffer staging, VkDeviceSize staging_offset);
+
+// Same split for any TextureFile: create_image takes the format and mip count
+// (texture_file_image_levels), cmd_upload_file copies every stored level from
+// staging_offset + level offset and blits the rest only when generate_mips is set.
+bool bindless_textures_create_image(ResourceAllocator* allocator, VkDevice device, VkFormat format, uint32_t w, uint32_t h,
+                                    uint32_t mipCount, TextureResource* out_tex);
+void bindless_textures_cmd_upload_file(VkCommandBuffer cmd, TextureResource* tex, const TextureFile* file, VkBuffer staging,
+                                       VkDeviceSize staging_offset);
+bool bindless_textures_create_from_file(ResourceAllocator* allocator, VkDevice device, VkQueue queue, VkCommandPool pool,
+                                        const TextureFile* file, TextureResource* out_tex);
+
+// tex_create_*: content already loaded is shared. With TEX_SLOT_AUTO the
+// existing slot comes back with one more reference, an explicit slot becomes
+// an alias of the image. tex_destroy drops one reference; the last one
+// invalidates the handle at once and frees slot and image from
+// bindless_textures_begin_frame once the frames that may sample them are done.
 bool tex_create_from_rgba8_cpu(BindlessTextures* bindless,
                                ResourceAllocator* allocator,
                                VkDevice device,
@@ -51,7 +188,7 @@ bool tex_create_from_rgba8_cpu(BindlessTextures* bindless,
                                uint32_t h,
                                const uint8_t* pixels,
                                uint32_t slot_hint,
-                               uint32_t* out_slot);
+                               TextureHandle* out_handle);
 
 bool tex_create_from_file_rgba8(BindlessTextures* bindless,
                                 ResourceAllocator* allocator,
@@ -60,6 +197,17 @@ bool tex_create_from_file_rgba8(BindlessTextures* bindless,
                                 VkCommandPool pool,
                                 const char* path,
                                 uint32_t slot_hint,
-                                uint32_t* out_slot);
+                                TextureHandle* out_handle);
+
+// .dds/.ktx keep their BC format and mip chain, other files load as RGBA8 (see texture_file.h).
+bool tex_create_from_file(BindlessTextures* bindless,
+                          ResourceAllocator* allocator,
+                          VkDevice device,
+                          VkQueue queue,
+                          VkCommandPool pool,
+                          const char* path,
+                          uint32_t slot_hint,
+                          TextureHandle* out_handle);
 
-bool tex_destroy(BindlessTextures* bindless, ResourceAllocator* allocator, VkDevice device, uint32_t slot);
+// False for stale handles.
+bool tex_destroy(BindlessTextures* bindless, TextureHandle handle);
@@ -31,6 +31,25 @@ void camera_get_basis(Camera* cam, vec3 out_forward, vec3 out_right, vec3 out_up
     glm_vec3_normalize(out_up);
 }
 
+void camera_screen_ray(Camera* cam, float mx, float my, float width, float height, float aspect, vec3 out_origin, vec3 out_dir)
+{
+    float ndc_x = (2.0f * mx / fmaxf(width, 1.0f)) - 1.0f;
+    float ndc_y = 1.0f - (2.0f * my / fmaxf(height, 1.0f));
+
+    vec3 forward, right, up;
+    camera_get_basis(cam, forward, right, up);
+
+    float tan_half_y = tanf(cam->fov_y * 0.5f);
+    float tan_half_x = tan_half_y * aspect;
+
+    glm_vec3_copy(forward, out_dir);
+    glm_vec3_muladds(right, ndc_x * tan_half_x, out_dir);
+    glm_vec3_muladds(up, ndc_y * tan_half_y, out_dir);
+    glm_vec3_normalize(out_dir);
+
+    glm_vec3_copy(cam->position, out_origin);
+}
+
 void camera_build_view(mat4 out_view, Camera* cam)
 {
     // View matrix is inverse(camera transform)
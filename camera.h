@@ -33,3 +33,6 @@ void camera_build_proj(mat4 out_proj,  Camera* cam, float aspect);
 
 // Utility: get forward/right/up basis vectors from camera rotation
 void camera_get_basis( Camera* cam, vec3 out_forward, vec3 out_right, vec3 out_up);
+
+// World-space ray through a pixel (mx, my from the top-left). out_dir is normalized.
+void camera_screen_ray(Camera* cam, float mx, float my, float width, float height, float aspect, vec3 out_origin, vec3 out_dir);
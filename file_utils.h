@@ -133,7 +133,7 @@ static bool compile_glsl_to_spv(const char* src_path, const char* spv_path)
         return false;
 
     char cmd[2048];
-    snprintf(cmd, sizeof(cmd), "glslc \"%s\" -o \"%s\" 2> compiledshaders/shader_errors.txt", src_path, spv_path);
+    snprintf(cmd, sizeof(cmd), "glslc --target-env=vulkan1.3 \"%s\" -o \"%s\" 2> compiledshaders/shader_errors.txt", src_path, spv_path);
 
     int r = system(cmd);
     if(r != 0)
@@ -0,0 +1,264 @@
+#include "geometry_codec.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "external/meshoptimizer/src/meshoptimizer.h"
+
+// ------------------------------------------------------------
+// Encode
+// ------------------------------------------------------------
+
+typedef struct EncodeJob
+{
+    const Geometry* geometry;
+    GeometryStream* streams;
+    uint8_t**       blobs;  // per stream, malloc
+    uint32_t        vertexBase;
+    uint32_t        indexBase;
+    uint32_t        failed;  // __atomic
+} EncodeJob;
+
+static void encode_stream(void* user, uint32_t index)
+{
+    EncodeJob*      job = (EncodeJob*)user;
+    GeometryStream* s   = &job->streams[index];
+
+    size_t vbound = s->vertexCount ? meshopt_encodeVertexBufferBound(s->vertexCount, sizeof(VertexPacked)) : 0;
+    size_t ibound = s->indexCount ? meshopt_encodeIndexBufferBound(s->indexCount, s->vertexCount) : 0;
+
+    uint8_t* blob = (uint8_t*)malloc(MAX(vbound + ibound, 1u));
+    if(!blob)
+    {
+        __atomic_store_n(&job->failed, 1u, __ATOMIC_RELAXED);
+        return;
+    }
+
+    size_t vbytes = 0, ibytes = 0;
+    if(s->vertexCount)
+        vbytes = meshopt_encodeVertexBuffer(blob, vbound, &job->geometry->vertices[job->vertexBase + s->vertexOffset],
+                                            s->vertexCount, sizeof(VertexPacked));
+    if(s->indexCount)
+        ibytes = meshopt_encodeIndexBuffer(blob + vbytes, ibound, &job->geometry->indices[job->indexBase + s->indexOffset],
+                                           s->indexCount);
+
+    if((s->vertexCount && vbytes == 0) || (s->indexCount && ibytes == 0))
+        __atomic_store_n(&job->failed, 1u, __ATOMIC_RELAXED);
+
+    s->vertexBytes    = (uint32_t)vbytes;
+    s->indexBytes     = (uint32_t)ibytes;
+    job->blobs[index] = blob;
+}
+
+// Index range of a mesh: its LODs back to back, starting at lods[0].
+static bool mesh_index_range(const Mesh* m, uint32_t* outFirst, uint32_t* outCount)
+{
+    uint32_t first = m->lodCount ? m->lods[0].indexOffset : *outFirst;
+    uint32_t end   = first;
+
+    for(uint32_t li = 0; li < m->lodCount && li < SCENE_MAX_LODS; li++)
+    {
+        const MeshLod* lod = &m->lods[li];
+        if(lod->indexOffset != end)
+            return false;
+        end += lod->indexCount;
+    }
+
+    *outFirst = first;
+    *outCount = end - first;
+    return true;
+}
+
+bool geometry_pack_encode(GeometryPack* out, const Geometry* geometry, uint32_t meshBase, uint32_t meshCount,
+                          uint32_t vertexBase, uint32_t vertexCount, uint32_t indexBase, uint32_t indexCount,
+                          JobPool* pool)
+{
+    memset(out, 0, sizeof(*out));
+
+    GeometryStream* streams = (GeometryStream*)calloc(MAX(meshCount, 1u), sizeof(GeometryStream));
+    uint8_t**       blobs   = (uint8_t**)calloc(MAX(meshCount, 1u), sizeof(uint8_t*));
+    bool            ok      = streams && blobs;
+
+    uint32_t vcur = vertexBase, icur = indexBase;
+    for(uint32_t i = 0; ok && i < meshCount; i++)
+    {
+        const Mesh* m      = &geometry->meshes[meshBase + i];
+        uint32_t    ifirst = icur, icount = 0;
+
+        ok = m->vertexOffset == vcur && mesh_index_range(m, &ifirst, &icount) && ifirst == icur && icount % 3u == 0;
+        if(!ok)
+            break;
+
+        streams[i].vertexOffset = vcur - vertexBase;
+        streams[i].vertexCount  = m->vertexCount;
+        streams[i].indexOffset  = icur - indexBase;
+        streams[i].indexCount   = icount;
+
+        vcur += m->vertexCount;
+        icur += icount;
+    }
+    ok = ok && vcur - vertexBase == vertexCount && icur - indexBase == indexCount;
+
+    if(ok)
+    {
+        EncodeJob job = {.geometry = geometry, .streams = streams, .blobs = blobs, .vertexBase = vertexBase, .indexBase = indexBase};
+        job_pool_parallel_for(pool, meshCount, encode_stream, &job);
+        ok = job.failed == 0;
+    }
+
+    if(ok)
+    {
+        uint64_t total = 0;
+        for(uint32_t i = 0; i < meshCount; i++)
+            total += (uint64_t)streams[i].vertexBytes + streams[i].indexBytes;
+
+        arrsetlen(out->data, total);
+        uint64_t at = 0;
+        for(uint32_t i = 0; i < meshCount; i++)
+        {
+            size_t bytes          = (size_t)streams[i].vertexBytes + streams[i].indexBytes;
+            streams[i].dataOffset = at;
+            memcpy(out->data + at, blobs[i], bytes);
+            at += bytes;
+            arrpush(out->streams, streams[i]);
+        }
+        out->vertexCount = vertexCount;
+        out->indexCount  = indexCount;
+    }
+
+    for(uint32_t i = 0; blobs && i < meshCount; i++)
+        free(blobs[i]);
+    free(blobs);
+    free(streams);
+    return ok;
+}
+
+// ------------------------------------------------------------
+// Decode
+// ------------------------------------------------------------
+
+bool geometry_streams_valid(const GeometryStream* streams, uint32_t streamCount, uint64_t dataSize,
+                            uint32_t vertexCount, uint32_t indexCount)
+{
+    uint64_t vcur = 0, icur = 0;
+    for(uint32_t i = 0; i < streamCount; i++)
+    {
+        const GeometryStream* s = &streams[i];
+        if(s->vertexOffset != vcur || s->indexOffset != icur || s->indexCount % 3u != 0)
+            return false;
+        if(s->dataOffset > dataSize || (uint64_t)s->vertexBytes + s->indexBytes > dataSize - s->dataOffset)
+            return false;
+
+        vcur += s->vertexCount;
+        icur += s->indexCount;
+    }
+    return vcur == vertexCount && icur == indexCount;
+}
+
+typedef struct DecodeJob
+{
+    const GeometryStream* streams;
+    const uint8_t*        data;
+    VertexPacked*         vertices;
+    uint32_t*             indices;
+    uint32_t              failed;  // __atomic
+} DecodeJob;
+
+static void decode_stream(void* user, uint32_t index)
+{
+    DecodeJob*            job = (DecodeJob*)user;
+    const GeometryStream* s   = &job->streams[index];
+    const uint8_t*        src = job->data + s->dataOffset;
+
+    int rc = 0;
+    if(job->vertices && s->vertexCount)
+        rc |= meshopt_decodeVertexBuffer(job->vertices + s->vertexOffset, s->vertexCount, sizeof(VertexPacked), src,
+                                         s->vertexBytes);
+    if(job->indices && s->indexCount)
+        rc |= meshopt_decodeIndexBuffer(job->indices + s->indexOffset, s->indexCount, sizeof(uint32_t),
+                                        src + s->vertexBytes, s->indexBytes);
+
+    if(rc != 0)
+        __atomic_store_n(&job->failed, 1u, __ATOMIC_RELAXED);
+}
+
+bool geometry_pack_decode(const GeometryStream* streams, uint32_t streamCount, const uint8_t* data,
+                          VertexPacked* dstVertices, uint32_t* dstIndices, JobPool* pool)
+{
+    DecodeJob job = {.streams = streams, .data = data, .vertices = dstVertices, .indices = dstIndices};
+    job_pool_parallel_for(pool, streamCount, decode_stream, &job);
+    return job.failed == 0;
+}
+
+// ------------------------------------------------------------
+// Pack storage
+// ------------------------------------------------------------
+
+void geometry_pack_append(GeometryPack* pack, const GeometryStream* streams, uint32_t streamCount, const uint8_t* data,
+                          uint64_t dataSize, uint32_t vertexCount, uint32_t indexCount)
+{
+    uint64_t dataBase = (uint64_t)arrlen(pack->data);
+    if(dataSize)
+    {
+        arrsetlen(pack->data, dataBase + dataSize);
+        memcpy(pack->data + dataBase, data, (size_t)dataSize);
+    }
+
+    for(uint32_t i = 0; i < streamCount; i++)
+    {
+        GeometryStream s = streams[i];
+        s.vertexOffset += pack->vertexCount;
+        s.indexOffset += pack->indexCount;
+        s.dataOffset += dataBase;
+        arrpush(pack->streams, s);
+    }
+
+    pack->vertexCount += vertexCount;
+    pack->indexCount += indexCount;
+}
+
+bool geometry_unpack(Geometry* geometry, JobPool* pool)
+{
+    GeometryPack* pack = &geometry->packed;
+    if(!pack->streams)
+        return true;
+
+    arrsetlen(geometry->vertices, pack->vertexCount);
+    arrsetlen(geometry->indices, pack->indexCount);
+
+    if(!geometry_pack_decode(pack->streams, (uint32_t)arrlen(pack->streams), pack->data, geometry->vertices,
+                             geometry->indices, pool))
+    {
+        arrsetlen(geometry->vertices, 0);
+        arrsetlen(geometry->indices, 0);
+        return false;
+    }
+
+    geometry_pack_free(pack);
+    return true;
+}
+
+bool geometry_indices_equivalent(const uint32_t* a, const uint32_t* b, uint32_t indexCount)
+{
+    if(indexCount % 3u != 0)
+        return memcmp(a, b, (size_t)indexCount * sizeof(uint32_t)) == 0;
+
+    for(uint32_t i = 0; i < indexCount; i += 3)
+    {
+        const uint32_t* x = a + i;
+        const uint32_t* y = b + i;
+
+        bool same = (x[0] == y[0] && x[1] == y[1] && x[2] == y[2]) || (x[0] == y[1] && x[1] == y[2] && x[2] == y[0])
+                    || (x[0] == y[2] && x[1] == y[0] && x[2] == y[1]);
+        if(!same)
+            return false;
+    }
+    return true;
+}
+
+void geometry_pack_free(GeometryPack* pack)
+{
+    arrfree(pack->streams);
+    arrfree(pack->data);
+    memset(pack, 0, sizeof(*pack));
+}
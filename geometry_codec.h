@@ -0,0 +1,49 @@
+#pragma once
+
+#include "scene.h"
+#include "job_pool.h"
+
+// meshopt vertex/index codecs over Geometry, one GeometryStream per mesh.
+//
+// VertexPacked is already quantized to 16 bytes; the vertex codec still gets
+// most of its win from byte deltas between neighbours, which the vertex fetch
+// order build_mesh leaves makes small. The index codec relies on the vertex
+// cache order from the same pass. Streams are independent, so decoding runs
+// one job per mesh and can write straight into mapped staging memory.
+//
+// The vertex codec is lossless. The index codec keeps triangle order and
+// winding but may rotate a triangle's corners ({a,b,c} -> {b,c,a}), so decoded
+// indices are compared with geometry_indices_equivalent, not memcmp.
+
+// Encodes meshes [meshBase, meshBase + meshCount) into an empty pack. Their
+// vertex and index ranges must follow each other in order and exactly cover
+// vertexCount vertices from vertexBase and indexCount indices from indexBase
+// (true for anything scene_load_gltf appended); stream offsets are relative to
+// those bases. Returns false, leaving out empty, if they don't or an encode fails.
+bool geometry_pack_encode(GeometryPack* out, const Geometry* geometry, uint32_t meshBase, uint32_t meshCount,
+                          uint32_t vertexBase, uint32_t vertexCount, uint32_t indexBase, uint32_t indexCount,
+                          JobPool* pool);
+
+// Streams tile [0, vertexCount) / [0, indexCount) in order and their bytes stay
+// inside dataSize. Anything read from disk goes through this before decoding.
+bool geometry_streams_valid(const GeometryStream* streams, uint32_t streamCount, uint64_t dataSize,
+                            uint32_t vertexCount, uint32_t indexCount);
+
+// Decodes every stream, one job per stream. dstVertices / dstIndices hold the
+// full range the streams tile; either may be NULL to skip that half. Returns
+// false if any stream fails to decode.
+bool geometry_pack_decode(const GeometryStream* streams, uint32_t streamCount, const uint8_t* data,
+                          VertexPacked* dstVertices, uint32_t* dstIndices, JobPool* pool);
+
+// Appends valid streams to pack, rebasing them after what it already holds.
+void geometry_pack_append(GeometryPack* pack, const GeometryStream* streams, uint32_t streamCount, const uint8_t* data,
+                          uint64_t dataSize, uint32_t vertexCount, uint32_t indexCount);
+
+void geometry_pack_free(GeometryPack* pack);
+
+// Same triangles in the same order and winding, allowing per-triangle rotation.
+bool geometry_indices_equivalent(const uint32_t* a, const uint32_t* b, uint32_t indexCount);
+
+// Decodes geometry->packed into geometry->vertices/indices (both empty while it
+// holds anything) and frees the encoded copy. No-op for plain geometry.
+bool geometry_unpack(Geometry* geometry, JobPool* pool);
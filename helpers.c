@@ -1,4 +1,7 @@
 #include "vk_defaults.h"
+
+#include <time.h>
+
 uint32_t hash32_bytes(const void* data, size_t size)
 {
     return (uint32_t)XXH32(data, size, 0);
@@ -28,3 +31,66 @@ size_t c99_strnlen(const char* s, size_t maxlen)
     }
     return i;
 }
+
+uint64_t time_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+uint32_t hash_index_next(const HashIndex* index, uint64_t hash, uint32_t* probe)
+{
+    if(index->capacity == 0)
+        return HASH_INDEX_NONE;
+
+    uint32_t mask = index->capacity - 1;
+    for(uint32_t i = *probe; i < index->capacity; i++)
+    {
+        const HashIndexSlot* slot = &index->slots[(hash + i) & mask];
+        if(slot->index == 0)
+            break;
+        if(slot->hash == hash)
+        {
+            *probe = i + 1;
+            return slot->index - 1;
+        }
+    }
+
+    *probe = index->capacity;
+    return HASH_INDEX_NONE;
+}
+
+static void hash_index_place(HashIndexSlot* slots, uint32_t mask, uint64_t hash, uint32_t index)
+{
+    uint32_t at = (uint32_t)hash & mask;
+    while(slots[at].index != 0)
+        at = (at + 1) & mask;
+    slots[at] = (HashIndexSlot){.hash = hash, .index = index};
+}
+
+void hash_index_insert(HashIndex* index, uint64_t hash, uint32_t entry)
+{
+    if((index->count + 1) * 4 > index->capacity * 3)
+    {
+        uint32_t       capacity = index->capacity ? index->capacity * 2 : 64;
+        HashIndexSlot* slots    = (HashIndexSlot*)calloc(capacity, sizeof(HashIndexSlot));
+        for(uint32_t i = 0; i < index->capacity; i++)
+        {
+            if(index->slots[i].index != 0)
+                hash_index_place(slots, capacity - 1, index->slots[i].hash, index->slots[i].index);
+        }
+        free(index->slots);
+        index->slots    = slots;
+        index->capacity = capacity;
+    }
+
+    hash_index_place(index->slots, index->capacity - 1, hash, entry + 1);
+    index->count++;
+}
+
+void hash_index_free(HashIndex* index)
+{
+    free(index->slots);
+    *index = (HashIndex){0};
+}
@@ -0,0 +1,208 @@
+#include "job_pool.h"
+
+#include <unistd.h>
+
+uint32_t job_pool_default_threads(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if(n <= 1)
+        return 1;
+    return (uint32_t)(n - 1);
+}
+
+// mutex must be held
+static bool pop_job(JobPool* pool, Job* out)
+{
+    if(pool->queue_count == 0)
+        return false;
+
+    *out             = pool->queue[pool->queue_head];
+    pool->queue_head = (pool->queue_head + 1) % pool->queue_cap;
+    pool->queue_count--;
+    return true;
+}
+
+// mutex must be held
+static void push_job(JobPool* pool, const Job* job)
+{
+    if(pool->queue_count == pool->queue_cap)
+    {
+        uint32_t new_cap = pool->queue_cap ? pool->queue_cap * 2 : 256;
+        Job*     q       = (Job*)malloc(sizeof(Job) * new_cap);
+        for(uint32_t i = 0; i < pool->queue_count; i++)
+            q[i] = pool->queue[(pool->queue_head + i) % pool->queue_cap];
+
+        free(pool->queue);
+        pool->queue      = q;
+        pool->queue_cap  = new_cap;
+        pool->queue_head = 0;
+    }
+
+    pool->queue[(pool->queue_head + pool->queue_count) % pool->queue_cap] = *job;
+    pool->queue_count++;
+}
+
+static void execute(JobPool* pool, const Job* job)
+{
+    job->fn(job->user, job->index);
+
+    if(job->counter && __atomic_sub_fetch(&job->counter->pending, 1, __ATOMIC_ACQ_REL) == 0)
+    {
+        pthread_mutex_lock(&pool->mutex);
+        pthread_cond_broadcast(&pool->done_cond);
+        pthread_mutex_unlock(&pool->mutex);
+    }
+}
+
+static void* worker_main(void* arg)
+{
+    JobPool* pool = (JobPool*)arg;
+
+    for(;;)
+    {
+        pthread_mutex_lock(&pool->mutex);
+        while(pool->queue_count == 0 && !pool->shutdown)
+            pthread_cond_wait(&pool->work_cond, &pool->mutex);
+
+        Job  job;
+        bool have = pop_job(pool, &job);
+        bool quit = !have && pool->shutdown;
+        pthread_mutex_unlock(&pool->mutex);
+
+        if(quit)
+            break;
+        if(have)
+            execute(pool, &job);
+    }
+
+    return NULL;
+}
+
+void job_pool_init(JobPool* pool, uint32_t thread_count)
+{
+    memset(pool, 0, sizeof(*pool));
+
+    if(thread_count == 0)
+        thread_count = job_pool_default_threads();
+
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->work_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+
+    pool->threads = (pthread_t*)malloc(sizeof(pthread_t) * thread_count);
+    for(uint32_t i = 0; i < thread_count; i++)
+    {
+        if(pthread_create(&pool->threads[i], NULL, worker_main, pool) != 0)
+        {
+            log_warn("job_pool: only %u of %u workers started", i, thread_count);
+            break;
+        }
+        pool->thread_count++;
+    }
+}
+
+void job_pool_destroy(JobPool* pool)
+{
+    if(!pool || !pool->threads)
+        return;
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for(uint32_t i = 0; i < pool->thread_count; i++)
+        pthread_join(pool->threads[i], NULL);
+
+    pthread_cond_destroy(&pool->done_cond);
+    pthread_cond_destroy(&pool->work_cond);
+    pthread_mutex_destroy(&pool->mutex);
+
+    free(pool->threads);
+    free(pool->queue);
+    memset(pool, 0, sizeof(*pool));
+}
+
+void job_pool_run(JobPool* pool, JobFunc fn, void* user, uint32_t index, JobCounter* counter)
+{
+    if(counter)
+        __atomic_add_fetch(&counter->pending, 1, __ATOMIC_ACQ_REL);
+
+    Job job = {.fn = fn, .user = user, .index = index, .counter = counter};
+
+    pthread_mutex_lock(&pool->mutex);
+    push_job(pool, &job);
+    pthread_cond_signal(&pool->work_cond);
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+bool job_pool_is_done(const JobCounter* counter)
+{
+    return __atomic_load_n(&counter->pending, __ATOMIC_ACQUIRE) == 0;
+}
+
+void job_pool_wait(JobPool* pool, JobCounter* counter)
+{
+    pthread_mutex_lock(&pool->mutex);
+    while(!job_pool_is_done(counter))
+    {
+        // help out instead of sleeping while there is queued work
+        Job job;
+        if(pop_job(pool, &job))
+        {
+            pthread_mutex_unlock(&pool->mutex);
+            execute(pool, &job);
+            pthread_mutex_lock(&pool->mutex);
+            continue;
+        }
+
+        pthread_cond_wait(&pool->done_cond, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+typedef struct ParallelFor
+{
+    JobFunc  fn;
+    void*    user;
+    uint32_t count;
+    uint32_t next;  // atomic
+} ParallelFor;
+
+// One job per worker; each pulls indices until the range is exhausted, which
+// load-balances uneven work (e.g. one huge primitive among many small ones).
+static void parallel_for_worker(void* user, uint32_t index)
+{
+    (void)index;
+    ParallelFor* pf = (ParallelFor*)user;
+
+    for(;;)
+    {
+        uint32_t i = __atomic_fetch_add(&pf->next, 1, __ATOMIC_RELAXED);
+        if(i >= pf->count)
+            break;
+        pf->fn(pf->user, i);
+    }
+}
+
+void job_pool_parallel_for(JobPool* pool, uint32_t count, JobFunc fn, void* user)
+{
+    if(count == 0)
+        return;
+
+    if(!pool || pool->thread_count == 0 || count == 1)
+    {
+        for(uint32_t i = 0; i < count; i++)
+            fn(user, i);
+        return;
+    }
+
+    ParallelFor pf      = {.fn = fn, .user = user, .count = count, .next = 0};
+    JobCounter  counter = {0};
+
+    uint32_t jobs = MIN(pool->thread_count + 1u, count);
+    for(uint32_t i = 0; i < jobs; i++)
+        job_pool_run(pool, parallel_for_worker, &pf, i, &counter);
+
+    job_pool_wait(pool, &counter);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "tinytypes.h"
+#include <pthread.h>
+
+// Minimal pthread worker pool.
+//
+// Jobs are (fn, user, index) triples pushed to one FIFO. A JobCounter tracks a
+// group of jobs; job_pool_wait() helps drain the queue on the calling thread
+// until the group is done, so waiting never deadlocks even with 0 workers.
+
+typedef void (*JobFunc)(void* user, uint32_t index);
+
+typedef struct JobCounter
+{
+    uint32_t pending;  // accessed with __atomic builtins
+} JobCounter;
+
+typedef struct Job
+{
+    JobFunc     fn;
+    void*       user;
+    uint32_t    index;
+    JobCounter* counter;
+} Job;
+
+typedef struct JobPool
+{
+    pthread_t*      threads;
+    uint32_t        thread_count;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t  work_cond;  // queue became non-empty / shutdown
+    pthread_cond_t  done_cond;  // some counter reached zero
+
+    Job*     queue;  // ring buffer
+    uint32_t queue_cap;
+    uint32_t queue_head;
+    uint32_t queue_count;
+
+    bool shutdown;
+} JobPool;
+
+// Number of hardware threads minus one (the caller also works), at least 1.
+uint32_t job_pool_default_threads(void);
+
+// thread_count == 0 picks job_pool_default_threads().
+void job_pool_init(JobPool* pool, uint32_t thread_count);
+void job_pool_destroy(JobPool* pool);
+
+void job_pool_run(JobPool* pool, JobFunc fn, void* user, uint32_t index, JobCounter* counter);
+void job_pool_wait(JobPool* pool, JobCounter* counter);
+bool job_pool_is_done(const JobCounter* counter);
+
+// Runs fn(user, i) for i in [0, count) and blocks until all are done.
+void job_pool_parallel_for(JobPool* pool, uint32_t count, JobFunc fn, void* user);
@@ -0,0 +1,262 @@
+#include "meshlet_cull.h"
+
+#include <math.h>
+#include <string.h>
+
+// Matches rotateQuat() in the shaders.
+static void rotate_quat(const float v[3], const versor q, float out[3])
+{
+    float c0[3] = {
+        q[1] * v[2] - q[2] * v[1] + q[3] * v[0],
+        q[2] * v[0] - q[0] * v[2] + q[3] * v[1],
+        q[0] * v[1] - q[1] * v[0] + q[3] * v[2],
+    };
+
+    out[0] = v[0] + 2.0f * (q[1] * c0[2] - q[2] * c0[1]);
+    out[1] = v[1] + 2.0f * (q[2] * c0[0] - q[0] * c0[2]);
+    out[2] = v[2] + 2.0f * (q[0] * c0[1] - q[1] * c0[0]);
+}
+
+// Mesh-space sphere to view space.
+static void sphere_to_view(const CullParams* p, const MeshDraw* draw, const float center[3], float radius, float out_center[3],
+                           float* out_radius)
+{
+    float world[3];
+    rotate_quat(center, draw->orientation, world);
+    world[0] = world[0] * draw->scale + draw->position[0];
+    world[1] = world[1] * draw->scale + draw->position[1];
+    world[2] = world[2] * draw->scale + draw->position[2];
+
+    glm_mat4_mulv3((vec4*)p->view, world, 1.0f, out_center);
+    *out_radius = radius * draw->scale;
+}
+
+static bool frustum_visible(const CullParams* p, const float c[3], float radius)
+{
+    float viewZ   = -c[2];
+    bool  visible = true;
+
+    visible = visible && viewZ * p->tanHalfX - fabsf(c[0]) > -radius;
+    visible = visible && viewZ * p->tanHalfY - fabsf(c[1]) > -radius;
+    visible = visible && viewZ + radius > p->znear && viewZ - radius < p->zfar;
+    return visible;
+}
+
+bool cull_draw_ref(const CullParams* p, const MeshDraw* draw, const Mesh* mesh, uint32_t* out_lod)
+{
+    float c[3], radius;
+    sphere_to_view(p, draw, mesh->center, mesh->radius, c, &radius);
+
+    if(!frustum_visible(p, c, radius))
+        return false;
+
+    uint32_t lodIndex = 0;
+    if(p->lodEnabled)
+    {
+        float viewZ      = -c[2];
+        float distance   = fmaxf(viewZ - radius, 1e-4f);
+        float scale      = fmaxf(draw->scale, 1e-6f);
+        float projScale  = 1.0f / fmaxf(p->tanHalfY, 1e-6f);
+        float pixelScale = 0.5f * fmaxf(p->viewportHeight, 1.0f);
+
+        for(uint32_t i = 1; i < mesh->lodCount; i++)
+        {
+            float errorWorld = mesh->lods[i].error * scale;
+            float ssePixels  = (errorWorld / distance) * projScale * pixelScale;
+            if(ssePixels <= p->lodTargetPx)
+                lodIndex = i;
+        }
+    }
+
+    *out_lod = lodIndex;
+    return true;
+}
+
+// Normal cone test in view space (camera at the origin).
+static bool cone_culled(const CullParams* p, const MeshDraw* draw, const Meshlet* m, const float c[3], float radius)
+{
+    // a mirrored transform flips the cone, and scale 0 has no facing at all
+    if(m->coneCutoff >= 1.0f || draw->scale <= 0.0f)
+        return false;
+
+    float world[3], axis[3];
+    rotate_quat(m->coneAxis, draw->orientation, world);
+    glm_mat4_mulv3((vec4*)p->view, world, 0.0f, axis);
+
+    float len = sqrtf(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+    return c[0] * axis[0] + c[1] * axis[1] + c[2] * axis[2] >= m->coneCutoff * len + radius;
+}
+
+// Conservative sphere vs occlusion grid. The sphere's view-space box is
+// projected with the near and far z of the box, which bounds the true ellipse.
+static bool occlusion_culled(const CullParams* p, const float c[3], float radius)
+{
+    if(!p->occlusion)
+        return false;
+
+    float viewZ = -c[2];
+    float zNear = viewZ - radius;
+    if(zNear <= p->znear)
+        return false;
+
+    float zFar = viewZ + radius;
+
+    float minX = fminf((c[0] - radius) / zNear, (c[0] - radius) / zFar) / p->tanHalfX;
+    float maxX = fmaxf((c[0] + radius) / zNear, (c[0] + radius) / zFar) / p->tanHalfX;
+    float minY = fminf((c[1] - radius) / zNear, (c[1] - radius) / zFar) / p->tanHalfY;
+    float maxY = fmaxf((c[1] + radius) / zNear, (c[1] + radius) / zFar) / p->tanHalfY;
+
+    // NDC to grid; the projection flips Y, so +Y view is the top row
+    float u0 = glm_clamp(minX * 0.5f + 0.5f, 0.0f, 1.0f);
+    float u1 = glm_clamp(maxX * 0.5f + 0.5f, 0.0f, 1.0f);
+    float v0 = glm_clamp(0.5f - maxY * 0.5f, 0.0f, 1.0f);
+    float v1 = glm_clamp(0.5f - minY * 0.5f, 0.0f, 1.0f);
+
+    uint32_t x0 = (uint32_t)(u0 * OCCLUSION_GRID_W), x1 = MIN((uint32_t)(u1 * OCCLUSION_GRID_W), OCCLUSION_GRID_W - 1u);
+    uint32_t y0 = (uint32_t)(v0 * OCCLUSION_GRID_H), y1 = MIN((uint32_t)(v1 * OCCLUSION_GRID_H), OCCLUSION_GRID_H - 1u);
+    x0          = MIN(x0, OCCLUSION_GRID_W - 1u);
+    y0          = MIN(y0, OCCLUSION_GRID_H - 1u);
+
+    if((x1 - x0 + 1u) * (y1 - y0 + 1u) > OCCLUSION_MAX_TILES)
+        return false;
+
+    // reverse-Z infinite: depth = znear / viewZ, larger is closer
+    float sphereDepth = p->znear / zNear;
+
+    for(uint32_t y = y0; y <= y1; y++)
+        for(uint32_t x = x0; x <= x1; x++)
+            if(sphereDepth >= p->occlusion[y * OCCLUSION_GRID_W + x])
+                return false;
+
+    return true;
+}
+
+void meshlet_cull_scene(const CullParams* p, const Scene* scene, MeshletCullStats* stats, MeshletDrawRange** ranges)
+{
+    memset(stats, 0, sizeof(*stats));
+
+    const Geometry* geom = &scene->geometry;
+
+    for(uint32_t di = 0; di < (uint32_t)arrlen(scene->draws); di++)
+    {
+        const MeshDraw* draw = &scene->draws[di];
+        const Mesh*     mesh = &geom->meshes[draw->meshIndex];
+
+        stats->drawsTested++;
+
+        uint32_t lodIndex = 0;
+        if(!cull_draw_ref(p, draw, mesh, &lodIndex))
+            continue;
+
+        const MeshLod* lod = &mesh->lods[lodIndex];
+
+        stats->drawsVisible++;
+        stats->trianglesDrawCull += lod->indexCount / 3u;
+
+        if(lod->meshletCount == 0)
+        {
+            stats->trianglesMeshletCull += lod->indexCount / 3u;
+            if(ranges)
+            {
+                MeshletDrawRange r = {lod->indexOffset, lod->indexCount, mesh->vertexOffset + lod->vertexOffset, di};
+                arrpush(*ranges, r);
+            }
+            continue;
+        }
+
+        for(uint32_t mi = 0; mi < lod->meshletCount; mi++)
+        {
+            const Meshlet* m = &geom->meshlets[lod->meshletOffset + mi];
+
+            stats->meshletsTested++;
+
+            float c[3], radius;
+            sphere_to_view(p, draw, m->center, m->radius, c, &radius);
+
+            if(!frustum_visible(p, c, radius))
+            {
+                stats->culledFrustum++;
+                continue;
+            }
+            if(cone_culled(p, draw, m, c, radius))
+            {
+                stats->culledCone++;
+                continue;
+            }
+            if(occlusion_culled(p, c, radius))
+            {
+                stats->culledOcclusion++;
+                continue;
+            }
+
+            stats->meshletsVisible++;
+            stats->trianglesMeshletCull += m->triangleCount;
+
+            if(ranges)
+            {
+                MeshletDrawRange r = {m->indexOffset, m->triangleCount * 3u, mesh->vertexOffset + lod->vertexOffset, di};
+                arrpush(*ranges, r);
+            }
+        }
+    }
+}
+
+typedef struct MeshletBatchKey
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    uint32_t vertexOffset;
+} MeshletBatchKey;
+
+typedef struct MeshletBatchLookup
+{
+    MeshletBatchKey key;
+    uint32_t        value;  // batch index
+} MeshletBatchLookup;
+
+uint32_t meshlet_cull_batch(const MeshletDrawRange* ranges, uint32_t count, MeshletDrawBatch** batches,
+                            uint32_t** instanceDraws)
+{
+    arrsetlen(*batches, 0);
+    arrsetlen(*instanceDraws, count);
+
+    MeshletBatchLookup* lookup  = NULL;
+    uint32_t*          batchOf = (uint32_t*)malloc(sizeof(uint32_t) * MAX(count, 1u));
+
+    // open a batch per new key, count instances (draw_batch.glsl emitDraw)
+    for(uint32_t i = 0; i < count; i++)
+    {
+        MeshletBatchKey key = {ranges[i].firstIndex, ranges[i].indexCount, ranges[i].vertexOffset};
+        ptrdiff_t       at  = hmgeti(lookup, key);
+        if(at < 0)
+        {
+            MeshletDrawBatch b = {key.firstIndex, key.indexCount, key.vertexOffset, 0, 0};
+            hmput(lookup, key, (uint32_t)arrlen(*batches));
+            arrpush(*batches, b);
+            at = hmgeti(lookup, key);
+        }
+
+        batchOf[i] = lookup[at].value;
+        (*batches)[batchOf[i]].instanceCount++;
+    }
+
+    // draw_batch.comp pass 0: instance ranges
+    uint32_t cursor = 0;
+    for(uint32_t b = 0; b < (uint32_t)arrlen(*batches); b++)
+    {
+        (*batches)[b].firstInstance = cursor;
+        cursor += (*batches)[b].instanceCount;
+        (*batches)[b].instanceCount = 0;
+    }
+
+    // pass 1: scatter drawIds into instance order
+    for(uint32_t i = 0; i < count; i++)
+    {
+        MeshletDrawBatch* b = &(*batches)[batchOf[i]];
+        (*instanceDraws)[b->firstInstance + b->instanceCount++] = ranges[i].drawId;
+    }
+
+    hmfree(lookup);
+    free(batchOf);
+    return (uint32_t)arrlen(*batches);
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "scene.h"
+
+// CPU reference for the GPU culling chain (shaders/cull.comp followed by
+// shaders/meshlet_cull.comp). Same math, same order, so it can be used to check
+// the GPU output and to measure how much per-meshlet culling saves.
+
+// Occlusion grid: farthest (reverse-Z, so smallest) depth per screen tile,
+// written by shaders/occlusion_reduce.comp. Keep in sync with the shaders.
+#define OCCLUSION_GRID_W 160
+#define OCCLUSION_GRID_H 90
+
+// Meshlets whose screen rect covers more tiles than this skip the occlusion test.
+#define OCCLUSION_MAX_TILES 64
+
+typedef struct CullParams
+{
+    mat4  view;
+    float tanHalfX;
+    float tanHalfY;
+    float znear;
+    float zfar;
+    float lodTargetPx;     // max screen-space error in pixels
+    float viewportHeight;
+    bool  lodEnabled;
+
+    const float* occlusion;  // OCCLUSION_GRID_W * OCCLUSION_GRID_H tiles, NULL = no occlusion test
+} CullParams;
+
+// One compacted range, the CPU equivalent of a VkDrawIndexedIndirectCommand
+// plus the drawId the vertex shader fetches.
+typedef struct MeshletDrawRange
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    uint32_t vertexOffset;
+    uint32_t drawId;
+} MeshletDrawRange;
+
+typedef struct MeshletCullStats
+{
+    uint32_t drawsTested;
+    uint32_t drawsVisible;
+
+    uint64_t meshletsTested;  // meshlets of the selected LOD of visible draws
+    uint64_t meshletsVisible;
+    uint64_t culledFrustum;
+    uint64_t culledCone;
+    uint64_t culledOcclusion;
+
+    uint64_t trianglesDrawCull;     // triangles submitted with draw-level culling only
+    uint64_t trianglesMeshletCull;  // triangles submitted after meshlet culling
+} MeshletCullStats;
+
+// Draw-level test from cull.comp. Returns false if culled, else writes the LOD.
+bool cull_draw_ref(const CullParams* p, const MeshDraw* draw, const Mesh* mesh, uint32_t* out_lod);
+
+// Runs both stages over every draw. ranges (stb_ds, may be NULL) receives the
+// compacted meshlet ranges in draw order; the GPU emits the same set unordered.
+// Draws whose LOD has no meshlets are emitted whole.
+void meshlet_cull_scene(const CullParams* p, const Scene* scene, MeshletCullStats* stats, MeshletDrawRange** ranges);
+
+// Automatic instancing reference (shaders/draw_batch.glsl + draw_batch.comp):
+// ranges with the same index range and vertex offset collapse into one
+// instanced command. Material is not part of the key, the shaders fetch it per
+// instance through the drawId.
+typedef struct MeshletDrawBatch
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    uint32_t vertexOffset;
+    uint32_t firstInstance;  // into instanceDraws
+    uint32_t instanceCount;
+} MeshletDrawBatch;
+
+// batches (stb_ds) receives the commands in order of first appearance and
+// instanceDraws (stb_ds) the drawId per instance, each batch's instances in
+// range order. Both arrays are reset first. Returns the batch count.
+uint32_t meshlet_cull_batch(const MeshletDrawRange* ranges, uint32_t count, MeshletDrawBatch** batches,
+                            uint32_t** instanceDraws);
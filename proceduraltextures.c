@@ -1,57 +1,596 @@
 #include "proceduraltextures.h"
 
-#include <stdbool.h>
+#include <math.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PROCEDURAL_X86 1
+#endif
+
+// skew / unskew factors of the 2D simplex lattice
+#define SIMPLEX_F2 0.36602540378f  // (sqrt(3) - 1) / 2
+#define SIMPLEX_G2 0.21132486540f  // (3 - sqrt(3)) / 6
+#define SIMPLEX_SCALE 70.0f        // peak of the three-corner sum back to ~1
+
+static int g_isa = -1;  // active ISA, resolved on first use
+
+static inline void store_texel(uint8_t* p, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+{
+    p[0] = r;
+    p[1] = g;
+    p[2] = b;
+    p[3] = a;
+}
+
+// ------------------------------------------------------------
+// Patterns: template rows, copied down
+// ------------------------------------------------------------
 
 void procedural_fill_checker_rgba8(uint8_t* out, uint32_t w, uint32_t h, uint32_t check_size,
                                    uint8_t r0, uint8_t g0, uint8_t b0,
                                    uint8_t r1, uint8_t g1, uint8_t b1)
 {
-    for(uint32_t y = 0; y < h; y++)
+    size_t   row   = (size_t)w * 4;
+    uint32_t check = check_size ? check_size : 1;
+
+    // row 0 starts with color 0, row `check` (if any) with color 1
+    for(uint32_t x = 0; x < w; x++)
+    {
+        bool a = ((x / check) & 1u) == 0u;
+        store_texel(out + (size_t)x * 4, a ? r0 : r1, a ? g0 : g1, a ? b0 : b1, 255);
+        if(check < h)
+            store_texel(out + check * row + (size_t)x * 4, a ? r1 : r0, a ? g1 : g0, a ? b1 : b0, 255);
+    }
+
+    for(uint32_t y = 1; y < h; y++)
+    {
+        uint32_t src = ((y / check) & 1u) ? check : 0;
+        if(y != src)
+            memcpy(out + y * row, out + src * row, row);
+    }
+}
+
+void procedural_fill_gradient_rgba8(uint8_t* out, uint32_t w, uint32_t h)
+{
+    size_t row = (size_t)w * 4;
+
+    // red / blue run along x and fill row 0 (green is 0 there)
+    for(uint32_t x = 0; x < w; x++)
+    {
+        float fx = (w > 1) ? (float)x / (float)(w - 1) : 0.0f;
+        store_texel(out + (size_t)x * 4, (uint8_t)(fx * 255.0f), 0, (uint8_t)(255.0f - fx * 255.0f), 255);
+    }
+
+    for(uint32_t y = 1; y < h; y++)
     {
+        float    fy = (h > 1) ? (float)y / (float)(h - 1) : 0.0f;
+        uint8_t  g  = (uint8_t)(fy * 255.0f);
+        uint8_t* p  = out + y * row;
+        memcpy(p, out, row);
         for(uint32_t x = 0; x < w; x++)
+            p[(size_t)x * 4 + 1] = g;
+    }
+}
+
+void procedural_fill_solid_rgba8(uint8_t* out, uint32_t w, uint32_t h, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+{
+    size_t row = (size_t)w * 4;
+    for(uint32_t x = 0; x < w; x++)
+        store_texel(out + (size_t)x * 4, r, g, b, a);
+    for(uint32_t y = 1; y < h; y++)
+        memcpy(out + y * row, out, row);
+}
+
+// ------------------------------------------------------------
+// Noise
+// ------------------------------------------------------------
+
+typedef struct NoiseOctave
+{
+    int32_t period;      // lattice cells across the image
+    int32_t sx, sy;      // seed offset of the hashed lattice
+    float   scale_x;     // texel -> lattice
+    float   scale_y;
+    float   amp;
+} NoiseOctave;
+
+typedef struct NoiseJob
+{
+    uint8_t*        out;
+    uint32_t        w, h;
+    uint32_t        tiles_x;
+    ProceduralNoise type;
+    NoiseOctave     octaves[PROCEDURAL_MAX_OCTAVES];
+    uint32_t        octave_count;
+    float           inv_norm;  // 1 / sum of every octave's amplitude
+    float           color0[4];
+    float           delta[4];  // color1 - color0
+    ProceduralIsa   isa;
+} NoiseJob;
+
+static inline int32_t wrap_cell(int32_t c, int32_t period)
+{
+    if(c < 0)
+        return c + period;
+    if(c >= period)
+        return c - period;
+    return c;
+}
+
+static inline float fade_smooth(float f)
+{
+    return f * f * (3.0f - 2.0f * f);
+}
+
+static inline float fade_quintic(float f)
+{
+    return f * f * f * (f * (f * 6.0f - 15.0f) + 10.0f);
+}
+
+// diagonal gradients (+-1, +-1) picked by hash bits 24 and 25
+static inline float grad2(uint32_t h, float dx, float dy)
+{
+    return ((h & (1u << 24)) ? -dx : dx) + ((h & (1u << 25)) ? -dy : dy);
+}
+
+static float value2(const NoiseOctave* o, float px, float py)
+{
+    float   fx = floorf(px), fy = floorf(py);
+    int32_t ix = (int32_t)fx, iy = (int32_t)fy;
+    int32_t x0 = ix + o->sx, x1 = wrap_cell(ix + 1, o->period) + o->sx;
+    int32_t y0 = iy + o->sy, y1 = wrap_cell(iy + 1, o->period) + o->sy;
+    float   ux = fade_smooth(px - fx), uy = fade_smooth(py - fy);
+
+    float a  = procedural_hash2f(x0, y0);
+    float b  = procedural_hash2f(x1, y0);
+    float c  = procedural_hash2f(x0, y1);
+    float d  = procedural_hash2f(x1, y1);
+    float ab = a + (b - a) * ux;
+    float cd = c + (d - c) * ux;
+    return ab + (cd - ab) * uy;
+}
+
+static float perlin2(const NoiseOctave* o, float px, float py)
+{
+    float   fx = floorf(px), fy = floorf(py);
+    int32_t ix = (int32_t)fx, iy = (int32_t)fy;
+    int32_t x0 = ix + o->sx, x1 = wrap_cell(ix + 1, o->period) + o->sx;
+    int32_t y0 = iy + o->sy, y1 = wrap_cell(iy + 1, o->period) + o->sy;
+    float   dx = px - fx, dy = py - fy;
+
+    float a  = grad2(procedural_hash2(x0, y0), dx, dy);
+    float b  = grad2(procedural_hash2(x1, y0), dx - 1.0f, dy);
+    float c  = grad2(procedural_hash2(x0, y1), dx, dy - 1.0f);
+    float d  = grad2(procedural_hash2(x1, y1), dx - 1.0f, dy - 1.0f);
+    float ux = fade_quintic(dx), uy = fade_quintic(dy);
+    float ab = a + (b - a) * ux;
+    float cd = c + (d - c) * ux;
+    return (ab + (cd - ab) * uy) * 0.5f + 0.5f;
+}
+
+static inline float simplex_corner(uint32_t h, float x, float y)
+{
+    float t = 0.5f - x * x - y * y;
+    if(t < 0.0f)
+        return 0.0f;
+    float t2 = t * t;
+    return t2 * t2 * grad2(h, x, y);
+}
+
+static float simplex2(const NoiseOctave* o, float px, float py)
+{
+    float s  = (px + py) * SIMPLEX_F2;
+    float fi = floorf(px + s), fj = floorf(py + s);
+    float t  = (fi + fj) * SIMPLEX_G2;
+    float x0 = px - (fi - t);
+    float y0 = py - (fj - t);
+
+    float i1 = (x0 > y0) ? 1.0f : 0.0f;
+    float j1 = 1.0f - i1;
+    float x1 = x0 - i1 + SIMPLEX_G2;
+    float y1 = y0 - j1 + SIMPLEX_G2;
+    float x2 = x0 - 1.0f + 2.0f * SIMPLEX_G2;
+    float y2 = y0 - 1.0f + 2.0f * SIMPLEX_G2;
+
+    int32_t i = (int32_t)fi + o->sx, j = (int32_t)fj + o->sy;
+    float   n = simplex_corner(procedural_hash2(i, j), x0, y0)
+              + simplex_corner(procedural_hash2(i + (int32_t)i1, j + (int32_t)j1), x1, y1)
+              + simplex_corner(procedural_hash2(i + 1, j + 1), x2, y2);
+    return n * (SIMPLEX_SCALE * 0.5f) + 0.5f;
+}
+
+// one feature point per cell, at the cell's hash (16 bits per axis)
+static float worley2(const NoiseOctave* o, float px, float py)
+{
+    float   fx = floorf(px), fy = floorf(py);
+    int32_t ix = (int32_t)fx, iy = (int32_t)fy;
+    float   dx = px - fx, dy = py - fy;
+    float   best = 8.0f;
+
+    for(int32_t oy = -1; oy <= 1; oy++)
+    {
+        int32_t cy = wrap_cell(iy + oy, o->period) + o->sy;
+        for(int32_t ox = -1; ox <= 1; ox++)
         {
-            uint32_t cx    = (x / check_size) & 1u;
-            uint32_t cy    = (y / check_size) & 1u;
-            bool     use_a = ((cx ^ cy) == 0u);
-
-            uint8_t* p = out + (y * w + x) * 4;
-            p[0]       = use_a ? r0 : r1;
-            p[1]       = use_a ? g0 : g1;
-            p[2]       = use_a ? b0 : b1;
-            p[3]       = 255;
+            uint32_t h  = procedural_hash2(wrap_cell(ix + ox, o->period) + o->sx, cy);
+            float    vx = (float)ox + (float)(h & 0xFFFFu) / 65535.0f - dx;
+            float    vy = (float)oy + (float)(h >> 16) / 65535.0f - dy;
+            best        = fminf(best, vx * vx + vy * vy);
         }
     }
+    return fminf(sqrtf(best), 1.0f);
 }
 
-void procedural_fill_gradient_rgba8(uint8_t* out, uint32_t w, uint32_t h)
+static void row_scalar(const NoiseJob* j, uint32_t y, uint32_t x0, uint32_t x1, uint8_t* out)
 {
-    for(uint32_t y = 0; y < h; y++)
+    for(uint32_t x = x0; x < x1; x++)
     {
-        for(uint32_t x = 0; x < w; x++)
+        float sum = 0.0f;
+        for(uint32_t k = 0; k < j->octave_count; k++)
         {
-            float    fx = (float)x / (float)(w - 1);
-            float    fy = (float)y / (float)(h - 1);
-            uint8_t* p  = out + (y * w + x) * 4;
-
-            p[0] = (uint8_t)(fx * 255.0f);
-            p[1] = (uint8_t)(fy * 255.0f);
-            p[2] = (uint8_t)(255.0f - fx * 255.0f);
-            p[3] = 255;
+            const NoiseOctave* o  = &j->octaves[k];
+            float              px = ((float)x + 0.5f) * o->scale_x;
+            float              py = ((float)y + 0.5f) * o->scale_y;
+            float              n  = 0.0f;
+            switch(j->type)
+            {
+                case PROCEDURAL_NOISE_VALUE:
+                    n = value2(o, px, py);
+                    break;
+                case PROCEDURAL_NOISE_PERLIN:
+                    n = perlin2(o, px, py);
+                    break;
+                case PROCEDURAL_NOISE_SIMPLEX:
+                    n = simplex2(o, px, py);
+                    break;
+                default:
+                    n = worley2(o, px, py);
+                    break;
+            }
+            sum += o->amp * (n * 2.0f - 1.0f);
         }
+
+        float t = fminf(fmaxf(sum * j->inv_norm * 0.5f + 0.5f, 0.0f), 1.0f);
+        for(uint32_t c = 0; c < 4; c++)
+            out[(size_t)x * 4 + c] = (uint8_t)(j->color0[c] + j->delta[c] * t + 0.5f);
     }
 }
 
-void procedural_fill_solid_rgba8(uint8_t* out, uint32_t w, uint32_t h, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+#ifdef PROCEDURAL_X86
+
+#define AVX2 __attribute__((target("avx2")))
+
+AVX2 static inline __m256i hash8(__m256i x, __m256i y)
 {
-    for(uint32_t y = 0; y < h; y++)
+    __m256i h = _mm256_add_epi32(_mm256_mullo_epi32(x, _mm256_set1_epi32(374761393)),
+                                 _mm256_mullo_epi32(y, _mm256_set1_epi32(668265263)));
+    h         = _mm256_xor_si256(h, _mm256_srli_epi32(h, 13));
+    return _mm256_mullo_epi32(h, _mm256_set1_epi32((int)1274126177u));
+}
+
+AVX2 static inline __m256 hash8f(__m256i x, __m256i y)
+{
+    __m256i h = _mm256_and_si256(hash8(x, y), _mm256_set1_epi32(0x00FFFFFF));
+    return _mm256_div_ps(_mm256_cvtepi32_ps(h), _mm256_set1_ps(16777215.0f));
+}
+
+// c + 1 wrapped to [0, period)
+AVX2 static inline __m256i wrap_next8(__m256i c, __m256i period)
+{
+    c = _mm256_add_epi32(c, _mm256_set1_epi32(1));
+    return _mm256_sub_epi32(c, _mm256_and_si256(_mm256_cmpeq_epi32(c, period), period));
+}
+
+AVX2 static inline __m256i wrap8(__m256i c, __m256i period)
+{
+    __m256i below = _mm256_cmpgt_epi32(_mm256_setzero_si256(), c);
+    __m256i above = _mm256_cmpgt_epi32(c, _mm256_sub_epi32(period, _mm256_set1_epi32(1)));
+    c             = _mm256_add_epi32(c, _mm256_and_si256(below, period));
+    return _mm256_sub_epi32(c, _mm256_and_si256(above, period));
+}
+
+AVX2 static inline __m256 lerp8(__m256 a, __m256 b, __m256 t)
+{
+    return _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), t));
+}
+
+AVX2 static inline __m256 fade_smooth8(__m256 f)
+{
+    return _mm256_mul_ps(_mm256_mul_ps(f, f), _mm256_sub_ps(_mm256_set1_ps(3.0f), _mm256_mul_ps(_mm256_set1_ps(2.0f), f)));
+}
+
+AVX2 static inline __m256 fade_quintic8(__m256 f)
+{
+    __m256 inner = _mm256_sub_ps(_mm256_mul_ps(f, _mm256_set1_ps(6.0f)), _mm256_set1_ps(15.0f));
+    inner        = _mm256_add_ps(_mm256_mul_ps(f, inner), _mm256_set1_ps(10.0f));
+    return _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(f, f), f), inner);
+}
+
+// grad2: bits 24 / 25 of h become the sign bits of dx / dy
+AVX2 static inline __m256 grad8(__m256i h, __m256 dx, __m256 dy)
+{
+    __m256i sign = _mm256_set1_epi32((int)0x80000000u);
+    __m256  sx   = _mm256_castsi256_ps(_mm256_and_si256(_mm256_slli_epi32(h, 7), sign));
+    __m256  sy   = _mm256_castsi256_ps(_mm256_and_si256(_mm256_slli_epi32(h, 6), sign));
+    return _mm256_add_ps(_mm256_xor_ps(dx, sx), _mm256_xor_ps(dy, sy));
+}
+
+AVX2 static __m256 value8(const NoiseOctave* o, __m256 px, float py)
+{
+    __m256  fx     = _mm256_floor_ps(px);
+    __m256i ix     = _mm256_cvttps_epi32(fx);
+    __m256i period = _mm256_set1_epi32(o->period);
+    __m256i sx     = _mm256_set1_epi32(o->sx);
+    __m256i x0     = _mm256_add_epi32(ix, sx);
+    __m256i x1     = _mm256_add_epi32(wrap_next8(ix, period), sx);
+
+    float   fy = floorf(py);
+    int32_t iy = (int32_t)fy;
+    __m256i y0 = _mm256_set1_epi32(iy + o->sy);
+    __m256i y1 = _mm256_set1_epi32(wrap_cell(iy + 1, o->period) + o->sy);
+
+    __m256 ux = fade_smooth8(_mm256_sub_ps(px, fx));
+    __m256 uy = _mm256_set1_ps(fade_smooth(py - fy));
+
+    __m256 ab = lerp8(hash8f(x0, y0), hash8f(x1, y0), ux);
+    __m256 cd = lerp8(hash8f(x0, y1), hash8f(x1, y1), ux);
+    return lerp8(ab, cd, uy);
+}
+
+AVX2 static __m256 perlin8(const NoiseOctave* o, __m256 px, float py)
+{
+    __m256  one    = _mm256_set1_ps(1.0f);
+    __m256  fx     = _mm256_floor_ps(px);
+    __m256i ix     = _mm256_cvttps_epi32(fx);
+    __m256i period = _mm256_set1_epi32(o->period);
+    __m256i sx     = _mm256_set1_epi32(o->sx);
+    __m256i x0     = _mm256_add_epi32(ix, sx);
+    __m256i x1     = _mm256_add_epi32(wrap_next8(ix, period), sx);
+
+    float   fy = floorf(py);
+    int32_t iy = (int32_t)fy;
+    __m256i y0 = _mm256_set1_epi32(iy + o->sy);
+    __m256i y1 = _mm256_set1_epi32(wrap_cell(iy + 1, o->period) + o->sy);
+
+    __m256 dx  = _mm256_sub_ps(px, fx);
+    __m256 dy  = _mm256_set1_ps(py - fy);
+    __m256 dx1 = _mm256_sub_ps(dx, one);
+    __m256 dy1 = _mm256_sub_ps(dy, one);
+
+    __m256 a  = grad8(hash8(x0, y0), dx, dy);
+    __m256 b  = grad8(hash8(x1, y0), dx1, dy);
+    __m256 c  = grad8(hash8(x0, y1), dx, dy1);
+    __m256 d  = grad8(hash8(x1, y1), dx1, dy1);
+    __m256 ab = lerp8(a, b, fade_quintic8(dx));
+    __m256 cd = lerp8(c, d, fade_quintic8(dx));
+    __m256 n  = lerp8(ab, cd, _mm256_set1_ps(fade_quintic(py - fy)));
+    return _mm256_add_ps(_mm256_mul_ps(n, _mm256_set1_ps(0.5f)), _mm256_set1_ps(0.5f));
+}
+
+AVX2 static inline __m256 simplex_corner8(__m256i h, __m256 x, __m256 y)
+{
+    __m256 t  = _mm256_sub_ps(_mm256_sub_ps(_mm256_set1_ps(0.5f), _mm256_mul_ps(x, x)), _mm256_mul_ps(y, y));
+    __m256 t2 = _mm256_mul_ps(t, t);
+    __m256 n  = _mm256_mul_ps(_mm256_mul_ps(t2, t2), grad8(h, x, y));
+    return _mm256_and_ps(n, _mm256_cmp_ps(t, _mm256_setzero_ps(), _CMP_GE_OQ));
+}
+
+AVX2 static __m256 simplex8(const NoiseOctave* o, __m256 px, float py)
+{
+    __m256 g2  = _mm256_set1_ps(SIMPLEX_G2);
+    __m256 one = _mm256_set1_ps(1.0f);
+    __m256 vy  = _mm256_set1_ps(py);
+
+    __m256 s  = _mm256_mul_ps(_mm256_add_ps(px, vy), _mm256_set1_ps(SIMPLEX_F2));
+    __m256 fi = _mm256_floor_ps(_mm256_add_ps(px, s));
+    __m256 fj = _mm256_floor_ps(_mm256_add_ps(vy, s));
+    __m256 t  = _mm256_mul_ps(_mm256_add_ps(fi, fj), g2);
+    __m256 x0 = _mm256_sub_ps(px, _mm256_sub_ps(fi, t));
+    __m256 y0 = _mm256_sub_ps(vy, _mm256_sub_ps(fj, t));
+
+    __m256 i1 = _mm256_and_ps(_mm256_cmp_ps(x0, y0, _CMP_GT_OQ), one);
+    __m256 j1 = _mm256_sub_ps(one, i1);
+    __m256 x1 = _mm256_add_ps(_mm256_sub_ps(x0, i1), g2);
+    __m256 y1 = _mm256_add_ps(_mm256_sub_ps(y0, j1), g2);
+    __m256 x2 = _mm256_add_ps(_mm256_sub_ps(x0, one), _mm256_set1_ps(2.0f * SIMPLEX_G2));
+    __m256 y2 = _mm256_add_ps(_mm256_sub_ps(y0, one), _mm256_set1_ps(2.0f * SIMPLEX_G2));
+
+    __m256i i   = _mm256_add_epi32(_mm256_cvttps_epi32(fi), _mm256_set1_epi32(o->sx));
+    __m256i j   = _mm256_add_epi32(_mm256_cvttps_epi32(fj), _mm256_set1_epi32(o->sy));
+    __m256i one_i = _mm256_set1_epi32(1);
+
+    __m256 n = _mm256_add_ps(simplex_corner8(hash8(i, j), x0, y0),
+                             simplex_corner8(hash8(_mm256_add_epi32(i, _mm256_cvttps_epi32(i1)),
+                                                   _mm256_add_epi32(j, _mm256_cvttps_epi32(j1))),
+                                             x1, y1));
+    n = _mm256_add_ps(n, simplex_corner8(hash8(_mm256_add_epi32(i, one_i), _mm256_add_epi32(j, one_i)), x2, y2));
+    return _mm256_add_ps(_mm256_mul_ps(n, _mm256_set1_ps(SIMPLEX_SCALE * 0.5f)), _mm256_set1_ps(0.5f));
+}
+
+AVX2 static __m256 worley8(const NoiseOctave* o, __m256 px, float py)
+{
+    __m256  fx     = _mm256_floor_ps(px);
+    __m256i ix     = _mm256_cvttps_epi32(fx);
+    __m256i period = _mm256_set1_epi32(o->period);
+    __m256i sx     = _mm256_set1_epi32(o->sx);
+    __m256  dx     = _mm256_sub_ps(px, fx);
+    __m256  inv16  = _mm256_set1_ps(65535.0f);
+    __m256i lo16   = _mm256_set1_epi32(0xFFFF);
+
+    float   fy   = floorf(py);
+    int32_t iy   = (int32_t)fy;
+    __m256  dy   = _mm256_set1_ps(py - fy);
+    __m256  best = _mm256_set1_ps(8.0f);
+
+    for(int32_t oy = -1; oy <= 1; oy++)
     {
-        for(uint32_t x = 0; x < w; x++)
+        __m256i cy = _mm256_set1_epi32(wrap_cell(iy + oy, o->period) + o->sy);
+        __m256  fo = _mm256_set1_ps((float)oy);
+        for(int32_t ox = -1; ox <= 1; ox++)
         {
-            uint8_t* p = out + (y * w + x) * 4;
-            p[0]       = r;
-            p[1]       = g;
-            p[2]       = b;
-            p[3]       = a;
+            __m256i cx = _mm256_add_epi32(wrap8(_mm256_add_epi32(ix, _mm256_set1_epi32(ox)), period), sx);
+            __m256i h  = hash8(cx, cy);
+            __m256  jx = _mm256_div_ps(_mm256_cvtepi32_ps(_mm256_and_si256(h, lo16)), inv16);
+            __m256  jy = _mm256_div_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(h, 16)), inv16);
+            __m256  vx = _mm256_sub_ps(_mm256_add_ps(_mm256_set1_ps((float)ox), jx), dx);
+            __m256  vy = _mm256_sub_ps(_mm256_add_ps(fo, jy), dy);
+            best       = _mm256_min_ps(best, _mm256_add_ps(_mm256_mul_ps(vx, vx), _mm256_mul_ps(vy, vy)));
         }
     }
+    return _mm256_min_ps(_mm256_sqrt_ps(best), _mm256_set1_ps(1.0f));
+}
+
+AVX2 static uint32_t row_avx2(const NoiseJob* j, uint32_t y, uint32_t x0, uint32_t x1, uint8_t* out)
+{
+    const __m256 lane = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+    const __m256 one  = _mm256_set1_ps(1.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+
+    uint32_t x = x0;
+    for(; x + 8 <= x1; x += 8)
+    {
+        __m256 fx  = _mm256_add_ps(_mm256_add_ps(_mm256_set1_ps((float)x), lane), half);
+        __m256 sum = _mm256_setzero_ps();
+        for(uint32_t k = 0; k < j->octave_count; k++)
+        {
+            const NoiseOctave* o  = &j->octaves[k];
+            __m256             px = _mm256_mul_ps(fx, _mm256_set1_ps(o->scale_x));
+            float              py = ((float)y + 0.5f) * o->scale_y;
+            __m256             n;
+            switch(j->type)
+            {
+                case PROCEDURAL_NOISE_VALUE:
+                    n = value8(o, px, py);
+                    break;
+                case PROCEDURAL_NOISE_PERLIN:
+                    n = perlin8(o, px, py);
+                    break;
+                case PROCEDURAL_NOISE_SIMPLEX:
+                    n = simplex8(o, px, py);
+                    break;
+                default:
+                    n = worley8(o, px, py);
+                    break;
+            }
+            n   = _mm256_sub_ps(_mm256_mul_ps(n, _mm256_set1_ps(2.0f)), one);
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(o->amp), n));
+        }
+
+        __m256 t = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(sum, _mm256_set1_ps(j->inv_norm)), half), half);
+        t        = _mm256_min_ps(_mm256_max_ps(t, _mm256_setzero_ps()), one);
+
+        __m256i texel = _mm256_setzero_si256();
+        for(int c = 0; c < 4; c++)
+        {
+            __m256 v = _mm256_add_ps(_mm256_add_ps(_mm256_set1_ps(j->color0[c]), _mm256_mul_ps(_mm256_set1_ps(j->delta[c]), t)), half);
+            texel    = _mm256_or_si256(texel, _mm256_slli_epi32(_mm256_cvttps_epi32(v), c * 8));
+        }
+        _mm256_storeu_si256((__m256i*)(out + (size_t)x * 4), texel);
+    }
+    return x;
+}
+
+#undef AVX2
+
+#endif
+
+static ProceduralIsa detect_isa(void)
+{
+#ifdef PROCEDURAL_X86
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? PROCEDURAL_ISA_AVX2 : PROCEDURAL_ISA_SCALAR;
+#else
+    return PROCEDURAL_ISA_SCALAR;
+#endif
+}
+
+ProceduralIsa procedural_isa(void)
+{
+    if(g_isa < 0)
+        g_isa = (int)detect_isa();
+    return (ProceduralIsa)g_isa;
+}
+
+ProceduralIsa procedural_set_isa(ProceduralIsa isa)
+{
+    g_isa = (int)MIN(isa, detect_isa());
+    return (ProceduralIsa)g_isa;
+}
+
+static void noise_tile(void* user, uint32_t index)
+{
+    const NoiseJob* j  = (const NoiseJob*)user;
+    uint32_t        x0 = (index % j->tiles_x) * PROCEDURAL_TILE_SIZE;
+    uint32_t        y0 = (index / j->tiles_x) * PROCEDURAL_TILE_SIZE;
+    uint32_t        x1 = MIN(x0 + PROCEDURAL_TILE_SIZE, j->w);
+    uint32_t        y1 = MIN(y0 + PROCEDURAL_TILE_SIZE, j->h);
+
+    for(uint32_t y = y0; y < y1; y++)
+    {
+        uint8_t* row = j->out + (size_t)y * j->w * 4;
+        uint32_t x   = x0;
+#ifdef PROCEDURAL_X86
+        if(j->isa >= PROCEDURAL_ISA_AVX2)
+            x = row_avx2(j, y, x0, x1, row);
+#endif
+        row_scalar(j, y, x, x1, row);
+    }
+}
+
+// Octaves with cells of fewer than two texels are dropped (max_cells);
+// inv_norm still covers all of desc's octaves.
+static void noise_level(uint8_t* out, uint32_t w, uint32_t h, const ProceduralNoiseDesc* desc, uint32_t max_cells, JobPool* pool)
+{
+    NoiseJob j = {
+        .out     = out,
+        .w       = w,
+        .h       = h,
+        .tiles_x = (w + PROCEDURAL_TILE_SIZE - 1) / PROCEDURAL_TILE_SIZE,
+        .type    = desc->type,
+        .isa     = procedural_isa(),
+    };
+
+    uint32_t octaves = MIN(MAX(desc->octaves, 1u), PROCEDURAL_MAX_OCTAVES);
+    uint32_t period  = MAX(desc->frequency, 1u);
+    float    amp     = 1.0f;
+    float    norm    = 0.0f;
+    for(uint32_t k = 0; k < octaves; k++, period <<= 1, amp *= desc->gain)
+    {
+        norm += amp;
+        if(k > 0 && period > max_cells)
+            continue;
+
+        j.octaves[j.octave_count++] = (NoiseOctave){
+            .period  = (int32_t)period,
+            .sx      = (int32_t)(desc->seed * 1013u + k * 7919u),
+            .sy      = (int32_t)(desc->seed * 2039u + k * 104729u),
+            .scale_x = (float)period / (float)w,
+            .scale_y = (float)period / (float)h,
+            .amp     = amp,
+        };
+    }
+    j.inv_norm = 1.0f / norm;
+
+    for(uint32_t c = 0; c < 4; c++)
+    {
+        j.color0[c] = (float)desc->color0[c];
+        j.delta[c]  = (float)desc->color1[c] - (float)desc->color0[c];
+    }
+
+    job_pool_parallel_for(pool, j.tiles_x * ((h + PROCEDURAL_TILE_SIZE - 1) / PROCEDURAL_TILE_SIZE), noise_tile, &j);
+}
+
+void procedural_fill_noise_rgba8(uint8_t* out, uint32_t w, uint32_t h, const ProceduralNoiseDesc* desc, JobPool* pool)
+{
+    noise_level(out, w, h, desc, UINT32_MAX, pool);
+}
+
+void procedural_fill_noise_mips_rgba8(uint8_t* chain, const TextureFileLevel* levels, uint32_t level_count,
+                                      const ProceduralNoiseDesc* desc, JobPool* pool)
+{
+    for(uint32_t l = 0; l < level_count; l++)
+    {
+        const TextureFileLevel* level = &levels[l];
+        noise_level(chain + level->offset, level->width, level->height, desc, MAX(level->width, level->height) / 2, pool);
+    }
 }
@@ -1,6 +1,62 @@
 #pragma once
 
-#include <stdint.h>
+#include "texture_file.h"
+
+// Procedural RGBA8 textures.
+//
+// Patterns (checker, gradient, solid) build one or two template rows and copy
+// them down the image. Noise evaluates per texel through row kernels, 8 texels
+// per step with AVX2 and scalar otherwise, on PROCEDURAL_TILE_SIZE square
+// tiles spread over a JobPool (NULL: calling thread).
+//
+// Noise coordinates are in lattice cells across the image: frequency cells
+// at octave 0, doubling per octave (fBm, gain per octave). Value, Perlin and
+// Worley wrap their lattice at that period, so the result tiles; simplex
+// uses a skewed lattice and does not. The lattice hash is procedural_hash2,
+// the one terrain.h uses for its height noise. The [0,1] result is mapped
+// from color0 to color1.
+
+#define PROCEDURAL_TILE_SIZE 64u
+#define PROCEDURAL_MAX_OCTAVES 12u
+
+typedef enum ProceduralNoise
+{
+    PROCEDURAL_NOISE_VALUE = 0,
+    PROCEDURAL_NOISE_PERLIN,
+    PROCEDURAL_NOISE_SIMPLEX,
+    PROCEDURAL_NOISE_WORLEY,  // distance to the nearest feature point (F1)
+    PROCEDURAL_NOISE_COUNT,
+} ProceduralNoise;
+
+typedef enum ProceduralIsa
+{
+    PROCEDURAL_ISA_SCALAR = 0,
+    PROCEDURAL_ISA_AVX2,  // 8 texels per step
+} ProceduralIsa;
+
+typedef struct ProceduralNoiseDesc
+{
+    ProceduralNoise type;
+    uint32_t        seed;
+    uint32_t        frequency;  // cells across the image at octave 0, at least 1
+    uint32_t        octaves;    // 1 = plain noise
+    float           gain;       // amplitude ratio between octaves, 0.5 typical
+    uint8_t         color0[4];  // at 0
+    uint8_t         color1[4];  // at 1
+} ProceduralNoiseDesc;
+
+// Shared lattice hash (terrain.h): integer cell -> 32 well mixed bits.
+static inline uint32_t procedural_hash2(int32_t x, int32_t y)
+{
+    uint32_t h = (uint32_t)x * 374761393u + (uint32_t)y * 668265263u;
+    return (h ^ (h >> 13u)) * 1274126177u;
+}
+
+// Low 24 bits of procedural_hash2 as [0,1].
+static inline float procedural_hash2f(int32_t x, int32_t y)
+{
+    return (float)(procedural_hash2(x, y) & 0x00FFFFFFu) / 16777215.0f;
+}
 
 void procedural_fill_checker_rgba8(uint8_t* out, uint32_t w, uint32_t h, uint32_t check_size,
                                    uint8_t r0, uint8_t g0, uint8_t b0,
@@ -9,3 +65,16 @@ void procedural_fill_checker_rgba8(uint8_t* out, uint32_t w, uint32_t h, uint32_
 void procedural_fill_gradient_rgba8(uint8_t* out, uint32_t w, uint32_t h);
 
 void procedural_fill_solid_rgba8(uint8_t* out, uint32_t w, uint32_t h, uint8_t r, uint8_t g, uint8_t b, uint8_t a);
+
+void procedural_fill_noise_rgba8(uint8_t* out, uint32_t w, uint32_t h, const ProceduralNoiseDesc* desc, JobPool* pool);
+
+// Every level of chain evaluated at its own size instead of filtered from the
+// one above: octaves finer than two texels are left out, and the sum is still
+// normalized over all of them, as a box filter would average them away.
+// levels as in TextureFile (tightly packed RGBA8).
+void procedural_fill_noise_mips_rgba8(uint8_t* chain, const TextureFileLevel* levels, uint32_t level_count,
+                                      const ProceduralNoiseDesc* desc, JobPool* pool);
+
+// Best ISA the CPU supports unless lowered with procedural_set_isa (benchmarks).
+ProceduralIsa procedural_isa(void);
+ProceduralIsa procedural_set_isa(ProceduralIsa isa);
@@ -1,4 +1,5 @@
 #include "render_object.h"
+#include "vk_queue.h"
 
 #include <assert.h>
 #include <stdio.h>
@@ -6,6 +7,7 @@
 #include <string.h>
 #include <sys/stat.h>
 #include "file_utils.h"
+#include "vk_slang_bridge.h"
 #include "stb/stb_ds.h"
 
 // ============================================================================
@@ -79,6 +81,24 @@ static bool is_buffer_descriptor(VkDescriptorType type)
     }
 }
 
+// compiledshaders/*.spv is checked in, and a binary older than its GLSL source
+// no longer matches what the host binds. Rebuild it from shaders/ before
+// loading (same as `make shaders`, minus #include tracking). Without glslc the
+// existing file is used as is.
+static void refresh_glsl_spv(const char* spv_path)
+{
+    char src_path[1024];
+    if(!spv_to_source_path(src_path, sizeof(src_path), spv_path))
+        return;
+
+    uint64_t src_mtime = file_mtime_ns(src_path);
+    if(src_mtime == 0 || src_mtime <= file_mtime_ns(spv_path))
+        return;
+
+    log_info("[render_pipeline_create] %s is older than %s, recompiling", spv_path, src_path);
+    compile_glsl_to_spv(src_path, spv_path);
+}
+
 static bool slang_source_to_spv_path(const char* source_path, char* out_path, size_t out_cap)
 {
     if(!source_path || !out_path || out_cap == 0)
@@ -168,6 +188,75 @@ static bool compile_slang_to_spv_cli(const char* source_path, const char* spv_pa
     return true;
 }
 
+static bool write_spv_file(const char* path, const void* code, size_t size)
+{
+    FILE* f = fopen(path, "wb");
+    if(!f)
+    {
+        log_error("Failed to write '%s'", path);
+        return false;
+    }
+
+    bool ok = fwrite(code, 1, size, f) == size;
+    ok      = (fclose(f) == 0) && ok;
+    if(!ok)
+        log_error("Short write for '%s'", path);
+    return ok;
+}
+
+// Compiles entries of one Slang source as a single linked program through
+// vk_slang_bridge (cached sessions/modules, on-disk SPIR-V cache) and writes
+// each entry's .spv. Falls back to slangc per entry if that fails.
+static bool compile_slang_entries_to_spv(const char*        source_path,
+                                         const char* const* entries,
+                                         const int*         stages,
+                                         const char* const* spv_paths,
+                                         uint32_t           count)
+{
+    void*  code[VK_SLANG_MAX_ENTRIES] = {0};
+    size_t size[VK_SLANG_MAX_ENTRIES] = {0};
+
+    if(count > VK_SLANG_MAX_ENTRIES || !vk_slang_compile_entries(source_path, entries, stages, count, code, size))
+    {
+        log_warn("[slang] in-process compile failed for %s, trying slangc", source_path);
+        for(uint32_t i = 0; i < count; i++)
+        {
+            if(!compile_slang_to_spv_cli(source_path, spv_paths[i], entries[i]))
+                return false;
+        }
+        return true;
+    }
+
+    bool ok = true;
+    for(uint32_t i = 0; i < count; i++)
+    {
+        ok = ok && write_spv_file(spv_paths[i], code[i], size[i]);
+        free(code[i]);
+    }
+    return ok;
+}
+
+static bool compile_slang_compute_to_spv(const char* source_path, const char* spv_path)
+{
+    const char* entry = "computeMain";
+    int         stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    return compile_slang_entries_to_spv(source_path, &entry, &stage, &spv_path, 1);
+}
+
+// vsMain/psMain; one program when both come from the same file
+static bool compile_slang_graphics_to_spv(const char* vert_source, const char* frag_source, const char* vert_spv, const char* frag_spv)
+{
+    const char* entries[2]   = {"vsMain", "psMain"};
+    int         stages[2]    = {VK_SHADER_STAGE_VERTEX_BIT, VK_SHADER_STAGE_FRAGMENT_BIT};
+    const char* spv_paths[2] = {vert_spv, frag_spv};
+
+    if(strcmp(vert_source, frag_source) == 0)
+        return compile_slang_entries_to_spv(vert_source, entries, stages, spv_paths, 2);
+
+    return compile_slang_entries_to_spv(vert_source, &entries[0], &stages[0], &spv_paths[0], 1)
+           && compile_slang_entries_to_spv(frag_source, &entries[1], &stages[1], &spv_paths[1], 1);
+}
+
 // ------------------------------------------------------------
 // Shader hot reload (RenderPipeline)
 // ------------------------------------------------------------
@@ -361,7 +450,7 @@ static VkPipeline render_pipeline_rebuild(RenderPipeline*         pipe,
             char spv_path[1024];
             if(!slang_source_to_spv_path(spec->comp_spv, spv_path, sizeof(spv_path)))
                 return VK_NULL_HANDLE;
-            if(!compile_slang_to_spv_cli(spec->comp_spv, spv_path, "computeMain"))
+            if(!compile_slang_compute_to_spv(spec->comp_spv, spv_path))
                 return VK_NULL_HANDLE;
             if(!read_file(spv_path, &comp_code, &comp_size))
                 return VK_NULL_HANDLE;
@@ -405,17 +494,18 @@ static VkPipeline render_pipeline_rebuild(RenderPipeline*         pipe,
     if(!spec->vert_spv || !spec->frag_spv)
         return VK_NULL_HANDLE;
 
+    char        vert_spv[1024];
+    char        frag_spv[1024];
+    const char* vert_path = spec->vert_spv;
+    const char* frag_path = spec->frag_spv;
+
     if(spec->shader == SLANG)
     {
-        char vert_spv[1024];
-        char frag_spv[1024];
         if(!slang_source_to_stage_spv_path(spec->vert_spv, "vert", vert_spv, sizeof(vert_spv)))
             return VK_NULL_HANDLE;
         if(!slang_source_to_stage_spv_path(spec->frag_spv, "frag", frag_spv, sizeof(frag_spv)))
             return VK_NULL_HANDLE;
-        if(!compile_slang_to_spv_cli(spec->vert_spv, vert_spv, "vsMain"))
-            return VK_NULL_HANDLE;
-        if(!compile_slang_to_spv_cli(spec->frag_spv, frag_spv, "psMain"))
+        if(!compile_slang_graphics_to_spv(spec->vert_spv, spec->frag_spv, vert_spv, frag_spv))
             return VK_NULL_HANDLE;
         if(!read_file(vert_spv, &vert_code, &vert_size))
             return VK_NULL_HANDLE;
@@ -424,6 +514,8 @@ static VkPipeline render_pipeline_rebuild(RenderPipeline*         pipe,
             free(vert_code);
             return VK_NULL_HANDLE;
         }
+        vert_path = vert_spv;
+        frag_path = frag_spv;
     }
     else
     {
@@ -441,12 +533,12 @@ static VkPipeline render_pipeline_rebuild(RenderPipeline*         pipe,
     const char* frag_entry_name = "main";
     ShaderReflection vert_reflect = {0};
     ShaderReflection frag_reflect = {0};
-    if(shader_reflect_create(&vert_reflect, vert_code, vert_size))
+    if(shader_reflect_create_cached(&vert_reflect, vert_code, vert_size, vert_path))
     {
         if(vert_reflect.entry_point)
             vert_entry_name = vert_reflect.entry_point;
     }
-    if(shader_reflect_create(&frag_reflect, frag_code, frag_size))
+    if(shader_reflect_create_cached(&frag_reflect, frag_code, frag_size, frag_path))
     {
         if(frag_reflect.entry_point)
             frag_entry_name = frag_reflect.entry_point;
@@ -491,12 +583,8 @@ static VkPipeline render_pipeline_rebuild(RenderPipeline*         pipe,
 
     if(spec->use_vertex_input)
     {
-        ShaderReflection vert_reflect = {0};
-        if(shader_reflect_create(&vert_reflect, vert_code, vert_size))
-        {
-            attr_count = shader_reflect_get_vertex_attributes(&vert_reflect, attrs, 16, 0);
-            shader_reflect_destroy(&vert_reflect);
-        }
+        // vert_reflect is zeroed (no inputs) if reflection failed
+        attr_count = shader_reflect_get_vertex_attributes(&vert_reflect, attrs, 16, 0);
 
         uint32_t stride = 0;
         for(uint32_t i = 0; i < attr_count; i++)
@@ -842,7 +930,9 @@ void render_pipeline_hot_reload_update(void)
             VkPipeline new_pipe = render_pipeline_rebuild(e->pipeline, e->cache, &e->spec, e->device, e->layout);
             if(new_pipe != VK_NULL_HANDLE)
             {
+                vk_queue_lock();
                 vkDeviceWaitIdle(e->device);
+                vk_queue_unlock();
                 if(e->pipeline_handle)
                     vkDestroyPipeline(e->device, e->pipeline_handle, NULL);
                 e->pipeline_handle        = new_pipe;
@@ -909,7 +999,9 @@ void render_pipeline_hot_reload_update(void)
         VkPipeline new_pipe = render_pipeline_rebuild(e->pipeline, e->cache, &e->spec, e->device, e->layout);
         if(new_pipe != VK_NULL_HANDLE)
         {
+            vk_queue_lock();
             vkDeviceWaitIdle(e->device);
+            vk_queue_unlock();
             if(e->pipeline_handle)
                 vkDestroyPipeline(e->device, e->pipeline_handle, NULL);
             e->pipeline_handle        = new_pipe;
@@ -933,78 +1025,6 @@ static bool is_image_descriptor(VkDescriptorType type)
     }
 }
 
-static bool str_contains_case(const char* s, const char* token)
-{
-    if(!s || !token)
-        return false;
-
-    size_t token_len = strlen(token);
-    if(token_len == 0)
-        return false;
-
-    for(const char* p = s; *p; p++)
-    {
-        size_t i = 0;
-        while(i < token_len)
-        {
-            char c1 = p[i];
-            char c2 = token[i];
-            if(c1 == 0)
-                break;
-
-            if(c1 >= 'A' && c1 <= 'Z')
-                c1 = (char)(c1 - 'A' + 'a');
-            if(c2 >= 'A' && c2 <= 'Z')
-                c2 = (char)(c2 - 'A' + 'a');
-
-            if(c1 != c2)
-                break;
-            i++;
-        }
-        if(i == token_len)
-            return true;
-    }
-    return false;
-}
-
-static char* sanitize_binding_name(const char* name, bool* out_bindless, bool* out_per_frame, bool* out_update_after_bind)
-{
-    if(out_bindless)
-        *out_bindless = false;
-    if(out_per_frame)
-        *out_per_frame = false;
-    if(out_update_after_bind)
-        *out_update_after_bind = false;
-
-    if(!name)
-        return NULL;
-
-    if(out_bindless && (str_contains_case(name, "@bindless") || str_contains_case(name, "bindless")))
-        *out_bindless = true;
-
-    if(out_per_frame && (str_contains_case(name, "@per_frame") || str_contains_case(name, "@perframe")))
-        *out_per_frame = true;
-
-    if(out_update_after_bind && (str_contains_case(name, "@update_after_bind") || str_contains_case(name, "@uabo")))
-        *out_update_after_bind = true;
-
-    const char* cut = strchr(name, '@');
-    if(!cut)
-        return dup_string(name);
-
-    size_t len = (size_t)(cut - name);
-    if(len == 0)
-        return dup_string(name);
-
-    char* out = (char*)malloc(len + 1);
-    if(!out)
-        return NULL;
-
-    memcpy(out, name, len);
-    out[len] = 0;
-    return out;
-}
-
 BindingId render_bind_id(const char* name)
 {
     if(!name)
@@ -1195,12 +1215,12 @@ static void build_reflection_and_layouts(const RenderObjectSpec* spec,
 
         for(uint32_t b = 0; b < set->binding_count && b < SHADER_REFLECT_MAX_BINDINGS; b++)
         {
+            // name tags and the BindingId come with the reflection (sidecar or SPIRV-Reflect)
             const ReflectedBinding* src                   = &set->bindings[b];
-            bool                    bindless_tag          = false;
-            bool                    per_frame_tag         = false;
-            bool                    update_after_bind_tag = false;
-
-            char* clean_name = sanitize_binding_name(src->name, &bindless_tag, &per_frame_tag, &update_after_bind_tag);
+            bool                    bindless_tag          = (src->tags & SHADER_BINDING_TAG_BINDLESS) != 0;
+            bool                    per_frame_tag         = (src->tags & SHADER_BINDING_TAG_PER_FRAME) != 0;
+            bool                    update_after_bind_tag = (src->tags & SHADER_BINDING_TAG_UPDATE_AFTER_BIND) != 0;
+            bool                    textures_tag          = (src->tags & SHADER_BINDING_TAG_TEXTURES) != 0;
 
             VkDescriptorSetLayoutBinding binding = {
                 .binding            = src->binding,
@@ -1210,7 +1230,7 @@ static void build_reflection_and_layouts(const RenderObjectSpec* spec,
                 .pImmutableSamplers = NULL,
             };
 
-            if(str_contains_case(src->name, "u_textures"))
+            if(textures_tag)
                 binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
 
             VkDescriptorBindingFlags flags = 0;
@@ -1220,7 +1240,7 @@ static void build_reflection_and_layouts(const RenderObjectSpec* spec,
 
             bool bindless_candidate =
                 wants_bindless && is_image_descriptor(binding.descriptorType)
-                && (src->descriptor_count == 0 || bindless_tag || str_contains_case(src->name, "u_textures"));
+                && (src->descriptor_count == 0 || bindless_tag || textures_tag);
 
             if(bindless_candidate)
                 wants_uab = true;
@@ -1251,8 +1271,8 @@ static void build_reflection_and_layouts(const RenderObjectSpec* spec,
             info->binding_count++;
 
             RenderBindingInfo rb = {
-                .name             = clean_name,
-                .id               = clean_name ? render_bind_id(clean_name) : 0,
+                .name             = dup_string(src->clean_name),
+                .id               = src->id,
                 .set              = set->set_index,
                 .binding          = src->binding,
                 .descriptor_type  = src->descriptor_type,
@@ -1358,7 +1378,8 @@ static __thread struct
 
 static void render_bind_sets(VkCommandBuffer cmd, const RenderPipeline* pipe, const RenderResources* res, VkPipelineBindPoint bind_point, uint32_t frame_index)
 {
-    if(!pipe || !res)
+    // still compiling: callers gate the pass on render_pipeline_ready
+    if(!pipe || !res || pipe->pending)
         return;
 
     VkDescriptorSet sets[SHADER_REFLECT_MAX_SETS] = {0};
@@ -1401,20 +1422,76 @@ static bool render_resources_has_written(RenderResources* res, BindingId id)
 // Pipeline
 // ------------------------------------------------------------
 
-RenderPipeline render_pipeline_create(VkDevice                device,
-                                      VkPipelineCache         pipeline_cache,
-                                      DescriptorLayoutCache*  desc_cache,
-                                      PipelineLayoutCache*    pipe_cache,
-                                      const RenderObjectSpec* spec)
+// Everything vkCreate*Pipelines needs once reflection and layouts are done.
+// Owns its copies, so an async build can outlive render_pipeline_create_async.
+typedef struct RenderPipelineBuild
 {
-    RenderPipeline out = {0};
-    out.device         = device;
+    bool             is_compute;
+    VkPipelineLayout layout;
+    RenderObjectSpec spec;  // render_object_spec_clone
+
+    void*  vert_code;
+    void*  frag_code;
+    void*  comp_code;
+    size_t vert_size;
+    size_t frag_size;
+    size_t comp_size;
+    char*  vert_entry;
+    char*  frag_entry;
+
+    VkVertexInputBindingDescription   bindings[8];
+    VkVertexInputAttributeDescription attrs[16];
+    uint32_t                          binding_count;
+    uint32_t                          attr_count;
+} RenderPipelineBuild;
+
+// Async compile in flight for a RenderPipeline (RenderPipeline.pending).
+struct RenderPipelineAsync
+{
+    PipelineFuture      future;
+    RenderPipelineBuild build;
+    bool                hot_reload;  // render_object_enable_hot_reload before it was ready
+    VkPipelineCache     hot_reload_cache;
+};
+
+static void render_object_spec_free_clone(RenderObjectSpec* spec)
+{
+    free((void*)spec->color_formats);
+    free((void*)spec->dynamic_states);
+    free((void*)spec->spec_map);
+    free((void*)spec->spec_data);
+    *spec = (RenderObjectSpec){0};
+}
+
+static void render_pipeline_build_free(RenderPipelineBuild* build)
+{
+    render_object_spec_free_clone(&build->spec);
+    free(build->vert_code);
+    free(build->frag_code);
+    free(build->comp_code);
+    free(build->vert_entry);
+    free(build->frag_entry);
+    *build = (RenderPipelineBuild){0};
+}
+
+// Main thread part of pipeline creation: loads and reflects the shaders,
+// fills out's layouts and reflection, and leaves the pipeline itself to
+// render_pipeline_build.
+static bool render_pipeline_prepare(RenderPipeline*         out,
+                                    RenderPipelineBuild*    build,
+                                    VkDevice                device,
+                                    DescriptorLayoutCache*  desc_cache,
+                                    PipelineLayoutCache*    pipe_cache,
+                                    const RenderObjectSpec* spec)
+{
+    *out        = (RenderPipeline){0};
+    *build      = (RenderPipelineBuild){0};
+    out->device = device;
 
     if(!spec)
-        return out;
+        return false;
 
     bool is_compute = (spec->comp_spv != NULL);
-
     if(spec)
     {
         log_info("[render_pipeline_create] type=%s vert=%s frag=%s comp=%s", is_compute ? "compute" : "graphics",
@@ -1442,25 +1519,34 @@ RenderPipeline render_pipeline_create(VkDevice                device,
     ShaderReflection reflections[2] = {0};
     uint32_t         refl_count     = 0;
 
+    // .spv paths the code was read from; the reflection sidecars sit next to them
+    char        vert_spv[1024];
+    char        frag_spv[1024];
+    char        comp_spv[1024];
+    const char* vert_path = spec->vert_spv;
+    const char* frag_path = spec->frag_spv;
+    const char* comp_path = spec->comp_spv;
+
     if(is_compute)
     {
         if(spec->shader == SLANG)
         {
-            char spv_path[1024];
-            if(!slang_source_to_spv_path(spec->comp_spv, spv_path, sizeof(spv_path)))
-                return out;
-            if(!compile_slang_to_spv_cli(spec->comp_spv, spv_path, "computeMain"))
-                return out;
-            if(!read_file(spv_path, &comp_code, &comp_size))
-                return out;
+            if(!slang_source_to_spv_path(spec->comp_spv, comp_spv, sizeof(comp_spv)))
+                return false;
+            if(!compile_slang_compute_to_spv(spec->comp_spv, comp_spv))
+                return false;
+            if(!read_file(comp_spv, &comp_code, &comp_size))
+                return false;
+            comp_path = comp_spv;
         }
         else
         {
+            refresh_glsl_spv(spec->comp_spv);
             if(!read_file(spec->comp_spv, &comp_code, &comp_size))
-                return out;
+                return false;
         }
 
-        if(shader_reflect_create(&reflections[refl_count], comp_code, comp_size))
+        if(shader_reflect_create_cached(&reflections[refl_count], comp_code, comp_size, comp_path))
             refl_count++;
     }
     else
@@ -1468,53 +1554,53 @@ RenderPipeline render_pipeline_create(VkDevice                device,
         if(!spec->vert_spv)
         {
             log_error("Render pipeline requires vert_spv for graphics");
-            return out;
+            return false;
         }
 
         if(spec->shader == SLANG)
         {
-            char vert_spv[1024];
-            char frag_spv[1024];
             if(!slang_source_to_stage_spv_path(spec->vert_spv, "vert", vert_spv, sizeof(vert_spv)))
-                return out;
+                return false;
             if(!slang_source_to_stage_spv_path(spec->frag_spv, "frag", frag_spv, sizeof(frag_spv)))
-                return out;
-            if(!compile_slang_to_spv_cli(spec->vert_spv, vert_spv, "vsMain"))
-                return out;
-            if(!compile_slang_to_spv_cli(spec->frag_spv, frag_spv, "psMain"))
-                return out;
+                return false;
+            if(!compile_slang_graphics_to_spv(spec->vert_spv, spec->frag_spv, vert_spv, frag_spv))
+                return false;
             if(!read_file(vert_spv, &vert_code, &vert_size))
-                return out;
+                return false;
             if(!read_file(frag_spv, &frag_code, &frag_size))
             {
                 free(vert_code);
-                return out;
+                return false;
             }
+            vert_path = vert_spv;
+            frag_path = frag_spv;
         }
         else
         {
+            refresh_glsl_spv(spec->vert_spv);
             if(!read_file(spec->vert_spv, &vert_code, &vert_size))
-                return out;
+                return false;
 
             if(spec->frag_spv)
             {
+                refresh_glsl_spv(spec->frag_spv);
                 if(!read_file(spec->frag_spv, &frag_code, &frag_size))
                 {
                     free(vert_code);
-                    return out;
+                    return false;
                 }
             }
             else
             {
                 log_error("Render pipeline requires frag_spv for graphics");
                 free(vert_code);
-                return out;
+                return false;
             }
         }
 
-        if(shader_reflect_create(&reflections[refl_count], vert_code, vert_size))
+        if(shader_reflect_create_cached(&reflections[refl_count], vert_code, vert_size, vert_path))
             refl_count++;
-        if(shader_reflect_create(&reflections[refl_count], frag_code, frag_size))
+        if(shader_reflect_create_cached(&reflections[refl_count], frag_code, frag_size, frag_path))
             refl_count++;
     }
 
@@ -1523,7 +1609,7 @@ RenderPipeline render_pipeline_create(VkDevice                device,
         free(vert_code);
         free(frag_code);
         free(comp_code);
-        return out;
+        return false;
     }
 
     const char* vert_entry_name = "main";
@@ -1544,91 +1630,41 @@ RenderPipeline render_pipeline_create(VkDevice                device,
 
     RenderSetLayoutInfo set_infos[SHADER_REFLECT_MAX_SETS] = {0};
     uint32_t            set_count                          = 0;
-    build_reflection_and_layouts(spec, &merged, &out.refl, set_infos, &set_count);
+    build_reflection_and_layouts(spec, &merged, &out->refl, set_infos, &set_count);
 
-    out.set_count   = set_count;
-    out.set_layouts = (VkDescriptorSetLayout*)calloc(set_count, sizeof(VkDescriptorSetLayout));
+    out->set_count   = set_count;
+    out->set_layouts = (VkDescriptorSetLayout*)calloc(set_count, sizeof(VkDescriptorSetLayout));
 
     for(uint32_t i = 0; i < set_count; i++)
     {
-        out.set_layouts[i] =
+        out->set_layouts[i] =
             get_or_create_set_layout(desc_cache, set_infos[i].bindings, set_infos[i].binding_count, set_infos[i].create_flags,
                                      (set_infos[i].binding_count > 0) ? set_infos[i].binding_flags : NULL);
-        out.variable_descriptor_counts[i] = set_infos[i].variable_descriptor_count;
-        out.set_create_flags[i]           = set_infos[i].create_flags;
-    }
-
-    out.layout = pipeline_layout_cache_get(device, pipe_cache, out.set_layouts, out.set_count, out.refl.push_constants,
-                                           out.refl.push_constant_count);
-
-    VkSpecializationInfo spec_info = {0};
-    if(spec->spec_constant_count > 0 && spec->spec_map && spec->spec_data && spec->spec_data_size > 0)
-    {
-        spec_info.mapEntryCount = spec->spec_constant_count;
-        spec_info.pMapEntries   = spec->spec_map;
-        spec_info.dataSize      = spec->spec_data_size;
-        spec_info.pData         = spec->spec_data;
+        out->variable_descriptor_counts[i] = set_infos[i].variable_descriptor_count;
+        out->set_create_flags[i]           = set_infos[i].create_flags;
     }
 
-    if(is_compute)
-    {
-        VkShaderModule comp_mod = create_shader_module(device, comp_code, comp_size);
-
-        VkPipelineShaderStageCreateInfo stage = {
-            .sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-            .stage               = VK_SHADER_STAGE_COMPUTE_BIT,
-            .module              = comp_mod,
-            .pName               = "main",
-            .pSpecializationInfo = (spec_info.mapEntryCount > 0) ? &spec_info : NULL,
-        };
+    out->layout = pipeline_layout_cache_get(device, pipe_cache, out->set_layouts, out->set_count, out->refl.push_constants,
+                                            out->refl.push_constant_count);
 
-        VkComputePipelineCreateInfo ci = {
-            .sType  = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
-            .stage  = stage,
-            .layout = out.layout,
-        };
+    out->bind_point = is_compute ? VK_PIPELINE_BIND_POINT_COMPUTE : VK_PIPELINE_BIND_POINT_GRAPHICS;
 
-        VK_CHECK(vkCreateComputePipelines(device, pipeline_cache, 1, &ci, NULL, &out.pipeline));
-        out.bind_point = VK_PIPELINE_BIND_POINT_COMPUTE;
+    build->is_compute = is_compute;
+    build->layout     = out->layout;
+    build->spec       = render_object_spec_clone(spec);
+    build->vert_code  = vert_code;
+    build->frag_code  = frag_code;
+    build->comp_code  = comp_code;
+    build->vert_size  = vert_size;
+    build->frag_size  = frag_size;
+    build->comp_size  = comp_size;
+    build->vert_entry = dup_string(vert_entry_name);
+    build->frag_entry = dup_string(frag_entry_name);
 
-        vkDestroyShaderModule(device, comp_mod, NULL);
-    }
-    else
+    if(!is_compute)
     {
-        VkShaderModule vert_mod = create_shader_module(device, vert_code, vert_size);
-        VkShaderModule frag_mod = create_shader_module(device, frag_code, frag_size);
-
-        VkPipelineShaderStageCreateInfo stages[2] = {
-            {
-                .sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-                .stage               = VK_SHADER_STAGE_VERTEX_BIT,
-                .module              = vert_mod,
-                .pName               = vert_entry_name,
-                .pSpecializationInfo = (spec_info.mapEntryCount > 0) ? &spec_info : NULL,
-            },
-            {
-                .sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-                .stage               = VK_SHADER_STAGE_FRAGMENT_BIT,
-                .module              = frag_mod,
-                .pName               = frag_entry_name,
-                .pSpecializationInfo = (spec_info.mapEntryCount > 0) ? &spec_info : NULL,
-            },
-        };
-
-        VkPipelineVertexInputStateCreateInfo vertex_input = {
-            .sType                           = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-            .pNext                           = NULL,
-            .flags                           = 0,
-            .vertexBindingDescriptionCount   = 0,
-            .pVertexBindingDescriptions      = NULL,
-            .vertexAttributeDescriptionCount = 0,
-            .pVertexAttributeDescriptions    = NULL,
-        };
-
-        VkVertexInputAttributeDescription  attrs[16]     = {0};
-        VkVertexInputBindingDescription    bindings[8]   = {0};
-        VkVertexInputAttributeDescription* attrs_ptr     = NULL;
-        VkVertexInputBindingDescription*   bindings_ptr  = NULL;
+        VkVertexInputAttributeDescription* attrs         = build->attrs;
+        VkVertexInputBindingDescription*   bindings      = build->bindings;
         uint32_t                           attr_count    = 0;
         uint32_t                           binding_count = 0;
 
@@ -1683,9 +1719,6 @@ RenderPipeline render_pipeline_create(VkDevice                device,
                 };
             }
 
-            bindings_ptr = (binding_count > 0) ? bindings : NULL;
-            attrs_ptr    = (attr_count > 0) ? attrs : NULL;
-
             if(vert_reflect)
             {
                 log_info("[pipeline] vert=%s frag=%s use_vertex_input=1 attrs=%u bindings=%u",
@@ -1706,10 +1739,101 @@ RenderPipeline render_pipeline_create(VkDevice                device,
             }
         }
 
-        vertex_input.vertexBindingDescriptionCount   = binding_count;
-        vertex_input.pVertexBindingDescriptions      = bindings_ptr;
-        vertex_input.vertexAttributeDescriptionCount = attr_count;
-        vertex_input.pVertexAttributeDescriptions    = attrs_ptr;
+        build->binding_count = binding_count;
+        build->attr_count    = attr_count;
+    }
+
+    for(uint32_t i = 0; i < refl_count; i++)
+        shader_reflect_destroy(&reflections[i]);
+
+    return true;
+}
+
+// Creates the pipeline from a prepared build. Only touches the device and the
+// pipeline cache, so it can run on a PipelineCompiler worker. feedback (may be
+// NULL) receives the whole-pipeline creation feedback.
+static VkResult render_pipeline_build(const RenderPipelineBuild*  build,
+                                      VkDevice                    device,
+                                      VkPipelineCache             pipeline_cache,
+                                      VkPipelineCreationFeedback* feedback,
+                                      VkPipeline*                 out_pipeline)
+{
+    const RenderObjectSpec* spec = &build->spec;
+    VkResult                result;
+
+    VkPipelineCreationFeedbackCreateInfo feedback_info = {
+        .sType                     = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO,
+        .pPipelineCreationFeedback = feedback,
+    };
+
+    VkSpecializationInfo spec_info = {0};
+    if(spec->spec_constant_count > 0 && spec->spec_map && spec->spec_data && spec->spec_data_size > 0)
+    {
+        spec_info.mapEntryCount = spec->spec_constant_count;
+        spec_info.pMapEntries   = spec->spec_map;
+        spec_info.dataSize      = spec->spec_data_size;
+        spec_info.pData         = spec->spec_data;
+    }
+
+    if(build->is_compute)
+    {
+        VkShaderModule comp_mod = create_shader_module(device, build->comp_code, build->comp_size);
+
+        VkPipelineShaderStageCreateInfo stage = {
+            .sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage               = VK_SHADER_STAGE_COMPUTE_BIT,
+            .module              = comp_mod,
+            .pName               = "main",
+            .pSpecializationInfo = (spec_info.mapEntryCount > 0) ? &spec_info : NULL,
+        };
+
+        VkComputePipelineCreateInfo ci = {
+            .sType  = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+            .pNext  = feedback ? &feedback_info : NULL,
+            .stage  = stage,
+            .layout = build->layout,
+        };
+
+        result = vkCreateComputePipelines(device, pipeline_cache, 1, &ci, NULL, out_pipeline);
+
+        vkDestroyShaderModule(device, comp_mod, NULL);
+    }
+    else
+    {
+        VkShaderModule vert_mod = create_shader_module(device, build->vert_code, build->vert_size);
+        VkShaderModule frag_mod = create_shader_module(device, build->frag_code, build->frag_size);
+
+        VkPipelineShaderStageCreateInfo stages[2] = {
+            {
+                .sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage               = VK_SHADER_STAGE_VERTEX_BIT,
+                .module              = vert_mod,
+                .pName               = build->vert_entry,
+                .pSpecializationInfo = (spec_info.mapEntryCount > 0) ? &spec_info : NULL,
+            },
+            {
+                .sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage               = VK_SHADER_STAGE_FRAGMENT_BIT,
+                .module              = frag_mod,
+                .pName               = build->frag_entry,
+                .pSpecializationInfo = (spec_info.mapEntryCount > 0) ? &spec_info : NULL,
+            },
+        };
+
+        VkPipelineVertexInputStateCreateInfo vertex_input = {
+            .sType                           = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+            .pNext                           = NULL,
+            .flags                           = 0,
+            .vertexBindingDescriptionCount   = 0,
+            .pVertexBindingDescriptions      = NULL,
+            .vertexAttributeDescriptionCount = 0,
+            .pVertexAttributeDescriptions    = NULL,
+        };
+
+        vertex_input.vertexBindingDescriptionCount   = build->binding_count;
+        vertex_input.pVertexBindingDescriptions      = (build->binding_count > 0) ? build->bindings : NULL;
+        vertex_input.vertexAttributeDescriptionCount = build->attr_count;
+        vertex_input.pVertexAttributeDescriptions    = (build->attr_count > 0) ? build->attrs : NULL;
 
         if(vertex_input.vertexAttributeDescriptionCount > 0 && vertex_input.vertexBindingDescriptionCount == 0)
         {
@@ -1782,6 +1906,7 @@ RenderPipeline render_pipeline_create(VkDevice                device,
 
         VkPipelineRenderingCreateInfo rendering = {
             .sType                   = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+            .pNext                   = feedback ? &feedback_info : NULL,
             .colorAttachmentCount    = spec->color_attachment_count,
             .pColorAttachmentFormats = spec->color_formats,
             .depthAttachmentFormat   = spec->depth_format,
@@ -1801,36 +1926,147 @@ RenderPipeline render_pipeline_create(VkDevice                device,
             .pDepthStencilState  = &depth_stencil,
             .pColorBlendState    = &blend,
             .pDynamicState       = &dynamic,
-            .layout              = out.layout,
+            .layout              = build->layout,
         };
 
         log_info("[pipeline] create gfx: vert=%s frag=%s vb=%u va=%u", spec->vert_spv ? spec->vert_spv : "(null)",
                  spec->frag_spv ? spec->frag_spv : "(null)", vertex_input.vertexBindingDescriptionCount,
                  vertex_input.vertexAttributeDescriptionCount);
 
-        VK_CHECK(vkCreateGraphicsPipelines(device, pipeline_cache, 1, &ci, NULL, &out.pipeline));
-        out.bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        result = vkCreateGraphicsPipelines(device, pipeline_cache, 1, &ci, NULL, out_pipeline);
 
         vkDestroyShaderModule(device, vert_mod, NULL);
         vkDestroyShaderModule(device, frag_mod, NULL);
     }
 
-    for(uint32_t i = 0; i < refl_count; i++)
-        shader_reflect_destroy(&reflections[i]);
+    return result;
+}
 
-    free(vert_code);
-    free(frag_code);
-    free(comp_code);
+RenderPipeline render_pipeline_create(VkDevice                device,
+                                      VkPipelineCache         pipeline_cache,
+                                      DescriptorLayoutCache*  desc_cache,
+                                      PipelineLayoutCache*    pipe_cache,
+                                      const RenderObjectSpec* spec)
+{
+    RenderPipeline      out   = {0};
+    RenderPipelineBuild build = {0};
 
+    if(render_pipeline_prepare(&out, &build, device, desc_cache, pipe_cache, spec))
+        VK_CHECK(render_pipeline_build(&build, device, pipeline_cache, NULL, &out.pipeline));
+
+    render_pipeline_build_free(&build);
+    return out;
+}
+
+static VkResult render_pipeline_async_build(void*                       user,
+                                            VkDevice                    device,
+                                            VkPipelineCache             cache,
+                                            VkPipelineCreationFeedback* feedback,
+                                            VkPipeline*                 out_pipeline)
+{
+    struct RenderPipelineAsync* async = (struct RenderPipelineAsync*)user;
+    return render_pipeline_build(&async->build, device, cache, feedback, out_pipeline);
+}
+
+RenderPipeline render_pipeline_create_async(VkDevice                device,
+                                            PipelineCompiler*       compiler,
+                                            DescriptorLayoutCache*  desc_cache,
+                                            PipelineLayoutCache*    pipe_cache,
+                                            const RenderObjectSpec* spec)
+{
+    RenderPipeline              out   = {.device = device};
+    struct RenderPipelineAsync* async = (struct RenderPipelineAsync*)calloc(1, sizeof(*async));
+    if(!async)
+        return out;
+
+    if(!render_pipeline_prepare(&out, &async->build, device, desc_cache, pipe_cache, spec))
+    {
+        render_pipeline_build_free(&async->build);
+        free(async);
+        return out;
+    }
+
+    out.pending = async;
+    pipeline_compiler_submit(compiler, &async->future, render_pipeline_async_build, async);
     return out;
 }
 
+// Main thread: move the compiled handle into pipe and finish what
+// render_object_enable_hot_reload deferred.
+static void render_pipeline_install(RenderPipeline* pipe)
+{
+    struct RenderPipelineAsync* async = pipe->pending;
+    const RenderObjectSpec*     spec  = &async->build.spec;
+
+    pipe->pending  = NULL;
+    pipe->pipeline = async->future.pipeline;
+
+    if(pipe->pipeline == VK_NULL_HANDLE)
+    {
+        log_error("[render_pipeline] async compile failed (%d): vert=%s frag=%s comp=%s", (int)async->future.result,
+                  spec->vert_spv ? spec->vert_spv : "(null)", spec->frag_spv ? spec->frag_spv : "(null)",
+                  spec->comp_spv ? spec->comp_spv : "(null)");
+    }
+    else
+    {
+        VkPipelineCreationFeedbackFlags fb     = async->future.feedback.flags;
+        const char*                     lookup = "no feedback";
+        if(fb & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT)
+            lookup = (fb & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT) ? "cache hit" : "cache miss";
+
+        log_info("[render_pipeline] async pipeline 0x%llx ready in %.2f ms (%s) vert=%s frag=%s comp=%s",
+                 (unsigned long long)pipe->pipeline, time_ns_to_ms(async->future.compile_ns), lookup,
+                 spec->vert_spv ? spec->vert_spv : "(null)", spec->frag_spv ? spec->frag_spv : "(null)",
+                 spec->comp_spv ? spec->comp_spv : "(null)");
+        if(async->hot_reload)
+            render_pipeline_hot_reload_register(pipe, async->hot_reload_cache, spec);
+    }
+
+    render_pipeline_build_free(&async->build);
+    free(async);
+}
+
+bool render_pipeline_ready(RenderPipeline* pipe)
+{
+    if(!pipe)
+        return false;
+
+    if(pipe->pending)
+    {
+        if(!pipeline_future_ready(&pipe->pending->future))
+            return false;
+        render_pipeline_install(pipe);
+    }
+
+    return pipe->pipeline != VK_NULL_HANDLE;
+}
+
+bool render_pipeline_wait(RenderPipeline* pipe)
+{
+    if(!pipe)
+        return false;
+
+    if(pipe->pending)
+    {
+        pipeline_future_wait(&pipe->pending->future);
+        render_pipeline_install(pipe);
+    }
+
+    return pipe->pipeline != VK_NULL_HANDLE;
+}
 
 void render_pipeline_destroy(VkDevice device, RenderPipeline* pipe)
 {
     if(!pipe)
         return;
 
+    // a compile still in flight owns its build data; let it land first
+    if(pipe->pending)
+    {
+        pipe->pending->hot_reload = false;
+        render_pipeline_wait(pipe);
+    }
+
     VkPipeline       resolved_pipe   = VK_NULL_HANDLE;
     VkPipelineLayout resolved_layout = VK_NULL_HANDLE;
     render_pipeline_resolve_handles(pipe, &resolved_pipe, &resolved_layout);
@@ -2043,6 +2279,28 @@ void render_resources_write_all(RenderResources* res, const RenderPipeline* pipe
 // Render object (combined)
 // ------------------------------------------------------------
 
+static void render_object_init_resources(RenderObject* obj, DescriptorAllocator* alloc, const RenderObjectSpec* spec, uint32_t frames_in_flight)
+{
+    VkBool32 per_frame = spec ? spec->per_frame_sets : VK_FALSE;
+
+    if(spec && spec->per_frame_sets == VK_FALSE && obj->pipeline.refl.per_frame_hint == VK_TRUE)
+        per_frame = VK_TRUE;
+
+
+    obj->resources = (RenderResources){
+        .set_count         = obj->pipeline.set_count,
+        .frames_in_flight  = frames_in_flight,
+        .per_frame_sets    = per_frame,
+        .owns_sets         = true,
+        .external_set_mask = 0,
+        .allocator         = alloc,
+        .device            = alloc->device,
+        .allocated         = VK_FALSE,
+    };
+    log_info("[render_object_create] resources per_frame=%u external_set_mask=0x%x", obj->resources.per_frame_sets,
+             obj->resources.external_set_mask);
+}
+
 void render_object_create(RenderObject*           obj,
                           VkPipelineCache         pipeline_cache,
                           DescriptorLayoutCache*  desc_cache,
@@ -2071,24 +2329,29 @@ void render_object_create(RenderObject*           obj,
 
         render_object_enable_hot_reload(obj, VK_NULL_HANDLE, spec);
     }
-    VkBool32 per_frame = spec ? spec->per_frame_sets : VK_FALSE;
+    render_object_init_resources(obj, alloc, spec, frames_in_flight);
+}
 
-    if(spec && spec->per_frame_sets == VK_FALSE && obj->pipeline.refl.per_frame_hint == VK_TRUE)
-        per_frame = VK_TRUE;
+void render_object_create_async(RenderObject*           obj,
+                                PipelineCompiler*       compiler,
+                                DescriptorLayoutCache*  desc_cache,
+                                PipelineLayoutCache*    pipe_cache,
+                                DescriptorAllocator*    alloc,
+                                const RenderObjectSpec* spec,
+                                uint32_t                frames_in_flight)
+{
+    *obj = (RenderObject){0};
+    if(spec)
+    {
+        log_info("[render_object_create] async vert=%s frag=%s comp=%s", spec->vert_spv ? spec->vert_spv : "(null)",
+                 spec->frag_spv ? spec->frag_spv : "(null)", spec->comp_spv ? spec->comp_spv : "(null)");
+    }
 
+    obj->pipeline = render_pipeline_create_async(alloc->device, compiler, desc_cache, pipe_cache, spec);
 
-    obj->resources = (RenderResources){
-        .set_count         = obj->pipeline.set_count,
-        .frames_in_flight  = frames_in_flight,
-        .per_frame_sets    = per_frame,
-        .owns_sets         = true,
-        .external_set_mask = 0,
-        .allocator         = alloc,
-        .device            = alloc->device,
-        .allocated         = VK_FALSE,
-    };
-    log_info("[render_object_create] resources per_frame=%u external_set_mask=0x%x", obj->resources.per_frame_sets,
-             obj->resources.external_set_mask);
+    if(spec && spec->reloadable)
+        render_object_enable_hot_reload(obj, VK_NULL_HANDLE, spec);
+    render_object_init_resources(obj, alloc, spec, frames_in_flight);
 }
 
 void render_object_enable_hot_reload(RenderObject* obj, VkPipelineCache pipeline_cache, const RenderObjectSpec* spec)
@@ -2096,6 +2359,15 @@ void render_object_enable_hot_reload(RenderObject* obj, VkPipelineCache pipeline
     if(!obj || !spec || !spec->reloadable)
         return;
 
+    // registered by render_pipeline_ready once the compile lands
+    if(obj->pipeline.pending)
+    {
+        obj->pipeline.pending->hot_reload            = true;
+        obj->pipeline.pending->hot_reload_cache      = pipeline_cache;
+        obj->pipeline.pending->build.spec.reloadable = true;
+        return;
+    }
+
     if(obj->pipeline.pipeline == VK_NULL_HANDLE)
     {
         log_warn("[render_object_enable_hot_reload] pipeline is NULL, skipping");
@@ -3,6 +3,7 @@
 #include "desc_write.h"
 #include "vk_defaults.h"
 #include "vk_descriptor.h"
+#include "vk_pipeline_compiler.h"
 #include "vk_pipeline_layout.h"
 #include "vk_pipelines.h"
 #include "vk_shader_reflect.h"
@@ -254,6 +255,8 @@ typedef struct RenderPipeline
     VkDescriptorSetLayoutCreateFlags set_create_flags[SHADER_REFLECT_MAX_SETS];
     uint32_t                         variable_descriptor_counts[SHADER_REFLECT_MAX_SETS];
     RenderObjectReflection           refl;
+
+    struct RenderPipelineAsync* pending;  // set while a PipelineCompiler builds `pipeline`
 } RenderPipeline;
 
 typedef struct RenderResources
@@ -295,6 +298,15 @@ void      render_object_create(RenderObject*           obj,
                                DescriptorAllocator*    alloc,
                                const RenderObjectSpec* spec,
                                uint32_t                frames_in_flight);
+// Same as render_object_create, but vkCreate*Pipelines runs on a compiler
+// worker. Layouts and resources are valid on return; see render_pipeline_ready.
+void      render_object_create_async(RenderObject*           obj,
+                                     PipelineCompiler*       compiler,
+                                     DescriptorLayoutCache*  desc_cache,
+                                     PipelineLayoutCache*    pipe_cache,
+                                     DescriptorAllocator*    alloc,
+                                     const RenderObjectSpec* spec,
+                                     uint32_t                frames_in_flight);
 BindingId render_bind_id(const char* name);
 
 RenderBinding render_object_get_binding(const RenderObject* obj, const char* name);
@@ -312,6 +324,22 @@ RenderPipeline render_pipeline_create(VkDevice                device,
                                       PipelineLayoutCache*    pipe_cache,
                                       const RenderObjectSpec* spec);
 
+// Shader loading, reflection and layouts happen here; the pipeline itself is
+// compiled by `compiler` against its VkPipelineCache.
+RenderPipeline render_pipeline_create_async(VkDevice                device,
+                                            PipelineCompiler*       compiler,
+                                            DescriptorLayoutCache*  desc_cache,
+                                            PipelineLayoutCache*    pipe_cache,
+                                            const RenderObjectSpec* spec);
+
+// Installs a finished async compile and returns true once `pipeline` is
+// usable; cheap to call every frame. Skip the pass while it returns false.
+// Call on the pipeline in its final location (hot reload keys by address).
+bool render_pipeline_ready(RenderPipeline* pipe);
+// Blocks (running queued compiles on this thread) until the pipeline is
+// installed. Returns false if it failed to compile.
+bool render_pipeline_wait(RenderPipeline* pipe);
+
 // Shader hot reload (no-op unless any reloadable pipelines are registered)
 void render_pipeline_hot_reload_update(void);
 
@@ -8,6 +8,10 @@
 #include <math.h>
 
 #include "external/meshoptimizer/src/meshoptimizer.h"
+#include "scene_cache.h"
+#include "geometry_codec.h"
+#include "job_pool.h"
+#include "animation_sampler.h"
 
 
 // ------------------------------------------------------------
@@ -188,6 +192,198 @@ static void decompose_transform(float translation[3], float rotation[4], float s
     rotation[qc ^ 3] = qs * (r12 + qs3 * r21);
 }
 
+// Applies the parent transform (t, r, uniform s) to a key.
+static void keyframe_transform(Keyframe* key, const vec3 t, const versor r, float s)
+{
+    vec3 scaled, rotated;
+    glm_vec3_scale(key->translation, s, scaled);
+    glm_quat_rotatev((float*)r, scaled, rotated);
+    glm_vec3_add((float*)t, rotated, key->translation);
+
+    versor rot;
+    glm_quat_mul((float*)r, key->rotation, rot);
+    glm_quat_copy(rot, key->rotation);
+
+    key->scale *= s;
+}
+
+// ------------------------------------------------------------
+// Animation import
+// ------------------------------------------------------------
+
+#define SCENE_ANIMATION_RATE 30.0f  // keys per second of imported tracks
+
+typedef struct NodeDraws
+{
+    uint32_t first;  // scene draw index
+    uint32_t count;
+} NodeDraws;
+
+// times/values are malloc'd copies; cubic spline outputs keep their values and
+// drop the tangents.
+static bool unpack_animation_channel(const cgltf_animation_sampler* sampler, uint32_t components, AnimationChannel* out)
+{
+    const cgltf_accessor* in  = sampler->input;
+    const cgltf_accessor* val = sampler->output;
+    if(!in || !val || in->count == 0)
+        return false;
+
+    bool     cubic   = sampler->interpolation == cgltf_interpolation_type_cubic_spline;
+    uint32_t count   = (uint32_t)in->count;
+    uint32_t per_key = cubic ? 3u * components : components;
+    size_t   floats  = val->count * cgltf_num_components(val->type);
+    if(cgltf_num_components(val->type) != components || floats < (size_t)count * per_key)
+        return false;
+
+    float* times  = (float*)malloc(sizeof(float) * count);
+    float* raw    = (float*)malloc(sizeof(float) * floats);
+    float* values = cubic ? (float*)malloc(sizeof(float) * count * components) : raw;
+    if(!times || !raw || !values)
+    {
+        free(times);
+        free(raw);
+        if(cubic)
+            free(values);
+        return false;
+    }
+
+    cgltf_accessor_unpack_floats(in, times, count);
+    cgltf_accessor_unpack_floats(val, raw, floats);
+    if(cubic)
+    {
+        for(uint32_t k = 0; k < count; k++)
+            memcpy(values + (size_t)k * components, raw + (size_t)k * per_key + components, sizeof(float) * components);
+        free(raw);
+    }
+
+    *out = (AnimationChannel){
+        .times  = times,
+        .values = values,
+        .count  = count,
+        .step   = sampler->interpolation == cgltf_interpolation_type_step,
+    };
+    return true;
+}
+
+static void node_local_transform(const cgltf_node* node, SceneObjectTransform* out)
+{
+    float t[3] = {0.0f, 0.0f, 0.0f}, r[4] = {0.0f, 0.0f, 0.0f, 1.0f}, s[3] = {1.0f, 1.0f, 1.0f};
+    if(node->has_matrix)
+    {
+        decompose_transform(t, r, s, node->matrix);
+    }
+    else
+    {
+        if(node->has_translation)
+            memcpy(t, node->translation, sizeof(t));
+        if(node->has_rotation)
+            memcpy(r, node->rotation, sizeof(r));
+        if(node->has_scale)
+            memcpy(s, node->scale, sizeof(s));
+    }
+
+    glm_vec3_copy(t, out->position);
+    glm_quat_copy(r, out->rotation);
+    out->scale = fmaxf(s[0], fmaxf(s[1], s[2]));
+}
+
+// One Animation per draw of every animated mesh node, resampled from the TRS
+// channels of the first glTF animation that targets the node and composed with
+// the parent's rest world transform. Animated ancestors, skins and morph
+// weights are not applied.
+static void import_animations(Scene* scene, cgltf_data* data, const NodeDraws* nodeDraws)
+{
+    uint8_t* claimed = (uint8_t*)calloc(data->nodes_count ? data->nodes_count : 1, 1);
+    uint32_t tracks = 0, ignored = 0;
+
+    for(size_t ai = 0; ai < data->animations_count; ai++)
+    {
+        const cgltf_animation* anim = &data->animations[ai];
+
+        for(size_t ci = 0; ci < anim->channels_count; ci++)
+        {
+            cgltf_node* node = anim->channels[ci].target_node;
+            if(!node)
+                continue;
+
+            size_t ni = cgltf_node_index(data, node);
+            if(claimed[ni])
+                continue;
+            claimed[ni] = 1;
+
+            if(nodeDraws[ni].count == 0)
+            {
+                ignored++;
+                continue;
+            }
+
+            // every channel of this animation on the node
+            AnimationChannel channels[3] = {0};  // translation, rotation, scale
+            for(size_t cj = ci; cj < anim->channels_count; cj++)
+            {
+                const cgltf_animation_channel* ch = &anim->channels[cj];
+                if(ch->target_node != node || !ch->sampler)
+                    continue;
+
+                int      slot       = -1;
+                uint32_t components = 3;
+                if(ch->target_path == cgltf_animation_path_type_translation)
+                    slot = 0;
+                else if(ch->target_path == cgltf_animation_path_type_rotation)
+                    slot = 1, components = 4;
+                else if(ch->target_path == cgltf_animation_path_type_scale)
+                    slot = 2;
+
+                if(slot >= 0 && channels[slot].count == 0)
+                    unpack_animation_channel(ch->sampler, components, &channels[slot]);
+            }
+
+            SceneObjectTransform rest;
+            node_local_transform(node, &rest);
+
+            float pt[3] = {0.0f, 0.0f, 0.0f}, pr[4] = {0.0f, 0.0f, 0.0f, 1.0f}, ps[3] = {1.0f, 1.0f, 1.0f};
+            if(node->parent)
+            {
+                float matrix[16];
+                cgltf_node_transform_world(node->parent, matrix);
+                decompose_transform(pt, pr, ps, matrix);
+            }
+            float parentScale = fmaxf(ps[0], fmaxf(ps[1], ps[2]));
+
+            Animation track;
+            if(animation_resample(&track, nodeDraws[ni].first, &rest, &channels[0], &channels[1], &channels[2],
+                                  SCENE_ANIMATION_RATE))
+            {
+                for(uint32_t k = 0; k < (uint32_t)arrlen(track.keyframes); k++)
+                    keyframe_transform(&track.keyframes[k], pt, pr, parentScale);
+
+                // the node's primitives move together
+                for(uint32_t d = 0; d < nodeDraws[ni].count; d++)
+                {
+                    Animation copy = track;
+                    copy.drawIndex = nodeDraws[ni].first + d;
+                    copy.keyframes = NULL;
+                    arrsetlen(copy.keyframes, arrlen(track.keyframes));
+                    memcpy(copy.keyframes, track.keyframes, sizeof(Keyframe) * arrlen(track.keyframes));
+                    arrpush(scene->animations, copy);
+                    tracks++;
+                }
+                arrfree(track.keyframes);
+            }
+
+            for(int c = 0; c < 3; c++)
+            {
+                free((void*)channels[c].times);
+                free((void*)channels[c].values);
+            }
+        }
+    }
+
+    if(tracks || ignored)
+        printf("scene: %u animation tracks, %u animated nodes without a mesh ignored\n", tracks, ignored);
+    free(claimed);
+}
+
 // ------------------------------------------------------------
 // Primitive loading
 // ------------------------------------------------------------
@@ -355,8 +551,224 @@ static void compute_bounds(VertexPacked* verts, uint32_t count, vec3 outCenter,
     *outRadius = radius;
 }
 
-static void append_mesh(Geometry* geom, VertexPacked* verts, uint32_t vcount, uint32_t* indices, uint32_t icount)
+// Result of processing one primitive, with offsets local to the primitive.
+// Built without touching Geometry so primitives can be processed in parallel.
+typedef struct MeshBuild
+{
+    VertexPacked* vertices;  // malloc
+    uint32_t*     indices;   // malloc, LOD0 followed by the LOD chain
+    uint32_t      vertexCount;
+    uint32_t      indexCount;
+    Mesh          mesh;      // vertexOffset = 0, lod indexOffset relative to indices
+    Meshlet*      meshlets;  // malloc, indexOffset relative to indices; NULL unless meshlets are enabled
+    uint32_t      meshletCount;
+    bool          valid;
+} MeshBuild;
+
+static bool g_import_meshlets = false;
+
+void scene_import_set_meshlets(bool enabled)
+{
+    g_import_meshlets = enabled;
+}
+
+bool scene_import_meshlets(void)
+{
+    return g_import_meshlets;
+}
+
+static bool g_import_packed = false;
+
+void scene_import_set_packed_geometry(bool enabled)
+{
+    g_import_packed = enabled;
+}
+
+static void mesh_build_free(MeshBuild* b)
+{
+    free(b->vertices);
+    free(b->indices);
+    free(b->meshlets);
+    memset(b, 0, sizeof(*b));
+}
+
+static void dequantize_positions(const VertexPacked* verts, uint32_t count, float* out)
 {
+    for(uint32_t i = 0; i < count; i++)
+    {
+        out[i * 3u + 0u] = meshopt_dequantizeHalf(verts[i].vx);
+        out[i * 3u + 1u] = meshopt_dequantizeHalf(verts[i].vy);
+        out[i * 3u + 2u] = meshopt_dequantizeHalf(verts[i].vz);
+    }
+}
+
+// Splits every LOD into meshlets and rewrites its index range in meshlet order.
+// The triangle set is unchanged, only the order, so LOD index counts stay valid.
+// positions covers every vertex of the build; each LOD only sees its own range.
+static void build_meshlets(MeshBuild* out, const float* positions)
+{
+    Mesh* mesh = &out->mesh;
+
+    size_t total = 0;
+    for(uint32_t li = 0; li < mesh->lodCount; li++)
+        total += meshopt_buildMeshletsBound(mesh->lods[li].indexCount, SCENE_MESHLET_MAX_VERTICES, SCENE_MESHLET_MAX_TRIANGLES);
+
+    // LOD0 is the largest range, so its bound sizes the scratch for every LOD
+    size_t scratch_bound = meshopt_buildMeshletsBound(mesh->lods[0].indexCount, SCENE_MESHLET_MAX_VERTICES,
+                                                      SCENE_MESHLET_MAX_TRIANGLES);
+
+    Meshlet*               meshlets = (Meshlet*)malloc(sizeof(Meshlet) * total);
+    struct meshopt_Meshlet* ml      = (struct meshopt_Meshlet*)malloc(sizeof(struct meshopt_Meshlet) * scratch_bound);
+    uint32_t*              mv       = (uint32_t*)malloc(sizeof(uint32_t) * scratch_bound * SCENE_MESHLET_MAX_VERTICES);
+    uint8_t*               mt       = (uint8_t*)malloc(scratch_bound * SCENE_MESHLET_MAX_TRIANGLES * 3u);
+
+    if(!meshlets || !ml || !mv || !mt)
+    {
+        free(meshlets);
+        free(ml);
+        free(mv);
+        free(mt);
+        return;
+    }
+
+    uint32_t count = 0;
+
+    for(uint32_t li = 0; li < mesh->lodCount; li++)
+    {
+        MeshLod*     lod           = &mesh->lods[li];
+        uint32_t*    indices       = out->indices + lod->indexOffset;
+        const float* lod_positions = positions + (size_t)lod->vertexOffset * 3u;
+
+        size_t lod_meshlets = meshopt_buildMeshlets(ml, mv, mt, indices, lod->indexCount, lod_positions,
+                                                    lod->vertexCount, sizeof(float) * 3u, SCENE_MESHLET_MAX_VERTICES,
+                                                    SCENE_MESHLET_MAX_TRIANGLES, 0.25f);
+
+        lod->meshletOffset = count;
+        lod->meshletCount  = (uint32_t)lod_meshlets;
+
+        uint32_t cursor = lod->indexOffset;
+        for(size_t mi = 0; mi < lod_meshlets; mi++)
+        {
+            const struct meshopt_Meshlet* src = &ml[mi];
+
+            struct meshopt_Bounds b = meshopt_computeMeshletBounds(&mv[src->vertex_offset], &mt[src->triangle_offset],
+                                                                   src->triangle_count, lod_positions,
+                                                                   lod->vertexCount, sizeof(float) * 3u);
+
+            Meshlet* dst = &meshlets[count++];
+            memset(dst, 0, sizeof(*dst));
+            glm_vec3_copy(b.center, dst->center);
+            dst->radius        = b.radius;
+            dst->coneAxis[0]   = b.cone_axis[0];
+            dst->coneAxis[1]   = b.cone_axis[1];
+            dst->coneAxis[2]   = b.cone_axis[2];
+            dst->coneCutoff    = b.cone_cutoff;
+            dst->indexOffset   = cursor;
+            dst->triangleCount = src->triangle_count;
+            dst->vertexCount   = src->vertex_count;
+
+            for(uint32_t t = 0; t < src->triangle_count * 3u; t++)
+                out->indices[cursor++] = mv[src->vertex_offset + mt[src->triangle_offset + t]];
+        }
+    }
+
+    free(ml);
+    free(mv);
+    free(mt);
+
+    out->meshlets     = meshlets;
+    out->meshletCount = count;
+}
+
+// LOD chain, as fractions of the LOD0 triangle count.
+static const float g_lod_ratios[] = {0.5f, 0.25f, 0.12f, 0.06f};
+
+// meshopt_simplifyWithAttributes weights for normal xyz and uv, relative to
+// positions normalized to the mesh extent.
+#define LOD_ATTRIBUTE_COUNT 5u
+static const float g_lod_attribute_weights[LOD_ATTRIBUTE_COUNT] = {0.5f, 0.5f, 0.5f, 0.5f, 0.5f};
+
+// Error cap in mesh units, the same bound the plain meshopt_simplify chain used.
+// Both simplifiers take it relative to the extent (divided by
+// meshopt_simplifyScale). Topology-preserving simplification counts as stalled
+// when it ends more than LOD_STALL_FACTOR above its target; the sloppy
+// simplifier then gets a go under the same cap.
+#define LOD_MAX_ERROR    1e-3f
+#define LOD_STALL_FACTOR 1.25f
+
+// A LOD using more than this share of LOD0's vertices keeps indexing LOD0's
+// range instead of getting a compacted copy.
+#define LOD_SHARED_VERTEX_RATIO 0.75f
+
+static void unpack_lod_attributes(const VertexPacked* verts, uint32_t count, float* out)
+{
+    for(uint32_t i = 0; i < count; i++)
+    {
+        uint32_t np = verts[i].np;
+        float*   a  = out + (size_t)i * LOD_ATTRIBUTE_COUNT;
+
+        a[0] = (float)((int)(np & 1023u) - 511) / 511.f;
+        a[1] = (float)((int)((np >> 10) & 1023u) - 511) / 511.f;
+        a[2] = (float)((int)((np >> 20) & 1023u) - 511) / 511.f;
+        a[3] = meshopt_dequantizeHalf(verts[i].tu);
+        a[4] = meshopt_dequantizeHalf(verts[i].tv);
+    }
+}
+
+static bool reserve_build_vertices(MeshBuild* out, uint32_t* capacity, uint32_t needed)
+{
+    if(needed <= *capacity)
+        return true;
+
+    uint32_t      cap = MAX(needed, *capacity + *capacity / 2u);
+    VertexPacked* v   = (VertexPacked*)realloc(out->vertices, sizeof(VertexPacked) * cap);
+    if(!v)
+        return false;
+
+    out->vertices = v;
+    *capacity     = cap;
+    return true;
+}
+
+// Simplifies LOD0 towards target indices into dst: attribute-aware first, sloppy
+// if that stalls. maxError and *outError are relative to the extent. Returns the
+// index count.
+static size_t simplify_lod(uint32_t* dst, const uint32_t* indices, uint32_t icount, const float* positions,
+                           const float* attributes, uint32_t vcount, size_t target, float maxError, float* outError)
+{
+    float  error = 0.0f;
+    size_t count = meshopt_simplifyWithAttributes(dst, indices, icount, positions, vcount, sizeof(float) * 3u, attributes,
+                                                  sizeof(float) * LOD_ATTRIBUTE_COUNT, g_lod_attribute_weights,
+                                                  LOD_ATTRIBUTE_COUNT, NULL, target, maxError, 0, &error);
+
+    if((float)count > (float)target * LOD_STALL_FACTOR)
+    {
+        float  sloppy_error = 0.0f;
+        size_t sloppy       = meshopt_simplifySloppy(dst, indices, icount, positions, vcount, sizeof(float) * 3u, target,
+                                                     maxError, &sloppy_error);
+        if(sloppy >= 3 && sloppy < count)
+        {
+            count = sloppy;
+            error = MAX(error, sloppy_error);
+        }
+        else
+        {
+            // sloppy did no better under the cap: redo the topology-preserving result
+            count = meshopt_simplifyWithAttributes(dst, indices, icount, positions, vcount, sizeof(float) * 3u,
+                                                   attributes, sizeof(float) * LOD_ATTRIBUTE_COUNT,
+                                                   g_lod_attribute_weights, LOD_ATTRIBUTE_COUNT, NULL, target,
+                                                   maxError, 0, &error);
+        }
+    }
+
+    *outError = error;
+    return count;
+}
+
+static void build_mesh(MeshBuild* out, VertexPacked* verts, uint32_t vcount, uint32_t* indices, uint32_t icount)
+{
+    memset(out, 0, sizeof(*out));
+
     uint32_t* remap = (uint32_t*)malloc(sizeof(uint32_t) * vcount);
     if(!remap) return;
 
@@ -370,88 +782,268 @@ static void append_mesh(Geometry* geom, VertexPacked* verts, uint32_t vcount, ui
     meshopt_optimizeVertexCache(indices, indices, icount, vcount);
     meshopt_optimizeVertexFetch(verts, indices, icount, verts, vcount, sizeof(VertexPacked));
 
-    free(remap);
+    // LOD0 plus room for meshopt_simplify to write a full index_count per LOD
+    const uint32_t lod_ratio_count = (uint32_t)(sizeof(g_lod_ratios) / sizeof(g_lod_ratios[0]));
+    size_t         index_cap       = (size_t)icount * (1u + lod_ratio_count);
+    uint32_t       vertex_cap      = vcount + vcount / 2u;
 
-    Mesh mesh;
-    memset(&mesh, 0, sizeof(mesh));
+    out->vertices = (VertexPacked*)malloc(sizeof(VertexPacked) * vertex_cap);
+    out->indices  = (uint32_t*)malloc(sizeof(uint32_t) * index_cap);
+    if(!out->vertices || !out->indices)
+    {
+        free(remap);
+        mesh_build_free(out);
+        return;
+    }
+
+    Mesh* mesh = &out->mesh;
 
-    mesh.vertexOffset = (uint32_t)arrlen(geom->vertices);
-    mesh.vertexCount  = vcount;
+    mesh->vertexOffset = 0;
 
-    for(uint32_t i = 0; i < vcount; i++)
-        arrpush(geom->vertices, verts[i]);
+    memcpy(out->vertices, verts, sizeof(VertexPacked) * vcount);
+    out->vertexCount = vcount;
 
-    MeshLod lod0;
-    lod0.indexOffset = (uint32_t)arrlen(geom->indices);
-    lod0.indexCount  = icount;
-    lod0.error       = 0.f;
+    MeshLod lod0 = {0};
+    lod0.indexOffset  = 0;
+    lod0.indexCount   = icount;
+    lod0.error        = 0.f;
+    lod0.vertexOffset = 0;
+    lod0.vertexCount  = vcount;
 
-    for(uint32_t i = 0; i < icount; i++)
-        arrpush(geom->indices, indices[i]);
+    memcpy(out->indices, indices, sizeof(uint32_t) * icount);
+    out->indexCount = icount;
 
-    mesh.lodCount = 1;
-    mesh.lods[0]  = lod0;
+    mesh->lodCount = 1;
+    mesh->lods[0]  = lod0;
 
-    float* positions = (float*)malloc(sizeof(float) * vcount * 3u);
-    if(positions)
+    float* positions  = (float*)malloc(sizeof(float) * vcount * 3u);
+    float* attributes = (float*)malloc(sizeof(float) * vcount * LOD_ATTRIBUTE_COUNT);
+    if(positions && attributes)
     {
-        for(uint32_t i = 0; i < vcount; i++)
-        {
-            positions[i * 3u + 0u] = meshopt_dequantizeHalf(verts[i].vx);
-            positions[i * 3u + 1u] = meshopt_dequantizeHalf(verts[i].vy);
-            positions[i * 3u + 2u] = meshopt_dequantizeHalf(verts[i].vz);
-        }
+        dequantize_positions(verts, vcount, positions);
+        unpack_lod_attributes(verts, vcount, attributes);
 
-        static const float lod_ratios[] = {0.5f, 0.25f, 0.12f, 0.06f};
-        size_t             prev_count   = icount;
+        // simplifier errors are relative to the extent; LOD selection wants mesh units
+        float  error_scale = meshopt_simplifyScale(positions, vcount, sizeof(float) * 3u);
+        float  max_error   = error_scale > 0.0f ? LOD_MAX_ERROR / error_scale : 0.0f;
+        size_t prev_count  = icount;
 
-        for(uint32_t li = 0; li < (uint32_t)(sizeof(lod_ratios) / sizeof(lod_ratios[0])) && mesh.lodCount < SCENE_MAX_LODS; li++)
+        for(uint32_t li = 0; li < lod_ratio_count && mesh->lodCount < SCENE_MAX_LODS; li++)
         {
-            size_t target = (size_t)((float)icount * lod_ratios[li]);
+            size_t target = (size_t)((float)icount * g_lod_ratios[li]);
             if(target < 36)
                 target = 36;
             target = (target / 3u) * 3u;
             if(target >= prev_count)
                 continue;
 
-            uint32_t* lod_indices = (uint32_t*)malloc(sizeof(uint32_t) * icount);
-            if(!lod_indices)
-                break;
+            // simplify straight into the output buffer; only committed if accepted
+            uint32_t* lod_indices = out->indices + out->indexCount;
 
             float  result_error = 0.0f;
-            size_t lod_count    = meshopt_simplify(lod_indices, indices, icount, positions, vcount, sizeof(float) * 3u,
-                                                   target, 1e-3f, meshopt_SimplifyErrorAbsolute, &result_error);
+            size_t lod_count    = simplify_lod(lod_indices, indices, icount, positions, attributes, vcount, target,
+                                               max_error, &result_error);
 
             if(lod_count < 3 || lod_count + 6 >= prev_count)
-            {
-                free(lod_indices);
                 continue;
-            }
 
             meshopt_optimizeVertexCache(lod_indices, lod_indices, lod_count, vcount);
 
             MeshLod lod = {0};
-            lod.indexOffset = (uint32_t)arrlen(geom->indices);
-            lod.indexCount  = (uint32_t)lod_count;
-            lod.error       = result_error;
+            lod.indexOffset  = out->indexCount;
+            lod.indexCount   = (uint32_t)lod_count;
+            lod.error        = result_error * error_scale;
+            lod.vertexOffset = 0;
+            lod.vertexCount  = vcount;
+
+            // compact the vertices this LOD uses into a range of its own, so vertex
+            // fetch shrinks with it; its indices become local to that range
+            size_t lod_vcount = meshopt_optimizeVertexFetchRemap(remap, lod_indices, lod_count, vcount);
+            if((float)lod_vcount <= (float)vcount * LOD_SHARED_VERTEX_RATIO
+               && reserve_build_vertices(out, &vertex_cap, out->vertexCount + (uint32_t)lod_vcount))
+            {
+                meshopt_remapIndexBuffer(lod_indices, lod_indices, lod_count, remap);
+                meshopt_remapVertexBuffer(out->vertices + out->vertexCount, verts, vcount, sizeof(VertexPacked), remap);
 
-            for(uint32_t i = 0; i < lod.indexCount; i++)
-                arrpush(geom->indices, lod_indices[i]);
+                lod.vertexOffset = out->vertexCount;
+                lod.vertexCount  = (uint32_t)lod_vcount;
+                out->vertexCount += (uint32_t)lod_vcount;
+            }
 
-            mesh.lods[mesh.lodCount++] = lod;
-            prev_count                 = lod_count;
+            out->indexCount += lod.indexCount;
 
-            free(lod_indices);
+            mesh->lods[mesh->lodCount++] = lod;
+            prev_count                   = lod_count;
         }
 
-        free(positions);
+        if(g_import_meshlets)
+        {
+            float* all_positions = (float*)malloc(sizeof(float) * out->vertexCount * 3u);
+            if(all_positions)
+            {
+                dequantize_positions(out->vertices, out->vertexCount, all_positions);
+                build_meshlets(out, all_positions);
+                free(all_positions);
+            }
+        }
     }
+    free(positions);
+    free(attributes);
+    free(remap);
+
+    // every LOD range: the vertex codec and uploads treat the mesh as one block
+    mesh->vertexCount = out->vertexCount;
+
+    compute_bounds(out->vertices, out->vertexCount, mesh->center, &mesh->radius);
 
-    compute_bounds(&geom->vertices[mesh.vertexOffset], mesh.vertexCount, mesh.center, &mesh.radius);
+    out->valid = true;
+}
+
+static void merge_mesh(Geometry* geom, const MeshBuild* b)
+{
+    if(!b->valid)
+        return;
+
+    Mesh mesh = b->mesh;
+
+    uint32_t vertexBase = (uint32_t)arrlen(geom->vertices);
+    uint32_t indexBase  = (uint32_t)arrlen(geom->indices);
+
+    arrsetlen(geom->vertices, vertexBase + b->vertexCount);
+    memcpy(&geom->vertices[vertexBase], b->vertices, sizeof(VertexPacked) * b->vertexCount);
+
+    arrsetlen(geom->indices, indexBase + b->indexCount);
+    memcpy(&geom->indices[indexBase], b->indices, sizeof(uint32_t) * b->indexCount);
+
+    mesh.vertexOffset = vertexBase;
+    for(uint32_t li = 0; li < mesh.lodCount; li++)
+        mesh.lods[li].indexOffset += indexBase;
+
+    if(b->meshletCount > 0)
+    {
+        uint32_t meshletBase = (uint32_t)arrlen(geom->meshlets);
+
+        arrsetlen(geom->meshlets, meshletBase + b->meshletCount);
+        memcpy(&geom->meshlets[meshletBase], b->meshlets, sizeof(Meshlet) * b->meshletCount);
+
+        for(uint32_t mi = 0; mi < b->meshletCount; mi++)
+            geom->meshlets[meshletBase + mi].indexOffset += indexBase;
+        for(uint32_t li = 0; li < mesh.lodCount; li++)
+            mesh.lods[li].meshletOffset += meshletBase;
+    }
 
     arrpush(geom->meshes, mesh);
 }
 
+// ------------------------------------------------------------
+// Primitive jobs
+// ------------------------------------------------------------
+
+typedef struct PrimitiveJob
+{
+    const cgltf_primitive* prim;
+    MeshBuild              build;
+} PrimitiveJob;
+
+static void process_primitive(void* user, uint32_t index)
+{
+    PrimitiveJob* job = &((PrimitiveJob*)user)[index];
+
+    VertexPacked* verts = NULL;
+    uint32_t vcount = 0;
+
+    uint32_t* inds = NULL;
+    uint32_t icount = 0;
+
+    if(!load_primitive_vertices(&verts, &vcount, job->prim))
+        return;
+
+    if(!load_primitive_indices(&inds, &icount, job->prim))
+    {
+        arrfree(verts);
+        return;
+    }
+
+    build_mesh(&job->build, verts, vcount, inds, icount);
+
+    arrfree(verts);
+    arrfree(inds);
+}
+
+static uint32_t g_import_threads = 0;  // 0 = auto, 1 = serial
+static JobPool  g_import_pool;
+static uint32_t g_import_pool_threads = 0;
+
+void scene_import_set_threads(uint32_t threads)
+{
+    g_import_threads = threads;
+}
+
+static JobPool* import_pool(void)
+{
+    uint32_t want = g_import_threads ? g_import_threads - 1u : job_pool_default_threads();
+    if(want == 0)
+        return NULL;
+
+    if(g_import_pool_threads != want)
+    {
+        job_pool_destroy(&g_import_pool);
+        job_pool_init(&g_import_pool, want);
+        g_import_pool_threads = want;
+    }
+    return &g_import_pool;
+}
+
+void scene_import_shutdown(void)
+{
+    job_pool_destroy(&g_import_pool);
+    g_import_pool_threads = 0;
+}
+
+// ------------------------------------------------------------
+// Packed geometry
+// ------------------------------------------------------------
+
+uint32_t scene_geometry_vertex_count(const Geometry* geometry)
+{
+    return geometry->packed.streams ? geometry->packed.vertexCount : (uint32_t)arrlen(geometry->vertices);
+}
+
+uint32_t scene_geometry_index_count(const Geometry* geometry)
+{
+    return geometry->packed.streams ? geometry->packed.indexCount : (uint32_t)arrlen(geometry->indices);
+}
+
+bool scene_geometry_decode(const Geometry* geometry, VertexPacked* dstVertices, uint32_t* dstIndices)
+{
+    const GeometryPack* pack = &geometry->packed;
+    if(pack->streams)
+        return geometry_pack_decode(pack->streams, (uint32_t)arrlen(pack->streams), pack->data, dstVertices, dstIndices,
+                                    import_pool());
+
+    if(dstVertices && geometry->vertices)
+        memcpy(dstVertices, geometry->vertices, sizeof(VertexPacked) * arrlen(geometry->vertices));
+    if(dstIndices && geometry->indices)
+        memcpy(dstIndices, geometry->indices, sizeof(uint32_t) * arrlen(geometry->indices));
+    return true;
+}
+
+bool scene_geometry_unpack(Geometry* geometry)
+{
+    return geometry_unpack(geometry, import_pool());
+}
+
+bool scene_texture_is_color(const Scene* scene, uint32_t texture)
+{
+    for(uint32_t i = 0; i < (uint32_t)arrlen(scene->materials); i++)
+    {
+        const Material* m = &scene->materials[i];
+        if(m->albedoTexture == (int)texture || m->emissiveTexture == (int)texture)
+            return true;
+    }
+    return false;
+}
+
 // ------------------------------------------------------------
 // Public API
 // ------------------------------------------------------------
@@ -498,6 +1090,41 @@ bool scene_load_gltf(Scene* scene, const char* path)
         textureBase  = 1;
     }
 
+    uint64_t          load_start = time_now_ns();
+    SceneImportBase   base       = scene_import_base(scene);
+    SceneImportExtras extras     = {0};
+    uint64_t          sourceHash = 0;
+    char*             cachePath  = NULL;
+    uint32_t          importFlags = g_import_meshlets ? SCENE_IMPORT_MESHLETS : 0u;
+
+    if(scene_cache_enabled() && scene_cache_hash_source(path, &sourceHash))
+    {
+        cachePath = scene_cache_path(path);
+        if(cachePath && scene_cache_load(cachePath, sourceHash, importFlags, scene, &extras, g_import_packed, import_pool()))
+        {
+            if(init_scene && (extras.flags & SCENE_CACHE_HAS_CAMERA))
+                scene->camera = extras.camera;
+            if(init_scene && (extras.flags & SCENE_CACHE_HAS_SUN))
+                glm_vec3_copy(extras.sunDirection, scene->sunDirection);
+
+            printf("Loaded scene (cache %s, %.2f ms): %u meshes, %u draws, %u vertices, %u indices%s\n", cachePath,
+                   time_ns_to_ms(time_now_ns() - load_start), (uint32_t)arrlen(scene->geometry.meshes),
+                   (uint32_t)arrlen(scene->draws), scene_geometry_vertex_count(&scene->geometry),
+                   scene_geometry_index_count(&scene->geometry), scene->geometry.packed.streams ? " (packed)" : "");
+
+            free(cachePath);
+            return true;
+        }
+    }
+
+    // the import appends to the plain arrays
+    if(!scene_geometry_unpack(&scene->geometry))
+    {
+        fprintf(stderr, "scene: failed to decode packed geometry\n");
+        free(cachePath);
+        return false;
+    }
+
     cgltf_options options = {0};
     cgltf_data* data = NULL;
 
@@ -505,6 +1132,7 @@ bool scene_load_gltf(Scene* scene, const char* path)
     if(res != cgltf_result_success)
     {
         fprintf(stderr, "cgltf_parse_file failed\n");
+        free(cachePath);
         return false;
     }
 
@@ -513,6 +1141,7 @@ bool scene_load_gltf(Scene* scene, const char* path)
     {
         fprintf(stderr, "cgltf_load_buffers failed\n");
         cgltf_free(data);
+        free(cachePath);
         return false;
     }
 
@@ -521,6 +1150,7 @@ bool scene_load_gltf(Scene* scene, const char* path)
     {
         fprintf(stderr, "cgltf_validate failed\n");
         cgltf_free(data);
+        free(cachePath);
         return false;
     }
 
@@ -543,49 +1173,59 @@ bool scene_load_gltf(Scene* scene, const char* path)
     // store primitive material pointer list in geometry-mesh order
     cgltf_material** primitiveMaterials = NULL;
 
+    // Gather triangle primitives in glTF order, process them on the import pool
+    // (one MeshBuild per primitive), then merge serially in the same order so
+    // mesh indices are identical to a serial import.
+    PrimitiveJob* jobs = NULL;
     for(size_t mi = 0; mi < data->meshes_count; mi++)
     {
         const cgltf_mesh* mesh = &data->meshes[mi];
 
-        uint32_t meshOffset = (uint32_t)arrlen(scene->geometry.meshes);
-        uint32_t primCount  = 0;
-
         for(size_t pi = 0; pi < mesh->primitives_count; pi++)
         {
             const cgltf_primitive* prim = &mesh->primitives[pi];
             if(prim->type != cgltf_primitive_type_triangles || !prim->indices)
                 continue;
 
-            VertexPacked* verts = NULL;
-            uint32_t vcount = 0;
+            PrimitiveJob job = {.prim = prim};
+            arrpush(jobs, job);
+        }
+    }
 
-            uint32_t* inds = NULL;
-            uint32_t icount = 0;
+    uint32_t jobCount = (uint32_t)arrlen(jobs);
+    job_pool_parallel_for(jobCount > 1 ? import_pool() : NULL, jobCount, process_primitive, jobs);
 
-            if(!load_primitive_vertices(&verts, &vcount, prim))
-                continue;
+    uint32_t ji = 0;
+    for(size_t mi = 0; mi < data->meshes_count; mi++)
+    {
+        const cgltf_mesh* mesh = &data->meshes[mi];
 
-            if(!load_primitive_indices(&inds, &icount, prim))
-            {
-                arrfree(verts);
+        uint32_t meshOffset = (uint32_t)arrlen(scene->geometry.meshes);
+        uint32_t primCount  = 0;
+
+        for(; ji < jobCount && jobs[ji].prim >= mesh->primitives && jobs[ji].prim < mesh->primitives + mesh->primitives_count; ji++)
+        {
+            PrimitiveJob* job = &jobs[ji];
+            if(!job->build.valid)
                 continue;
-            }
 
-            append_mesh(&scene->geometry, verts, vcount, inds, icount);
+            merge_mesh(&scene->geometry, &job->build);
+            mesh_build_free(&job->build);
 
             // record primitive material in same order as appended meshes
-            arrpush(primitiveMaterials, prim->material);
+            arrpush(primitiveMaterials, job->prim->material);
 
             primCount++;
-
-            arrfree(verts);
-            arrfree(inds);
         }
 
         primitives[mi].first = meshOffset;
         primitives[mi].count = primCount;
     }
 
+    for(uint32_t i = 0; i < jobCount; i++)
+        mesh_build_free(&jobs[i].build);
+    arrfree(jobs);
+
     // ------------------------------------------------------------
     // 2) Load textures (paths only, keep .dds swap)
     // ------------------------------------------------------------
@@ -657,12 +1297,14 @@ bool scene_load_gltf(Scene* scene, const char* path)
     // ------------------------------------------------------------
     // 4) Nodes -> Draws (THIS is the important part)
     // ------------------------------------------------------------
+    NodeDraws* nodeDraws = (NodeDraws*)calloc(data->nodes_count ? data->nodes_count : 1, sizeof(NodeDraws));
+
     for(size_t ni = 0; ni < data->nodes_count; ni++)
     {
         cgltf_node* node = &data->nodes[ni];
 
-        // camera
-        if(init_scene && node->camera && node->camera->type == cgltf_camera_type_perspective)
+        // camera (recorded for the cache even when the scene already has one)
+        if(node->camera && node->camera->type == cgltf_camera_type_perspective)
         {
             float matrix[16];
             cgltf_node_transform_world(node, matrix);
@@ -670,27 +1312,37 @@ bool scene_load_gltf(Scene* scene, const char* path)
             float t[3], r[4], s[3];
             decompose_transform(t, r, s, matrix);
 
-            scene->camera.position[0] = t[0];
-            scene->camera.position[1] = t[1];
-            scene->camera.position[2] = t[2];
+            extras.flags |= SCENE_CACHE_HAS_CAMERA;
+            extras.camera = scene->camera;
+
+            extras.camera.position[0] = t[0];
+            extras.camera.position[1] = t[1];
+            extras.camera.position[2] = t[2];
+
+            extras.camera.orientation[0] = r[0];
+            extras.camera.orientation[1] = r[1];
+            extras.camera.orientation[2] = r[2];
+            extras.camera.orientation[3] = r[3];
 
-            scene->camera.orientation[0] = r[0];
-            scene->camera.orientation[1] = r[1];
-            scene->camera.orientation[2] = r[2];
-            scene->camera.orientation[3] = r[3];
+            extras.camera.fovY = node->camera->data.perspective.yfov;
 
-            scene->camera.fovY = node->camera->data.perspective.yfov;
+            if(init_scene)
+                scene->camera = extras.camera;
         }
 
         // sun
-        if(init_scene && node->light && node->light->type == cgltf_light_type_directional)
+        if(node->light && node->light->type == cgltf_light_type_directional)
         {
             float matrix[16];
             cgltf_node_transform_world(node, matrix);
 
-            scene->sunDirection[0] = matrix[8];
-            scene->sunDirection[1] = matrix[9];
-            scene->sunDirection[2] = matrix[10];
+            extras.flags |= SCENE_CACHE_HAS_SUN;
+            extras.sunDirection[0] = matrix[8];
+            extras.sunDirection[1] = matrix[9];
+            extras.sunDirection[2] = matrix[10];
+
+            if(init_scene)
+                glm_vec3_copy(extras.sunDirection, scene->sunDirection);
         }
 
         // drawable mesh node
@@ -708,6 +1360,9 @@ bool scene_load_gltf(Scene* scene, const char* path)
             // NOTE: your MeshDraw only supports uniform scale
             float uniformScale = fmaxf(s[0], fmaxf(s[1], s[2]));
 
+            nodeDraws[ni].first = (uint32_t)arrlen(scene->draws);
+            nodeDraws[ni].count = range.count;
+
             for(uint32_t j = 0; j < range.count; j++)
             {
                 uint32_t geomMeshIndex = range.first + j;
@@ -744,6 +1399,12 @@ bool scene_load_gltf(Scene* scene, const char* path)
         }
     }
 
+    // ------------------------------------------------------------
+    // 5) Animations
+    // ------------------------------------------------------------
+    import_animations(scene, data, nodeDraws);
+    free(nodeDraws);
+
     // cleanup
     arrfree(primitiveMaterials);
     arrfree(primitives);
@@ -751,7 +1412,13 @@ bool scene_load_gltf(Scene* scene, const char* path)
     free(basedir);
     cgltf_free(data);
 
-    printf("Loaded scene: %u meshes, %u draws, %u vertices, %u indices\n",
+    double import_ms = time_ns_to_ms(time_now_ns() - load_start);
+
+    if(cachePath)
+        scene_cache_write(cachePath, sourceHash, importFlags, scene, &base, &extras, import_pool());
+    free(cachePath);
+
+    printf("Loaded scene (import %.2f ms): %u meshes, %u draws, %u vertices, %u indices\n", import_ms,
            (uint32_t)arrlen(scene->geometry.meshes),
            (uint32_t)arrlen(scene->draws),
            (uint32_t)arrlen(scene->geometry.vertices),
@@ -764,6 +1431,7 @@ bool scene_load_gltf_at(Scene* scene, const char* path, const vec3 position, con
                         uint32_t* outTemplateCount)
 {
     uint32_t prev_draw_count = scene && scene->draws ? (uint32_t)arrlen(scene->draws) : 0;
+    uint32_t prev_anim_count = scene && scene->animations ? (uint32_t)arrlen(scene->animations) : 0;
 
     if(!scene_load_gltf(scene, path))
         return false;
@@ -793,27 +1461,95 @@ bool scene_load_gltf_at(Scene* scene, const char* path, const vec3 position, con
             glm_quat_copy(out_rot, draw->orientation);
         }
 
-        scene_spawn_from_draws(scene, prev_draw_count, templateCount, position, rotation, scale);
+        SceneObjectTransform xf;
+        glm_vec3_copy((float*)position, xf.position);
+        glm_quat_copy((float*)rotation, xf.rotation);
+        xf.scale = scale;
+
+        uint32_t* ids = (uint32_t*)calloc(templateCount, sizeof(uint32_t));
+        scene_spawn_from_draws_bulk(scene, prev_draw_count, templateCount, &xf, 1, ids);
+
+        // the imported tracks get the same placement and follow their draw's object
+        for(uint32_t i = prev_anim_count; i < (uint32_t)arrlen(scene->animations); i++)
+        {
+            Animation* a = &scene->animations[i];
+            for(uint32_t k = 0; k < (uint32_t)arrlen(a->keyframes); k++)
+                keyframe_transform(&a->keyframes[k], position, rotation, scale);
+            if(ids && a->drawIndex >= prev_draw_count && a->drawIndex < end)
+                a->objectId = ids[a->drawIndex - prev_draw_count];
+        }
+        free(ids);
     }
 
     return true;
 }
 
 // ------------------------------------------------------------
-// SceneObject API
+// SceneObject API (generational slot map)
 // ------------------------------------------------------------
 
-static int scene_object_index_by_id(Scene* scene, uint32_t objectId)
+static inline uint32_t object_handle(uint32_t slot, uint32_t generation)
+{
+    return (generation << SCENE_OBJECT_INDEX_BITS) | slot;
+}
+
+// Dense index of a live handle, or -1 for 0 / stale / out-of-range handles.
+static int scene_object_index_by_id(const Scene* scene, uint32_t objectId)
 {
     if(!scene || objectId == 0)
         return -1;
 
-    for(int i = 0; i < arrlen(scene->objects); i++)
+    uint32_t slot = objectId & SCENE_OBJECT_INDEX_MASK;
+    if(slot >= (uint32_t)arrlen(scene->objectSlots))
+        return -1;
+
+    // a freed slot already carries its next generation, so the dense entry is
+    // checked as well: its id only matches while the slot is in use
+    uint32_t dense = scene->objectSlots[slot].dense;
+    if(dense >= (uint32_t)arrlen(scene->objects) || scene->objects[dense].id != objectId)
+        return -1;
+
+    return (int)dense;
+}
+
+void scene_objects_reserve(Scene* scene, uint32_t count)
+{
+    if(!scene)
+        return;
+
+    // no more objects than handles can address; live never passes that
+    uint32_t live = MIN((uint32_t)arrlen(scene->objects), SCENE_OBJECT_INDEX_MASK + 1u);
+    uint32_t cap  = live + MIN(count, SCENE_OBJECT_INDEX_MASK + 1u - live);
+    arrsetcap(scene->objects, cap);
+    arrsetcap(scene->objectSlots, cap);
+}
+
+static uint32_t object_alloc(Scene* scene, const SceneObject* src)
+{
+    uint32_t slot;
+
+    if(scene->objectFreeSlot)
+    {
+        slot                  = scene->objectFreeSlot - 1u;
+        scene->objectFreeSlot = scene->objectSlots[slot].dense;
+    }
+    else
     {
-        if(scene->objects[i].id == objectId)
-            return i;
+        slot = (uint32_t)arrlen(scene->objectSlots);
+        if(slot > SCENE_OBJECT_INDEX_MASK)
+            return 0;
+
+        SceneObjectSlot fresh = {.dense = 0, .generation = 1};
+        arrpush(scene->objectSlots, fresh);
     }
-    return -1;
+
+    SceneObjectSlot* s = &scene->objectSlots[slot];
+    s->dense           = (uint32_t)arrlen(scene->objects);
+
+    SceneObject obj = *src;
+    obj.id          = object_handle(slot, s->generation);
+    arrpush(scene->objects, obj);
+    return obj.id;
 }
 
 uint32_t scene_object_create(Scene* scene, uint32_t meshIndex, uint32_t materialIndex, uint32_t templateIndex,
@@ -822,11 +1558,7 @@ uint32_t scene_object_create(Scene* scene, uint32_t meshIndex, uint32_t material
     if(!scene)
         return 0;
 
-    if(scene->nextObjectId == 0)
-        scene->nextObjectId = 1;
-
     SceneObject obj = {0};
-    obj.id            = scene->nextObjectId++;
     obj.meshIndex     = meshIndex;
     obj.materialIndex = materialIndex;
     obj.templateIndex = templateIndex;
@@ -834,47 +1566,88 @@ uint32_t scene_object_create(Scene* scene, uint32_t meshIndex, uint32_t material
     glm_quat_copy(rotation, obj.rotation);
     obj.scale = scale;
 
-    arrpush(scene->objects, obj);
-    return obj.id;
+    return object_alloc(scene, &obj);
 }
 
-uint32_t scene_spawn_from_draws(Scene* scene, uint32_t templateOffset, uint32_t templateCount,
-                                const vec3 position, const versor rotation, float scale)
+uint32_t scene_spawn_from_draws_bulk(Scene* scene, uint32_t templateOffset, uint32_t templateCount,
+                                     const SceneObjectTransform* transforms, uint32_t transformCount, uint32_t* outIds)
 {
-    if(!scene || templateCount == 0)
+    if(!scene || templateCount == 0 || transformCount == 0 || !transforms)
         return 0;
 
-    uint32_t created = 0;
     uint32_t draw_count = (uint32_t)arrlen(scene->draws);
+    if(templateOffset >= draw_count)
+        return 0;
+
+    templateCount = MIN(templateCount, draw_count - templateOffset);
+    // the product can pass 32 bits; reserve clamps it to the handle capacity
+    uint64_t total = (uint64_t)templateCount * transformCount;
+    scene_objects_reserve(scene, (uint32_t)MIN(total, (uint64_t)UINT32_MAX));
 
-    for(uint32_t i = 0; i < templateCount; i++)
+    uint32_t created = 0;
+    for(uint32_t t = 0; t < transformCount; t++)
     {
-        uint32_t templateIndex = templateOffset + i;
-        if(templateIndex >= draw_count)
-            break;
+        const SceneObjectTransform* xf = &transforms[t];
 
-        MeshDraw* src = &scene->draws[templateIndex];
-        scene_object_create(scene, src->meshIndex, src->materialIndex, templateIndex, position, rotation, scale);
-        created++;
+        for(uint32_t i = 0; i < templateCount; i++)
+        {
+            uint32_t        templateIndex = templateOffset + i;
+            const MeshDraw* src           = &scene->draws[templateIndex];
+
+            SceneObject obj = {0};
+            obj.meshIndex     = src->meshIndex;
+            obj.materialIndex = src->materialIndex;
+            obj.templateIndex = templateIndex;
+            glm_vec3_copy((float*)xf->position, obj.position);
+            glm_quat_copy((float*)xf->rotation, obj.rotation);
+            obj.scale = xf->scale;
+
+            uint32_t id = object_alloc(scene, &obj);
+            if(id == 0)
+                return created;  // out of slots
+
+            if(outIds)
+                outIds[created] = id;
+            created++;
+        }
     }
 
     return created;
 }
 
-bool scene_object_remove(Scene* scene, uint32_t objectId)
+uint32_t scene_spawn_from_draws(Scene* scene, uint32_t templateOffset, uint32_t templateCount,
+                                const vec3 position, const versor rotation, float scale)
 {
-    if(!scene)
-        return false;
+    SceneObjectTransform xf;
+    glm_vec3_copy((float*)position, xf.position);
+    glm_quat_copy((float*)rotation, xf.rotation);
+    xf.scale = scale;
+
+    return scene_spawn_from_draws_bulk(scene, templateOffset, templateCount, &xf, 1, NULL);
+}
 
+bool scene_object_remove(Scene* scene, uint32_t objectId)
+{
     int idx = scene_object_index_by_id(scene, objectId);
     if(idx < 0)
         return false;
 
+    // swap-remove, then point the moved object's slot at its new dense index
     int last = arrlen(scene->objects) - 1;
     if(idx != last)
+    {
         scene->objects[idx] = scene->objects[last];
+        scene->objectSlots[scene->objects[idx].id & SCENE_OBJECT_INDEX_MASK].dense = (uint32_t)idx;
+    }
 
     arrpop(scene->objects);
+
+    uint32_t         slot = objectId & SCENE_OBJECT_INDEX_MASK;
+    SceneObjectSlot* s    = &scene->objectSlots[slot];
+
+    s->generation = s->generation == SCENE_OBJECT_GEN_MAX ? 1u : s->generation + 1u;
+    s->dense      = scene->objectFreeSlot;
+    scene->objectFreeSlot = slot + 1u;
     return true;
 }
 
@@ -930,6 +1703,8 @@ void scene_free(Scene* scene)
     arrfree(scene->geometry.vertices);
     arrfree(scene->geometry.indices);
     arrfree(scene->geometry.meshes);
+    arrfree(scene->geometry.meshlets);
+    geometry_pack_free(&scene->geometry.packed);
 
     arrfree(scene->materials);
     arrfree(scene->draws);
@@ -949,6 +1724,7 @@ void scene_free(Scene* scene)
     }
 
     arrfree(scene->objects);
+    arrfree(scene->objectSlots);
 
     memset(scene, 0, sizeof(*scene));
 }
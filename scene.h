@@ -23,8 +23,39 @@ typedef struct MeshLod
     uint32_t indexOffset;
     uint32_t indexCount;
     float    error;
+
+    // meshlets covering this LOD's index range (meshletCount == 0 when not built)
+    uint32_t meshletOffset;
+    uint32_t meshletCount;
+
+    // vertex range this LOD indexes, relative to Mesh.vertexOffset; its indices
+    // are local to it. Coarse LODs get a compacted copy of just the vertices
+    // they use, others share LOD0's range.
+    uint32_t vertexOffset;
+    uint32_t vertexCount;
 } MeshLod;
 
+// Cluster of up to SCENE_MESHLET_MAX_TRIANGLES triangles. When meshlets are built
+// the LOD index range is rewritten in meshlet order, so each meshlet is the
+// contiguous sub-range [indexOffset, indexOffset + triangleCount * 3).
+// Layout matches the GPU struct (48 bytes, std430).
+#define SCENE_MESHLET_MAX_VERTICES  64
+#define SCENE_MESHLET_MAX_TRIANGLES 124
+
+typedef struct Meshlet
+{
+    vec3  center;  // bounding sphere, mesh space
+    float radius;
+
+    float coneAxis[3];  // normal cone; coneCutoff >= 1 means the cone test never culls
+    float coneCutoff;
+
+    uint32_t indexOffset;
+    uint32_t triangleCount;
+    uint32_t vertexCount;
+    uint32_t pad;
+} Meshlet;
+
 typedef struct Mesh
 {
     vec3  center;
@@ -61,9 +92,17 @@ typedef struct MeshDraw
     uint32_t materialIndex;
 } MeshDraw;
 
+// Object handles are generational: the low SCENE_OBJECT_INDEX_BITS select a slot,
+// the rest is the slot's generation, bumped on every remove. A stale handle
+// resolves to NULL instead of aliasing whatever reuses the slot. 0 is never a
+// valid handle.
+#define SCENE_OBJECT_INDEX_BITS 22u
+#define SCENE_OBJECT_INDEX_MASK ((1u << SCENE_OBJECT_INDEX_BITS) - 1u)
+#define SCENE_OBJECT_GEN_MAX    ((1u << (32u - SCENE_OBJECT_INDEX_BITS)) - 1u)
+
 typedef struct SceneObject
 {
-    uint32_t id;
+    uint32_t id;  // handle of this object
     uint32_t meshIndex;
     uint32_t materialIndex;
     uint32_t templateIndex;
@@ -72,6 +111,19 @@ typedef struct SceneObject
     float    scale;
 } SceneObject;
 
+typedef struct SceneObjectSlot
+{
+    uint32_t dense;       // index into Scene.objects, or next free slot + 1 while free
+    uint32_t generation;  // 1..SCENE_OBJECT_GEN_MAX
+} SceneObjectSlot;
+
+typedef struct SceneObjectTransform
+{
+    vec3   position;
+    versor rotation;
+    float  scale;
+} SceneObjectTransform;
+
 typedef struct Cam
 {
     vec3 position;
@@ -87,20 +139,54 @@ typedef struct Keyframe
     versor rotation;
 } Keyframe;
 
+// Fixed-rate track of one draw's world transform (see animation_sampler.h).
+// glTF imports fill these from the animation channels of mesh nodes.
 typedef struct Animation
 {
     uint32_t drawIndex;
+    uint32_t objectId;  // SceneObject of the draw (scene_load_gltf_at), 0 = none
     float startTime;
     float period;
 
     Keyframe* keyframes; // stb_ds dynamic array
 } Animation;
 
+// One mesh worth of meshopt-encoded geometry: the vertex codec output for
+// vertices [vertexOffset, +vertexCount), then the index codec output for indices
+// [indexOffset, +indexCount). Indices are mesh-local, like Geometry.indices.
+// Same layout in memory and in the scene cache (32 bytes).
+typedef struct GeometryStream
+{
+    uint32_t vertexOffset;
+    uint32_t vertexCount;
+    uint32_t indexOffset;
+    uint32_t indexCount;
+    uint64_t dataOffset;  // into GeometryPack.data
+    uint32_t vertexBytes;
+    uint32_t indexBytes;
+} GeometryStream;
+
+// Encoded vertices/indices. The streams tile [0, vertexCount) and
+// [0, indexCount) in order, so decoding them all fills both arrays.
+typedef struct GeometryPack
+{
+    GeometryStream* streams;  // stb_ds
+    uint8_t*        data;     // stb_ds
+    uint32_t        vertexCount;
+    uint32_t        indexCount;
+} GeometryPack;
+
 typedef struct Geometry
 {
     VertexPacked* vertices; // stb_ds
     uint32_t*     indices;  // stb_ds
     Mesh*         meshes;   // stb_ds
+    Meshlet*      meshlets; // stb_ds, empty unless meshlets were built
+
+    // Still-encoded vertices/indices from compressed scene caches, only with
+    // scene_import_set_packed_geometry(true). While it holds anything,
+    // vertices/indices are empty and mesh offsets index the decoded streams.
+    GeometryPack packed;
 } Geometry;
 
 typedef struct Scene
@@ -112,8 +198,9 @@ typedef struct Scene
     char**     texturePaths;  // stb_ds (heap strings)
     Animation* animations;    // stb_ds
 
-    SceneObject* objects;      // stb_ds
-    uint32_t     nextObjectId;
+    SceneObject*     objects;         // stb_ds, dense; order changes on remove
+    SceneObjectSlot* objectSlots;     // stb_ds, indexed by handle
+    uint32_t         objectFreeSlot;  // first free slot + 1, 0 = none
 
     Cam camera;
     vec3   sunDirection;
@@ -124,11 +211,51 @@ bool scene_load_gltf_at(Scene* scene, const char* path, const vec3 position, con
                         uint32_t* outTemplateCount);
 void scene_free(Scene* scene);
 
+// Worker threads used for per-primitive mesh processing during import.
+// 0 = one per core (default), 1 = serial. Output is identical either way.
+void scene_import_set_threads(uint32_t threads);
+
+// Joins and frees the import worker pool. A later import starts a new one.
+void scene_import_shutdown(void);
+
+// Build meshlets for every LOD on import (off by default). Part of the scene
+// cache key, so toggling it re-imports instead of loading a stale cache.
+void scene_import_set_meshlets(bool enabled);
+bool scene_import_meshlets(void);
+
+// Keep geometry from compressed caches encoded until upload (off by default), so
+// it can be decoded straight into staging memory with scene_geometry_decode.
+// Imports that need the CPU arrays unpack it first.
+void scene_import_set_packed_geometry(bool enabled);
+
+// Vertex / index counts whether the geometry is packed or not.
+uint32_t scene_geometry_vertex_count(const Geometry* geometry);
+uint32_t scene_geometry_index_count(const Geometry* geometry);
+
+// Decodes packed geometry on the import workers; either destination may be NULL.
+// Plain geometry is copied. Returns false if a stream fails to decode.
+bool scene_geometry_decode(const Geometry* geometry, VertexPacked* dstVertices, uint32_t* dstIndices);
+
+// Decodes packed geometry into vertices/indices and drops the encoded copy.
+bool scene_geometry_unpack(Geometry* geometry);
+
+// True when some material samples the texture as albedo or emissive, i.e. it
+// holds color and its mips are filtered in linear light. Materials come from
+// the scene cache too, so this holds for cached imports.
+bool scene_texture_is_color(const Scene* scene, uint32_t texture);
+
 uint32_t     scene_object_create(Scene* scene, uint32_t meshIndex, uint32_t materialIndex, uint32_t templateIndex,
                                  const vec3 position, const versor rotation, float scale);
 uint32_t     scene_spawn_from_draws(Scene* scene, uint32_t templateOffset, uint32_t templateCount,
                                     const vec3 position, const versor rotation, float scale);
+// Spawns the template range once per transform, reserving storage up front.
+// outIds (optional) receives transformCount * templateCount handles, grouped by
+// transform. Returns the number of objects created.
+uint32_t     scene_spawn_from_draws_bulk(Scene* scene, uint32_t templateOffset, uint32_t templateCount,
+                                         const SceneObjectTransform* transforms, uint32_t transformCount, uint32_t* outIds);
+void         scene_objects_reserve(Scene* scene, uint32_t count);
 bool         scene_object_remove(Scene* scene, uint32_t objectId);
+// O(1). The pointer is only valid until the next create or remove.
 SceneObject* scene_object_get(Scene* scene, uint32_t objectId);
 void         scene_object_set_transform(Scene* scene, uint32_t objectId, const vec3 position, const versor rotation, float scale);
 void         scene_object_translate(Scene* scene, uint32_t objectId, const vec3 delta);
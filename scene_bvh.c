@@ -0,0 +1,585 @@
+#include "scene_bvh.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Traversal stacks hold at most depth + 1 entries; the build switches to
+// median splits past SCENE_BVH_SAH_DEPTH so depth stays below this.
+#define BVH_STACK_SIZE 64
+#define SCENE_BVH_SAH_DEPTH 32
+
+void scene_draw_sphere(const Scene* scene, uint32_t drawIndex, vec4 out)
+{
+    const MeshDraw* d = &scene->draws[drawIndex];
+    const Mesh*     m = &scene->geometry.meshes[d->meshIndex];
+
+    vec3 c;
+    glm_quat_rotatev((float*)d->orientation, (float*)m->center, c);
+
+    out[0] = c[0] * d->scale + d->position[0];
+    out[1] = c[1] * d->scale + d->position[1];
+    out[2] = c[2] * d->scale + d->position[2];
+    out[3] = m->radius * d->scale;
+}
+
+// ------------------------------------------------------------
+// Bounds helpers
+// ------------------------------------------------------------
+
+static void bounds_reset(float mn[3], float mx[3])
+{
+    for(int k = 0; k < 3; k++)
+    {
+        mn[k] = FLT_MAX;
+        mx[k] = -FLT_MAX;
+    }
+}
+
+static void bounds_add_sphere(float mn[3], float mx[3], const float* s)
+{
+    for(int k = 0; k < 3; k++)
+    {
+        mn[k] = fminf(mn[k], s[k] - s[3]);
+        mx[k] = fmaxf(mx[k], s[k] + s[3]);
+    }
+}
+
+static float bounds_area(const float mn[3], const float mx[3])
+{
+    float ex = mx[0] - mn[0], ey = mx[1] - mn[1], ez = mx[2] - mn[2];
+    if(ex < 0.0f || ey < 0.0f || ez < 0.0f)
+        return 0.0f;
+    return ex * ey + ey * ez + ez * ex;
+}
+
+static void leaf_bounds(SceneBvh* bvh, BvhNode* node)
+{
+    bounds_reset(node->min, node->max);
+    for(uint32_t i = 0; i < node->count; i++)
+        bounds_add_sphere(node->min, node->max, bvh->spheres[node->first + i]);
+}
+
+static void interior_bounds(SceneBvh* bvh, BvhNode* node)
+{
+    const BvhNode* l = &bvh->nodes[node->first];
+    const BvhNode* r = &bvh->nodes[node->first + 1];
+
+    for(int k = 0; k < 3; k++)
+    {
+        node->min[k] = fminf(l->min[k], r->min[k]);
+        node->max[k] = fmaxf(l->max[k], r->max[k]);
+    }
+}
+
+// ------------------------------------------------------------
+// Build
+// ------------------------------------------------------------
+
+typedef struct BvhBin
+{
+    float    min[3];
+    float    max[3];
+    uint32_t count;
+} BvhBin;
+
+// Binned SAH over centroids. Returns the number of prims that go left
+// (partitioned in place), or 0 if no split beats keeping the node whole.
+static uint32_t split_sah(SceneBvh* bvh, const BvhNode* node)
+{
+    float cmin[3], cmax[3];
+    bounds_reset(cmin, cmax);
+    for(uint32_t i = 0; i < node->count; i++)
+    {
+        const float* s = bvh->spheres[node->first + i];
+        for(int k = 0; k < 3; k++)
+        {
+            cmin[k] = fminf(cmin[k], s[k]);
+            cmax[k] = fmaxf(cmax[k], s[k]);
+        }
+    }
+
+    float    best_cost = (float)node->count * bounds_area(node->min, node->max);
+    int      best_axis = -1;
+    uint32_t best_bin  = 0;
+
+    for(int axis = 0; axis < 3; axis++)
+    {
+        float extent = cmax[axis] - cmin[axis];
+        if(extent <= 1e-6f)
+            continue;
+
+        BvhBin bins[SCENE_BVH_BINS];
+        for(uint32_t b = 0; b < SCENE_BVH_BINS; b++)
+        {
+            bounds_reset(bins[b].min, bins[b].max);
+            bins[b].count = 0;
+        }
+
+        float scale = (float)SCENE_BVH_BINS / extent;
+        for(uint32_t i = 0; i < node->count; i++)
+        {
+            const float* s = bvh->spheres[node->first + i];
+            uint32_t     b = MIN((uint32_t)((s[axis] - cmin[axis]) * scale), SCENE_BVH_BINS - 1u);
+            bounds_add_sphere(bins[b].min, bins[b].max, s);
+            bins[b].count++;
+        }
+
+        // sweep from the right to get the right-side area for every split plane
+        float    right_area[SCENE_BVH_BINS];
+        uint32_t right_count[SCENE_BVH_BINS];
+        float    rmin[3], rmax[3];
+        uint32_t rc = 0;
+        bounds_reset(rmin, rmax);
+        for(uint32_t b = SCENE_BVH_BINS - 1u; b > 0; b--)
+        {
+            for(int k = 0; k < 3; k++)
+            {
+                rmin[k] = fminf(rmin[k], bins[b].min[k]);
+                rmax[k] = fmaxf(rmax[k], bins[b].max[k]);
+            }
+            rc += bins[b].count;
+            right_area[b]  = bounds_area(rmin, rmax);
+            right_count[b] = rc;
+        }
+
+        float    lmin[3], lmax[3];
+        uint32_t lc = 0;
+        bounds_reset(lmin, lmax);
+        for(uint32_t b = 0; b < SCENE_BVH_BINS - 1u; b++)
+        {
+            for(int k = 0; k < 3; k++)
+            {
+                lmin[k] = fminf(lmin[k], bins[b].min[k]);
+                lmax[k] = fmaxf(lmax[k], bins[b].max[k]);
+            }
+            lc += bins[b].count;
+            if(lc == 0 || right_count[b + 1] == 0)
+                continue;
+
+            float cost = (float)lc * bounds_area(lmin, lmax) + (float)right_count[b + 1] * right_area[b + 1];
+            if(cost < best_cost)
+            {
+                best_cost = cost;
+                best_axis = axis;
+                best_bin  = b;
+            }
+        }
+    }
+
+    if(best_axis < 0)
+        return 0;
+
+    float     scale   = (float)SCENE_BVH_BINS / (cmax[best_axis] - cmin[best_axis]);
+    uint32_t* prims   = bvh->prims + node->first;
+    vec4*     spheres = bvh->spheres + node->first;
+    uint32_t  i = 0, j = node->count;
+    while(i < j)
+    {
+        uint32_t b = MIN((uint32_t)((spheres[i][best_axis] - cmin[best_axis]) * scale), SCENE_BVH_BINS - 1u);
+        if(b <= best_bin)
+        {
+            i++;
+            continue;
+        }
+
+        j--;
+        uint32_t tp = prims[i];
+        prims[i]    = prims[j];
+        prims[j]    = tp;
+
+        vec4 ts;
+        glm_vec4_copy(spheres[i], ts);
+        glm_vec4_copy(spheres[j], spheres[i]);
+        glm_vec4_copy(ts, spheres[j]);
+    }
+
+    return (i == 0 || i == node->count) ? 0 : i;
+}
+
+void scene_bvh_destroy(SceneBvh* bvh)
+{
+    free(bvh->nodes);
+    free(bvh->parents);
+    free(bvh->prims);
+    free(bvh->spheres);
+    free(bvh->primSlot);
+    free(bvh->primLeaf);
+    memset(bvh, 0, sizeof(*bvh));
+}
+
+bool scene_bvh_build_spheres(SceneBvh* bvh, const vec4* spheres, uint32_t count)
+{
+    scene_bvh_destroy(bvh);
+    if(count == 0)
+        return true;
+
+    uint32_t max_nodes = count * 2u - 1u;
+
+    bvh->nodes    = (BvhNode*)malloc(sizeof(BvhNode) * max_nodes);
+    bvh->parents  = (uint32_t*)malloc(sizeof(uint32_t) * max_nodes);
+    bvh->prims    = (uint32_t*)malloc(sizeof(uint32_t) * count);
+    bvh->spheres  = (vec4*)malloc(sizeof(vec4) * count);
+    bvh->primSlot = (uint32_t*)malloc(sizeof(uint32_t) * count);
+    bvh->primLeaf = (uint32_t*)malloc(sizeof(uint32_t) * count);
+
+    if(!bvh->nodes || !bvh->parents || !bvh->prims || !bvh->spheres || !bvh->primSlot || !bvh->primLeaf)
+    {
+        scene_bvh_destroy(bvh);
+        return false;
+    }
+
+    memcpy(bvh->spheres, spheres, sizeof(vec4) * count);
+    for(uint32_t i = 0; i < count; i++)
+        bvh->prims[i] = i;
+    bvh->primCount = count;
+
+    BvhNode* root = &bvh->nodes[0];
+    root->first   = 0;
+    root->count   = count;
+    leaf_bounds(bvh, root);
+    bvh->parents[0] = UINT32_MAX;
+    bvh->nodeCount  = 1;
+
+    uint32_t stack[BVH_STACK_SIZE * 2];
+    uint32_t depth[BVH_STACK_SIZE * 2];
+    uint32_t sp = 0;
+    stack[sp]   = 0;
+    depth[sp++] = 0;
+
+    while(sp > 0)
+    {
+        sp--;
+        uint32_t ni = stack[sp];
+        uint32_t d  = depth[sp];
+        BvhNode* n  = &bvh->nodes[ni];
+
+        uint32_t left_count = 0;
+        if(n->count > SCENE_BVH_LEAF_SIZE)
+            left_count = (d < SCENE_BVH_SAH_DEPTH) ? split_sah(bvh, n) : n->count / 2u;
+
+        // SAH found nothing better but the node is too big for a leaf (e.g. many
+        // coincident centers): halve it so leaves stay small
+        if(left_count == 0 && n->count > SCENE_BVH_LEAF_SIZE * 4u)
+            left_count = n->count / 2u;
+
+        if(left_count == 0)
+        {
+            for(uint32_t i = n->first; i < n->first + n->count; i++)
+            {
+                bvh->primSlot[bvh->prims[i]] = i;
+                bvh->primLeaf[bvh->prims[i]] = ni;
+            }
+            continue;
+        }
+
+        uint32_t li = bvh->nodeCount;
+        bvh->nodeCount += 2;
+
+        BvhNode* l = &bvh->nodes[li];
+        BvhNode* r = &bvh->nodes[li + 1];
+        l->first   = n->first;
+        l->count   = left_count;
+        r->first   = n->first + left_count;
+        r->count   = n->count - left_count;
+        leaf_bounds(bvh, l);
+        leaf_bounds(bvh, r);
+
+        bvh->parents[li]     = ni;
+        bvh->parents[li + 1] = ni;
+
+        n->first = li;
+        n->count = 0;
+
+        stack[sp]   = li;
+        depth[sp++] = d + 1;
+        stack[sp]   = li + 1;
+        depth[sp++] = d + 1;
+    }
+
+    return true;
+}
+
+bool scene_bvh_build(SceneBvh* bvh, const Scene* scene)
+{
+    uint32_t count   = (uint32_t)arrlen(scene->draws);
+    vec4*    spheres = (vec4*)malloc(sizeof(vec4) * MAX(count, 1u));
+    if(!spheres)
+        return false;
+
+    for(uint32_t i = 0; i < count; i++)
+        scene_draw_sphere(scene, i, spheres[i]);
+
+    bool ok = scene_bvh_build_spheres(bvh, spheres, count);
+    free(spheres);
+    return ok;
+}
+
+// ------------------------------------------------------------
+// Refit
+// ------------------------------------------------------------
+
+void scene_bvh_refit(SceneBvh* bvh)
+{
+    for(uint32_t i = bvh->nodeCount; i-- > 0;)
+    {
+        BvhNode* n = &bvh->nodes[i];
+        if(n->count)
+            leaf_bounds(bvh, n);
+        else
+            interior_bounds(bvh, n);
+    }
+}
+
+void scene_bvh_update(SceneBvh* bvh, uint32_t drawIndex, const vec4 sphere)
+{
+    if(drawIndex >= bvh->primCount)
+        return;
+
+    glm_vec4_copy((float*)sphere, bvh->spheres[bvh->primSlot[drawIndex]]);
+
+    uint32_t ni = bvh->primLeaf[drawIndex];
+    while(ni != UINT32_MAX)
+    {
+        BvhNode* n   = &bvh->nodes[ni];
+        BvhNode  old = *n;
+
+        if(n->count)
+            leaf_bounds(bvh, n);
+        else
+            interior_bounds(bvh, n);
+
+        if(memcmp(old.min, n->min, sizeof(n->min)) == 0 && memcmp(old.max, n->max, sizeof(n->max)) == 0)
+            break;
+
+        ni = bvh->parents[ni];
+    }
+}
+
+// ------------------------------------------------------------
+// Queries
+// ------------------------------------------------------------
+
+// Slab test; returns the entry distance or FLT_MAX on miss.
+static float ray_aabb(const BvhNode* n, const float o[3], const float inv[3], float maxT)
+{
+    float t0 = 0.0f, t1 = maxT;
+    for(int k = 0; k < 3; k++)
+    {
+        float a = (n->min[k] - o[k]) * inv[k];
+        float b = (n->max[k] - o[k]) * inv[k];
+        t0      = fmaxf(t0, fminf(a, b));
+        t1      = fminf(t1, fmaxf(a, b));
+    }
+    return t0 <= t1 ? t0 : FLT_MAX;
+}
+
+bool scene_bvh_raycast(const SceneBvh* bvh, const vec3 origin, const vec3 dir, float maxT, uint32_t* outDraw, float* outT)
+{
+    if(bvh->nodeCount == 0)
+        return false;
+
+    float inv[3];
+    for(int k = 0; k < 3; k++)
+        inv[k] = 1.0f / (fabsf(dir[k]) > 1e-12f ? dir[k] : copysignf(1e-12f, dir[k]));
+
+    float    best_t    = maxT;
+    uint32_t best_draw = UINT32_MAX;
+
+    uint32_t stack[BVH_STACK_SIZE];
+    uint32_t sp = 0;
+    if(ray_aabb(&bvh->nodes[0], origin, inv, best_t) == FLT_MAX)
+        return false;
+    stack[sp++] = 0;
+
+    while(sp > 0)
+    {
+        const BvhNode* n = &bvh->nodes[stack[--sp]];
+
+        if(n->count)
+        {
+            for(uint32_t i = 0; i < n->count; i++)
+            {
+                uint32_t     e = n->first + i;
+                const float* s = bvh->spheres[e];
+
+                float oc[3] = {origin[0] - s[0], origin[1] - s[1], origin[2] - s[2]};
+                float b     = oc[0] * dir[0] + oc[1] * dir[1] + oc[2] * dir[2];
+                float c     = oc[0] * oc[0] + oc[1] * oc[1] + oc[2] * oc[2] - s[3] * s[3];
+                float disc  = b * b - c;
+                if(disc < 0.0f || (c > 0.0f && b > 0.0f))
+                    continue;
+
+                float t = fmaxf(-b - sqrtf(disc), 0.0f);  // 0 when the origin is inside
+                if(t < best_t)
+                {
+                    best_t    = t;
+                    best_draw = bvh->prims[e];
+                }
+            }
+            continue;
+        }
+
+        // push the farther child first so the nearer one is visited first
+        uint32_t li = n->first, ri = n->first + 1;
+        float    tl = ray_aabb(&bvh->nodes[li], origin, inv, best_t);
+        float    tr = ray_aabb(&bvh->nodes[ri], origin, inv, best_t);
+
+        if(tl > tr)
+        {
+            uint32_t ti = li;
+            float    tt = tl;
+            li = ri;
+            tl = tr;
+            ri = ti;
+            tr = tt;
+        }
+        if(tr != FLT_MAX)
+            stack[sp++] = ri;
+        if(tl != FLT_MAX)
+            stack[sp++] = li;
+    }
+
+    if(best_draw == UINT32_MAX)
+        return false;
+
+    if(outDraw)
+        *outDraw = best_draw;
+    if(outT)
+        *outT = best_t;
+    return true;
+}
+
+uint32_t scene_bvh_query_sphere(const SceneBvh* bvh, const vec3 center, float radius, uint32_t* out, uint32_t maxOut)
+{
+    if(bvh->nodeCount == 0)
+        return 0;
+
+    uint32_t written = 0;
+    uint32_t stack[BVH_STACK_SIZE];
+    uint32_t sp = 0;
+    stack[sp++] = 0;
+
+    while(sp > 0 && written < maxOut)
+    {
+        const BvhNode* n = &bvh->nodes[stack[--sp]];
+
+        float d2 = 0.0f;
+        for(int k = 0; k < 3; k++)
+        {
+            float v = fmaxf(fmaxf(n->min[k] - center[k], 0.0f), center[k] - n->max[k]);
+            d2 += v * v;
+        }
+        if(d2 > radius * radius)
+            continue;
+
+        if(n->count == 0)
+        {
+            stack[sp++] = n->first + 1;
+            stack[sp++] = n->first;
+            continue;
+        }
+
+        for(uint32_t i = 0; i < n->count && written < maxOut; i++)
+        {
+            const float* s  = bvh->spheres[n->first + i];
+            float        dx = s[0] - center[0], dy = s[1] - center[1], dz = s[2] - center[2];
+            float        rr = s[3] + radius;
+            if(dx * dx + dy * dy + dz * dz <= rr * rr)
+                out[written++] = bvh->prims[n->first + i];
+        }
+    }
+
+    return written;
+}
+
+uint32_t scene_bvh_query_frustum(const SceneBvh* bvh, const vec4 planes[6], uint32_t* out, uint32_t maxOut)
+{
+    if(bvh->nodeCount == 0)
+        return 0;
+
+    uint32_t written = 0;
+    uint32_t stack[BVH_STACK_SIZE];
+    bool     inside[BVH_STACK_SIZE];  // every plane already passed: skip the tests below
+    uint32_t sp = 0;
+    stack[sp]    = 0;
+    inside[sp++] = false;
+
+    while(sp > 0 && written < maxOut)
+    {
+        sp--;
+        const BvhNode* n  = &bvh->nodes[stack[sp]];
+        bool           in = inside[sp];
+
+        if(!in)
+        {
+            bool culled = false;
+            in          = true;
+            for(int p = 0; p < 6 && !culled; p++)
+            {
+                const float* pl = planes[p];
+
+                // farthest corner along the normal decides culling, nearest decides containment
+                float far_d  = pl[3];
+                float near_d = pl[3];
+                for(int k = 0; k < 3; k++)
+                {
+                    far_d += pl[k] * (pl[k] >= 0.0f ? n->max[k] : n->min[k]);
+                    near_d += pl[k] * (pl[k] >= 0.0f ? n->min[k] : n->max[k]);
+                }
+                culled = far_d < 0.0f;
+                in     = in && near_d >= 0.0f;
+            }
+            if(culled)
+                continue;
+        }
+
+        if(n->count == 0)
+        {
+            stack[sp]    = n->first + 1;
+            inside[sp++] = in;
+            stack[sp]    = n->first;
+            inside[sp++] = in;
+            continue;
+        }
+
+        for(uint32_t i = 0; i < n->count && written < maxOut; i++)
+        {
+            const float* s       = bvh->spheres[n->first + i];
+            bool         visible = true;
+
+            for(int p = 0; p < 6 && visible && !in; p++)
+                visible = planes[p][0] * s[0] + planes[p][1] * s[1] + planes[p][2] * s[2] + planes[p][3] >= -s[3];
+
+            if(visible)
+                out[written++] = bvh->prims[n->first + i];
+        }
+    }
+
+    return written;
+}
+
+void scene_bvh_frustum_planes(const mat4 view, float tanHalfX, float tanHalfY, float znear, float zfar, vec4 out[6])
+{
+    // view space, camera looking down -Z, normals pointing inside
+    float ix = 1.0f / sqrtf(1.0f + tanHalfX * tanHalfX);
+    float iy = 1.0f / sqrtf(1.0f + tanHalfY * tanHalfY);
+
+    vec4 vs[6] = {
+        {ix, 0.0f, -tanHalfX * ix, 0.0f},   // left
+        {-ix, 0.0f, -tanHalfX * ix, 0.0f},  // right
+        {0.0f, iy, -tanHalfY * iy, 0.0f},   // bottom
+        {0.0f, -iy, -tanHalfY * iy, 0.0f},  // top
+        {0.0f, 0.0f, -1.0f, -znear},        // near
+        {0.0f, 0.0f, 1.0f, zfar},           // far
+    };
+
+    // plane_world = plane_view * view (view is rigid, so normals stay unit length)
+    for(int p = 0; p < 6; p++)
+    {
+        for(int j = 0; j < 4; j++)
+            out[p][j] = vs[p][0] * view[j][0] + vs[p][1] * view[j][1] + vs[p][2] * view[j][2];
+        out[p][3] += vs[p][3];
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "scene.h"
+
+// CPU BVH over world-space bounding spheres of scene draws, for picking,
+// CPU pre-culling and spatial queries.
+//
+// Built with binned SAH over sphere centroids. Nodes are stored depth-first
+// with children adjacent, so a child index is always greater than its
+// parent's and a full refit is one reverse pass. Moving a few draws refits
+// only the path from their leaf to the root.
+
+#define SCENE_BVH_LEAF_SIZE 4u
+#define SCENE_BVH_BINS 12u
+
+typedef struct BvhNode
+{
+    float    min[3];
+    uint32_t first;  // leaf: first entry in prims, interior: left child (right = first + 1)
+    float    max[3];
+    uint32_t count;  // leaf: prim count, interior: 0
+} BvhNode;
+
+typedef struct SceneBvh
+{
+    BvhNode*  nodes;
+    uint32_t  nodeCount;
+    uint32_t* parents;  // per node, UINT32_MAX for the root
+
+    // Leaf entries: leaf nodes cover [first, first + count). Spheres are kept in
+    // entry order so builds, refits and queries stream through memory.
+    uint32_t* prims;    // draw index per entry
+    vec4*     spheres;  // per entry: xyz world center, w radius
+    uint32_t  primCount;
+
+    uint32_t* primSlot;  // entry per draw index
+    uint32_t* primLeaf;  // leaf node per draw index
+} SceneBvh;
+
+// World bounding sphere of a draw, same transform as cull.comp.
+void scene_draw_sphere(const Scene* scene, uint32_t drawIndex, vec4 out);
+
+bool scene_bvh_build(SceneBvh* bvh, const Scene* scene);
+bool scene_bvh_build_spheres(SceneBvh* bvh, const vec4* spheres, uint32_t count);
+void scene_bvh_destroy(SceneBvh* bvh);
+
+// Moves one draw and refits its leaf-to-root path, stopping once a node's
+// bounds no longer change.
+void scene_bvh_update(SceneBvh* bvh, uint32_t drawIndex, const vec4 sphere);
+
+// Refits every node from bvh->spheres (after writing many entries at once).
+void scene_bvh_refit(SceneBvh* bvh);
+
+// Nearest sphere hit along dir (normalized) within maxT. Returns false on miss.
+bool scene_bvh_raycast(const SceneBvh* bvh, const vec3 origin, const vec3 dir, float maxT, uint32_t* outDraw, float* outT);
+
+// Draws whose sphere overlaps the query sphere / lies at least partly inside
+// the planes (xyz normal pointing inside, w offset). Writes up to maxOut draw
+// indices and returns the number written.
+uint32_t scene_bvh_query_sphere(const SceneBvh* bvh, const vec3 center, float radius, uint32_t* out, uint32_t maxOut);
+uint32_t scene_bvh_query_frustum(const SceneBvh* bvh, const vec4 planes[6], uint32_t* out, uint32_t maxOut);
+
+// World-space planes for the symmetric frustum cull.comp tests. Normalized, so
+// the pre-cull never rejects a draw the GPU test would keep.
+void scene_bvh_frustum_planes(const mat4 view, float tanHalfX, float tanHalfY, float znear, float zfar, vec4 out[6]);
@@ -0,0 +1,697 @@
+#include "scene_cache.h"
+#include "geometry_codec.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static bool g_scene_cache_enabled     = true;
+static bool g_scene_cache_compression = false;
+
+void scene_cache_set_enabled(bool enabled)
+{
+    g_scene_cache_enabled = enabled;
+}
+
+bool scene_cache_enabled(void)
+{
+    return g_scene_cache_enabled;
+}
+
+void scene_cache_set_compression(bool enabled)
+{
+    g_scene_cache_compression = enabled;
+}
+
+bool scene_cache_compression(void)
+{
+    return g_scene_cache_compression;
+}
+
+SceneImportBase scene_import_base(const Scene* scene)
+{
+    SceneImportBase b = {0};
+    b.vertex   = scene_geometry_vertex_count(&scene->geometry);
+    b.index    = scene_geometry_index_count(&scene->geometry);
+    b.mesh     = (uint32_t)arrlen(scene->geometry.meshes);
+    b.material = (uint32_t)arrlen(scene->materials);
+    b.draw     = (uint32_t)arrlen(scene->draws);
+    b.texture  = (uint32_t)arrlen(scene->texturePaths);
+    b.meshlet   = (uint32_t)arrlen(scene->geometry.meshlets);
+    b.animation = (uint32_t)arrlen(scene->animations);
+    return b;
+}
+
+// ------------------------------------------------------------
+// File mapping
+// ------------------------------------------------------------
+
+typedef struct MappedFile
+{
+    const uint8_t* data;
+    size_t         size;
+} MappedFile;
+
+static bool map_file(const char* path, MappedFile* out)
+{
+    memset(out, 0, sizeof(*out));
+
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+        return false;
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    void* p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(p == MAP_FAILED)
+        return false;
+
+    madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    out->data = (const uint8_t*)p;
+    out->size = (size_t)st.st_size;
+    return true;
+}
+
+static void unmap_file(MappedFile* f)
+{
+    if(f->data)
+        munmap((void*)f->data, f->size);
+    memset(f, 0, sizeof(*f));
+}
+
+bool scene_cache_hash_file(const char* path, uint64_t* out_hash)
+{
+    MappedFile f;
+    if(!path || !map_file(path, &f))
+        return false;
+
+    *out_hash = hash64_bytes(f.data, f.size);
+    unmap_file(&f);
+    return true;
+}
+
+static uint64_t hash_combine(uint64_t a, uint64_t b)
+{
+    uint64_t v[2] = {a, b};
+    return hash64_bytes(v, sizeof(v));
+}
+
+// data: URIs and the GLB binary chunk are already part of the source bytes
+static bool uri_is_external(const char* uri)
+{
+    return uri && uri[0] && strncmp(uri, "data:", 5) != 0 && !strstr(uri, "://");
+}
+
+// uri relative to the directory of source_path, percent-decoded like cgltf_load_buffers does
+static bool resolve_uri(const char* source_path, const char* uri, char* out, size_t cap)
+{
+    const char* slash = strrchr(source_path, '/');
+    size_t      dir   = slash ? (size_t)(slash - source_path) + 1 : 0;
+    size_t      n     = strlen(uri);
+    if(dir + n + 1 > cap)
+        return false;
+
+    memcpy(out, source_path, dir);
+    memcpy(out + dir, uri, n + 1);
+    cgltf_decode_uri(out + dir);
+    return true;
+}
+
+bool scene_cache_hash_source(const char* path, uint64_t* out_hash)
+{
+    MappedFile f;
+    if(!path || !map_file(path, &f))
+        return false;
+
+    uint64_t hash = hash64_bytes(f.data, f.size);
+
+    cgltf_options options = {0};
+    cgltf_data*   data    = NULL;
+    if(cgltf_parse(&options, f.data, f.size, &data) != cgltf_result_success)
+    {
+        // the import will fail the same way; nothing worth caching
+        unmap_file(&f);
+        return false;
+    }
+
+    bool ok = true;
+    char dep[1024];
+
+    // buffers feed the vertices and indices: hash their bytes
+    for(cgltf_size i = 0; ok && i < data->buffers_count; i++)
+    {
+        const char* uri = data->buffers[i].uri;
+        if(!uri_is_external(uri))
+            continue;
+
+        uint64_t dep_hash = 0;
+        ok   = resolve_uri(path, uri, dep, sizeof(dep)) && scene_cache_hash_file(dep, &dep_hash);
+        hash = hash_combine(hash, dep_hash);
+    }
+
+    // only image paths end up in the cache, so size + mtime is enough to
+    // notice a replaced file; a missing image is not an error here
+    for(cgltf_size i = 0; ok && i < data->images_count; i++)
+    {
+        const char* uri = data->images[i].uri;
+        if(!uri_is_external(uri) || !resolve_uri(path, uri, dep, sizeof(dep)))
+            continue;
+
+        struct stat st;
+        uint64_t    stamp[2] = {0, 0};
+        if(stat(dep, &st) == 0)
+        {
+            stamp[0] = (uint64_t)st.st_size;
+#if defined(__APPLE__)
+            stamp[1] = (uint64_t)st.st_mtimespec.tv_sec * 1000000000ull + (uint64_t)st.st_mtimespec.tv_nsec;
+#else
+            stamp[1] = (uint64_t)st.st_mtim.tv_sec * 1000000000ull + (uint64_t)st.st_mtim.tv_nsec;
+#endif
+        }
+        hash = hash_combine(hash, hash64_bytes(stamp, sizeof(stamp)));
+    }
+
+    cgltf_free(data);
+    unmap_file(&f);
+
+    if(ok)
+        *out_hash = hash;
+    return ok;
+}
+
+char* scene_cache_path(const char* source_path)
+{
+    if(!source_path)
+        return NULL;
+
+    size_t n   = strlen(source_path);
+    size_t e   = strlen(SCENE_CACHE_EXT);
+    char*  out = (char*)malloc(n + e + 1);
+    if(!out)
+        return NULL;
+
+    memcpy(out, source_path, n);
+    memcpy(out + n, SCENE_CACHE_EXT, e + 1);
+    return out;
+}
+
+// ------------------------------------------------------------
+// Index rebasing
+// ------------------------------------------------------------
+// Material texture slots and draw material indices use 0 for "none", so the
+// cache stores (index - base + 1) for real entries and keeps 0 as-is.
+
+static inline int rel_texture(int t, uint32_t base)
+{
+    return t > 0 ? t - (int)base + 1 : 0;
+}
+
+static inline int abs_texture(int t, uint32_t base)
+{
+    return t > 0 ? t - 1 + (int)base : 0;
+}
+
+static inline uint32_t rel_material(uint32_t m, uint32_t base)
+{
+    return m > 0 ? m - base + 1u : 0u;
+}
+
+static inline uint32_t abs_material(uint32_t m, uint32_t base)
+{
+    return m > 0 ? m - 1u + base : 0u;
+}
+
+static void material_rebase(Material* m, bool to_abs, uint32_t base)
+{
+    int (*fn)(int, uint32_t) = to_abs ? abs_texture : rel_texture;
+
+    m->albedoTexture    = fn(m->albedoTexture, base);
+    m->normalTexture    = fn(m->normalTexture, base);
+    m->specularTexture  = fn(m->specularTexture, base);
+    m->emissiveTexture  = fn(m->emissiveTexture, base);
+    m->occlusionTexture = fn(m->occlusionTexture, base);
+}
+
+// ------------------------------------------------------------
+// Write
+// ------------------------------------------------------------
+
+static uint64_t align16(uint64_t v)
+{
+    return (v + 15u) & ~(uint64_t)15u;
+}
+
+static bool write_at(FILE* f, uint64_t offset, const void* data, size_t size)
+{
+    if(size == 0)
+        return true;
+    if(fseek(f, (long)offset, SEEK_SET) != 0)
+        return false;
+    return fwrite(data, 1, size, f) == size;
+}
+
+bool scene_cache_write(const char* cache_path, uint64_t source_hash, uint32_t import_flags, const Scene* scene,
+                       const SceneImportBase* base, const SceneImportExtras* extras, JobPool* pool)
+{
+    if(!cache_path || !scene || !base)
+        return false;
+
+    // imports always land in the plain arrays, never in packed geometry
+    if(scene->geometry.packed.streams)
+        return false;
+
+    SceneImportBase end = scene_import_base(scene);
+
+    SceneCacheHeader h = {0};
+    h.magic            = SCENE_CACHE_MAGIC;
+    h.version          = SCENE_CACHE_VERSION;
+    h.source_hash      = source_hash;
+    h.vertex_stride    = sizeof(VertexPacked);
+    h.mesh_stride      = sizeof(Mesh);
+    h.material_stride  = sizeof(Material);
+    h.draw_stride      = sizeof(MeshDraw);
+    h.meshlet_stride   = sizeof(Meshlet);
+    h.animation_stride = sizeof(SceneCacheAnimation);
+    h.keyframe_stride  = sizeof(Keyframe);
+    h.import_flags     = import_flags;
+
+    h.vertex_count    = end.vertex - base->vertex;
+    h.index_count     = end.index - base->index;
+    h.mesh_count      = end.mesh - base->mesh;
+    h.material_count  = end.material - base->material;
+    h.draw_count      = end.draw - base->draw;
+    h.texture_count   = end.texture - base->texture;
+    h.meshlet_count   = end.meshlet - base->meshlet;
+    h.animation_count = end.animation - base->animation;
+    for(uint32_t i = 0; i < h.animation_count; i++)
+        h.keyframe_count += (uint32_t)arrlen(scene->animations[base->animation + i].keyframes);
+
+    if(extras)
+    {
+        h.flags  = extras->flags;
+        h.camera = extras->camera;
+        memcpy(h.sunDirection, extras->sunDirection, sizeof(h.sunDirection));
+    }
+
+    GeometryPack pack = {0};
+    if(g_scene_cache_compression)
+    {
+        if(geometry_pack_encode(&pack, &scene->geometry, base->mesh, h.mesh_count, base->vertex, h.vertex_count,
+                                base->index, h.index_count, pool))
+        {
+            h.geometry_codec = SCENE_CACHE_CODEC_MESHOPT;
+            h.stream_count   = (uint32_t)arrlen(pack.streams);
+            h.geometry_bytes = (uint64_t)arrlen(pack.data);
+        }
+        else
+        {
+            log_warn("scene cache: geometry doesn't encode, writing it raw");
+        }
+    }
+    bool compressed = h.geometry_codec == SCENE_CACHE_CODEC_MESHOPT;
+
+    uint64_t texture_bytes = 0;
+    for(uint32_t i = 0; i < h.texture_count; i++)
+    {
+        const char* s = scene->texturePaths[base->texture + i];
+        texture_bytes += (s ? strlen(s) : 0) + 1;
+    }
+
+    uint64_t at        = align16(sizeof(SceneCacheHeader));
+    h.vertex_offset    = at;
+    at                 = align16(at + (compressed ? 0u : (uint64_t)h.vertex_count * h.vertex_stride));
+    h.index_offset     = at;
+    at                 = align16(at + (compressed ? 0u : (uint64_t)h.index_count * sizeof(uint32_t)));
+    h.mesh_offset      = at;
+    at                 = align16(at + (uint64_t)h.mesh_count * h.mesh_stride);
+    h.material_offset  = at;
+    at                 = align16(at + (uint64_t)h.material_count * h.material_stride);
+    h.draw_offset      = at;
+    at                 = align16(at + (uint64_t)h.draw_count * h.draw_stride);
+    h.meshlet_offset   = at;
+    at                 = align16(at + (uint64_t)h.meshlet_count * h.meshlet_stride);
+    h.animation_offset = at;
+    at                 = align16(at + (uint64_t)h.animation_count * h.animation_stride);
+    h.keyframe_offset  = at;
+    at                 = align16(at + (uint64_t)h.keyframe_count * h.keyframe_stride);
+    h.stream_offset    = at;
+    at                 = align16(at + (uint64_t)h.stream_count * sizeof(GeometryStream));
+    h.geometry_offset  = at;
+    at                 = align16(at + h.geometry_bytes);
+    h.texture_offset   = at;
+    h.texture_bytes    = texture_bytes;
+    h.file_size        = at + texture_bytes;
+
+    // write to a temp file and rename, so a crash never leaves a torn cache behind
+    size_t tmp_len  = strlen(cache_path) + 5;
+    char*  tmp_path = (char*)malloc(tmp_len);
+    if(!tmp_path)
+    {
+        geometry_pack_free(&pack);
+        return false;
+    }
+    snprintf(tmp_path, tmp_len, "%s.tmp", cache_path);
+
+    FILE* f = fopen(tmp_path, "wb");
+    if(!f)
+    {
+        log_warn("scene cache: can't open '%s' (errno=%d)", tmp_path, errno);
+        free(tmp_path);
+        geometry_pack_free(&pack);
+        return false;
+    }
+
+    bool ok = write_at(f, 0, &h, sizeof(h));
+    if(compressed)
+    {
+        ok = ok && write_at(f, h.stream_offset, pack.streams, (size_t)h.stream_count * sizeof(GeometryStream));
+        ok = ok && write_at(f, h.geometry_offset, pack.data, (size_t)h.geometry_bytes);
+    }
+    else
+    {
+        ok = ok && write_at(f, h.vertex_offset, &scene->geometry.vertices[base->vertex], (size_t)h.vertex_count * h.vertex_stride);
+        ok = ok && write_at(f, h.index_offset, &scene->geometry.indices[base->index], (size_t)h.index_count * sizeof(uint32_t));
+    }
+    geometry_pack_free(&pack);
+
+    for(uint32_t i = 0; ok && i < h.mesh_count; i++)
+    {
+        Mesh m = scene->geometry.meshes[base->mesh + i];
+        m.vertexOffset -= base->vertex;
+        for(uint32_t li = 0; li < m.lodCount && li < SCENE_MAX_LODS; li++)
+        {
+            m.lods[li].indexOffset -= base->index;
+            if(m.lods[li].meshletCount)
+                m.lods[li].meshletOffset -= base->meshlet;
+        }
+
+        ok = write_at(f, h.mesh_offset + (uint64_t)i * h.mesh_stride, &m, sizeof(m));
+    }
+
+    for(uint32_t i = 0; ok && i < h.material_count; i++)
+    {
+        Material m = scene->materials[base->material + i];
+        material_rebase(&m, false, base->texture);
+        ok = write_at(f, h.material_offset + (uint64_t)i * h.material_stride, &m, sizeof(m));
+    }
+
+    for(uint32_t i = 0; ok && i < h.draw_count; i++)
+    {
+        MeshDraw d = scene->draws[base->draw + i];
+        d.meshIndex -= base->mesh;
+        d.materialIndex = rel_material(d.materialIndex, base->material);
+        ok              = write_at(f, h.draw_offset + (uint64_t)i * h.draw_stride, &d, sizeof(d));
+    }
+
+    for(uint32_t i = 0; ok && i < h.meshlet_count; i++)
+    {
+        Meshlet m = scene->geometry.meshlets[base->meshlet + i];
+        m.indexOffset -= base->index;
+        ok = write_at(f, h.meshlet_offset + (uint64_t)i * h.meshlet_stride, &m, sizeof(m));
+    }
+
+    uint32_t keyframe = 0;
+    for(uint32_t i = 0; ok && i < h.animation_count; i++)
+    {
+        const Animation*    a = &scene->animations[base->animation + i];
+        SceneCacheAnimation c = {0};
+        c.draw_index          = a->drawIndex - base->draw;
+        c.keyframe_offset     = keyframe;
+        c.keyframe_count      = (uint32_t)arrlen(a->keyframes);
+        c.start_time          = a->startTime;
+        c.period              = a->period;
+
+        ok = write_at(f, h.animation_offset + (uint64_t)i * h.animation_stride, &c, sizeof(c));
+        ok = ok && write_at(f, h.keyframe_offset + (uint64_t)keyframe * h.keyframe_stride, a->keyframes,
+                            (size_t)c.keyframe_count * sizeof(Keyframe));
+        keyframe += c.keyframe_count;
+    }
+
+    if(ok && h.texture_count > 0)
+    {
+        ok = fseek(f, (long)h.texture_offset, SEEK_SET) == 0;
+        for(uint32_t i = 0; ok && i < h.texture_count; i++)
+        {
+            const char* s = scene->texturePaths[base->texture + i];
+            ok            = fwrite(s ? s : "", 1, (s ? strlen(s) : 0) + 1, f) > 0;
+        }
+    }
+
+    // without textures the last section may end short of its alignment padding
+    if(ok && fseek(f, 0, SEEK_END) == 0 && (uint64_t)ftell(f) < h.file_size)
+    {
+        uint8_t zero = 0;
+        ok           = write_at(f, h.file_size - 1u, &zero, 1);
+    }
+
+    ok = (fclose(f) == 0) && ok;
+    ok = ok && rename(tmp_path, cache_path) == 0;
+    if(!ok)
+    {
+        log_warn("scene cache: failed to write '%s'", cache_path);
+        remove(tmp_path);
+    }
+
+    free(tmp_path);
+    return ok;
+}
+
+// ------------------------------------------------------------
+// Load
+// ------------------------------------------------------------
+
+static bool section_ok(const SceneCacheHeader* h, uint64_t offset, uint64_t count, uint64_t stride)
+{
+    return offset <= h->file_size && count * stride <= h->file_size - offset;
+}
+
+static bool header_ok(const SceneCacheHeader* h, size_t file_size, uint64_t source_hash, uint32_t import_flags)
+{
+    if(h->magic != SCENE_CACHE_MAGIC || h->version != SCENE_CACHE_VERSION || h->source_hash != source_hash)
+        return false;
+
+    if(h->import_flags != import_flags)
+        return false;
+
+    if(h->vertex_stride != sizeof(VertexPacked) || h->mesh_stride != sizeof(Mesh) || h->material_stride != sizeof(Material)
+       || h->draw_stride != sizeof(MeshDraw) || h->meshlet_stride != sizeof(Meshlet)
+       || h->animation_stride != sizeof(SceneCacheAnimation) || h->keyframe_stride != sizeof(Keyframe))
+        return false;
+
+    if(h->file_size != file_size)
+        return false;
+
+    bool geometry_ok;
+    if(h->geometry_codec == SCENE_CACHE_CODEC_MESHOPT)
+        geometry_ok = (h->stream_offset & 15u) == 0 && section_ok(h, h->stream_offset, h->stream_count, sizeof(GeometryStream))
+                      && section_ok(h, h->geometry_offset, h->geometry_bytes, 1);
+    else
+        geometry_ok = h->geometry_codec == SCENE_CACHE_CODEC_RAW && h->stream_count == 0
+                      && section_ok(h, h->vertex_offset, h->vertex_count, h->vertex_stride)
+                      && section_ok(h, h->index_offset, h->index_count, sizeof(uint32_t));
+
+    return geometry_ok
+           && section_ok(h, h->mesh_offset, h->mesh_count, h->mesh_stride)
+           && section_ok(h, h->material_offset, h->material_count, h->material_stride)
+           && section_ok(h, h->draw_offset, h->draw_count, h->draw_stride)
+           && section_ok(h, h->meshlet_offset, h->meshlet_count, h->meshlet_stride)
+           && section_ok(h, h->animation_offset, h->animation_count, h->animation_stride)
+           && section_ok(h, h->keyframe_offset, h->keyframe_count, h->keyframe_stride)
+           && section_ok(h, h->texture_offset, h->texture_bytes, 1);
+}
+
+bool scene_cache_load(const char* cache_path, uint64_t source_hash, uint32_t import_flags, Scene* scene,
+                      SceneImportExtras* out_extras, bool keep_packed, JobPool* pool)
+{
+    if(!cache_path || !scene)
+        return false;
+
+    MappedFile f;
+    if(!map_file(cache_path, &f))
+        return false;
+
+    if(f.size < sizeof(SceneCacheHeader))
+    {
+        unmap_file(&f);
+        return false;
+    }
+
+    SceneCacheHeader h;
+    memcpy(&h, f.data, sizeof(h));
+    if(!header_ok(&h, f.size, source_hash, import_flags))
+    {
+        unmap_file(&f);
+        return false;
+    }
+
+    // texture strings must be exactly texture_count NUL terminated entries
+    const char* strings = (const char*)(f.data + h.texture_offset);
+    uint32_t    nul     = 0;
+    for(uint64_t i = 0; i < h.texture_bytes; i++)
+        nul += strings[i] == '\0';
+    if(nul != h.texture_count || (h.texture_bytes > 0 && strings[h.texture_bytes - 1] != '\0'))
+    {
+        unmap_file(&f);
+        return false;
+    }
+
+    // every animation must target an imported draw and own keys inside the keyframe section
+    const SceneCacheAnimation* anims = (const SceneCacheAnimation*)(f.data + h.animation_offset);
+    for(uint32_t i = 0; i < h.animation_count; i++)
+    {
+        if(anims[i].draw_index >= h.draw_count || anims[i].keyframe_offset > h.keyframe_count
+           || anims[i].keyframe_count > h.keyframe_count - anims[i].keyframe_offset)
+        {
+            unmap_file(&f);
+            return false;
+        }
+    }
+
+    const GeometryStream* streams    = (const GeometryStream*)(f.data + h.stream_offset);
+    bool                  compressed = h.geometry_codec == SCENE_CACHE_CODEC_MESHOPT;
+    if(compressed && !geometry_streams_valid(streams, h.stream_count, h.geometry_bytes, h.vertex_count, h.index_count))
+    {
+        unmap_file(&f);
+        return false;
+    }
+
+    Geometry* geom = &scene->geometry;
+    bool      pack = compressed && keep_packed && arrlen(geom->vertices) == 0 && arrlen(geom->indices) == 0;
+
+    // appending plain arrays needs the existing geometry plain too
+    if(!pack && !geometry_unpack(geom, pool))
+    {
+        unmap_file(&f);
+        return false;
+    }
+
+    SceneImportBase base = scene_import_base(scene);
+
+    if(pack)
+    {
+        geometry_pack_append(&geom->packed, streams, h.stream_count, f.data + h.geometry_offset, h.geometry_bytes,
+                             h.vertex_count, h.index_count);
+    }
+    else if(compressed)
+    {
+        // decoded in place: the arrays are the only copy that is ever written
+        arrsetlen(geom->vertices, base.vertex + h.vertex_count);
+        arrsetlen(geom->indices, base.index + h.index_count);
+        if(!geometry_pack_decode(streams, h.stream_count, f.data + h.geometry_offset, geom->vertices + base.vertex,
+                                 geom->indices + base.index, pool))
+        {
+            log_warn("scene cache: corrupt geometry in '%s'", cache_path);
+            arrsetlen(geom->vertices, base.vertex);
+            arrsetlen(geom->indices, base.index);
+            unmap_file(&f);
+            return false;
+        }
+    }
+    else
+    {
+        // bulk sections: one memcpy each, no per-element work
+        if(h.vertex_count)
+        {
+            arrsetlen(geom->vertices, base.vertex + h.vertex_count);
+            memcpy(&geom->vertices[base.vertex], f.data + h.vertex_offset, (size_t)h.vertex_count * h.vertex_stride);
+        }
+
+        if(h.index_count)
+        {
+            arrsetlen(geom->indices, base.index + h.index_count);
+            memcpy(&geom->indices[base.index], f.data + h.index_offset, (size_t)h.index_count * sizeof(uint32_t));
+        }
+    }
+
+    if(h.mesh_count)
+    {
+        arrsetlen(scene->geometry.meshes, base.mesh + h.mesh_count);
+        Mesh* meshes = &scene->geometry.meshes[base.mesh];
+        memcpy(meshes, f.data + h.mesh_offset, (size_t)h.mesh_count * h.mesh_stride);
+        for(uint32_t i = 0; i < h.mesh_count; i++)
+        {
+            meshes[i].vertexOffset += base.vertex;
+            for(uint32_t li = 0; li < meshes[i].lodCount && li < SCENE_MAX_LODS; li++)
+            {
+                meshes[i].lods[li].indexOffset += base.index;
+                if(meshes[i].lods[li].meshletCount)
+                    meshes[i].lods[li].meshletOffset += base.meshlet;
+            }
+        }
+    }
+
+    if(h.meshlet_count)
+    {
+        arrsetlen(scene->geometry.meshlets, base.meshlet + h.meshlet_count);
+        Meshlet* meshlets = &scene->geometry.meshlets[base.meshlet];
+        memcpy(meshlets, f.data + h.meshlet_offset, (size_t)h.meshlet_count * h.meshlet_stride);
+        for(uint32_t i = 0; i < h.meshlet_count; i++)
+            meshlets[i].indexOffset += base.index;
+    }
+
+    if(h.material_count)
+    {
+        arrsetlen(scene->materials, base.material + h.material_count);
+        Material* mats = &scene->materials[base.material];
+        memcpy(mats, f.data + h.material_offset, (size_t)h.material_count * h.material_stride);
+        for(uint32_t i = 0; i < h.material_count; i++)
+            material_rebase(&mats[i], true, base.texture);
+    }
+
+    if(h.draw_count)
+    {
+        arrsetlen(scene->draws, base.draw + h.draw_count);
+        MeshDraw* draws = &scene->draws[base.draw];
+        memcpy(draws, f.data + h.draw_offset, (size_t)h.draw_count * h.draw_stride);
+        for(uint32_t i = 0; i < h.draw_count; i++)
+        {
+            draws[i].meshIndex += base.mesh;
+            draws[i].materialIndex = abs_material(draws[i].materialIndex, base.material);
+        }
+    }
+
+    const Keyframe* keys = (const Keyframe*)(f.data + h.keyframe_offset);
+    for(uint32_t i = 0; i < h.animation_count; i++)
+    {
+        Animation a = {0};
+        a.drawIndex = base.draw + anims[i].draw_index;
+        a.startTime = anims[i].start_time;
+        a.period    = anims[i].period;
+        arrsetlen(a.keyframes, anims[i].keyframe_count);
+        memcpy(a.keyframes, keys + anims[i].keyframe_offset, sizeof(Keyframe) * anims[i].keyframe_count);
+        arrpush(scene->animations, a);
+    }
+
+    const char* s = strings;
+    for(uint32_t i = 0; i < h.texture_count; i++)
+    {
+        size_t n   = strlen(s);
+        char*  dup = (char*)malloc(n + 1);
+        if(dup)
+            memcpy(dup, s, n + 1);
+        arrpush(scene->texturePaths, dup);
+        s += n + 1;
+    }
+
+    if(out_extras)
+    {
+        out_extras->flags  = h.flags;
+        out_extras->camera = h.camera;
+        memcpy(out_extras->sunDirection, h.sunDirection, sizeof(h.sunDirection));
+    }
+
+    unmap_file(&f);
+    return true;
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "scene.h"
+#include "job_pool.h"
+
+// Binary scene cache for scene_load_gltf.
+//
+// The cache file sits next to the source ("<path>.scache") and holds the fully
+// processed output of one glTF import: remapped/optimized vertices, indices with
+// the LOD chain, meshes, meshlets, materials, draws, animations and texture
+// paths. It is keyed by scene_cache_hash_source: the xxHash64 of the source
+// file bytes and of every external buffer it references, plus the size and
+// mtime of its external images. Editing the .gltf/.glb, its .bin files or
+// swapping an image invalidates it.
+//
+// Import settings that change the output (SCENE_IMPORT_*) are stored too; a
+// cache written with different settings is treated as a miss.
+//
+// Offsets and indices are stored relative to the import (the scene may already
+// hold other glTFs), and rebased when the cache is mapped back in.
+//
+// With compression on (scene_cache_set_compression) vertices and indices are
+// stored as meshopt-encoded streams, one per mesh (see geometry_codec.h), instead
+// of raw sections. That is a storage choice, not an import setting: either kind
+// of cache loads regardless of the current setting.
+
+// Bump SCENE_CACHE_VERSION with any change to what an import produces (LOD
+// generation, vertex processing, meshlets), not just the file layout: the
+// header can't tell an old LOD chain from a new one.
+#define SCENE_CACHE_MAGIC   0x48435353u  // 'SSCH'
+#define SCENE_CACHE_VERSION 5u
+#define SCENE_CACHE_EXT     ".scache"
+
+enum
+{
+    SCENE_CACHE_HAS_CAMERA = 1u << 0,
+    SCENE_CACHE_HAS_SUN    = 1u << 1,
+};
+
+enum
+{
+    SCENE_IMPORT_MESHLETS = 1u << 0,
+};
+
+enum
+{
+    SCENE_CACHE_CODEC_RAW     = 0,
+    SCENE_CACHE_CODEC_MESHOPT = 1,  // vertex/index sections empty, geometry streams instead
+};
+
+// Scene.animations entry; its keys are keyframe_count Keyframes starting at
+// keyframe_offset in the keyframe section.
+typedef struct SceneCacheAnimation
+{
+    uint32_t draw_index;  // relative to the import
+    uint32_t keyframe_offset;
+    uint32_t keyframe_count;
+    float    start_time;
+    float    period;
+    uint32_t pad[3];
+} SceneCacheAnimation;
+
+typedef struct SceneCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t source_hash;
+
+    // struct sizes, so a layout change without a version bump still misses
+    uint32_t vertex_stride;
+    uint32_t mesh_stride;
+    uint32_t material_stride;
+    uint32_t draw_stride;
+    uint32_t meshlet_stride;
+    uint32_t animation_stride;
+    uint32_t keyframe_stride;
+    uint32_t import_flags;  // SCENE_IMPORT_*
+
+    uint32_t vertex_count;
+    uint32_t index_count;
+    uint32_t mesh_count;
+    uint32_t material_count;
+    uint32_t draw_count;
+    uint32_t texture_count;
+    uint32_t meshlet_count;
+    uint32_t animation_count;
+    uint32_t keyframe_count;
+    uint32_t flags;
+    uint32_t geometry_codec;  // SCENE_CACHE_CODEC_*
+    uint32_t stream_count;
+
+    // byte offsets from the start of the file
+    uint64_t vertex_offset;
+    uint64_t index_offset;
+    uint64_t mesh_offset;
+    uint64_t material_offset;
+    uint64_t draw_offset;
+    uint64_t meshlet_offset;
+    uint64_t animation_offset;
+    uint64_t keyframe_offset;
+    uint64_t texture_offset;  // NUL separated strings
+    uint64_t texture_bytes;
+    uint64_t stream_offset;  // GeometryStream[stream_count]
+    uint64_t geometry_offset;
+    uint64_t geometry_bytes;
+    uint64_t file_size;
+
+    Cam   camera;
+    float sunDirection[3];
+    float pad;
+} SceneCacheHeader;
+
+// Array lengths of the scene right before an import, used to rebase on load and
+// to slice out the imported range on write.
+typedef struct SceneImportBase
+{
+    uint32_t vertex;
+    uint32_t index;
+    uint32_t mesh;
+    uint32_t material;
+    uint32_t draw;
+    uint32_t texture;
+    uint32_t meshlet;
+    uint32_t animation;
+} SceneImportBase;
+
+// Scene-level data found in the glTF that is only applied to a fresh scene.
+typedef struct SceneImportExtras
+{
+    uint32_t flags;  // SCENE_CACHE_HAS_*
+    Cam      camera;
+    vec3     sunDirection;
+} SceneImportExtras;
+
+void            scene_cache_set_enabled(bool enabled);
+bool            scene_cache_enabled(void);
+void            scene_cache_set_compression(bool enabled);  // off by default
+bool            scene_cache_compression(void);
+SceneImportBase scene_import_base(const Scene* scene);
+
+// xxHash64 of the file contents (mmap'd). Returns false if the file can't be read.
+bool scene_cache_hash_file(const char* path, uint64_t* out_hash);
+
+// Cache key for a glTF: scene_cache_hash_file of the source folded with the
+// hashes of its external buffers (buffers[].uri) and the size + mtime of its
+// external images (images[].uri). Returns false if the source can't be parsed
+// or a referenced buffer can't be read.
+bool scene_cache_hash_source(const char* path, uint64_t* out_hash);
+
+// Caller frees with free().
+char* scene_cache_path(const char* source_path);
+
+// pool (may be NULL) runs the per-mesh encode when compression is on.
+bool scene_cache_write(const char* cache_path, uint64_t source_hash, uint32_t import_flags, const Scene* scene,
+                       const SceneImportBase* base, const SceneImportExtras* extras, JobPool* pool);
+
+// Appends the cached import to the scene. On failure the scene is untouched.
+// Compressed geometry is decoded on pool straight into the scene arrays, or, with
+// keep_packed and a scene whose vertices/indices are empty, appended to
+// geometry.packed still encoded.
+bool scene_cache_load(const char* cache_path, uint64_t source_hash, uint32_t import_flags, Scene* scene,
+                      SceneImportExtras* out_extras, bool keep_packed, JobPool* pool);
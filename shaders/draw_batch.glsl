@@ -0,0 +1,86 @@
+// Final draw emission with automatic instancing, shared by the stages that
+// write the indirect stream: cull.comp when meshlets are off, meshlet_cull.comp
+// otherwise. The includer declares cullData, drawCount, drawCmds and
+// indirectCmds, and defines DRAW_BATCH_BINDING as the first of the three
+// bindings declared here.
+//
+// Every index range a draw can emit has a fixed slot: mesh LOD ranges start at
+// MeshGpu.meta.w, meshlet ranges at cullData.batch.z + meshlet index. The first
+// draw landing in a slot opens a batch (one DrawIndexedCmd); draw_batch.comp
+// then sizes the batches and scatters drawIds into per-instance order, so the
+// vertex shaders fetch drawCmds.drawId[gl_InstanceIndex]. That needs a non-zero
+// firstInstance (drawIndirectFirstInstance).
+//
+// Unbatched, every draw is its own command with firstInstance = 0 and the
+// vertex shaders fetch drawCmds.drawId[gl_DrawIDARB] (GlobalUBO.drawParams.x).
+// CPU reference: meshlet_cull_batch() in meshlet_cull.c
+
+struct BatchSlot
+{
+    uint count; // draws in the slot this frame, reset by draw_batch.comp
+    uint batch; // command index, valid once count > 0
+};
+
+struct BatchEntry
+{
+    uint slot;
+    uint local; // instance index within the slot
+    uint drawId;
+};
+
+layout(std430, binding = DRAW_BATCH_BINDING) buffer BatchSlots
+{
+    BatchSlot slots[];
+} batchSlots;
+
+// slot of each batch, in command order
+layout(std430, binding = DRAW_BATCH_BINDING + 1) buffer BatchSlotIds
+{
+    uint slot[];
+} batchSlotIds;
+
+// one per emitted draw
+layout(std430, binding = DRAW_BATCH_BINDING + 2) buffer BatchEntries
+{
+    BatchEntry entries[];
+} batchEntries;
+
+void emitDraw(uint di, uint slot, uint firstIndex, uint indexCount, uint vertexOffset, bool batched)
+{
+    uint e = atomicAdd(drawCount.count, 1);
+    if (e >= cullData.counts.w)
+        return;
+
+    // keeps the indirect dispatch of draw_batch.comp's scatter pass in step
+    if ((e & 63) == 0)
+        atomicAdd(drawCount.emitDispatch.x, 1);
+
+    if (!batched)
+    {
+        drawCmds.drawId[e] = di;
+        indirectCmds.cmds[e].indexCount = indexCount;
+        indirectCmds.cmds[e].instanceCount = 1;
+        indirectCmds.cmds[e].firstIndex = firstIndex;
+        indirectCmds.cmds[e].vertexOffset = int(vertexOffset);
+        indirectCmds.cmds[e].firstInstance = 0;
+        return;
+    }
+
+    uint local = atomicAdd(batchSlots.slots[slot].count, 1);
+    batchEntries.entries[e] = BatchEntry(slot, local, di);
+
+    if (local == 0)
+    {
+        uint b = atomicAdd(drawCount.batchCount, 1);
+        if ((b & 63) == 0)
+            atomicAdd(drawCount.batchDispatch.x, 1);
+
+        batchSlots.slots[slot].batch = b;
+        batchSlotIds.slot[b] = slot;
+        indirectCmds.cmds[b].indexCount = indexCount;
+        indirectCmds.cmds[b].instanceCount = 0;
+        indirectCmds.cmds[b].firstIndex = firstIndex;
+        indirectCmds.cmds[b].vertexOffset = int(vertexOffset);
+        indirectCmds.cmds[b].firstInstance = 0;
+    }
+}
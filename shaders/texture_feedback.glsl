@@ -0,0 +1,42 @@
+#ifndef TEXTURE_FEEDBACK_GLSL
+#define TEXTURE_FEEDBACK_GLSL
+
+// Streaming feedback (texture_streamer.h): the finest mip level each bindless
+// slot was sampled at this frame, UINT_MAX when not sampled. Levels are
+// relative to the image in the slot and may be negative (magnified), stored
+// plus TEXTURE_FEEDBACK_LOD_BIAS. Needs u_textures.
+
+// Keep in sync with TEXTURE_STREAM_LOD_BIAS (texture_streamer.h).
+#define TEXTURE_FEEDBACK_LOD_BIAS 32.0
+
+// Specialization constant TEXTURE_STREAM_FEEDBACK_CONSTANT_ID: set only when a
+// TextureStreamer reads the buffer back. Off, texture_feedback() is dead code.
+layout(constant_id = 0) const bool TEXTURE_FEEDBACK = false;
+
+layout(set = 0, binding = 5, std430) buffer TextureFeedback
+{
+    uint mips[];
+} feedback_buf;
+
+// One fragment in 16 reports, which is plenty for a per-texture minimum.
+// The LOD comes from the UV derivatives rather than textureQueryLod, whose
+// level is clamped to the levels the image holds; derivatives are taken
+// before the branch.
+void texture_feedback(uint slot, vec2 uv)
+{
+    if(!TEXTURE_FEEDBACK)
+        return;
+
+    vec2 size = vec2(textureSize(u_textures[nonuniformEXT(slot)], 0));
+    vec2 dx   = dFdx(uv) * size;
+    vec2 dy   = dFdy(uv) * size;
+
+    if(((uint(gl_FragCoord.x) | uint(gl_FragCoord.y)) & 3u) != 0u)
+        return;
+
+    float lod = 0.5 * log2(max(max(dot(dx, dx), dot(dy, dy)), 1e-20));
+    lod       = clamp(floor(lod), -TEXTURE_FEEDBACK_LOD_BIAS, TEXTURE_FEEDBACK_LOD_BIAS);
+    atomicMin(feedback_buf.mips[slot], uint(lod + TEXTURE_FEEDBACK_LOD_BIAS));
+}
+
+#endif // TEXTURE_FEEDBACK_GLSL
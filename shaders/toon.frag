@@ -19,6 +19,8 @@ layout(set = 0, binding = 4, std430) readonly buffer Materials
     MaterialGpu materials[];
 } materials_buf;
 
+#include "texture_feedback.glsl"
+
 layout(location = 0) flat in uint in_drawId;
 layout(location = 1) in vec2 in_uv;
 layout(location = 2) in vec3 in_normal;
@@ -49,6 +51,7 @@ void main()
     MaterialGpu mat = materials_buf.materials[in_materialIndex];
 
     vec4 baseTex = texture(u_textures[nonuniformEXT(mat.textures.x)], in_uv);
+    texture_feedback(mat.textures.x, in_uv);
     vec4 baseColor = baseTex * mat.diffuseFactor;
 
     if(pc.params1.x > 0.5 && baseColor.a < pc.params1.y)
@@ -64,6 +64,7 @@ layout(set = 0, binding = 3, std140) uniform GlobalUBO {
     mat4 proj;
     mat4 viewproj;
     vec4 cameraPos;
+    uvec4 drawParams; // x=1: instanced commands (draw_batch.glsl)
 } g;
 
 layout(push_constant) uniform ToonPC
@@ -120,7 +121,7 @@ float getOutlineCameraFovAndDistanceFix(float positionVS_Z)
 
 void main()
 {
-    uint drawId = drawCommands.drawId[gl_DrawIDARB];
+    uint drawId = drawCommands.drawId[g.drawParams.x == 1u ? uint(gl_InstanceIndex) : uint(gl_DrawIDARB)];
     MeshDraw meshDraw = draws.draws[drawId];
 
     uint vi = gl_VertexIndex;
@@ -18,6 +18,8 @@ layout(set = 0, binding = 4, std430) readonly buffer Materials
     MaterialGpu materials[];
 } materials_buf;
 
+#include "texture_feedback.glsl"
+
 layout(location = 0) flat in uint in_drawId;
 layout(location = 1) in vec2 in_uv;
 layout(location = 2) in vec3 in_normal;
@@ -32,6 +34,7 @@ void main()
     uint texIndex = materials_buf.materials[in_materialIndex].textures.x;
 
     vec4 tex = texture(u_textures[nonuniformEXT(texIndex)], in_uv);
+    texture_feedback(texIndex, in_uv);
     vec4 diffuse = materials_buf.materials[in_materialIndex].diffuseFactor;
     vec3 n = normalize(in_normal) * 0.5 + 0.5;
     outColor = vec4(n, 1.0) * tex * diffuse;
@@ -55,6 +55,7 @@ layout(set = 0, binding = 3, std140) uniform GlobalUBO {
     mat4 proj;
     mat4 viewproj;
     vec4 cameraPos;
+    uvec4 drawParams; // x=1: instanced commands (draw_batch.glsl)
 } g;
 
 vec3 rotateQuat(vec3 v, vec4 q)
@@ -87,7 +88,7 @@ void unpackTBN(uint np, uint tp, out vec3 normal, out vec4 tangent)
 }
 void main()
 {
-    uint drawId = drawCommands.drawId[gl_DrawIDARB];
+    uint drawId = drawCommands.drawId[g.drawParams.x == 1u ? uint(gl_InstanceIndex) : uint(gl_DrawIDARB)];
     MeshDraw meshDraw = draws.draws[drawId];
 
     uint vi = gl_VertexIndex;
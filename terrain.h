@@ -2,7 +2,9 @@
 #include "vk_barrier.h"
 #include "vk_cmd.h"
 #include "vk_resources.h"
+#include "vk_upload.h"
 #include "camera.h"
+#include "proceduraltextures.h"
 #include <math.h>
 
 static const char*    TERRAIN_SAVE_PATH    = "terrain_heightmap.bin";
@@ -121,11 +123,10 @@ static bool terrain_save_heightmap(const char*              path,
     return wrote == (1 + (size_t)data_size);
 }
 
+// Reads straight into the staging ring; the copy lands in the ring's current
+// command buffer (see vk_staging.h).
 static bool terrain_load_heightmap(const char*        path,
-                                   ResourceAllocator* allocator,
-                                   VkDevice           device,
-                                   VkQueue            gfx_queue,
-                                   VkCommandPool      pool,
+                                   StagingRing*       staging,
                                    Image*             image,
                                    TerrainSaveHeader* out_header)
 {
@@ -147,35 +148,22 @@ static bool terrain_load_heightmap(const char*        path,
 
     VkDeviceSize data_size = (VkDeviceSize)out_header->res * (VkDeviceSize)out_header->res * sizeof(uint16_t);
 
-    Buffer staging = {0};
-    res_create_buffer(allocator, data_size, VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_AUTO_PREFER_HOST,
-                      VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, 0, &staging);
+    StagingAlloc slice = {0};
+    if(!staging_ring_alloc(staging, data_size, sizeof(uint16_t), &slice))
+    {
+        fclose(f);
+        return false;
+    }
 
-    if(fread(staging.mapping, 1, (size_t)data_size, f) != (size_t)data_size)
+    // a short read leaves the slice unused, the ring reclaims it with the frame
+    if(fread(slice.mapping, 1, (size_t)data_size, f) != (size_t)data_size)
     {
         fclose(f);
-        res_destroy_buffer(allocator, &staging);
         return false;
     }
     fclose(f);
-
-    VkCommandBuffer cmd = begin_one_time_cmd(device, pool);
-    image_to_transfer_dst(cmd, image);
-
-    VkBufferImageCopy region = {
-        .bufferOffset      = 0,
-        .bufferRowLength   = 0,
-        .bufferImageHeight = 0,
-        .imageSubresource = {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .mipLevel = 0, .baseArrayLayer = 0, .layerCount = 1},
-        .imageOffset = {0, 0, 0},
-        .imageExtent = {out_header->res, out_header->res, 1},
-    };
-    vkCmdCopyBufferToImage(cmd, staging.buffer, image->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-
-    image_to_sampled(cmd, image);
-    end_one_time_cmd(device, gfx_queue, pool, cmd);
-
-    res_destroy_buffer(allocator, &staging);
+    staging_ring_commit(staging, &slice, data_size);
+    staging_copy_to_image(staging, &slice, image);
     return true;
 }
 
@@ -186,9 +174,7 @@ static inline float fractf(float x)
 
 static float hash2i(int x, int y)
 {
-    uint32_t h = (uint32_t)(x * 374761393u + y * 668265263u);
-    h          = (h ^ (h >> 13u)) * 1274126177u;
-    return (h & 0x00FFFFFFu) / 16777215.0f;  // [0..1]
+    return procedural_hash2f(x, y);  // [0..1], shared with the procedural noise textures
 }
 
 static float noise2(float x, float y)
@@ -349,10 +335,7 @@ static float cpu_terrain_height_procedural(float xz_x, float xz_y, float freq, f
     return h * height_scale;
 }
 
-static void terrain_bake_base_heightmap(ResourceAllocator* allocator,
-                                        VkDevice           device,
-                                        VkQueue            gfx_queue,
-                                        VkCommandPool      pool,
+static bool terrain_bake_base_heightmap(StagingRing*       staging,
                                         Image*             base_height_image,
                                         uint32_t           res,
                                         float              map_min_x,
@@ -366,11 +349,15 @@ static void terrain_bake_base_heightmap(ResourceAllocator* allocator,
 {
     VkDeviceSize data_size = (VkDeviceSize)res * (VkDeviceSize)res * sizeof(uint16_t);
 
-    Buffer staging = {0};
-    res_create_buffer(allocator, data_size, VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_AUTO_PREFER_HOST,
-                      VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, 0, &staging);
+    // baked straight into staging, row by row (write-combined memory: never read back)
+    StagingAlloc slice = {0};
+    if(!staging_ring_alloc(staging, data_size, sizeof(uint16_t), &slice))
+    {
+        printf("[TERRAIN] No staging space for the %ux%u heightmap\n", res, res);
+        return false;
+    }
 
-    uint16_t* pixels = (uint16_t*)staging.mapping;
+    uint16_t* pixels = (uint16_t*)slice.mapping;
 
     printf("[TERRAIN] Baking base heightmap %ux%u...\n", res, res);
 
@@ -419,25 +406,10 @@ static void terrain_bake_base_heightmap(ResourceAllocator* allocator,
     }
 
     printf("[TERRAIN] Base heightmap baked, uploading to GPU...\n");
-
-    VkCommandBuffer cmd = begin_one_time_cmd(device, pool);
-    image_to_transfer_dst(cmd, base_height_image);
-
-    VkBufferImageCopy region = {
-        .bufferOffset      = 0,
-        .bufferRowLength   = 0,
-        .bufferImageHeight = 0,
-        .imageSubresource = {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .mipLevel = 0, .baseArrayLayer = 0, .layerCount = 1},
-        .imageOffset = {0, 0, 0},
-        .imageExtent = {res, res, 1},
-    };
-    vkCmdCopyBufferToImage(cmd, staging.buffer, base_height_image->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-
-    image_to_sampled(cmd, base_height_image);
-    end_one_time_cmd(device, gfx_queue, pool, cmd);
-
-    res_destroy_buffer(allocator, &staging);
-    printf("[TERRAIN] Base heightmap upload complete.\n");
+    staging_ring_commit(staging, &slice, data_size);
+    staging_copy_to_image(staging, &slice, base_height_image);
+    printf("[TERRAIN] Base heightmap upload recorded.\n");
+    return true;
 }
 
 
@@ -626,10 +598,9 @@ static void terrain_generate_grid(uint32_t        grid_w,
     *out_icount = icount;
 }
 
+// verts / inds must outlive the batch submit.
 static void terrain_upload_to_gpu(ResourceAllocator*   allocator,
-                                  VkDevice             device,
-                                  VkQueue              gfx_queue,
-                                  VkCommandPool        upload_pool,
+                                  UploadBatch*         batch,
                                   const TerrainVertex* verts,
                                   uint32_t             vcount,
                                   const uint32_t*      inds,
@@ -645,8 +616,8 @@ static void terrain_upload_to_gpu(ResourceAllocator*   allocator,
     res_create_buffer(allocator, ib_size, VK_BUFFER_USAGE_2_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT,
                       VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE, 0, 0, &out_gpu->index);
 
-    upload_to_gpu_buffer(allocator, gfx_queue, upload_pool, out_gpu->vertex.buffer, 0, verts, vb_size);
-    upload_to_gpu_buffer(allocator, gfx_queue, upload_pool, out_gpu->index.buffer, 0, inds, ib_size);
+    upload_batch_buffer(batch, out_gpu->vertex.buffer, 0, verts, vb_size);
+    upload_batch_buffer(batch, out_gpu->index.buffer, 0, inds, ib_size);
 
     out_gpu->vertex_count = vcount;
     out_gpu->index_count  = icount;
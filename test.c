@@ -12,8 +12,13 @@
 #include "vk_cmd.h"
 #include "vk_pipelines.h"
 #include "render_object.h"
+#include "vk_slang_bridge.h"
 #include "vk_resources.h"
+#include "vk_staging.h"
+#include "vk_upload.h"
 #include "bindlesstextures.h"
+#include "texture_loader.h"
+#include "texture_streamer.h"
 #include "proceduraltextures.h"
 #include "debugtext.h"
 #include "gpu_timer.h"
@@ -21,16 +26,30 @@
 #include <stdint.h>
 #include <time.h>
 #include <math.h>
+#include <float.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <vulkan/vulkan_core.h>
 #include "depth.h"
 #include "camera.h"
 #include "scene.h"
+#include "scene_cache.h"
+#include "meshlet_cull.h"
+#include "transform_store.h"
+#include "animation_sampler.h"
+#include "scene_bvh.h"
 #include "file_utils.h"
 #include "terrain.h"
 
 #define VALIDATION false
+// scene textures: whole-chain loader (0, content dedup and loader mips) or mip
+// streaming under a VRAM budget (1, opt in with -DSTREAM_SCENE_TEXTURES=1)
+#ifndef STREAM_SCENE_TEXTURES
+#define STREAM_SCENE_TEXTURES 0
+#endif
+#define STREAM_BUDGET (512ull * 1024 * 1024)
+#define PIPELINE_CACHE_PATH "pipeline_cache.bin"
+#define PIPELINE_CACHE_SAVE_EVERY 16  // new pipelines between saves
 static void recreate_hdr_target(ResourceAllocator* allocator,
                                 VkDevice           device,
                                 VkQueue            queue,
@@ -98,6 +117,71 @@ static void recreate_hdr_target(ResourceAllocator* allocator,
 }
 static bool g_framebuffer_resized = false;
 
+static bool fill_scene_vertices(void* user, void* dst, VkDeviceSize size)
+{
+    (void)size;
+    return scene_geometry_decode((const Geometry*)user, (VertexPacked*)dst, NULL);
+}
+
+static bool fill_scene_indices(void* user, void* dst, VkDeviceSize size)
+{
+    (void)size;
+    return scene_geometry_decode((const Geometry*)user, NULL, (uint32_t*)dst);
+}
+
+static bool fill_draw_records(void* user, void* dst, VkDeviceSize size)
+{
+    (void)size;
+    transform_store_flush((TransformStore*)user, (MeshDrawGpu*)dst);
+    return true;
+}
+
+#define DRAW_UPLOAD_MAX_RANGES 64
+
+// Dirty draw records go through this frame's staging into the device-local
+// draws buffer, one copy region per dirty run. Frames still in flight keep
+// reading the old records until the copy, which waits for them. When staging
+// is full the entries stay dirty and go next frame.
+static void upload_dirty_draws(StagingRing* staging, VkCommandBuffer cmd, TransformStore* store, BufferSlice draws)
+{
+    TransformRange ranges[DRAW_UPLOAD_MAX_RANGES];
+    uint32_t       range_count = transform_store_dirty_ranges(store, ranges, DRAW_UPLOAD_MAX_RANGES);
+    if(range_count == 0)
+        return;
+
+    uint32_t total = 0;
+    for(uint32_t r = 0; r < range_count; r++)
+        total += ranges[r].count;
+
+    StagingAlloc alloc;
+    VkDeviceSize bytes = (VkDeviceSize)total * sizeof(MeshDrawGpu);
+    if(!staging_ring_alloc(staging, bytes, STAGING_ALIGNMENT, &alloc))
+        return;
+
+    VkBufferCopy regions[DRAW_UPLOAD_MAX_RANGES];
+    uint32_t     packed = 0;
+    for(uint32_t r = 0; r < range_count; r++)
+    {
+        transform_store_flush_range(store, ranges[r].first, ranges[r].count, (MeshDrawGpu*)alloc.mapping + packed);
+
+        regions[r] = (VkBufferCopy){
+            .srcOffset = alloc.offset + (VkDeviceSize)packed * sizeof(MeshDrawGpu),
+            .dstOffset = draws.offset + (VkDeviceSize)ranges[r].first * sizeof(MeshDrawGpu),
+            .size      = (VkDeviceSize)ranges[r].count * sizeof(MeshDrawGpu),
+        };
+        packed += ranges[r].count;
+    }
+    staging_ring_commit(staging, &alloc, bytes);
+
+    // previous frames' cull and vertex reads finish before the overwrite
+    BUFFER_BARRIER_IMMEDIATE(cmd, draws.buffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT,
+                             VK_PIPELINE_STAGE_2_TRANSFER_BIT, .src_access = 0, .dst_access = VK_ACCESS_2_TRANSFER_WRITE_BIT);
+    vkCmdCopyBuffer(cmd, alloc.buffer, draws.buffer, range_count, regions);
+    BUFFER_BARRIER_IMMEDIATE(cmd, draws.buffer, VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT,
+                             .src_access = VK_ACCESS_2_TRANSFER_WRITE_BIT, .dst_access = VK_ACCESS_2_SHADER_STORAGE_READ_BIT);
+}
+
 #define render_pc(cmd, obj, T, value_ptr) render_object_push_constants((cmd), (obj), (value_ptr), sizeof(T))
 
 static const uint32_t GRASS_GRID           = 256;
@@ -214,6 +298,7 @@ typedef struct GlobalUBO
     mat4 proj;
     mat4 viewproj;
     vec4 cameraPos;
+    uint32_t drawParams[4];  // x: 1 = instanced commands, vertex shaders fetch drawId[gl_InstanceIndex]
 } GlobalUBO;
 typedef struct RaymarchUBO
 {
@@ -245,22 +330,16 @@ typedef struct MeshDrawCommand
     uint32_t drawId;
 } MeshDrawCommand;
 
-typedef struct MeshDrawGpu
-{
-    float    position_scale[4];
-    float    orientation[4];
-    uint32_t meshIndex;
-    uint32_t postPass;
-    uint32_t materialIndex;
-    uint32_t pad;
-} MeshDrawGpu;
-
 typedef struct MeshLodGpu
 {
     uint32_t indexOffset;
     uint32_t indexCount;
     float    error;
-    float    pad;
+    uint32_t meshletOffset;
+    uint32_t meshletCount;
+    uint32_t vertexOffset;  // relative to MeshGpu.vertexOffset
+    uint32_t vertexCount;
+    uint32_t pad;
 } MeshLodGpu;
 
 typedef struct MeshGpu
@@ -269,7 +348,7 @@ typedef struct MeshGpu
     uint32_t   vertexOffset;
     uint32_t   vertexCount;
     uint32_t   lodCount;
-    uint32_t   pad;
+    uint32_t   lodSlot;  // first instancing batch slot, one per LOD (draw_batch.glsl)
     MeshLodGpu lods[SCENE_MAX_LODS];
 } MeshGpu;
 
@@ -278,9 +357,22 @@ typedef struct CullDataGpu
     mat4     view;
     vec4     frustum;    // x=1, y=tanHalfX, z=1, w=tanHalfY
     vec4     params;     // x=znear, y=zfar, z=lodTargetPx, w=viewportHeight
-    uint32_t counts[4];  // x=drawCount, y=lodEnabled
+    uint32_t counts[4];  // x=drawCount, y=lodEnabled, z=occlusionEnabled, w=meshletCapacity
+    uint32_t batch[4];   // x=cull.comp emits final draws, y=instancing, z=meshlet slot base
 } CullDataGpu;
 
+// drawCount block of cull.comp / meshlet_cull.comp / draw_batch.comp. The
+// dispatch args drive draw_batch.comp's passes indirectly.
+typedef struct DrawCountGpu
+{
+    uint32_t count;       // emitted draws
+    uint32_t batchCount;  // indirect commands when instancing
+    uint32_t instanceCursor;
+    uint32_t pad;
+    uint32_t emitDispatch[4];   // xyz: one group per 64 emitted draws
+    uint32_t batchDispatch[4];  // xyz: one group per 64 batches
+} DrawCountGpu;
+
 typedef struct MaterialGpu
 {
     uint32_t textures[4];
@@ -289,6 +381,59 @@ typedef struct MaterialGpu
     float    emissiveFactor[4];
 } MaterialGpu;
 
+// Loaded and streamed textures move to fresh bindless slots
+// (texture_loader_update, texture_streamer_update): materials sampling a moved
+// slot are repointed and flagged for upload.
+static void repoint_material_slots(MaterialGpu* materials, uint8_t* dirty, uint32_t material_count,
+                                   const TextureSlotMove* moves, uint32_t move_count)
+{
+    for(uint32_t i = 0; i < material_count; i++)
+    {
+        for(uint32_t t = 0; t < 4; t++)
+        {
+            for(uint32_t m = 0; m < move_count; m++)
+            {
+                if(materials[i].textures[t] == moves[m].from)
+                {
+                    materials[i].textures[t] = moves[m].to;
+                    dirty[i]                 = 1;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+// Before any draw of the frame: the old slots are retired behind it, so it
+// must not sample them.
+static void upload_dirty_materials(VkCommandBuffer cmd, MaterialGpu* materials, uint8_t* dirty, uint32_t material_count,
+                                   BufferSlice buffer)
+{
+    bool barrier = false;
+    for(uint32_t i = 0; i < material_count; i++)
+    {
+        if(!dirty[i])
+            continue;
+
+        // previous frames' material reads finish before the overwrite
+        if(!barrier)
+        {
+            BUFFER_BARRIER_IMMEDIATE(cmd, buffer.buffer, VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+                                     VK_PIPELINE_STAGE_2_TRANSFER_BIT, .src_access = 0, .dst_access = VK_ACCESS_2_TRANSFER_WRITE_BIT);
+            barrier = true;
+        }
+
+        VkDeviceSize offset = buffer.offset + (VkDeviceSize)i * sizeof(MaterialGpu) + offsetof(MaterialGpu, textures);
+        vkCmdUpdateBuffer(cmd, buffer.buffer, offset, sizeof(materials[i].textures), materials[i].textures);
+        dirty[i] = 0;
+    }
+
+    if(barrier)
+        BUFFER_BARRIER_IMMEDIATE(cmd, buffer.buffer, VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                                 VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+                                 .src_access = VK_ACCESS_2_TRANSFER_WRITE_BIT, .dst_access = VK_ACCESS_2_SHADER_STORAGE_READ_BIT);
+}
+
 typedef struct WaterMaterialGpu
 {
     float    shallow_color[4];
@@ -514,6 +659,7 @@ int main()
     create_device(gpu, surface, &desc, qf, &device);
     volkLoadDevice(device);
     init_device_queues(device, &qf);
+    texture_file_query_support(gpu);
 
 
     ResourceAllocator allocator = {0};
@@ -528,6 +674,8 @@ int main()
     // Per-frame sync + command buffers
     // ============================================================
     u32             current_frame = 0;
+    uint64_t        frame_value   = 0;  // frames submitted
+    uint64_t        frame_submitted[MAX_FRAME_IN_FLIGHT] = {0};  // frame_value of each slot's last submit
     u32             image_index   = 0;
     FrameSync       frame_sync[MAX_FRAME_IN_FLIGHT];
     VkCommandPool   cmd_pools[MAX_FRAME_IN_FLIGHT];
@@ -545,6 +693,15 @@ int main()
 
     vk_cmd_create_pool(device, qf.graphics_family, false, true, &upload_pool);
 
+    // startup uploads batch through the ring until the frame loop takes it over
+    StagingRing staging = {0};
+    staging_ring_init(&staging, &allocator, 64ull * 1024 * 1024, MAX_FRAME_IN_FLIGHT);
+    staging_ring_begin_immediate(&staging, qf.graphics_queue, upload_pool);
+
+    // runtime uploads: transfer queue, acquired by the next frame
+    UploadEngine uploads = {0};
+    upload_engine_init(&uploads, &allocator, &qf, 32ull * 1024 * 1024);
+
     FlowSwapchain swap = {0};
 
     int fb_w = 0, fb_h = 0;
@@ -605,6 +762,15 @@ int main()
     DescriptorAllocator persistent_desc = {0};
     descriptor_allocator_init(&persistent_desc, device, false);
 
+    // render object pipelines compile on workers while the rest of startup runs,
+    // against the cache the last run saved
+    uint32_t          compile_threads = job_pool_default_threads();
+    PipelineCacheFile pipeline_cache  = {0};
+    pipeline_cache_file_open(&pipeline_cache, device, gpu, PIPELINE_CACHE_PATH, compile_threads + 1, PIPELINE_CACHE_SAVE_EVERY);
+
+    PipelineCompiler pipeline_compiler = {0};
+    pipeline_compiler_init(&pipeline_compiler, device, &pipeline_cache, compile_threads);
+
     DescriptorAllocator bindless_desc = {0};
     descriptor_allocator_init(&bindless_desc, device, true);  // bindless needs update-after-bind
 
@@ -625,17 +791,17 @@ int main()
     size_t         tex_size   = (size_t)tex_w * (size_t)tex_h * 4u;
     uint8_t*       tex_pixels = (uint8_t*)malloc(tex_size);
 
-    uint32_t dummy_slot        = 0;
-    uint32_t checker_slot      = 0;
-    uint32_t gradient_slot     = 0;
-    uint32_t black_slot        = 0;
-    uint32_t water_normal_slot = 0;
-    uint32_t water_foam_slot   = 0;
-    uint32_t water_noise_slot  = 0;
+    TextureHandle dummy_tex        = 0;
+    TextureHandle checker_tex      = 0;
+    TextureHandle gradient_tex     = 0;
+    TextureHandle black_tex        = 0;
+    TextureHandle water_normal_tex = 0;
+    TextureHandle water_foam_tex   = 0;
+    TextureHandle water_noise_tex  = 0;
 
     // dummy slot 0 (solid white)
     procedural_fill_solid_rgba8(tex_pixels, 1, 1, 255, 255, 255, 255);
-    if(!tex_create_from_rgba8_cpu(&bindless, &allocator, device, qf.graphics_queue, upload_pool, 1, 1, tex_pixels, 0, &dummy_slot))
+    if(!tex_create_from_rgba8_cpu(&bindless, &allocator, device, qf.graphics_queue, upload_pool, 1, 1, tex_pixels, 0, &dummy_tex))
     {
         log_error("Failed to create dummy texture");
         return 1;
@@ -643,7 +809,7 @@ int main()
 
     procedural_fill_checker_rgba8(tex_pixels, tex_w, tex_h, 16, 32, 32, 32, 220, 220, 220);
     if(!tex_create_from_rgba8_cpu(&bindless, &allocator, device, qf.graphics_queue, upload_pool, tex_w, tex_h,
-                                  tex_pixels, TEX_SLOT_AUTO, &checker_slot))
+                                  tex_pixels, TEX_SLOT_AUTO, &checker_tex))
     {
         log_error("Failed to create checker texture");
         return 1;
@@ -651,7 +817,7 @@ int main()
 
     procedural_fill_gradient_rgba8(tex_pixels, tex_w, tex_h);
     if(!tex_create_from_rgba8_cpu(&bindless, &allocator, device, qf.graphics_queue, upload_pool, tex_w, tex_h,
-                                  tex_pixels, TEX_SLOT_AUTO, &gradient_slot))
+                                  tex_pixels, TEX_SLOT_AUTO, &gradient_tex))
     {
         log_error("Failed to create gradient texture");
         return 1;
@@ -659,7 +825,7 @@ int main()
 
     procedural_fill_solid_rgba8(tex_pixels, 1, 1, 0, 0, 0, 255);
     if(!tex_create_from_rgba8_cpu(&bindless, &allocator, device, qf.graphics_queue, upload_pool, 1, 1, tex_pixels,
-                                  TEX_SLOT_AUTO, &black_slot))
+                                  TEX_SLOT_AUTO, &black_tex))
     {
         log_error("Failed to create black texture");
         return 1;
@@ -669,23 +835,60 @@ int main()
 
     stbi_set_flip_vertically_on_load(1);
     if(!tex_create_from_file_rgba8(&bindless, &allocator, device, qf.graphics_queue, upload_pool,
-                                   "watertextures/SmallWaves.TGA", TEX_SLOT_AUTO, &water_normal_slot))
+                                   "watertextures/SmallWaves.TGA", TEX_SLOT_AUTO, &water_normal_tex))
     {
-        water_normal_slot = checker_slot;
+        water_normal_tex = checker_tex;
     }
 
+    // without the texture pack the water falls back to tiling procedural noise:
+    // cellular foam and a Perlin fBm pattern
+    uint8_t* noise_pixels = (uint8_t*)malloc(tex_size);
     if(!tex_create_from_file_rgba8(&bindless, &allocator, device, qf.graphics_queue, upload_pool,
-                                   "watertextures/Seafoam.TGA", TEX_SLOT_AUTO, &water_foam_slot))
+                                   "watertextures/Seafoam.TGA", TEX_SLOT_AUTO, &water_foam_tex))
     {
-        water_foam_slot = gradient_slot;
+        ProceduralNoiseDesc foam = {
+            .type = PROCEDURAL_NOISE_WORLEY, .seed = 1, .frequency = 8, .octaves = 2, .gain = 0.4f,
+            .color0 = {255, 255, 255, 255}, .color1 = {0, 0, 0, 255},
+        };
+        procedural_fill_noise_rgba8(noise_pixels, tex_w, tex_h, &foam, NULL);
+        if(!tex_create_from_rgba8_cpu(&bindless, &allocator, device, qf.graphics_queue, upload_pool, tex_w, tex_h,
+                                      noise_pixels, TEX_SLOT_AUTO, &water_foam_tex))
+            water_foam_tex = gradient_tex;
     }
 
     if(!tex_create_from_file_rgba8(&bindless, &allocator, device, qf.graphics_queue, upload_pool,
-                                   "watertextures/SeaPattern.TGA", TEX_SLOT_AUTO, &water_noise_slot))
+                                   "watertextures/SeaPattern.TGA", TEX_SLOT_AUTO, &water_noise_tex))
     {
-        water_noise_slot = checker_slot;
+        ProceduralNoiseDesc pattern = {
+            .type = PROCEDURAL_NOISE_PERLIN, .seed = 2, .frequency = 4, .octaves = 5, .gain = 0.5f,
+            .color0 = {0, 0, 0, 255}, .color1 = {255, 255, 255, 255},
+        };
+        procedural_fill_noise_rgba8(noise_pixels, tex_w, tex_h, &pattern, NULL);
+        if(!tex_create_from_rgba8_cpu(&bindless, &allocator, device, qf.graphics_queue, upload_pool, tex_w, tex_h,
+                                      noise_pixels, TEX_SLOT_AUTO, &water_noise_tex))
+            water_noise_tex = checker_tex;
+    }
+    free(noise_pixels);
+
+    // scene textures decode on worker threads and upload in batches from the loader's submit thread
+    TextureLoader texture_loader = {0};
+    if(!texture_loader_init(&texture_loader, &bindless, &allocator, device, qf.graphics_queue, qf.graphics_family, 0, 0))
+    {
+        printf("Failed to start texture loader\n");
+        return 1;
     }
 
+#if STREAM_SCENE_TEXTURES
+    // base mips first, the rest as the feedback asks for them
+    TextureStreamer texture_streamer = {0};
+    if(!texture_streamer_init(&texture_streamer, &bindless, &allocator, device, qf.graphics_queue, qf.graphics_family,
+                              STREAM_BUDGET, MAX_FRAME_IN_FLIGHT))
+    {
+        printf("Failed to start texture streamer\n");
+        return 1;
+    }
+#endif
+
     VkDebugText dbg = {0};
     vk_debug_text_init(&dbg, device, &persistent_desc, &desc_cache, &pipe_cache, &swap, "compiledshaders/debug_text.comp.spv");
 
@@ -707,6 +910,9 @@ int main()
     RenderObject grass_obj         = {0};
     RenderObject water_obj         = {0};
     RenderObject cull_obj          = {0};
+    RenderObject meshlet_cull_obj  = {0};
+    RenderObject draw_batch_obj    = {0};
+    RenderObject occlusion_obj     = {0};
     RenderObject terrain_paint_obj = {0};
     RenderObject postprocess_obj   = {0};
     RenderObject sky_obj           = {0};
@@ -718,6 +924,9 @@ int main()
     RenderObjectInstance grass_inst         = {0};
     RenderObjectInstance water_ro_inst      = {0};
     RenderObjectInstance cull_inst          = {0};
+    RenderObjectInstance meshlet_cull_inst  = {0};
+    RenderObjectInstance draw_batch_inst    = {0};
+    RenderObjectInstance occlusion_inst     = {0};
     RenderObjectInstance terrain_paint_inst = {0};
     RenderObjectInstance raymarch_inst      = {0};
     RenderObjectInstance postprocess_inst   = {0};
@@ -731,7 +940,15 @@ int main()
     tri_spec.use_bindless_if_available = VK_TRUE;
     tri_spec.bindless_descriptor_count = bindless.max_textures;
 
-    render_object_create(&tri_obj, VK_NULL_HANDLE, &desc_cache, &pipe_cache, &persistent_desc, &tri_spec, 1);
+    // texture_feedback.glsl only writes feedback the streamer reads back
+    const VkBool32           feedback_enabled = STREAM_SCENE_TEXTURES;
+    VkSpecializationMapEntry feedback_entry   = {TEXTURE_STREAM_FEEDBACK_CONSTANT_ID, 0, sizeof(VkBool32)};
+    tri_spec.spec_constant_count              = 1;
+    tri_spec.spec_map                         = &feedback_entry;
+    tri_spec.spec_data                        = &feedback_enabled;
+    tri_spec.spec_data_size                   = sizeof(feedback_enabled);
+
+    render_object_create_async(&tri_obj, &pipeline_compiler, &desc_cache, &pipe_cache, &persistent_desc, &tri_spec, 1);
     render_object_set_external_set(&tri_obj, "u_textures", bindless.set);
     render_instance_create(&tri_inst, &tri_obj.pipeline, &tri_obj.resources);
 
@@ -742,8 +959,12 @@ int main()
     toon_spec.allow_update_after_bind   = VK_TRUE;
     toon_spec.use_bindless_if_available = VK_TRUE;
     toon_spec.bindless_descriptor_count = bindless.max_textures;
+    toon_spec.spec_constant_count       = 1;
+    toon_spec.spec_map                  = &feedback_entry;
+    toon_spec.spec_data                 = &feedback_enabled;
+    toon_spec.spec_data_size            = sizeof(feedback_enabled);
 
-    render_object_create(&toon_obj, VK_NULL_HANDLE, &desc_cache, &pipe_cache, &persistent_desc, &toon_spec, 1);
+    render_object_create_async(&toon_obj, &pipeline_compiler, &desc_cache, &pipe_cache, &persistent_desc, &toon_spec, 1);
     render_object_set_external_set(&toon_obj, "u_textures", bindless.set);
     render_instance_create(&toon_inst, &toon_obj.pipeline, &toon_obj.resources);
     //
@@ -754,19 +975,37 @@ int main()
     toon_outline_spec.cull_mode        = VK_CULL_MODE_FRONT_BIT;
 
 
-    render_object_create(&toon_outline_obj, VK_NULL_HANDLE, &desc_cache, &pipe_cache, &persistent_desc, &toon_outline_spec, 1);
+    render_object_create_async(&toon_outline_obj, &pipeline_compiler, &desc_cache, &pipe_cache, &persistent_desc, &toon_outline_spec, 1);
     render_object_set_external_set(&toon_outline_obj, "u_textures", bindless.set);
     render_instance_create(&toon_outline_inst, &toon_outline_obj.pipeline, &toon_outline_obj.resources);
 
     RenderObjectSpec cull_spec = render_object_spec_default();
     cull_spec.comp_spv         = "compiledshaders/cull.comp.spv";
+    cull_spec.per_frame_sets   = VK_TRUE;  // CPU pre-cull candidates are per frame
 
 
-    render_object_create(&cull_obj, VK_NULL_HANDLE, &desc_cache, &pipe_cache, &persistent_desc, &cull_spec, 1);
+    render_object_create_async(&cull_obj, &pipeline_compiler, &desc_cache, &pipe_cache, &persistent_desc, &cull_spec, MAX_FRAME_IN_FLIGHT);
     render_instance_create(&cull_inst, &cull_obj.pipeline, &cull_obj.resources);
+
+    RenderObjectSpec meshlet_cull_spec = render_object_spec_default();
+    meshlet_cull_spec.comp_spv         = "compiledshaders/meshlet_cull.comp.spv";
+    render_object_create_async(&meshlet_cull_obj, &pipeline_compiler, &desc_cache, &pipe_cache, &persistent_desc, &meshlet_cull_spec, 1);
+    render_instance_create(&meshlet_cull_inst, &meshlet_cull_obj.pipeline, &meshlet_cull_obj.resources);
+
+    RenderObjectSpec draw_batch_spec = render_object_spec_default();
+    draw_batch_spec.comp_spv         = "compiledshaders/draw_batch.comp.spv";
+    render_object_create_async(&draw_batch_obj, &pipeline_compiler, &desc_cache, &pipe_cache, &persistent_desc, &draw_batch_spec, 1);
+    render_instance_create(&draw_batch_inst, &draw_batch_obj.pipeline, &draw_batch_obj.resources);
+
+    RenderObjectSpec occlusion_spec = render_object_spec_default();
+    occlusion_spec.comp_spv         = "compiledshaders/occlusion_reduce.comp.spv";
+    occlusion_spec.per_frame_sets   = VK_TRUE;  // depth input changes with current_frame
+    render_object_create_async(&occlusion_obj, &pipeline_compiler, &desc_cache, &pipe_cache, &persistent_desc, &occlusion_spec,
+                               MAX_FRAME_IN_FLIGHT);
+    render_instance_create(&occlusion_inst, &occlusion_obj.pipeline, &occlusion_obj.resources);
     RenderObjectSpec terrain_paint_spec = render_object_spec_default();
     terrain_paint_spec.comp_spv         = "compiledshaders/terrain_paint.comp.spv";
-    render_object_create(&terrain_paint_obj, VK_NULL_HANDLE, &desc_cache, &pipe_cache, &persistent_desc, &terrain_paint_spec, 1);
+    render_object_create_async(&terrain_paint_obj, &pipeline_compiler, &desc_cache, &pipe_cache, &persistent_desc, &terrain_paint_spec, 1);
     render_instance_create(&terrain_paint_inst, &terrain_paint_obj.pipeline, &terrain_paint_obj.resources);
 
     RenderObjectSpec raymarch_spec       = render_object_spec_default();
@@ -777,7 +1016,7 @@ int main()
     raymarch_spec.color_attachment_count = 1;
     raymarch_spec.color_formats          = &hdr_format;
 
-    render_object_create(&raymarch_obj, VK_NULL_HANDLE, &desc_cache, &pipe_cache, &persistent_desc, &raymarch_spec, 1);
+    render_object_create_async(&raymarch_obj, &pipeline_compiler, &desc_cache, &pipe_cache, &persistent_desc, &raymarch_spec, 1);
     render_instance_create(&raymarch_inst, &raymarch_obj.pipeline, &raymarch_obj.resources);
 
 
@@ -788,7 +1027,7 @@ int main()
     terrain_spec.blend_enable     = VK_FALSE;
     terrain_spec.use_vertex_input = VK_TRUE;
 
-    render_object_create(&terrain_obj, VK_NULL_HANDLE, &desc_cache, &pipe_cache, &persistent_desc, &terrain_spec, 1);
+    render_object_create_async(&terrain_obj, &pipeline_compiler, &desc_cache, &pipe_cache, &persistent_desc, &terrain_spec, 1);
     render_object_enable_hot_reload(&terrain_obj, VK_NULL_HANDLE, &terrain_spec);
     render_instance_create(&terrain_inst, &terrain_obj.pipeline, &terrain_obj.resources);
 
@@ -799,7 +1038,7 @@ int main()
     grass_spec.cull_mode        = VK_CULL_MODE_NONE;
     grass_spec.blend_enable     = VK_FALSE;
 
-    render_object_create(&grass_obj, VK_NULL_HANDLE, &desc_cache, &pipe_cache, &persistent_desc, &grass_spec, 1);
+    render_object_create_async(&grass_obj, &pipeline_compiler, &desc_cache, &pipe_cache, &persistent_desc, &grass_spec, 1);
     render_instance_create(&grass_inst, &grass_obj.pipeline, &grass_obj.resources);
 
 
@@ -816,7 +1055,7 @@ int main()
     water_spec.use_bindless_if_available = VK_TRUE;
     water_spec.bindless_descriptor_count = bindless.max_textures;
 
-    render_object_create(&water_obj, VK_NULL_HANDLE, &desc_cache, &pipe_cache, &persistent_desc, &water_spec, 1);
+    render_object_create_async(&water_obj, &pipeline_compiler, &desc_cache, &pipe_cache, &persistent_desc, &water_spec, 1);
     render_object_set_external_set(&water_obj, "u_textures", bindless.set);
     render_instance_create(&water_ro_inst, &water_obj.pipeline, &water_obj.resources);
 
@@ -826,8 +1065,8 @@ int main()
     postprocess_spec.per_frame_sets   = VK_TRUE;
     postprocess_spec.reloadable       = VK_TRUE;
 
-    render_object_create(&postprocess_obj, VK_NULL_HANDLE, &desc_cache, &pipe_cache, &persistent_desc, &postprocess_spec,
-                         MAX_FRAME_IN_FLIGHT);
+    render_object_create_async(&postprocess_obj, &pipeline_compiler, &desc_cache, &pipe_cache, &persistent_desc, &postprocess_spec,
+                               MAX_FRAME_IN_FLIGHT);
     render_instance_create(&postprocess_inst, &postprocess_obj.pipeline, &postprocess_obj.resources);
 
     RenderObjectSpec sky_spec = render_object_spec_from_config(&cfg);
@@ -841,7 +1080,7 @@ int main()
     sky_spec.color_formats          = &hdr_format;
     sky_spec.reloadable             = VK_TRUE;
 
-    render_object_create(&sky_obj, VK_NULL_HANDLE, &desc_cache, &pipe_cache, &persistent_desc, &sky_spec, 1);
+    render_object_create_async(&sky_obj, &pipeline_compiler, &desc_cache, &pipe_cache, &persistent_desc, &sky_spec, 1);
     render_instance_create(&sky_inst, &sky_obj.pipeline, &sky_obj.resources);
     BufferArena host_arena         = {0};
     BufferArena device_arena       = {0};
@@ -855,6 +1094,20 @@ int main()
     BufferSlice mesh_buffer       = {0};
     BufferSlice draw_count_buffer = {0};
 
+    // meshlet culling: cull.comp writes the visible draw list here and
+    // meshlet_cull.comp expands it into draw_cmd_buffer / indirect_buffer
+    BufferSlice meshlet_buffer          = {0};
+    BufferSlice visible_draw_buffer     = {0};
+    BufferSlice visible_lod_buffer      = {0};
+    BufferSlice visible_indirect_buffer = {0};
+    BufferSlice visible_dispatch_buffer = {0};
+    BufferSlice occlusion_buffer        = {0};
+
+    // automatic instancing state, see draw_batch.glsl
+    BufferSlice batch_slot_buffer    = {0};
+    BufferSlice batch_slot_id_buffer = {0};
+    BufferSlice batch_entry_buffer   = {0};
+
     buffer_arena_init(&allocator, 2 * 1024 * 1024, VK_BUFFER_USAGE_2_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT,
                       VMA_MEMORY_USAGE_AUTO_PREFER_HOST,
                       VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, 256, &host_arena);
@@ -980,7 +1233,7 @@ int main()
     TerrainSaveHeader loaded_header    = {0};
     if(file_exists(TERRAIN_SAVE_PATH))
     {
-        if(terrain_load_heightmap(TERRAIN_SAVE_PATH, &allocator, device, qf.graphics_queue, upload_pool, &sculpt_delta_img, &loaded_header))
+        if(terrain_load_heightmap(TERRAIN_SAVE_PATH, &staging, &sculpt_delta_img, &loaded_header))
         {
             terrain_gui.height_scale    = loaded_header.heightScale;
             terrain_gui.freq            = loaded_header.freq;
@@ -996,10 +1249,12 @@ int main()
     }
 
     // Always bake base terrain from procedural noise on CPU (once at startup)
-    terrain_bake_base_heightmap(&allocator, device, qf.graphics_queue, upload_pool, &base_height, HEIGHTMAP_RES,
-                                terrain_map_min_init[0], terrain_map_min_init[1], terrain_map_max_init[0],
-                                terrain_map_max_init[1], terrain_gui.freq, terrain_gui.noise_offset[0],
-                                terrain_gui.noise_offset[1], terrain_gui.height_scale);
+    terrain_bake_base_heightmap(&staging, &base_height, HEIGHTMAP_RES, terrain_map_min_init[0], terrain_map_min_init[1],
+                                terrain_map_max_init[0], terrain_map_max_init[1], terrain_gui.freq,
+                                terrain_gui.noise_offset[0], terrain_gui.noise_offset[1], terrain_gui.height_scale);
+
+    // heightmaps were staged in place; frames own the ring from here
+    staging_ring_end_immediate(&staging);
 
     GpuProfiler prof[MAX_FRAME_IN_FLIGHT];
     float       cpu_frame_ms[MAX_FRAME_IN_FLIGHT] = {0};
@@ -1014,6 +1269,11 @@ int main()
     }
 
     Scene scene = {0};
+    scene_import_set_meshlets(true);
+    // geometry stays meshopt-encoded from the cache until it is decoded into staging below
+    scene_cache_set_compression(true);
+    scene_import_set_packed_geometry(true);
+
     typedef struct SceneEntry
     {
         const char* path;
@@ -1062,33 +1322,38 @@ int main()
            (uint32_t)arrlen(grass_scene.geometry.vertices), (uint32_t)arrlen(grass_scene.geometry.indices));
 
     uint32_t  texture_count = (uint32_t)arrlen(scene.texturePaths);
-    uint32_t* texture_slots = NULL;
+    TextureHandle* texture_handles = NULL;
     if(texture_count > 0)
     {
-        texture_slots = (uint32_t*)malloc(sizeof(uint32_t) * texture_count);
-        if(!texture_slots)
+        texture_handles = (TextureHandle*)malloc(sizeof(TextureHandle) * texture_count);
+        if(!texture_handles)
         {
             printf("Failed to allocate texture slot map\n");
             return 1;
         }
 
-        texture_slots[0] = 0;
+        texture_handles[0] = 0;
         for(uint32_t i = 1; i < texture_count; i++)
         {
             const char* path = scene.texturePaths[i];
             if(path && path[0] != '\0')
             {
-                uint32_t slot = 0;
-                if(!tex_create_from_file_rgba8(&bindless, &allocator, device, qf.graphics_queue, upload_pool, path,
-                                               TEX_SLOT_AUTO, &slot))
+                // the slot samples the dummy until the texture lands in a fresh one (TextureSlotMove)
+                TextureHandle handle = 0;
+                bool          srgb   = scene_texture_is_color(&scene, i);
+#if STREAM_SCENE_TEXTURES
+                if(!texture_streamer_request(&texture_streamer, path, srgb, &handle))
+#else
+                if(!texture_loader_request(&texture_loader, path, srgb, &handle))
+#endif
                 {
                     printf("Failed to load texture: %s\n", path);
-                    slot = 0;
+                    handle = 0;
                 }
-                texture_slots[i] = slot;
+                texture_handles[i] = handle;
             }
             else
-                texture_slots[i] = 0;
+                texture_handles[i] = 0;
         }
     }
 
@@ -1106,22 +1371,22 @@ int main()
         MaterialGpu* dst = &materials_gpu[i];
         memset(dst, 0, sizeof(*dst));
 
-        if(src->albedoTexture > 0 && texture_slots)
-            dst->textures[0] = texture_slots[src->albedoTexture];
+        if(src->albedoTexture > 0 && texture_handles)
+            dst->textures[0] = bindless_textures_resolve(&bindless, texture_handles[src->albedoTexture]);
         else
             dst->textures[0] = 0;
 
-        if(src->emissiveTexture > 0 && texture_slots)
-            dst->textures[1] = texture_slots[src->emissiveTexture];
+        if(src->emissiveTexture > 0 && texture_handles)
+            dst->textures[1] = bindless_textures_resolve(&bindless, texture_handles[src->emissiveTexture]);
         else
             dst->textures[1] = 0;
 
-        if(src->occlusionTexture > 0 && texture_slots)
-            dst->textures[2] = texture_slots[src->occlusionTexture];
+        if(src->occlusionTexture > 0 && texture_handles)
+            dst->textures[2] = bindless_textures_resolve(&bindless, texture_handles[src->occlusionTexture]);
         else
             dst->textures[2] = 0;
 
-        dst->textures[3] = black_slot;
+        dst->textures[3] = bindless_textures_resolve(&bindless, black_tex);
 
         memcpy(dst->diffuseFactor, src->diffuseFactor, sizeof(dst->diffuseFactor));
         memcpy(dst->specularFactor, src->specularFactor, sizeof(dst->specularFactor));
@@ -1133,22 +1398,25 @@ int main()
     }
 
     VkDeviceSize material_bytes = (VkDeviceSize)material_count * sizeof(MaterialGpu);
-    free(texture_slots);
+    uint8_t*     material_dirty = (uint8_t*)calloc(MAX(material_count, 1u), 1);  // texture slots moved by streaming
+    free(texture_handles);
 
 
     uint32_t     draw_count               = (uint32_t)arrlen(scene.draws);
-    MeshDrawGpu* draws_cpu                = malloc(sizeof(MeshDrawGpu) * draw_count);
+    BufferArena  draw_arena               = {0};
     BufferSlice  draw_cmd_buffer          = {0};
     BufferSlice  draws_buffer             = {0};
     BufferSlice  indirect_buffer          = {0};
     Buffer       indirect_fallback_buffer = {0};
     bool         indirect_uses_fallback   = false;
-    printf("scene meshes=%u vertices=%u indices=%u\n", (uint32_t)arrlen(scene.geometry.meshes),
-           (uint32_t)arrlen(scene.geometry.vertices), (uint32_t)arrlen(scene.geometry.indices));
+    uint32_t     scene_vertex_count       = scene_geometry_vertex_count(&scene.geometry);
+    uint32_t     scene_index_count        = scene_geometry_index_count(&scene.geometry);
+    printf("scene meshes=%u vertices=%u indices=%u\n", (uint32_t)arrlen(scene.geometry.meshes), scene_vertex_count,
+           scene_index_count);
     GpuMeshBuffers gpu_scene = {0};
 
-    VkDeviceSize vb_size = (VkDeviceSize)arrlen(scene.geometry.vertices) * sizeof(VertexPacked);
-    VkDeviceSize ib_size = (VkDeviceSize)arrlen(scene.geometry.indices) * sizeof(uint32_t);
+    VkDeviceSize vb_size = (VkDeviceSize)scene_vertex_count * sizeof(VertexPacked);
+    VkDeviceSize ib_size = (VkDeviceSize)scene_index_count * sizeof(uint32_t);
     printf("scene draws=%u vb=%llu ib=%llu\n", draw_count, (unsigned long long)vb_size, (unsigned long long)ib_size);
 
     res_create_buffer(&allocator, vb_size,
@@ -1158,20 +1426,22 @@ int main()
     res_create_buffer(&allocator, ib_size, VK_BUFFER_USAGE_2_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT,
                       VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE, 0, 0, &gpu_scene.index);
 
-    // Upload data
-    upload_to_gpu_buffer(&allocator, qf.graphics_queue, upload_pool, gpu_scene.vertex.buffer, 0, scene.geometry.vertices, vb_size);
-
-    upload_to_gpu_buffer(&allocator, qf.graphics_queue, upload_pool, gpu_scene.index.buffer, 0, scene.geometry.indices, ib_size);
+    // Every start-up buffer goes out in one batch, submitted once the last one is queued.
+    // Packed geometry decodes on the import workers straight into its staging.
+    UploadBatch startup_uploads = {0};
+    upload_batch_begin(&startup_uploads, &allocator);
+    upload_batch_buffer_fill(&startup_uploads, gpu_scene.vertex.buffer, 0, vb_size, fill_scene_vertices, &scene.geometry);
+    upload_batch_buffer_fill(&startup_uploads, gpu_scene.index.buffer, 0, ib_size, fill_scene_indices, &scene.geometry);
 
-    gpu_scene.vertex_count = (uint32_t)arrlen(scene.geometry.vertices);
-    gpu_scene.index_count  = (uint32_t)arrlen(scene.geometry.indices);
+    gpu_scene.vertex_count = scene_vertex_count;
+    gpu_scene.index_count  = scene_index_count;
 
     GpuMeshBuffers water_gpu = {0};
 
+    WaterVertex* wverts = NULL;
+    uint32_t*    winds  = NULL;
     {
-        WaterVertex* wverts = NULL;
-        uint32_t*    winds  = NULL;
-        uint32_t     wvc = 0, wic = 0;
+        uint32_t wvc = 0, wic = 0;
 
         water_generate_grid(64,      // grid resolution (LOW)
                             512.0f,  // world size (big plane)
@@ -1183,16 +1453,12 @@ int main()
         res_create_buffer(&allocator, sizeof(uint32_t) * wic, VK_BUFFER_USAGE_2_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT,
                           VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE, 0, 0, &water_gpu.index);
 
-        upload_to_gpu_buffer(&allocator, qf.graphics_queue, upload_pool, water_gpu.vertex.buffer, 0, wverts,
-                             sizeof(WaterVertex) * wvc);
+        upload_batch_buffer(&startup_uploads, water_gpu.vertex.buffer, 0, wverts, sizeof(WaterVertex) * wvc);
 
-        upload_to_gpu_buffer(&allocator, qf.graphics_queue, upload_pool, water_gpu.index.buffer, 0, winds, sizeof(uint32_t) * wic);
+        upload_batch_buffer(&startup_uploads, water_gpu.index.buffer, 0, winds, sizeof(uint32_t) * wic);
 
         water_gpu.vertex_count = wvc;
         water_gpu.index_count  = wic;
-
-        free(wverts);
-        free(winds);
     }
 
     // Upload grass mesh to GPU
@@ -1209,15 +1475,13 @@ int main()
         res_create_buffer(&allocator, grass_ib_size, VK_BUFFER_USAGE_2_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT,
                           VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE, 0, 0, &grass_gpu_mesh.index);
 
-        upload_to_gpu_buffer(&allocator, qf.graphics_queue, upload_pool, grass_gpu_mesh.vertex.buffer, 0,
-                             grass_scene.geometry.vertices, grass_vb_size);
+        upload_batch_buffer(&startup_uploads, grass_gpu_mesh.vertex.buffer, 0, grass_scene.geometry.vertices, grass_vb_size);
 
-        upload_to_gpu_buffer(&allocator, qf.graphics_queue, upload_pool, grass_gpu_mesh.index.buffer, 0,
-                             grass_scene.geometry.indices, grass_ib_size);
+        upload_batch_buffer(&startup_uploads, grass_gpu_mesh.index.buffer, 0, grass_scene.geometry.indices, grass_ib_size);
 
         grass_gpu_mesh.vertex_count = (uint32_t)arrlen(grass_scene.geometry.vertices);
         grass_gpu_mesh.index_count  = (uint32_t)arrlen(grass_scene.geometry.indices);
-        printf("Grass mesh uploaded: %u verts, %u indices\n", grass_gpu_mesh.vertex_count, grass_gpu_mesh.index_count);
+        printf("Grass mesh queued: %u verts, %u indices\n", grass_gpu_mesh.vertex_count, grass_gpu_mesh.index_count);
     }
 
     if(arrlen(scene.geometry.meshes) == 0)
@@ -1234,6 +1498,8 @@ int main()
         return 2;
     }
 
+    uint32_t lod_slot_count = 0;  // instancing batch slots, see MeshGpu.lodSlot
+
     for(uint32_t i = 0; i < mesh_count; i++)
     {
         Mesh*    src = &scene.geometry.meshes[i];
@@ -1248,43 +1514,110 @@ int main()
         dst->vertexOffset = src->vertexOffset;
         dst->vertexCount  = src->vertexCount;
         dst->lodCount     = src->lodCount;
+        dst->lodSlot      = lod_slot_count;
+        lod_slot_count += MIN(src->lodCount, SCENE_MAX_LODS);
 
         for(uint32_t li = 0; li < src->lodCount && li < SCENE_MAX_LODS; li++)
         {
             dst->lods[li].indexOffset = src->lods[li].indexOffset;
             dst->lods[li].indexCount  = src->lods[li].indexCount;
             dst->lods[li].error       = src->lods[li].error;
-            dst->lods[li].pad         = 0.0f;
+
+            dst->lods[li].meshletOffset = src->lods[li].meshletOffset;
+            dst->lods[li].meshletCount  = src->lods[li].meshletCount;
+
+            dst->lods[li].vertexOffset = src->lods[li].vertexOffset;
+            dst->lods[li].vertexCount  = src->lods[li].vertexCount;
         }
     }
 
     VkDeviceSize mesh_bytes = (VkDeviceSize)mesh_count * sizeof(MeshGpu);
 
-    for(uint32_t i = 0; i < draw_count; i++)
+    // scene_load_gltf_at spawned one SceneObject per imported draw, in draw
+    // order, so object i, store entry i and GPU draw i line up. The objects
+    // carry the load placement; they take their draw's world transform here.
+    // Draw transforms live in a SoA store keyed by those handles; dirty entries
+    // are converted into staging and copied to the draws buffer each frame
+    // (upload_dirty_draws).
+    uint32_t object_count = (uint32_t)arrlen(scene.objects);
+    if(object_count != draw_count)
     {
-        MeshDraw* src = &scene.draws[i];
-
-        draws_cpu[i].position_scale[0] = src->position[0];
-        draws_cpu[i].position_scale[1] = src->position[1];
-        draws_cpu[i].position_scale[2] = src->position[2];
-        draws_cpu[i].position_scale[3] = src->scale;
-
-        draws_cpu[i].orientation[0] = src->orientation[0];
-        draws_cpu[i].orientation[1] = src->orientation[1];
-        draws_cpu[i].orientation[2] = src->orientation[2];
-        draws_cpu[i].orientation[3] = src->orientation[3];
-
-        draws_cpu[i].meshIndex     = src->meshIndex;
-        draws_cpu[i].postPass      = src->postPass;
-        draws_cpu[i].materialIndex = src->materialIndex;
-        draws_cpu[i].pad           = 0;
+        printf("Scene has %u objects for %u draws\n", object_count, draw_count);
+        return 1;
+    }
+    for(uint32_t i = 0; i < object_count; i++)
+    {
+        const SceneObject* o = &scene.objects[i];
+        const MeshDraw*    d = &scene.draws[i];
+        if(o->templateIndex != i)
+        {
+            printf("Scene object %u spawned from draw %u\n", i, o->templateIndex);
+            return 1;
+        }
+        scene_object_set_transform(&scene, o->id, d->position, d->orientation, d->scale);
+    }
+
+    TransformStore draw_transforms = {0};
+    transform_store_init(&draw_transforms, object_count);
+    if(!transform_store_from_objects(&draw_transforms, &scene))
+    {
+        printf("Failed to build the draw transform store\n");
+        return 1;
+    }
+
+    // Scene.animations (imported glTF clips), sampled into draw_transforms every
+    // frame before the flush. Tracks follow their SceneObject's store entry.
+    AnimationSet draw_animations = {0};
+    animation_set_build(&draw_animations, scene.animations, (uint32_t)arrlen(scene.animations), &draw_transforms,
+                        &scene);
+
+    // BVH over draw bounding spheres: editor picking and the CPU pre-cull that
+    // trims the candidate list cull.comp walks.
+    SceneBvh draw_bvh = {0};
+    {
+        uint64_t t0 = time_now_ns();
+        scene_bvh_build(&draw_bvh, &scene);
+        printf("scene bvh nodes=%u build=%.2f ms\n", draw_bvh.nodeCount, time_ns_to_ms(time_now_ns() - t0));
     }
 
 
-    VkDeviceSize draw_cmd_bytes   = (VkDeviceSize)draw_count * sizeof(MeshDrawCommand);
+    // With meshlets every visible draw can expand to one command per meshlet of
+    // its largest LOD; the draw stream is sized for that worst case.
+    uint32_t meshlet_count        = (uint32_t)arrlen(scene.geometry.meshlets);
+    bool     meshlet_cull_enabled = meshlet_count > 0;
+    uint32_t draw_cmd_capacity    = draw_count;
+
+    if(meshlet_cull_enabled)
+    {
+        draw_cmd_capacity = 0;
+        for(uint32_t i = 0; i < draw_count; i++)
+        {
+            const Mesh* mesh    = &scene.geometry.meshes[scene.draws[i].meshIndex];
+            uint32_t    largest = 1;
+            for(uint32_t li = 0; li < mesh->lodCount; li++)
+                largest = MAX(largest, mesh->lods[li].meshletCount);
+            draw_cmd_capacity += largest;
+        }
+        printf("scene meshlets=%u draw capacity=%u\n", meshlet_count, draw_cmd_capacity);
+    }
+
+    VkDeviceSize draw_cmd_bytes   = (VkDeviceSize)draw_cmd_capacity * sizeof(MeshDrawCommand);
     VkDeviceSize draws_bytes      = (VkDeviceSize)draw_count * sizeof(MeshDrawGpu);
-    VkDeviceSize draw_count_bytes = sizeof(uint32_t);
-    VkDeviceSize indirect_bytes   = (VkDeviceSize)draw_count * sizeof(VkDrawIndexedIndirectCommand);
+    VkDeviceSize draw_count_bytes = sizeof(DrawCountGpu);
+    VkDeviceSize indirect_bytes   = (VkDeviceSize)draw_cmd_capacity * sizeof(VkDrawIndexedIndirectCommand);
+
+    VkDeviceSize meshlet_bytes          = (VkDeviceSize)MAX(meshlet_count, 1u) * sizeof(Meshlet);
+    VkDeviceSize visible_draw_bytes     = (VkDeviceSize)draw_count * sizeof(uint32_t);
+    VkDeviceSize visible_indirect_bytes = (VkDeviceSize)draw_count * sizeof(VkDrawIndexedIndirectCommand);
+    VkDeviceSize visible_dispatch_bytes = sizeof(DrawCountGpu);  // dispatch x is cull.comp's count
+    VkDeviceSize occlusion_bytes        = (VkDeviceSize)OCCLUSION_GRID_W * OCCLUSION_GRID_H * sizeof(float);
+
+    // Automatic instancing: one slot per mesh LOD and per meshlet, i.e. per
+    // index range a draw can emit (see draw_batch.glsl).
+    uint32_t     batch_slot_count    = lod_slot_count + meshlet_count;
+    VkDeviceSize batch_slot_bytes    = (VkDeviceSize)MAX(batch_slot_count, 1u) * sizeof(uint32_t) * 2;
+    VkDeviceSize batch_slot_id_bytes = (VkDeviceSize)draw_cmd_capacity * sizeof(uint32_t);
+    VkDeviceSize batch_entry_bytes   = (VkDeviceSize)draw_cmd_capacity * sizeof(uint32_t) * 3;
 
     VkDeviceSize device_arena_size = 0;
     device_arena_size              = align_up(device_arena_size, 256) + material_bytes;
@@ -1293,6 +1626,14 @@ int main()
     device_arena_size              = align_up(device_arena_size, 256) + draw_cmd_bytes;
     device_arena_size              = align_up(device_arena_size, 256) + draws_bytes;
     device_arena_size              = align_up(device_arena_size, 256) + indirect_bytes;
+    device_arena_size              = align_up(device_arena_size, 256) + meshlet_bytes;
+    device_arena_size              = align_up(device_arena_size, 256) + visible_draw_bytes * 2;  // draw ids + lods
+    device_arena_size              = align_up(device_arena_size, 256) + visible_indirect_bytes;
+    device_arena_size              = align_up(device_arena_size, 256) + visible_dispatch_bytes;
+    device_arena_size              = align_up(device_arena_size, 256) + occlusion_bytes;
+    device_arena_size              = align_up(device_arena_size, 256) + batch_slot_bytes;
+    device_arena_size              = align_up(device_arena_size, 256) + batch_slot_id_bytes;
+    device_arena_size              = align_up(device_arena_size, 256) + batch_entry_bytes;
 
     buffer_arena_init(&allocator, device_arena_size,
                       VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_INDIRECT_BUFFER_BIT,
@@ -1304,6 +1645,16 @@ int main()
     draw_cmd_buffer   = buffer_arena_alloc(&device_arena, draw_cmd_bytes, 256);
     draws_buffer      = buffer_arena_alloc(&device_arena, draws_bytes, 256);
     indirect_buffer   = buffer_arena_alloc(&device_arena, indirect_bytes, 256);
+
+    meshlet_buffer          = buffer_arena_alloc(&device_arena, meshlet_bytes, 256);
+    visible_draw_buffer     = buffer_arena_alloc(&device_arena, visible_draw_bytes, 256);
+    visible_lod_buffer      = buffer_arena_alloc(&device_arena, visible_draw_bytes, 256);
+    visible_indirect_buffer = buffer_arena_alloc(&device_arena, visible_indirect_bytes, 256);
+    visible_dispatch_buffer = buffer_arena_alloc(&device_arena, visible_dispatch_bytes, 256);
+    occlusion_buffer        = buffer_arena_alloc(&device_arena, occlusion_bytes, 256);
+    batch_slot_buffer       = buffer_arena_alloc(&device_arena, batch_slot_bytes, 256);
+    batch_slot_id_buffer    = buffer_arena_alloc(&device_arena, batch_slot_id_bytes, 256);
+    batch_entry_buffer      = buffer_arena_alloc(&device_arena, batch_entry_bytes, 256);
     if(indirect_buffer.buffer == VK_NULL_HANDLE)
     {
         VkDeviceSize fallback_bytes = indirect_bytes;
@@ -1325,21 +1676,43 @@ int main()
     for(uint32_t i = 0; i < draw_count; i++)
         init_cmds[i].drawId = i;
 
-    upload_to_gpu_buffer(&allocator, qf.graphics_queue, upload_pool, draw_cmd_buffer.buffer, draw_cmd_buffer.offset,
-                         init_cmds, draw_count * sizeof(MeshDrawCommand));
+    upload_batch_buffer(&startup_uploads, draw_cmd_buffer.buffer, draw_cmd_buffer.offset, init_cmds,
+                        draw_count * sizeof(MeshDrawCommand));
 
-    free(init_cmds);
 
+    // candidates: uint count, then draw ids
+    VkDeviceSize candidate_bytes = (VkDeviceSize)(draw_count + 1u) * sizeof(uint32_t);
 
-    upload_to_gpu_buffer(&allocator, qf.graphics_queue, upload_pool, draws_buffer.buffer, draws_buffer.offset, draws_cpu, draws_bytes);
+    VkDeviceSize draw_arena_size = align_up(candidate_bytes, 256) * MAX_FRAME_IN_FLIGHT;
 
-    upload_to_gpu_buffer(&allocator, qf.graphics_queue, upload_pool, material_buffer.buffer, material_buffer.offset,
-                         materials_gpu, material_bytes);
-    upload_to_gpu_buffer(&allocator, qf.graphics_queue, upload_pool, mesh_buffer.buffer, mesh_buffer.offset, meshes_gpu, mesh_bytes);
+    buffer_arena_init(&allocator, draw_arena_size, VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_AUTO_PREFER_HOST,
+                      VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, 256, &draw_arena);
 
-    free(materials_gpu);
-    free(meshes_gpu);
-    free(draws_cpu);
+    // every entry is dirty after transform_store_from_draws: the first flush is the whole buffer
+    upload_batch_buffer_fill(&startup_uploads, draws_buffer.buffer, draws_buffer.offset, draws_bytes, fill_draw_records,
+                             &draw_transforms);
+
+    // every draw is a candidate until the first pre-cull
+    BufferSlice cull_candidate_buffer[MAX_FRAME_IN_FLIGHT] = {0};
+    for(uint32_t f = 0; f < MAX_FRAME_IN_FLIGHT; f++)
+    {
+        cull_candidate_buffer[f] = buffer_arena_alloc(&draw_arena, candidate_bytes, 256);
+
+        uint32_t* cand = (uint32_t*)cull_candidate_buffer[f].mapping;
+        cand[0]        = draw_count;
+        for(uint32_t i = 0; i < draw_count; i++)
+            cand[1 + i] = i;
+    }
+
+    upload_batch_buffer(&startup_uploads, material_buffer.buffer, material_buffer.offset, materials_gpu, material_bytes);
+    upload_batch_buffer(&startup_uploads, mesh_buffer.buffer, mesh_buffer.offset, meshes_gpu, mesh_bytes);
+    if(meshlet_cull_enabled)
+        upload_batch_buffer(&startup_uploads, meshlet_buffer.buffer, meshlet_buffer.offset, scene.geometry.meshlets,
+                            (VkDeviceSize)meshlet_count * sizeof(Meshlet));
+
+    // slot counts must start at zero; draw_batch.comp resets the ones it used
+    void* batch_slots_init = calloc(1, batch_slot_bytes);
+    upload_batch_buffer(&startup_uploads, batch_slot_buffer.buffer, batch_slot_buffer.offset, batch_slots_init, batch_slot_bytes);
 
     TerrainVertex* tverts  = NULL;
     uint32_t*      tinds   = NULL;
@@ -1348,8 +1721,22 @@ int main()
     terrain_generate_grid(TERRAIN_GRID, TERRAIN_GRID, TERRAIN_CELL, &tverts, &tvcount, &tinds, &ticount);
 
     GpuMeshBuffers terrain_gpu = {0};
-    terrain_upload_to_gpu(&allocator, device, qf.graphics_queue, upload_pool, tverts, tvcount, tinds, ticount, &terrain_gpu);
+    terrain_upload_to_gpu(&allocator, &startup_uploads, tverts, tvcount, tinds, ticount, &terrain_gpu);
 
+    UploadBatchStats startup_upload_stats = {0};
+    if(!upload_batch_submit(&startup_uploads, qf.graphics_queue, upload_pool, &startup_upload_stats))
+    {
+        printf("Failed to decode scene geometry\n");
+        return 1;
+    }
+    upload_batch_print_stats(scene.geometry.packed.streams ? "startup (geometry decoded into staging)" : "startup",
+                             &startup_upload_stats);
+
+    free(wverts);
+    free(winds);
+    free(init_cmds);
+    free(batch_slots_init);
+    free(meshes_gpu);
     free(tverts);
     free(tinds);
 
@@ -1357,12 +1744,25 @@ int main()
     vec2  terrain_map_min = {-terrain_half, -terrain_half};
     vec2  terrain_map_max = {terrain_half, terrain_half};
 
+#if STREAM_SCENE_TEXTURES
+    VkBuffer     feedback_buffer = texture_streamer.feedback.buffer;
+    VkDeviceSize feedback_offset = 0;
+    VkDeviceSize feedback_bytes  = (VkDeviceSize)bindless.max_textures * sizeof(uint32_t);
+#else
+    // TEXTURE_FEEDBACK is off: the shaders never touch feedback_buf, which only
+    // needs a valid storage buffer behind it
+    VkBuffer     feedback_buffer = material_buffer.buffer;
+    VkDeviceSize feedback_offset = material_buffer.offset;
+    VkDeviceSize feedback_bytes  = material_bytes;
+#endif
+
     RenderWrite tri_writes[] = {
         RW_BUF_O("drawCommands", draw_cmd_buffer.buffer, draw_cmd_buffer.offset, draw_cmd_bytes),
         RW_BUF_O("draws", draws_buffer.buffer, draws_buffer.offset, draws_bytes),
         RW_BUF("vb", gpu_scene.vertex.buffer, vb_size),
         RW_BUF_O("g", global_ubo_buf.buffer, global_ubo_buf.offset, sizeof(GlobalUBO)),
         RW_BUF_O("materials_buf", material_buffer.buffer, material_buffer.offset, material_bytes),
+        RW_BUF_O("feedback_buf", feedback_buffer, feedback_offset, feedback_bytes),
     };
     render_object_write_static(&tri_obj, tri_writes);
 
@@ -1372,6 +1772,7 @@ int main()
         RW_BUF("vb", gpu_scene.vertex.buffer, vb_size),
         RW_BUF_O("g", global_ubo_buf.buffer, global_ubo_buf.offset, sizeof(GlobalUBO)),
         RW_BUF_O("materials_buf", material_buffer.buffer, material_buffer.offset, material_bytes),
+        RW_BUF_O("feedback_buf", feedback_buffer, feedback_offset, feedback_bytes),
     };
     render_object_write_static(&toon_obj, toon_writes);
 
@@ -1412,17 +1813,68 @@ RenderWrite water_sampler_write =
 
 render_object_write_static(&water_obj, &water_sampler_write);
 
+    // With meshlets, cull.comp only produces the visible draw list and its count
+    // doubles as the x of meshlet_cull.comp's indirect dispatch.
+    BufferSlice cull_draw_ids = meshlet_cull_enabled ? visible_draw_buffer : draw_cmd_buffer;
+    BufferSlice cull_indirect = meshlet_cull_enabled ? visible_indirect_buffer : indirect_buffer;
+    BufferSlice cull_count    = meshlet_cull_enabled ? visible_dispatch_buffer : draw_count_buffer;
+
     RenderWrite cull_writes[] = {
         RW_BUF_O("cullData", cull_data_buffer.buffer, cull_data_buffer.offset, sizeof(CullDataGpu)),
         RW_BUF_O("drawsBuf", draws_buffer.buffer, draws_buffer.offset, draws_bytes),
         RW_BUF_O("meshesBuf", mesh_buffer.buffer, mesh_buffer.offset, mesh_bytes),
-        RW_BUF_O("drawCmds", draw_cmd_buffer.buffer, draw_cmd_buffer.offset, draw_cmd_bytes),
-        RW_BUF_O("indirectCmds", indirect_buffer.buffer, indirect_buffer.offset,
+        RW_BUF_O("drawCmds", cull_draw_ids.buffer, cull_draw_ids.offset, (VkDeviceSize)draw_count * sizeof(MeshDrawCommand)),
+        RW_BUF_O("indirectCmds", cull_indirect.buffer, cull_indirect.offset,
                  (VkDeviceSize)draw_count * sizeof(VkDrawIndexedIndirectCommand)),
-        RW_BUF_O("drawCount", draw_count_buffer.buffer, draw_count_buffer.offset, sizeof(uint32_t)),
+        RW_BUF_O("drawCount", cull_count.buffer, cull_count.offset, sizeof(DrawCountGpu)),
+        RW_BUF_O("drawLods", visible_lod_buffer.buffer, visible_lod_buffer.offset, visible_draw_bytes),
+        RW_BUF_O("batchSlots", batch_slot_buffer.buffer, batch_slot_buffer.offset, batch_slot_bytes),
+        RW_BUF_O("batchSlotIds", batch_slot_id_buffer.buffer, batch_slot_id_buffer.offset, batch_slot_id_bytes),
+        RW_BUF_O("batchEntries", batch_entry_buffer.buffer, batch_entry_buffer.offset, batch_entry_bytes),
     };
     render_object_write_static(&cull_obj, cull_writes);
 
+    for(uint32_t f = 0; f < MAX_FRAME_IN_FLIGHT; f++)
+    {
+        RenderWrite candidate_write =
+            RW_BUF_O("candidates", cull_candidate_buffer[f].buffer, cull_candidate_buffer[f].offset, candidate_bytes);
+        render_object_write_frame(&cull_obj, f, &candidate_write, 1);
+    }
+
+    RenderWrite meshlet_cull_writes[] = {
+        RW_BUF_O("cullData", cull_data_buffer.buffer, cull_data_buffer.offset, sizeof(CullDataGpu)),
+        RW_BUF_O("drawsBuf", draws_buffer.buffer, draws_buffer.offset, draws_bytes),
+        RW_BUF_O("meshesBuf", mesh_buffer.buffer, mesh_buffer.offset, mesh_bytes),
+        RW_BUF_O("meshletsBuf", meshlet_buffer.buffer, meshlet_buffer.offset, meshlet_bytes),
+        RW_BUF_O("visibleDraws", visible_draw_buffer.buffer, visible_draw_buffer.offset, visible_draw_bytes),
+        RW_BUF_O("visibleLods", visible_lod_buffer.buffer, visible_lod_buffer.offset, visible_draw_bytes),
+        RW_BUF_O("drawCmds", draw_cmd_buffer.buffer, draw_cmd_buffer.offset, draw_cmd_bytes),
+        RW_BUF_O("indirectCmds", indirect_buffer.buffer, indirect_buffer.offset, indirect_bytes),
+        RW_BUF_O("drawCount", draw_count_buffer.buffer, draw_count_buffer.offset, sizeof(DrawCountGpu)),
+        RW_BUF_O("occlusion", occlusion_buffer.buffer, occlusion_buffer.offset, occlusion_bytes),
+        RW_BUF_O("batchSlots", batch_slot_buffer.buffer, batch_slot_buffer.offset, batch_slot_bytes),
+        RW_BUF_O("batchSlotIds", batch_slot_id_buffer.buffer, batch_slot_id_buffer.offset, batch_slot_id_bytes),
+        RW_BUF_O("batchEntries", batch_entry_buffer.buffer, batch_entry_buffer.offset, batch_entry_bytes),
+    };
+    render_object_write_static(&meshlet_cull_obj, meshlet_cull_writes);
+
+    RenderWrite draw_batch_writes[] = {
+        RW_BUF_O("cullData", cull_data_buffer.buffer, cull_data_buffer.offset, sizeof(CullDataGpu)),
+        RW_BUF_O("drawCount", draw_count_buffer.buffer, draw_count_buffer.offset, sizeof(DrawCountGpu)),
+        RW_BUF_O("indirectCmds", indirect_buffer.buffer, indirect_buffer.offset, indirect_bytes),
+        RW_BUF_O("drawCmds", draw_cmd_buffer.buffer, draw_cmd_buffer.offset, draw_cmd_bytes),
+        RW_BUF_O("batchSlots", batch_slot_buffer.buffer, batch_slot_buffer.offset, batch_slot_bytes),
+        RW_BUF_O("batchSlotIds", batch_slot_id_buffer.buffer, batch_slot_id_buffer.offset, batch_slot_id_bytes),
+        RW_BUF_O("batchEntries", batch_entry_buffer.buffer, batch_entry_buffer.offset, batch_entry_bytes),
+    };
+    render_object_write_static(&draw_batch_obj, draw_batch_writes);
+
+    // Occlusion depth input is the per-frame depth target, written in the frame loop.
+    RenderWrite occlusion_writes[] = {
+        RW_BUF_O("occlusion", occlusion_buffer.buffer, occlusion_buffer.offset, occlusion_bytes),
+    };
+    render_object_write_static(&occlusion_obj, occlusion_writes);
+
     RenderWrite terrain_paint_writes[] = {
         RW_IMG("sculptDelta", sculpt_delta_img.view, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_GENERAL),
     };
@@ -1539,10 +1991,41 @@ render_object_write_static(&water_obj, &water_sampler_write);
     VkSampler   postprocess_input_sampler[MAX_FRAME_IN_FLIGHT]  = {VK_NULL_HANDLE};
     VkSampler   postprocess_linear_sampler[MAX_FRAME_IN_FLIGHT] = {VK_NULL_HANDLE};
 
+    VkImageView occlusion_depth_view[MAX_FRAME_IN_FLIGHT] = {VK_NULL_HANDLE};
+
     bool swapchain_needs_recreate = false;
 
-    const float    lod_target  = 1.0f;  // max screen-space error in pixels
-    const uint32_t lod_enabled = 1;
+    // batched commands start at a non-zero firstInstance; without
+    // drawIndirectFirstInstance every draw stays its own command and the vertex
+    // shaders index by gl_DrawIDARB
+    VkPhysicalDeviceFeatures gpu_features = {0};
+    vkGetPhysicalDeviceFeatures(gpu, &gpu_features);
+    if(!gpu_features.drawIndirectFirstInstance)
+        printf("drawIndirectFirstInstance unsupported, automatic instancing off\n");
+
+    const float    lod_target         = 1.0f;  // max screen-space error in pixels
+    const uint32_t lod_enabled        = 1;
+    const uint32_t occlusion_enabled  = 1;
+    const bool     bvh_precull        = true;
+
+    // merge draws of the same LOD / meshlet; F3 toggles it and prints the GPU
+    // time of the cull and gfx scopes averaged per setting
+    uint32_t instancing_enabled                   = gpu_features.drawIndirectFirstInstance ? 1u : 0u;
+    uint32_t prof_instancing[MAX_FRAME_IN_FLIGHT] = {0};  // setting each profiler's frame was recorded with
+    double   instancing_gpu_us[2]                 = {0.0, 0.0};
+    uint32_t instancing_gpu_frames[2]             = {0, 0};
+    bool     last_instancing_toggle               = false;
+
+    uint32_t cull_candidate_count = draw_count;
+    uint32_t picked_draw          = UINT32_MAX;
+    bool     last_pick_down       = false;
+
+    // compute passes feed each other and the indirect draws, so they are not
+    // skippable; the graphics passes below check render_pipeline_ready per frame
+    RenderObject* blocking_objs[] = {&cull_obj,      &meshlet_cull_obj,  &draw_batch_obj,
+                                     &occlusion_obj, &terrain_paint_obj, &postprocess_obj};
+    for(uint32_t i = 0; i < sizeof(blocking_objs) / sizeof(blocking_objs[0]); i++)
+        render_pipeline_wait(&blocking_objs[i]->pipeline);
 
     while(!glfwWindowShouldClose(window))
     {
@@ -1575,7 +2058,9 @@ swapchain_needs_recreate |=
                 continue;
             }
 
+            vk_queue_lock();
             vkDeviceWaitIdle(device);
+            vk_queue_unlock();
 
 
             vk_swapchain_recreate(device, gpu, &swap, w, h, qf.graphics_queue, upload_pool);
@@ -1600,6 +2085,7 @@ swapchain_needs_recreate |=
         }
 
         render_pipeline_hot_reload_update();
+        pipeline_cache_file_update(&pipeline_cache);
 
 
         double mx, my;
@@ -1620,6 +2106,25 @@ swapchain_needs_recreate |=
         }
         last_sculpt_toggle = sculpt_toggle;
 
+        bool instancing_toggle = glfwGetKey(window, GLFW_KEY_F3) == GLFW_PRESS;
+        if(instancing_toggle && !last_instancing_toggle && gpu_features.drawIndirectFirstInstance)
+        {
+            for(uint32_t m = 0; m < 2; m++)
+            {
+                if(instancing_gpu_frames[m])
+                    printf("instancing %s: cull + gfx %.1f us over %u frames\n", m ? "on" : "off",
+                           instancing_gpu_us[m] / instancing_gpu_frames[m], instancing_gpu_frames[m]);
+            }
+            // frames in flight read the setting from the shared global UBO
+            vk_queue_lock();
+            vkDeviceWaitIdle(device);
+            vk_queue_unlock();
+
+            instancing_enabled = !instancing_enabled;
+            printf("[INSTANCING %s]\n", instancing_enabled ? "ON" : "OFF");
+        }
+        last_instancing_toggle = instancing_toggle;
+
         if(!gui.enabled)
             glfwSetInputMode(window, GLFW_CURSOR, sculpt_mode ? GLFW_CURSOR_NORMAL : GLFW_CURSOR_DISABLED);
 
@@ -1696,9 +2201,48 @@ swapchain_needs_recreate |=
         GlobalUBO ubo    = {0};
         float     aspect = (float)swap.extent.width / (float)swap.extent.height;
         build_global_ubo(&ubo, &cam, aspect);
+        ubo.drawParams[0] = instancing_enabled;
 
         memcpy(global_ubo_buf.mapping, &ubo, sizeof(ubo));
 
+        if(draw_animations.trackCount)
+        {
+            animation_set_sample(&draw_animations, (float)glfwGetTime(), false, &draw_transforms);
+
+            // animated draws move: keep their objects, scene.draws and the BVH spheres in step
+            for(uint32_t t = 0; t < draw_animations.trackCount; t++)
+            {
+                uint32_t di = draw_animations.entry[t];
+                if(di >= draw_count)
+                    continue;
+
+                SceneObject* obj = scene_object_get(&scene, draw_transforms.objectId[di]);
+                if(obj)
+                {
+                    obj->position[0] = draw_transforms.px[di];
+                    obj->position[1] = draw_transforms.py[di];
+                    obj->position[2] = draw_transforms.pz[di];
+                    obj->scale       = draw_transforms.scale[di];
+                    glm_quat_copy((versor){draw_transforms.qx[di], draw_transforms.qy[di], draw_transforms.qz[di],
+                                           draw_transforms.qw[di]},
+                                  obj->rotation);
+                }
+
+                MeshDraw* d    = &scene.draws[di];
+                d->position[0] = draw_transforms.px[di];
+                d->position[1] = draw_transforms.py[di];
+                d->position[2] = draw_transforms.pz[di];
+                d->scale       = draw_transforms.scale[di];
+                glm_quat_copy((versor){draw_transforms.qx[di], draw_transforms.qy[di], draw_transforms.qz[di],
+                                       draw_transforms.qw[di]},
+                              d->orientation);
+
+                vec4 sphere;
+                scene_draw_sphere(&scene, di, sphere);
+                scene_bvh_update(&draw_bvh, di, sphere);
+            }
+        }
+
         WaterMaterialGpu water_mat = {0};
         water_mat.shallow_color[0] = water_gui.shallow_color[0];
         water_mat.shallow_color[1] = water_gui.shallow_color[1];
@@ -1725,9 +2269,9 @@ swapchain_needs_recreate |=
         water_mat.params1[2] = water_gui.color_variation;
         water_mat.params1[3] = water_gui.distortion_strength;
 
-        water_mat.textures[0] = water_normal_slot;
-        water_mat.textures[1] = water_foam_slot;
-        water_mat.textures[2] = water_noise_slot;
+        water_mat.textures[0] = bindless_textures_resolve(&bindless, water_normal_tex);
+        water_mat.textures[1] = bindless_textures_resolve(&bindless, water_foam_tex);
+        water_mat.textures[2] = bindless_textures_resolve(&bindless, water_noise_tex);
         water_mat.textures[3] = 0;
 
         WaterInstanceGpu water_inst = {0};
@@ -1753,6 +2297,11 @@ swapchain_needs_recreate |=
         cull.params[3]   = (float)swap.extent.height;
         cull.counts[0]   = draw_count;
         cull.counts[1]   = lod_enabled;
+        cull.counts[2]   = occlusion_enabled;
+        cull.counts[3]   = draw_cmd_capacity;
+        cull.batch[0]    = meshlet_cull_enabled ? 0u : 1u;
+        cull.batch[1]    = instancing_enabled;
+        cull.batch[2]    = lod_slot_count;
 
         memcpy(cull_data_buffer.mapping, &cull, sizeof(cull));
 
@@ -1820,13 +2369,78 @@ swapchain_needs_recreate |=
             sculpt_dragging = false;
         }
 
+        // Object picking with the GUI cursor: nearest draw bounding sphere under the mouse
+        bool pick_down = mouse_down && gui.enabled && !sculpt_mode && !imgui_capture_mouse;
+        if(pick_down && !last_pick_down)
+        {
+            vec3  ray_o, ray_d;
+            float hit_t = 0.0f;
+            camera_screen_ray(&cam, (float)mx, (float)my, (float)fb_w, (float)fb_h, aspect, ray_o, ray_d);
+
+            if(scene_bvh_raycast(&draw_bvh, ray_o, ray_d, FLT_MAX, &picked_draw, &hit_t))
+                printf("[PICK] draw %u mesh %u material %u t=%.2f\n", picked_draw, scene.draws[picked_draw].meshIndex,
+                       scene.draws[picked_draw].materialIndex, hit_t);
+            else
+                picked_draw = UINT32_MAX;
+        }
+        last_pick_down = pick_down;
+
         bool recreate = false;
         vkWaitForFences(device, 1, &frame_sync[current_frame].in_flight_fence, VK_TRUE, UINT64_MAX);
 
+        // the fence covers every earlier submit on the queue: textures destroyed
+        // up to that frame can go
+        bindless_textures_begin_frame(&bindless, &allocator, device, frame_value + 1, frame_submitted[current_frame]);
+
+        const TextureSlotMove* slot_moves = NULL;
+        uint32_t               move_count = 0;
+#if STREAM_SCENE_TEXTURES
+        // this slot's feedback is complete now; finished rebuilds land in fresh
+        // slots and retire the old ones behind the frames in flight
+        move_count = texture_streamer_update(&texture_streamer, current_frame, &slot_moves);
+        if(move_count > 0)
+            repoint_material_slots(materials_gpu, material_dirty, material_count, slot_moves, move_count);
+#endif
+
+        // loaded textures land in fresh slots the same way
+        if(!texture_loader_idle(&texture_loader))
+        {
+            move_count = texture_loader_update(&texture_loader, &slot_moves);
+            if(move_count > 0)
+                repoint_material_slots(materials_gpu, material_dirty, material_count, slot_moves, move_count);
+
+            if(texture_loader_idle(&texture_loader))
+            {
+                texture_loader_print_stats(&texture_loader);
+                bindless_textures_print_dedup_stats(&bindless, &allocator);
+            }
+        }
+
+        // CPU pre-cull: only draws whose sphere touches the frustum go to cull.comp.
+        // Written after the fence wait, so this frame's candidate buffer is free.
+        if(bvh_precull)
+        {
+            vec4 planes[6];
+            scene_bvh_frustum_planes(ubo.view, tan_half_x, tan_half_y, cam.znear, cam.zfar, planes);
+
+            uint32_t* cand       = (uint32_t*)cull_candidate_buffer[current_frame].mapping;
+            cull_candidate_count = scene_bvh_query_frustum(&draw_bvh, planes, cand + 1, draw_count);
+            cand[0]              = cull_candidate_count;
+        }
+
+        // the heightmaps are still sampled by the other frame in flight, and
+        // the transfer queue is not ordered against it
+        if(request_load || request_regen)
+        {
+            for(u32 i = 0; i < MAX_FRAME_IN_FLIGHT; i++)
+                vkWaitForFences(device, 1, &frame_sync[i].in_flight_fence, VK_TRUE, UINT64_MAX);
+        }
+
         if(request_load)
         {
             TerrainSaveHeader hdr = {0};
-            if(terrain_load_heightmap(TERRAIN_SAVE_PATH, &allocator, device, qf.graphics_queue, upload_pool, &sculpt_delta_img, &hdr))
+            StagingRing*      up  = upload_engine_begin(&uploads);
+            if(terrain_load_heightmap(TERRAIN_SAVE_PATH, up, &sculpt_delta_img, &hdr))
             {
                 terrain_gui.height_scale    = hdr.heightScale;
                 terrain_gui.freq            = hdr.freq;
@@ -1835,15 +2449,15 @@ swapchain_needs_recreate |=
                 printf("[TERRAIN] Loaded sculpt delta from %s\n", TERRAIN_SAVE_PATH);
 
                 // Re-bake base terrain with new parameters
-                terrain_bake_base_heightmap(&allocator, device, qf.graphics_queue, upload_pool, &base_height,
-                                            HEIGHTMAP_RES, terrain_map_min[0], terrain_map_min[1], terrain_map_max[0],
-                                            terrain_map_max[1], terrain_gui.freq, terrain_gui.noise_offset[0],
-                                            terrain_gui.noise_offset[1], terrain_gui.height_scale);
+                terrain_bake_base_heightmap(up, &base_height, HEIGHTMAP_RES, terrain_map_min[0], terrain_map_min[1],
+                                            terrain_map_max[0], terrain_map_max[1], terrain_gui.freq,
+                                            terrain_gui.noise_offset[0], terrain_gui.noise_offset[1], terrain_gui.height_scale);
             }
             else
             {
                 printf("[TERRAIN] Failed to load %s\n", TERRAIN_SAVE_PATH);
             }
+            upload_engine_submit(&uploads);
             request_load = false;
         }
 
@@ -1856,10 +2470,10 @@ swapchain_needs_recreate |=
             terrain_clear_heightmap(device, qf.graphics_queue, upload_pool, &sculpt_delta_img);
 
             // Re-bake base terrain with new seed
-            terrain_bake_base_heightmap(&allocator, device, qf.graphics_queue, upload_pool, &base_height, HEIGHTMAP_RES,
-                                        terrain_map_min[0], terrain_map_min[1], terrain_map_max[0], terrain_map_max[1],
-                                        terrain_gui.freq, terrain_gui.noise_offset[0], terrain_gui.noise_offset[1],
-                                        terrain_gui.height_scale);
+            terrain_bake_base_heightmap(upload_engine_begin(&uploads), &base_height, HEIGHTMAP_RES, terrain_map_min[0],
+                                        terrain_map_min[1], terrain_map_max[0], terrain_map_max[1], terrain_gui.freq,
+                                        terrain_gui.noise_offset[0], terrain_gui.noise_offset[1], terrain_gui.height_scale);
+            upload_engine_submit(&uploads);
             printf("[TERRAIN] Procedural terrain regenerated (seed %.2f, %.2f)\n", terrain_gui.noise_offset[0],
                    terrain_gui.noise_offset[1]);
             request_regen = false;
@@ -1893,6 +2507,13 @@ swapchain_needs_recreate |=
 
         GpuProfiler* P = &prof[current_frame];
         gpu_prof_resolve(P);
+
+        float cull_us = 0.0f, gfx_us = 0.0f;
+        if(gpu_prof_get_us(P, "cull", &cull_us) && gpu_prof_get_us(P, "gfx", &gfx_us))
+        {
+            instancing_gpu_us[prof_instancing[current_frame]] += cull_us + gfx_us;
+            instancing_gpu_frames[prof_instancing[current_frame]]++;
+        }
         vkResetFences(device, 1, &frame_sync[current_frame].in_flight_fence);
         /* reset EVERYTHING allocated for this frame */
         vkResetCommandPool(device, cmd_pools[current_frame], 0);
@@ -1917,9 +2538,16 @@ swapchain_needs_recreate |=
         render_pipeline_hot_reload_update();  // safe-ish now
         VkCommandBuffer cmd = cmd_buffers[current_frame];
         vk_cmd_begin(cmd, true);
+        staging_ring_begin_frame(&staging, current_frame, cmd);
+        upload_dirty_draws(&staging, cmd, &draw_transforms, draws_buffer);
+        upload_dirty_materials(cmd, materials_gpu, material_dirty, material_count, material_buffer);
+
+        VkSemaphoreSubmitInfo upload_wait  = {0};
+        bool                  wait_uploads = upload_engine_acquire(&uploads, cmd, &upload_wait);
 
 
         gpu_prof_begin_frame(cmd, P);
+        prof_instancing[current_frame] = instancing_enabled;
         /* transition for rendering target */
 
         // Transition HDR image for rendering
@@ -2004,10 +2632,13 @@ swapchain_needs_recreate |=
                 .hazeStrength   = 0.15f,
                 .exposure       = 1.0f,
             };
-            render_instance_bind(cmd, &sky_inst, VK_PIPELINE_BIND_POINT_GRAPHICS, current_frame);
-            render_instance_set_push_data(&sky_inst, &sky_pc, sizeof(sky_pc));
-            render_instance_push(cmd, &sky_inst);
-            vkCmdDraw(cmd, 3, 1, 0, 0);
+            if(render_pipeline_ready(&sky_obj.pipeline))
+            {
+                render_instance_bind(cmd, &sky_inst, VK_PIPELINE_BIND_POINT_GRAPHICS, current_frame);
+                render_instance_set_push_data(&sky_inst, &sky_pc, sizeof(sky_pc));
+                render_instance_push(cmd, &sky_inst);
+                vkCmdDraw(cmd, 3, 1, 0, 0);
+            }
         }
 
         GPU_SCOPE(cmd, P, "terrain", VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT)
@@ -2050,10 +2681,13 @@ swapchain_needs_recreate |=
 
 
             // --- TERRAIN ---
-            render_instance_bind(cmd, &terrain_inst, VK_PIPELINE_BIND_POINT_GRAPHICS, current_frame);
-            render_instance_set_push_data(&terrain_inst, &pc, sizeof(pc));
-            render_instance_push(cmd, &terrain_inst);
-            render_draw_indexed_mesh(cmd, &terrain_gpu);
+            if(render_pipeline_ready(&terrain_obj.pipeline))
+            {
+                render_instance_bind(cmd, &terrain_inst, VK_PIPELINE_BIND_POINT_GRAPHICS, current_frame);
+                render_instance_set_push_data(&terrain_inst, &pc, sizeof(pc));
+                render_instance_push(cmd, &terrain_inst);
+                render_draw_indexed_mesh(cmd, &terrain_gpu);
+            }
         }
 
 
@@ -2077,10 +2711,13 @@ swapchain_needs_recreate |=
             };
 
 
-            render_instance_bind(cmd, &grass_inst, VK_PIPELINE_BIND_POINT_GRAPHICS, current_frame);
-            render_instance_set_push_data(&grass_inst, &gpc, sizeof(gpc));
-            render_instance_push(cmd, &grass_inst);
-            vkCmdDraw(cmd, 6, GRASS_INSTANCE_COUNT, 0, 0);
+            if(render_pipeline_ready(&grass_obj.pipeline))
+            {
+                render_instance_bind(cmd, &grass_inst, VK_PIPELINE_BIND_POINT_GRAPHICS, current_frame);
+                render_instance_set_push_data(&grass_inst, &gpc, sizeof(gpc));
+                render_instance_push(cmd, &grass_inst);
+                vkCmdDraw(cmd, 6, GRASS_INSTANCE_COUNT, 0, 0);
+            }
             // if(grass_gpu_mesh.index_count > 0)
             // {
             //     VkDeviceSize offsets[] = {0};
@@ -2090,7 +2727,7 @@ swapchain_needs_recreate |=
             // }
         }
 
-        if(water_gui.enabled)
+        if(water_gui.enabled && render_pipeline_ready(&water_obj.pipeline))
         {
 
 
@@ -2173,16 +2810,97 @@ swapchain_needs_recreate |=
                                 .dst_stage  = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
                                 .src_access = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
                                 .dst_access = VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT);
+        if(meshlet_cull_enabled && occlusion_enabled)
+        {
+            // Depth so far holds terrain/grass/water, which occlude the meshes drawn next.
+            GPU_SCOPE(cmd, P, "occlusion", VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT)
+            {
+                if(occlusion_depth_view[current_frame] != depth.view[current_frame])
+                {
+                    RenderWrite depth_write = RW_IMG("depthTex", depth.view[current_frame], heightmap_sampler,
+                                                     VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_OPTIMAL);
+                    render_object_write_frame(&occlusion_obj, current_frame, &depth_write, 1);
+                    occlusion_depth_view[current_frame] = depth.view[current_frame];
+                }
+
+                IMAGE_BARRIER_IMMEDIATE(cmd, depth.image[current_frame], VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
+                                        VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_OPTIMAL,
+                                        .src_stage  = VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+                                        .dst_stage  = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                                        .src_access = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                                        .dst_access = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, .aspect = VK_IMAGE_ASPECT_DEPTH_BIT);
+
+                render_instance_bind(cmd, &occlusion_inst, VK_PIPELINE_BIND_POINT_COMPUTE, current_frame);
+                vkCmdDispatch(cmd, OCCLUSION_GRID_W, OCCLUSION_GRID_H, 1);
+
+                IMAGE_BARRIER_IMMEDIATE(cmd, depth.image[current_frame], VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_OPTIMAL,
+                                        VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
+                                        .src_stage  = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                                        .dst_stage  = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT,
+                                        .src_access = 0,
+                                        .dst_access = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT
+                                                      | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                                        .aspect = VK_IMAGE_ASPECT_DEPTH_BIT);
+                BUFFER_BARRIER_IMMEDIATE(cmd, occlusion_buffer.buffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                                         VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+            }
+        }
+
         GPU_SCOPE(cmd, P, "cull", VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT)
         {
-            vkCmdFillBuffer(cmd, draw_count_buffer.buffer, draw_count_buffer.offset, sizeof(uint32_t), 0);
+            DrawCountGpu count_init = {.emitDispatch = {0, 1, 1}, .batchDispatch = {0, 1, 1}};
+            vkCmdUpdateBuffer(cmd, draw_count_buffer.buffer, draw_count_buffer.offset, sizeof(count_init), &count_init);
+            if(meshlet_cull_enabled)
+            {
+                VkDispatchIndirectCommand dispatch_init = {0, 1, 1};
+                vkCmdUpdateBuffer(cmd, visible_dispatch_buffer.buffer, visible_dispatch_buffer.offset, sizeof(dispatch_init),
+                                  &dispatch_init);
+                BUFFER_BARRIER_IMMEDIATE(cmd, visible_dispatch_buffer.buffer, VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                                         VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+            }
             BUFFER_BARRIER_IMMEDIATE(cmd, draw_count_buffer.buffer, VK_PIPELINE_STAGE_2_TRANSFER_BIT,
                                      VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
 
             render_instance_bind(cmd, &cull_inst, VK_PIPELINE_BIND_POINT_COMPUTE, current_frame);
 
-            uint32_t group_count = (draw_count + 63u) / 64u;
-            vkCmdDispatch(cmd, group_count, 1, 1);
+            uint32_t group_count = (cull_candidate_count + 63u) / 64u;
+            if(group_count)
+                vkCmdDispatch(cmd, group_count, 1, 1);
+
+            if(meshlet_cull_enabled)
+            {
+                BUFFER_BARRIER_IMMEDIATE(cmd, visible_draw_buffer.buffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                                         VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+                BUFFER_BARRIER_IMMEDIATE(cmd, visible_dispatch_buffer.buffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                                         VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT);
+
+                // one workgroup per visible draw
+                render_instance_bind(cmd, &meshlet_cull_inst, VK_PIPELINE_BIND_POINT_COMPUTE, current_frame);
+                vkCmdDispatchIndirect(cmd, visible_dispatch_buffer.buffer, visible_dispatch_buffer.offset);
+            }
+
+            if(instancing_enabled)
+            {
+                // size the batches, then scatter draw ids into instance order
+                BUFFER_BARRIER_IMMEDIATE(cmd, draw_count_buffer.buffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                                         VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT);
+                BUFFER_BARRIER_IMMEDIATE(cmd, batch_slot_buffer.buffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                                         VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+
+                render_instance_bind(cmd, &draw_batch_inst, VK_PIPELINE_BIND_POINT_COMPUTE, current_frame);
+                uint32_t pass = 0;
+                render_instance_set_push_data(&draw_batch_inst, &pass, sizeof(pass));
+                render_instance_push(cmd, &draw_batch_inst);
+                vkCmdDispatchIndirect(cmd, draw_count_buffer.buffer, draw_count_buffer.offset + offsetof(DrawCountGpu, batchDispatch));
+
+                BUFFER_BARRIER_IMMEDIATE(cmd, indirect_buffer.buffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                                         VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+
+                pass = 1;
+                render_instance_set_push_data(&draw_batch_inst, &pass, sizeof(pass));
+                render_instance_push(cmd, &draw_batch_inst);
+                vkCmdDispatchIndirect(cmd, draw_count_buffer.buffer, draw_count_buffer.offset + offsetof(DrawCountGpu, emitDispatch));
+            }
 
             BUFFER_BARRIER_IMMEDIATE(cmd, draw_cmd_buffer.buffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
                                      VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT);
@@ -2222,25 +2940,38 @@ swapchain_needs_recreate |=
                 toon_pc.light_dir_intensity[2] = light_dir[2];
             }
 
-            render_instance_bind(cmd, &toon_inst, VK_PIPELINE_BIND_POINT_GRAPHICS, current_frame);
-            render_instance_set_push_data(&toon_inst, &toon_pc, sizeof(ToonPC));
-            render_instance_push(cmd, &toon_inst);
+            // instanced, the stream holds one command per batch
+            VkDeviceSize draw_count_offset =
+                draw_count_buffer.offset + (instancing_enabled ? offsetof(DrawCountGpu, batchCount) : 0);
 
             vkCmdBindIndexBuffer(cmd, gpu_scene.index.buffer, 0, VK_INDEX_TYPE_UINT32);
 
-            render_draw_indirect_count(cmd, indirect_buffer.buffer, indirect_buffer.offset, draw_count_buffer.buffer,
-                                       draw_count_buffer.offset, draw_count);
+            if(render_pipeline_ready(&toon_obj.pipeline))
+            {
+                render_instance_bind(cmd, &toon_inst, VK_PIPELINE_BIND_POINT_GRAPHICS, current_frame);
+                render_instance_set_push_data(&toon_inst, &toon_pc, sizeof(ToonPC));
+                render_instance_push(cmd, &toon_inst);
+                render_draw_indirect_count(cmd, indirect_buffer.buffer, indirect_buffer.offset, draw_count_buffer.buffer,
+                                           draw_count_offset, draw_cmd_capacity);
+            }
 
             toon_pc.params0[2] = toon_gui.outline_width;
-            render_instance_bind(cmd, &toon_outline_inst, VK_PIPELINE_BIND_POINT_GRAPHICS, current_frame);
-            render_instance_set_push_data(&toon_outline_inst, &toon_pc, sizeof(ToonPC));
-            render_instance_push(cmd, &toon_outline_inst);
-            render_draw_indirect_count(cmd, indirect_buffer.buffer, indirect_buffer.offset, draw_count_buffer.buffer,
-                                       draw_count_buffer.offset, draw_count);
+            if(render_pipeline_ready(&toon_outline_obj.pipeline))
+            {
+                render_instance_bind(cmd, &toon_outline_inst, VK_PIPELINE_BIND_POINT_GRAPHICS, current_frame);
+                render_instance_set_push_data(&toon_outline_inst, &toon_pc, sizeof(ToonPC));
+                render_instance_push(cmd, &toon_outline_inst);
+                render_draw_indirect_count(cmd, indirect_buffer.buffer, indirect_buffer.offset, draw_count_buffer.buffer,
+                                           draw_count_offset, draw_cmd_capacity);
+            }
 
             vkCmdEndRendering(cmd);
         }
 
+#if STREAM_SCENE_TEXTURES
+        texture_streamer_cmd_feedback(&texture_streamer, cmd, current_frame);
+#endif
+
         //         VkRenderingAttachmentInfo color_attach_overlay = color_attach;
         //         color_attach_overlay.loadOp                    = VK_ATTACHMENT_LOAD_OP_LOAD;
         //
@@ -2368,10 +3099,13 @@ swapchain_needs_recreate |=
                                 .src_access = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, .dst_access = 0);
         gpu_prof_end_frame(cmd, P);
         vk_cmd_end(cmd);
-        VkSemaphoreSubmitInfo wait_info   = {.sType     = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
-                                             .semaphore = frame_sync[current_frame].image_available_semaphore,
-                                             .value     = 0,
-                                             .stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT};
+        VkSemaphoreSubmitInfo wait_infos[2] = {
+            {.sType     = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+             .semaphore = frame_sync[current_frame].image_available_semaphore,
+             .value     = 0,
+             .stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT},
+            upload_wait,
+        };
         VkSemaphoreSubmitInfo signal_info = {
             .sType     = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
             .semaphore = swap.render_finished[image_index],
@@ -2385,8 +3119,8 @@ swapchain_needs_recreate |=
                                              .deviceMask    = 0};
 
         VkSubmitInfo2 submit = {.sType                    = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
-                                .waitSemaphoreInfoCount   = 1,
-                                .pWaitSemaphoreInfos      = &wait_info,
+                                .waitSemaphoreInfoCount   = wait_uploads ? 2u : 1u,
+                                .pWaitSemaphoreInfos      = wait_infos,
                                 .commandBufferInfoCount   = 1,
                                 .pCommandBufferInfos      = &cmdInfo,
                                 .signalSemaphoreInfoCount = 1,
@@ -2395,7 +3129,10 @@ swapchain_needs_recreate |=
 
         };
 
+        vk_queue_lock();
         VK_CHECK(vkQueueSubmit2(qf.graphics_queue, 1, &submit, frame_sync[current_frame].in_flight_fence));
+        vk_queue_unlock();
+        frame_submitted[current_frame] = ++frame_value;
         if(!vk_swapchain_present(qf.present_queue, &swap, &swap.render_finished[swap.current_image], 1, &recreate))
         {
             if(recreate)
@@ -2410,7 +3147,18 @@ swapchain_needs_recreate |=
         TracyCFrameMarkEnd("Frame");
     }
 
+    vk_queue_lock();
     vkDeviceWaitIdle(device);
+    vk_queue_unlock();
+
+    // finish in-flight compiles before the layouts they use are destroyed
+    pipeline_compiler_print_stats(&pipeline_compiler);
+    pipeline_compiler_destroy(&pipeline_compiler);
+    pipeline_cache_file_print_stats(&pipeline_cache);
+    pipeline_cache_file_close(&pipeline_cache);
+    vk_slang_print_stats();
+    vk_slang_shutdown();
+    scene_import_shutdown();
 
     TerrainSaveHeader autosave_hdr = {
         .magic       = TERRAIN_SAVE_MAGIC,
@@ -2436,13 +3184,24 @@ swapchain_needs_recreate |=
     descriptor_layout_cache_destroy(&desc_cache);
     pipeline_layout_cache_destroy(device, &pipe_cache);
 
+    texture_loader_destroy(&texture_loader);
+#if STREAM_SCENE_TEXTURES
+    texture_streamer_print_stats(&texture_streamer);
+    texture_streamer_destroy(&texture_streamer);
+#endif
     bindless_textures_destroy(&bindless, &allocator, device);
+    free(materials_gpu);
+    free(material_dirty);
 
     if(indirect_uses_fallback)
         res_destroy_buffer(&allocator, &indirect_fallback_buffer);
 
     buffer_arena_destroy(&allocator, &host_arena);
     buffer_arena_destroy(&allocator, &device_arena);
+    buffer_arena_destroy(&allocator, &draw_arena);
+    scene_bvh_destroy(&draw_bvh);
+    animation_set_destroy(&draw_animations);
+    transform_store_destroy(&draw_transforms);
     res_destroy_buffer(&allocator, &gpu_scene.index);
     res_destroy_buffer(&allocator, &gpu_scene.vertex);
     res_destroy_buffer(&allocator, &terrain_gpu.index);
@@ -2473,6 +3232,8 @@ swapchain_needs_recreate |=
 
     vk_swapchain_destroy(device, &swap);
 
+    upload_engine_destroy(&uploads);
+    staging_ring_destroy(&staging);
     res_deinit(&allocator);  // <- allocator dies LAST
 
     for(u32 i = 0; i < MAX_FRAME_IN_FLIGHT; i++)
@@ -2506,6 +3267,9 @@ swapchain_needs_recreate |=
     render_object_destroy(device, &grass_obj);
     render_object_destroy(device, &water_obj);
     render_object_destroy(device, &cull_obj);
+    render_object_destroy(device, &meshlet_cull_obj);
+    render_object_destroy(device, &draw_batch_obj);
+    render_object_destroy(device, &occlusion_obj);
     render_object_destroy(device, &terrain_paint_obj);
     render_object_destroy(device, &postprocess_obj);
     render_object_destroy(device, &sky_obj);
@@ -0,0 +1,456 @@
+#include "texture_file.h"
+#include "file_utils.h"
+#include "texture_mips.h"
+
+#define DDSKTX_IMPLEMENT
+#include "external/dds-ktx/dds-ktx.h"
+#include "external/stb/stb_image.h"
+
+#include <ctype.h>
+
+typedef void (*TextureBlockDecode)(const uint8_t* block, uint8_t* out_rgba);
+
+typedef struct TextureBcFormat
+{
+    ddsktx_format      dds;
+    VkFormat           vk;
+    uint32_t           block_bytes;
+    TextureBlockDecode decode;  // NULL: no CPU fallback
+} TextureBcFormat;
+
+static const TextureBcFormat g_bc_formats[] = {
+    {DDSKTX_FORMAT_BC1, VK_FORMAT_BC1_RGBA_UNORM_BLOCK, 8, texture_bc1_decode_block},
+    {DDSKTX_FORMAT_BC2, VK_FORMAT_BC2_UNORM_BLOCK, 16, texture_bc2_decode_block},
+    {DDSKTX_FORMAT_BC3, VK_FORMAT_BC3_UNORM_BLOCK, 16, texture_bc3_decode_block},
+    {DDSKTX_FORMAT_BC4, VK_FORMAT_BC4_UNORM_BLOCK, 8, texture_bc4_decode_block},
+    {DDSKTX_FORMAT_BC5, VK_FORMAT_BC5_UNORM_BLOCK, 16, texture_bc5_decode_block},
+    {DDSKTX_FORMAT_BC6H, VK_FORMAT_BC6H_UFLOAT_BLOCK, 16, NULL},
+    {DDSKTX_FORMAT_BC7, VK_FORMAT_BC7_UNORM_BLOCK, 16, NULL},
+};
+
+#define BC_FORMAT_COUNT (sizeof(g_bc_formats) / sizeof(g_bc_formats[0]))
+
+// zero = supported, so loads before texture_file_query_support() keep the BC data
+static bool g_bc_unsupported[BC_FORMAT_COUNT];
+
+static uint32_t calc_mip_count(uint32_t w, uint32_t h)
+{
+    uint32_t levels = 1;
+    while(w > 1 || h > 1)
+    {
+        w = (w > 1) ? (w >> 1) : 1;
+        h = (h > 1) ? (h >> 1) : 1;
+        levels++;
+    }
+    return levels;
+}
+
+void texture_file_query_support(VkPhysicalDevice gpu)
+{
+    const VkFormatFeatureFlags need = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT
+                                      | VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+
+    for(uint32_t i = 0; i < BC_FORMAT_COUNT; i++)
+    {
+        VkFormatProperties props = {0};
+        vkGetPhysicalDeviceFormatProperties(gpu, g_bc_formats[i].vk, &props);
+        g_bc_unsupported[i] = (props.optimalTilingFeatures & need) != need;
+        if(g_bc_unsupported[i])
+            log_info("[textures] %s not sampleable: %s", ddsktx_format_str(g_bc_formats[i].dds),
+                     g_bc_formats[i].decode ? "decoding to RGBA8 on load" : "no fallback");
+    }
+}
+
+bool texture_file_format_supported(VkFormat format)
+{
+    for(uint32_t i = 0; i < BC_FORMAT_COUNT; i++)
+    {
+        if(g_bc_formats[i].vk == format)
+            return !g_bc_unsupported[i];
+    }
+    return true;
+}
+
+static bool has_extension(const char* path, const char* ext)
+{
+    const char* dot = strrchr(path, '.');
+    if(!dot)
+        return false;
+
+    for(; *dot && *ext; dot++, ext++)
+    {
+        if(tolower((unsigned char)*dot) != *ext)
+            return false;
+    }
+    return *dot == '\0' && *ext == '\0';
+}
+
+// ------------------------------------------------------------
+// BC1-BC5 CPU decode
+// ------------------------------------------------------------
+
+static void rgb565_to_rgba8(uint16_t c, uint8_t* out)
+{
+    uint32_t r = (c >> 11) & 31;
+    uint32_t g = (c >> 5) & 63;
+    uint32_t b = c & 31;
+
+    out[0] = (uint8_t)((r << 3) | (r >> 2));
+    out[1] = (uint8_t)((g << 2) | (g >> 4));
+    out[2] = (uint8_t)((b << 3) | (b >> 2));
+    out[3] = 255;
+}
+
+// 8-byte color block shared by BC1-BC3. BC2/BC3 always use the four-color
+// mode; BC1 switches to three colors + transparent black when c0 <= c1.
+static void decode_color_block(const uint8_t* block, uint8_t* out_rgba, bool bc1)
+{
+    uint16_t c0 = (uint16_t)(block[0] | (block[1] << 8));
+    uint16_t c1 = (uint16_t)(block[2] | (block[3] << 8));
+    uint32_t bits = (uint32_t)block[4] | ((uint32_t)block[5] << 8) | ((uint32_t)block[6] << 16) | ((uint32_t)block[7] << 24);
+
+    uint8_t palette[4][4];
+    rgb565_to_rgba8(c0, palette[0]);
+    rgb565_to_rgba8(c1, palette[1]);
+
+    if(c0 > c1 || !bc1)
+    {
+        for(int k = 0; k < 3; k++)
+        {
+            palette[2][k] = (uint8_t)((2 * palette[0][k] + palette[1][k]) / 3);
+            palette[3][k] = (uint8_t)((palette[0][k] + 2 * palette[1][k]) / 3);
+        }
+        palette[2][3] = 255;
+        palette[3][3] = 255;
+    }
+    else
+    {
+        for(int k = 0; k < 3; k++)
+            palette[2][k] = (uint8_t)((palette[0][k] + palette[1][k]) / 2);
+        palette[2][3] = 255;
+        memset(palette[3], 0, 4);
+    }
+
+    for(int i = 0; i < 16; i++)
+        memcpy(out_rgba + i * 4, palette[(bits >> (i * 2)) & 3], 4);
+}
+
+// 8-byte interpolated channel block of BC3 alpha and BC4/BC5, written to
+// out[i * 4] for the 16 texels.
+static void decode_channel_block(const uint8_t* block, uint8_t* out)
+{
+    uint32_t a0 = block[0];
+    uint32_t a1 = block[1];
+
+    uint8_t values[8];
+    values[0] = (uint8_t)a0;
+    values[1] = (uint8_t)a1;
+    if(a0 > a1)
+    {
+        for(uint32_t k = 1; k < 7; k++)
+            values[k + 1] = (uint8_t)(((7 - k) * a0 + k * a1) / 7);
+    }
+    else
+    {
+        for(uint32_t k = 1; k < 5; k++)
+            values[k + 1] = (uint8_t)(((5 - k) * a0 + k * a1) / 5);
+        values[6] = 0;
+        values[7] = 255;
+    }
+
+    uint64_t bits = 0;
+    for(int b = 0; b < 6; b++)
+        bits |= (uint64_t)block[2 + b] << (8 * b);
+
+    for(int i = 0; i < 16; i++)
+        out[i * 4] = values[(bits >> (i * 3)) & 7];
+}
+
+void texture_bc1_decode_block(const uint8_t* block, uint8_t* out_rgba)
+{
+    decode_color_block(block, out_rgba, true);
+}
+
+void texture_bc2_decode_block(const uint8_t* block, uint8_t* out_rgba)
+{
+    decode_color_block(block + 8, out_rgba, false);
+    for(int i = 0; i < 16; i++)
+    {
+        uint32_t a          = (block[i / 2] >> ((i & 1) * 4)) & 15;
+        out_rgba[i * 4 + 3] = (uint8_t)(a * 17);
+    }
+}
+
+void texture_bc3_decode_block(const uint8_t* block, uint8_t* out_rgba)
+{
+    decode_color_block(block + 8, out_rgba, false);
+    decode_channel_block(block, out_rgba + 3);
+}
+
+// R8 / R8G8 expand like Vulkan samples BC4/BC5: missing channels 0, alpha 1
+void texture_bc4_decode_block(const uint8_t* block, uint8_t* out_rgba)
+{
+    for(int i = 0; i < 16; i++)
+    {
+        out_rgba[i * 4 + 1] = 0;
+        out_rgba[i * 4 + 2] = 0;
+        out_rgba[i * 4 + 3] = 255;
+    }
+    decode_channel_block(block, out_rgba);
+}
+
+void texture_bc5_decode_block(const uint8_t* block, uint8_t* out_rgba)
+{
+    for(int i = 0; i < 16; i++)
+    {
+        out_rgba[i * 4 + 2] = 0;
+        out_rgba[i * 4 + 3] = 255;
+    }
+    decode_channel_block(block, out_rgba);
+    decode_channel_block(block + 8, out_rgba + 1);
+}
+
+static void decode_bc_level(const TextureBcFormat* bc, const ddsktx_sub_data* sub, uint8_t* dst)
+{
+    uint32_t w        = (uint32_t)sub->width;
+    uint32_t h        = (uint32_t)sub->height;
+    uint32_t blocks_x = (w + 3) / 4;
+    uint32_t blocks_y = (h + 3) / 4;
+    uint32_t pitch    = sub->row_pitch_bytes > 0 ? (uint32_t)sub->row_pitch_bytes : blocks_x * bc->block_bytes;
+
+    uint8_t texels[16 * 4];
+    for(uint32_t by = 0; by < blocks_y; by++)
+    {
+        const uint8_t* row = (const uint8_t*)sub->buff + (size_t)by * pitch;
+        for(uint32_t bx = 0; bx < blocks_x; bx++)
+        {
+            bc->decode(row + (size_t)bx * bc->block_bytes, texels);
+
+            // edge blocks of levels smaller than 4 texels are clipped
+            uint32_t cw = MIN(4u, w - bx * 4);
+            uint32_t ch = MIN(4u, h - by * 4);
+            for(uint32_t y = 0; y < ch; y++)
+                memcpy(dst + (((size_t)(by * 4 + y) * w) + bx * 4) * 4, texels + y * 16, cw * 4);
+        }
+    }
+}
+
+// ------------------------------------------------------------
+// Loaders
+// ------------------------------------------------------------
+
+static const TextureBcFormat* find_bc_format(ddsktx_format format, uint32_t* out_index)
+{
+    for(uint32_t i = 0; i < BC_FORMAT_COUNT; i++)
+    {
+        if(g_bc_formats[i].dds == format)
+        {
+            *out_index = i;
+            return &g_bc_formats[i];
+        }
+    }
+    return NULL;
+}
+
+static bool load_dds_ktx(const char* path, TextureFile* out)
+{
+    void*  bytes = NULL;
+    size_t size  = 0;
+    if(!read_file(path, &bytes, &size))
+        return false;
+
+    ddsktx_texture_info info = {0};
+    ddsktx_error        err  = {0};
+    if(!ddsktx_parse(&info, bytes, (int)size, &err))
+    {
+        log_error("[textures] %s: %s", path, err.msg);
+        free(bytes);
+        return false;
+    }
+
+    if((info.flags & (DDSKTX_TEXTURE_FLAG_CUBEMAP | DDSKTX_TEXTURE_FLAG_VOLUME)) || info.num_layers > 1)
+    {
+        log_error("[textures] %s: only single 2D textures are supported", path);
+        free(bytes);
+        return false;
+    }
+
+    uint32_t               bc_index = 0;
+    const TextureBcFormat* bc       = find_bc_format(info.format, &bc_index);
+    bool                   bgra     = info.format == DDSKTX_FORMAT_BGRA8;
+    if(!bc && info.format != DDSKTX_FORMAT_RGBA8 && !bgra)
+    {
+        log_error("[textures] %s: unsupported format %s", path, ddsktx_format_str(info.format));
+        free(bytes);
+        return false;
+    }
+
+    bool decode = bc && g_bc_unsupported[bc_index];
+    if(decode && !bc->decode)
+    {
+        log_error("[textures] %s: %s is not supported by the device", path, ddsktx_format_str(info.format));
+        free(bytes);
+        return false;
+    }
+
+    // level layout first, then one allocation for the whole chain
+    uint32_t        level_count = (uint32_t)MIN(MAX(info.num_mips, 1), TEXTURE_FILE_MAX_LEVELS);
+    ddsktx_sub_data subs[TEXTURE_FILE_MAX_LEVELS];
+    VkDeviceSize    total = 0;
+    for(uint32_t l = 0; l < level_count; l++)
+    {
+        ddsktx_get_sub(&info, &subs[l], bytes, (int)size, 0, 0, (int)l);
+
+        TextureFileLevel* level = &out->levels[l];
+        level->width            = (uint32_t)subs[l].width;
+        level->height           = (uint32_t)subs[l].height;
+        level->offset           = total;
+        level->size = (bc && !decode) ? (VkDeviceSize)subs[l].size_bytes : (VkDeviceSize)level->width * level->height * 4;
+        total += level->size;
+    }
+
+    out->data = (uint8_t*)malloc((size_t)total);
+    if(!out->data)
+    {
+        free(bytes);
+        return false;
+    }
+
+    for(uint32_t l = 0; l < level_count; l++)
+    {
+        const ddsktx_sub_data*  sub   = &subs[l];
+        const TextureFileLevel* level = &out->levels[l];
+        uint8_t*                dst   = out->data + level->offset;
+
+        if(bc && !decode)
+        {
+            memcpy(dst, sub->buff, (size_t)level->size);
+        }
+        else if(decode)
+        {
+            decode_bc_level(bc, sub, dst);
+        }
+        else
+        {
+            for(uint32_t y = 0; y < level->height; y++)
+                memcpy(dst + (size_t)y * level->width * 4, (const uint8_t*)sub->buff + (size_t)y * sub->row_pitch_bytes,
+                       (size_t)level->width * 4);
+
+            if(bgra)
+            {
+                for(VkDeviceSize i = 0; i < level->size; i += 4)
+                {
+                    uint8_t t  = dst[i];
+                    dst[i]     = dst[i + 2];
+                    dst[i + 2] = t;
+                }
+            }
+        }
+    }
+
+    out->format        = (bc && !decode) ? bc->vk : VK_FORMAT_R8G8B8A8_UNORM;
+    out->width         = (uint32_t)info.width;
+    out->height        = (uint32_t)info.height;
+    out->level_count   = level_count;
+    out->generate_mips = level_count == 1 && out->format == VK_FORMAT_R8G8B8A8_UNORM;
+    out->size          = total;
+
+    free(bytes);
+    return true;
+}
+
+static bool load_stb(const char* path, TextureFile* out)
+{
+    int      w = 0, h = 0, comp = 0;
+    stbi_uc* pixels = stbi_load(path, &w, &h, &comp, 4);
+    if(!pixels)
+        return false;
+
+    // stb_image allocates with malloc (STBI_MALLOC is not overridden), so
+    // texture_file_free releases both paths the same way
+    out->format        = VK_FORMAT_R8G8B8A8_UNORM;
+    out->width         = (uint32_t)w;
+    out->height        = (uint32_t)h;
+    out->level_count   = 1;
+    out->generate_mips = true;
+    out->data          = pixels;
+    out->size          = (VkDeviceSize)w * (VkDeviceSize)h * 4;
+    out->levels[0]     = (TextureFileLevel){.width = (uint32_t)w, .height = (uint32_t)h, .offset = 0, .size = out->size};
+    return true;
+}
+
+bool texture_file_load(const char* path, TextureFile* out)
+{
+    memset(out, 0, sizeof(*out));
+    if(!path)
+        return false;
+
+    if(has_extension(path, ".dds") || has_extension(path, ".ktx"))
+        return load_dds_ktx(path, out);
+
+    return load_stb(path, out);
+}
+
+void texture_file_free(TextureFile* file)
+{
+    if(!file)
+        return;
+
+    free(file->data);
+    memset(file, 0, sizeof(*file));
+}
+
+uint32_t texture_file_image_levels(const TextureFile* file)
+{
+    return file->generate_mips ? calc_mip_count(file->width, file->height) : file->level_count;
+}
+
+VkDeviceSize texture_file_gpu_bytes(const TextureFile* file)
+{
+    if(!file->generate_mips)
+        return file->size;
+
+    VkDeviceSize bytes = 0;
+    uint32_t     w = file->width, h = file->height;
+    for(uint32_t l = 0; l < texture_file_image_levels(file); l++)
+    {
+        bytes += (VkDeviceSize)w * h * 4;
+        w = (w > 1) ? (w >> 1) : 1;
+        h = (h > 1) ? (h >> 1) : 1;
+    }
+    return bytes;
+}
+
+bool texture_file_build_mips(TextureFile* file, bool srgb, JobPool* pool)
+{
+    if(!file->generate_mips)
+        return true;
+
+    uint32_t     levels = MIN(calc_mip_count(file->width, file->height), (uint32_t)TEXTURE_FILE_MAX_LEVELS);
+    VkDeviceSize total  = 0;
+    uint32_t     w = file->width, h = file->height;
+    for(uint32_t l = 0; l < levels; l++)
+    {
+        VkDeviceSize size = (VkDeviceSize)w * h * 4;
+        file->levels[l]   = (TextureFileLevel){.width = w, .height = h, .offset = total, .size = size};
+        total += size;
+        w = (w > 1) ? (w >> 1) : 1;
+        h = (h > 1) ? (h >> 1) : 1;
+    }
+
+    // level 0 stays where it is
+    uint8_t* data = (uint8_t*)realloc(file->data, (size_t)total);
+    if(!data)
+    {
+        file->levels[0] = (TextureFileLevel){.width = file->width, .height = file->height, .offset = 0, .size = file->size};
+        return false;
+    }
+
+    texture_mips_build_rgba8(data, file->levels, levels, srgb, pool);
+
+    file->data          = data;
+    file->size          = total;
+    file->level_count   = levels;
+    file->generate_mips = false;
+    return true;
+}
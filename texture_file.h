@@ -0,0 +1,61 @@
+#pragma once
+
+#include "tinytypes.h"
+#include "job_pool.h"
+
+// Texture files as the GPU wants them.
+//
+// .dds / .ktx go through dds-ktx: BC1-BC7 mip chains are kept exactly as
+// stored and uploaded level by level, no CPU decode and no blit mips. When the
+// device cannot sample a BC format, BC1-BC5 are decoded to RGBA8 here (mip
+// chain kept); BC6H/BC7 have no CPU fallback and fail to load. Everything else
+// goes through stb_image as one RGBA8 level with generate_mips set.
+//
+// Formats are UNORM like the RGBA8 path: the shaders read albedo as stored.
+
+#define TEXTURE_FILE_MAX_LEVELS 16
+
+typedef struct TextureFileLevel
+{
+    uint32_t     width, height;
+    VkDeviceSize offset;  // into TextureFile.data
+    VkDeviceSize size;
+} TextureFileLevel;
+
+typedef struct TextureFile
+{
+    VkFormat         format;
+    uint32_t         width, height;
+    uint32_t         level_count;    // levels stored in data
+    bool             generate_mips;  // one RGBA8 level, blit the rest on upload
+    TextureFileLevel levels[TEXTURE_FILE_MAX_LEVELS];
+    uint8_t*         data;           // levels back to back, each offset a multiple of its block size
+    VkDeviceSize     size;
+} TextureFile;
+
+// Records which BC formats gpu can sample. Until called every BC format
+// counts as supported. Call once before any load.
+void texture_file_query_support(VkPhysicalDevice gpu);
+bool texture_file_format_supported(VkFormat format);
+
+bool texture_file_load(const char* path, TextureFile* out);
+void texture_file_free(TextureFile* file);
+
+// Mip count of the image the file ends up in.
+uint32_t texture_file_image_levels(const TextureFile* file);
+
+// Device memory the file takes once uploaded, mip chain included.
+VkDeviceSize texture_file_gpu_bytes(const TextureFile* file);
+
+// Replaces the single RGBA8 level of a generate_mips file with the whole
+// chain, box filtered on the CPU (texture_mips.h; srgb averages color in
+// linear light, pool may be NULL), and clears generate_mips. Files that carry
+// their levels are left alone. False only when out of memory.
+bool texture_file_build_mips(TextureFile* file, bool srgb, JobPool* pool);
+
+// CPU fallback decoders: one 4x4 block to 16 RGBA8 texels, row-major.
+void texture_bc1_decode_block(const uint8_t* block, uint8_t* out_rgba);
+void texture_bc2_decode_block(const uint8_t* block, uint8_t* out_rgba);
+void texture_bc3_decode_block(const uint8_t* block, uint8_t* out_rgba);
+void texture_bc4_decode_block(const uint8_t* block, uint8_t* out_rgba);
+void texture_bc5_decode_block(const uint8_t* block, uint8_t* out_rgba);
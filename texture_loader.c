@@ -0,0 +1,583 @@
+#include "texture_loader.h"
+
+#include "vk_cmd.h"
+#include "vk_queue.h"
+
+#define TEXTURE_LOADER_DEFAULT_BATCH_BYTES (64ull * 1024 * 1024)
+#define TEXTURE_LOADER_STAGING_ALIGN 16ull
+#define TEXTURE_LOADER_RETIRE_TIMEOUT_NS 2000000ull
+
+struct TextureLoadItem
+{
+    TextureLoader*  loader;
+    char*           path;
+    uint32_t        slot;
+    TextureFile     file;
+    VkDeviceSize    staging_offset;
+    TextureResource tex;
+    uint64_t        hash;
+    uint32_t        alias_slot;  // 0: uploads its own image
+    bool            srgb;
+    bool            failed;
+};
+
+static VkDeviceSize item_bytes(const TextureLoadItem* item)
+{
+    return item->file.size;
+}
+
+static void push_finished(TextureLoader* loader, TextureLoadItem* item)
+{
+    pthread_mutex_lock(&loader->mutex);
+    arrpush(loader->finished, item);
+    pthread_cond_broadcast(&loader->done_cond);
+    pthread_mutex_unlock(&loader->mutex);
+}
+
+// JobPool worker: file -> upload-ready levels (BC as stored, RGBA8 with its
+// mip chain built here, so the upload is plain copies)
+static void decode_job(void* user, uint32_t index)
+{
+    (void)index;
+    TextureLoadItem* item   = (TextureLoadItem*)user;
+    TextureLoader*   loader = item->loader;
+
+    if(!texture_file_load(item->path, &item->file))
+    {
+        item->failed = true;
+        push_finished(loader, item);
+        return;
+    }
+
+    // hashed as stored, like tex_create_*; sRGB-filtered chains only match each other
+    const TextureFile* file = &item->file;
+    item->hash = bindless_textures_content_hash(file->format, file->width, file->height, file->data, (size_t)file->size);
+    if(item->srgb)
+        item->hash = XXH64(&item->hash, sizeof(item->hash), 1) | 1;
+
+    // large levels split into row bands on the same pool
+    if(!texture_file_build_mips(&item->file, item->srgb, &loader->jobs))
+    {
+        texture_file_free(&item->file);
+        item->failed = true;
+        push_finished(loader, item);
+        return;
+    }
+
+    pthread_mutex_lock(&loader->mutex);
+    arrpush(loader->decoded, item);
+    pthread_cond_signal(&loader->work_cond);
+    pthread_mutex_unlock(&loader->mutex);
+}
+
+// Index into contents, UINT32_MAX when the hash is not there. Under mutex.
+static uint32_t find_content(const TextureLoader* loader, uint64_t hash)
+{
+    uint32_t probe = 0;
+    for(uint32_t i; (i = hash_index_next(&loader->content_index, hash, &probe)) != HASH_INDEX_NONE;)
+    {
+        if(loader->contents[i].hash == hash)
+            return i;
+    }
+    return UINT32_MAX;
+}
+
+static uint32_t find_uploaded(TextureLoader* loader, uint64_t hash)
+{
+    pthread_mutex_lock(&loader->mutex);
+    uint32_t i    = find_content(loader, hash);
+    uint32_t slot = i != UINT32_MAX ? loader->contents[i].slot : 0;
+    pthread_mutex_unlock(&loader->mutex);
+    return slot;
+}
+
+// Duplicates wait behind the newest batch, which retires after the one that
+// uploads their image; with nothing in flight that image is already out.
+static void queue_aliases(TextureLoader* loader, TextureLoadItem** aliases)
+{
+    uint32_t count = (uint32_t)arrlen(aliases);
+    if(count == 0)
+        return;
+
+    uint32_t in_flight = (uint32_t)arrlen(loader->in_flight);
+    if(in_flight > 0)
+    {
+        TextureLoadBatch* newest = &loader->in_flight[in_flight - 1];
+        for(uint32_t i = 0; i < count; i++)
+            arrpush(newest->items, aliases[i]);
+        return;
+    }
+
+    for(uint32_t i = 0; i < count; i++)
+        push_finished(loader, aliases[i]);
+}
+
+// Images, one staging buffer and one command buffer for the whole batch.
+static void submit_batch(TextureLoader* loader, TextureLoadItem** items)
+{
+    TextureLoadBatch  batch       = {0};
+    TextureLoadItem** aliases     = NULL;
+    VkDeviceSize      staging_end = 0;
+
+    for(uint32_t i = 0; i < (uint32_t)arrlen(items); i++)
+    {
+        TextureLoadItem* item = items[i];
+
+        item->alias_slot = find_uploaded(loader, item->hash);
+        if(item->alias_slot != 0)
+        {
+            free(item->file.data);
+            item->file.data = NULL;
+            arrpush(aliases, item);
+            continue;
+        }
+
+        const TextureFile* file = &item->file;
+        if(!bindless_textures_create_image(loader->allocator, loader->device, file->format, file->width, file->height,
+                                           texture_file_image_levels(file), &item->tex))
+        {
+            texture_file_free(&item->file);
+            item->failed = true;
+            push_finished(loader, item);
+            continue;
+        }
+
+        TextureLoadContent content = {.hash = item->hash, .slot = item->slot};
+        pthread_mutex_lock(&loader->mutex);
+        hash_index_insert(&loader->content_index, content.hash, (uint32_t)arrlen(loader->contents));
+        arrpush(loader->contents, content);
+        pthread_mutex_unlock(&loader->mutex);
+
+        staging_end          = (staging_end + TEXTURE_LOADER_STAGING_ALIGN - 1) & ~(TEXTURE_LOADER_STAGING_ALIGN - 1);
+        item->staging_offset = staging_end;
+        staging_end += item_bytes(item);
+        arrpush(batch.items, item);
+    }
+
+    if(arrlen(batch.items) == 0)
+    {
+        queue_aliases(loader, aliases);
+        arrfree(aliases);
+        return;
+    }
+
+    res_create_buffer(loader->allocator, staging_end, VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_AUTO,
+                      VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, 0, &batch.staging);
+
+    vk_cmd_alloc(loader->device, loader->cmd_pool, true, &batch.cmd);
+    vk_cmd_begin(batch.cmd, true);
+
+    for(uint32_t i = 0; i < (uint32_t)arrlen(batch.items); i++)
+    {
+        TextureLoadItem* item = batch.items[i];
+        memcpy(batch.staging.mapping + item->staging_offset, item->file.data, (size_t)item_bytes(item));
+        bindless_textures_cmd_upload_file(batch.cmd, &item->tex, &item->file, batch.staging.buffer, item->staging_offset);
+
+        // the size stays for the stats, the data is in staging now
+        free(item->file.data);
+        item->file.data = NULL;
+    }
+
+    vk_cmd_end(batch.cmd);
+
+    batch.value = ++loader->next_value;
+
+    VkCommandBufferSubmitInfo cmd_info = {
+        .sType         = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+        .commandBuffer = batch.cmd,
+    };
+
+    VkSemaphoreSubmitInfo signal = {
+        .sType     = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+        .semaphore = loader->timeline,
+        .value     = batch.value,
+        .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+    };
+
+    VkSubmitInfo2 submit = {
+        .sType                    = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+        .commandBufferInfoCount   = 1,
+        .pCommandBufferInfos      = &cmd_info,
+        .signalSemaphoreInfoCount = 1,
+        .pSignalSemaphoreInfos    = &signal,
+    };
+
+    vk_queue_lock();
+    VK_CHECK(vkQueueSubmit2(loader->queue, 1, &submit, VK_NULL_HANDLE));
+    vk_queue_unlock();
+
+    __atomic_fetch_add(&loader->stats.batches, 1, __ATOMIC_RELAXED);
+    arrpush(loader->in_flight, batch);
+
+    queue_aliases(loader, aliases);
+    arrfree(aliases);
+}
+
+// Hands completed batches to texture_loader_update. With wait set, blocks
+// briefly on the oldest batch so an idle submit thread does not spin.
+static void retire_batches(TextureLoader* loader, bool wait)
+{
+    if(arrlen(loader->in_flight) == 0)
+        return;
+
+    uint64_t done = 0;
+    VK_CHECK(vkGetSemaphoreCounterValue(loader->device, loader->timeline, &done));
+
+    if(wait && done < loader->in_flight[0].value)
+    {
+        VkSemaphoreWaitInfo wait_info = {
+            .sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .semaphoreCount = 1,
+            .pSemaphores    = &loader->timeline,
+            .pValues        = &loader->in_flight[0].value,
+        };
+        VkResult r = vkWaitSemaphores(loader->device, &wait_info, TEXTURE_LOADER_RETIRE_TIMEOUT_NS);
+        if(r != VK_TIMEOUT)
+            VK_CHECK(r);
+        VK_CHECK(vkGetSemaphoreCounterValue(loader->device, loader->timeline, &done));
+    }
+
+    for(uint32_t i = 0; i < (uint32_t)arrlen(loader->in_flight);)
+    {
+        TextureLoadBatch* batch = &loader->in_flight[i];
+        if(batch->value > done)
+        {
+            i++;
+            continue;
+        }
+
+        res_destroy_buffer(loader->allocator, &batch->staging);
+        vkFreeCommandBuffers(loader->device, loader->cmd_pool, 1, &batch->cmd);
+
+        pthread_mutex_lock(&loader->mutex);
+        for(uint32_t k = 0; k < (uint32_t)arrlen(batch->items); k++)
+            arrpush(loader->finished, batch->items[k]);
+        pthread_cond_broadcast(&loader->done_cond);
+        pthread_mutex_unlock(&loader->mutex);
+
+        arrfree(batch->items);
+        arrdel(loader->in_flight, i);
+    }
+}
+
+static void* submit_thread_main(void* arg)
+{
+    TextureLoader*    loader = (TextureLoader*)arg;
+    TextureLoadItem** batch  = NULL;
+
+    for(;;)
+    {
+        pthread_mutex_lock(&loader->mutex);
+        while(!loader->shutdown && arrlen(loader->decoded) == 0 && arrlen(loader->in_flight) == 0)
+            pthread_cond_wait(&loader->work_cond, &loader->mutex);
+
+        if(loader->shutdown && arrlen(loader->decoded) == 0 && arrlen(loader->in_flight) == 0)
+        {
+            pthread_mutex_unlock(&loader->mutex);
+            break;
+        }
+
+        // oldest first, up to max_batch_bytes (at least one texture)
+        VkDeviceSize bytes = 0;
+        uint32_t     take  = 0;
+        while(take < (uint32_t)arrlen(loader->decoded))
+        {
+            VkDeviceSize size = item_bytes(loader->decoded[take]) + TEXTURE_LOADER_STAGING_ALIGN;
+            if(take > 0 && bytes + size > loader->max_batch_bytes)
+                break;
+            arrpush(batch, loader->decoded[take]);
+            bytes += size;
+            take++;
+        }
+        if(take > 0)
+            arrdeln(loader->decoded, 0, take);
+        pthread_mutex_unlock(&loader->mutex);
+
+        if(take > 0)
+            submit_batch(loader, batch);
+        arrsetlen(batch, 0);
+
+        retire_batches(loader, take == 0);
+    }
+
+    arrfree(batch);
+    return NULL;
+}
+
+bool texture_loader_init(TextureLoader* loader, BindlessTextures* bindless, ResourceAllocator* allocator, VkDevice device,
+                         VkQueue queue, uint32_t queue_family, VkDeviceSize max_batch_bytes, uint32_t decode_threads)
+{
+    memset(loader, 0, sizeof(*loader));
+
+    loader->bindless        = bindless;
+    loader->allocator       = allocator;
+    loader->device          = device;
+    loader->queue           = queue;
+    loader->max_batch_bytes = max_batch_bytes ? max_batch_bytes : TEXTURE_LOADER_DEFAULT_BATCH_BYTES;
+
+    VkSemaphoreTypeCreateInfo type_info = {
+        .sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+        .initialValue  = 0,
+    };
+    VkSemaphoreCreateInfo sem_info = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &type_info,
+    };
+    VK_CHECK(vkCreateSemaphore(device, &sem_info, NULL, &loader->timeline));
+
+    // the submit thread frees each command buffer on retire
+    vk_cmd_create_pool(device, queue_family, true, false, &loader->cmd_pool);
+
+    pthread_mutex_init(&loader->mutex, NULL);
+    pthread_cond_init(&loader->work_cond, NULL);
+    pthread_cond_init(&loader->done_cond, NULL);
+
+    if(pthread_create(&loader->submit_thread, NULL, submit_thread_main, loader) != 0)
+    {
+        log_error("texture_loader: failed to start the submit thread");
+        pthread_cond_destroy(&loader->done_cond);
+        pthread_cond_destroy(&loader->work_cond);
+        pthread_mutex_destroy(&loader->mutex);
+        vk_cmd_destroy_pool(device, loader->cmd_pool);
+        vkDestroySemaphore(device, loader->timeline, NULL);
+        memset(loader, 0, sizeof(*loader));
+        return false;
+    }
+
+    job_pool_init(&loader->jobs, decode_threads);
+    return true;
+}
+
+void texture_loader_destroy(TextureLoader* loader)
+{
+    if(!loader || !loader->device)
+        return;
+
+    // every decode reaches decoded/finished, the submit thread drains both
+    // queues before it honours shutdown
+    job_pool_wait(&loader->jobs, &loader->decodes);
+
+    pthread_mutex_lock(&loader->mutex);
+    loader->shutdown = true;
+    pthread_cond_signal(&loader->work_cond);
+    pthread_mutex_unlock(&loader->mutex);
+    pthread_join(loader->submit_thread, NULL);
+
+    texture_loader_update(loader, NULL);
+
+    job_pool_destroy(&loader->jobs);
+    arrfree(loader->decoded);
+    arrfree(loader->finished);
+    arrfree(loader->in_flight);
+    arrfree(loader->contents);
+    hash_index_free(&loader->content_index);
+    arrfree(loader->moves);
+
+    pthread_cond_destroy(&loader->done_cond);
+    pthread_cond_destroy(&loader->work_cond);
+    pthread_mutex_destroy(&loader->mutex);
+
+    vk_cmd_destroy_pool(loader->device, loader->cmd_pool);
+    vkDestroySemaphore(loader->device, loader->timeline, NULL);
+
+    memset(loader, 0, sizeof(*loader));
+}
+
+bool texture_loader_request(TextureLoader* loader, const char* path, bool srgb, TextureHandle* out_handle)
+{
+    if(!loader || !path || !out_handle)
+        return false;
+
+    BindlessTextures* bt   = loader->bindless;
+    uint32_t          slot = bindless_textures_alloc_slot(bt);
+    if(slot == 0)
+        return false;
+
+    // dummy until the upload lands; the slot is fresh, so no frame in flight samples it
+    if(bt->textures[0].image.view && bt->textures[0].image.sampler)
+        bindless_textures_write(bt, loader->device, slot, bt->textures[0].image.view, bt->textures[0].image.sampler,
+                                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    TextureLoadItem* item = (TextureLoadItem*)calloc(1, sizeof(TextureLoadItem));
+    size_t           len  = strlen(path);
+    item->path            = (char*)malloc(len + 1);
+    memcpy(item->path, path, len + 1);
+    item->loader = loader;
+    item->slot   = slot;
+    item->srgb   = srgb;
+
+    if(loader->pending == 0)
+        loader->start_ns = time_now_ns();
+    loader->pending++;
+    loader->stats.requested++;
+
+    job_pool_run(&loader->jobs, decode_job, item, 0, &loader->decodes);
+
+    *out_handle = bindless_textures_handle(bt, slot);
+    return true;
+}
+
+// The owner slot of an alias was destroyed (or reused) before it landed:
+// forget it and decode the texture again. Returns false while shutting down.
+static bool requeue_alias(TextureLoader* loader, TextureLoadItem* item)
+{
+    pthread_mutex_lock(&loader->mutex);
+    uint32_t i = find_content(loader, item->hash);
+    if(i != UINT32_MAX && loader->contents[i].slot == item->alias_slot)
+    {
+        // HashIndex is insert only: rebuild it over the swapped array (rare)
+        arrdelswap(loader->contents, i);
+        hash_index_free(&loader->content_index);
+        for(uint32_t k = 0; k < (uint32_t)arrlen(loader->contents); k++)
+            hash_index_insert(&loader->content_index, loader->contents[k].hash, k);
+    }
+    bool shutdown = loader->shutdown;
+    pthread_mutex_unlock(&loader->mutex);
+
+    if(shutdown)
+        return false;
+
+    texture_file_free(&item->file);
+    item->alias_slot = 0;
+    job_pool_run(&loader->jobs, decode_job, item, 0, &loader->decodes);
+    return true;
+}
+
+static void push_move(TextureLoader* loader, uint32_t from, uint32_t to)
+{
+    TextureSlotMove move = {.from = from, .to = to};
+    arrpush(loader->moves, move);
+}
+
+// item's image, or an alias of an image with the same content, into a fresh
+// slot. False when no slot is free; the reserved slot keeps the dummy then.
+static bool publish(TextureLoader* loader, TextureLoadItem* item)
+{
+    BindlessTextures* bt    = loader->bindless;
+    uint32_t          owner = 0;
+    uint32_t          fresh;
+
+    if(bindless_textures_find_content(bt, item->hash, &owner))
+    {
+        // created through tex_create_* meanwhile; the batch is done, drop the copy
+        bindless_textures_destroy_texture(loader->allocator, loader->device, &item->tex);
+        fresh = bindless_textures_replace_alias(bt, loader->device, item->slot, owner);
+        if(fresh == 0)
+            return false;
+
+        push_move(loader, item->slot, fresh);
+        loader->stats.duplicates++;
+        return true;
+    }
+
+    fresh = bindless_textures_replace_content(bt, loader->allocator, loader->device, item->slot, &item->tex, item->hash);
+    if(fresh == 0)
+    {
+        bindless_textures_destroy_texture(loader->allocator, loader->device, &item->tex);
+        return false;
+    }
+
+    push_move(loader, item->slot, fresh);
+    loader->stats.bytes += item_bytes(item);
+    loader->stats.gpu_bytes += texture_file_gpu_bytes(&item->file);
+    return true;
+}
+
+uint32_t texture_loader_update(TextureLoader* loader, const TextureSlotMove** out_moves)
+{
+    if(loader->moves_taken)
+    {
+        arrsetlen(loader->moves, 0);
+        loader->moves_taken = false;
+    }
+
+    pthread_mutex_lock(&loader->mutex);
+    TextureLoadItem** done = loader->finished;
+    loader->finished       = NULL;
+    pthread_mutex_unlock(&loader->mutex);
+
+    uint32_t count     = (uint32_t)arrlen(done);
+    uint32_t published = 0;
+    for(uint32_t i = 0; i < count; i++)
+    {
+        TextureLoadItem* item = done[i];
+
+        if(!item->failed && item->alias_slot != 0)
+        {
+            // the owner was published ahead of this one (into a fresh slot of
+            // its own), unless it is gone again
+            uint32_t owner = 0;
+            if(bindless_textures_find_content(loader->bindless, item->hash, &owner))
+            {
+                uint32_t fresh = bindless_textures_replace_alias(loader->bindless, loader->device, item->slot, owner);
+                if(fresh != 0)
+                {
+                    push_move(loader, item->slot, fresh);
+                    loader->stats.duplicates++;
+                }
+                else
+                    item->failed = true;
+            }
+            else if(requeue_alias(loader, item))
+                continue;
+            else
+                item->failed = true;
+        }
+        else if(!item->failed)
+            item->failed = !publish(loader, item);
+
+        if(item->failed)
+        {
+            // the slot keeps the dummy so materials that point at it still sample something
+            log_warn("texture_loader: failed to load %s", item->path);
+            loader->stats.failed++;
+        }
+        else
+            loader->stats.loaded++;
+
+        texture_file_free(&item->file);
+        free(item->path);
+        free(item);
+        published++;
+    }
+    arrfree(done);
+
+    if(published > 0)
+    {
+        loader->pending -= published;
+        if(loader->pending == 0)
+            loader->stats.seconds += (double)(time_now_ns() - loader->start_ns) * 1e-9;
+    }
+
+    if(!out_moves)
+        return 0;
+
+    *out_moves          = loader->moves;
+    loader->moves_taken = true;
+    return (uint32_t)arrlen(loader->moves);
+}
+
+void texture_loader_wait(TextureLoader* loader)
+{
+    texture_loader_update(loader, NULL);
+    while(loader->pending > 0)
+    {
+        pthread_mutex_lock(&loader->mutex);
+        while(arrlen(loader->finished) == 0)
+            pthread_cond_wait(&loader->done_cond, &loader->mutex);
+        pthread_mutex_unlock(&loader->mutex);
+
+        texture_loader_update(loader, NULL);
+    }
+}
+
+void texture_loader_print_stats(const TextureLoader* loader)
+{
+    const TextureLoaderStats* s       = &loader->stats;
+    double                    seconds = s->seconds > 0.0 ? s->seconds : 1e-9;
+
+    printf("textures: %u loaded (%u failed, %u duplicates) in %.1f ms, %.1f tex/s, %.1f MB/s, %u batches, %.1f MB in VRAM\n",
+           s->loaded, s->failed, s->duplicates, s->seconds * 1000.0, (double)s->loaded / seconds,
+           (double)s->bytes / (1024.0 * 1024.0) / seconds, __atomic_load_n(&s->batches, __ATOMIC_RELAXED), (double)s->gpu_bytes / (1024.0 * 1024.0));
+}
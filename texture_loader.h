@@ -0,0 +1,124 @@
+#pragma once
+
+#include "bindlesstextures.h"
+#include "job_pool.h"
+
+// Asynchronous texture loading into BindlessTextures.
+//
+// texture_loader_request() reserves a fresh bindless slot right away and points
+// it at the dummy texture (slot 0), so materials can reference it before a
+// single pixel is decoded. JobPool workers read the files with
+// texture_file_load (BC chains as stored, RGBA8 otherwise) and build RGBA8 mip
+// chains on the CPU (texture_mips.h); one submit thread packs every texture
+// that finished loading into a shared staging buffer and one command buffer
+// (level copies only), submits it on the graphics queue and signals the
+// loader's timeline semaphore with the batch number. texture_loader_update(),
+// on the thread that owns the BindlessTextures, installs textures whose batch
+// is done. Frames in flight may sample the reserved slot, so its descriptor is
+// never rewritten: the texture goes into another fresh slot
+// (bindless_textures_replace_content), the reserved one retires behind the
+// frames in flight, and the caller repoints its materials from the returned
+// TextureSlotMoves, as with texture_streamer_update().
+//
+// Decoded levels are content hashed. A texture whose content the loader has
+// already uploaded skips the upload and is installed as an alias of the first
+// one's image (the slot was handed out before decoding, so the image is
+// shared, not the slot); one matching a texture created through tex_create_*
+// is aliased on publish and its fresh image dropped.
+
+typedef struct TextureLoadItem TextureLoadItem;
+
+typedef struct TextureLoadContent
+{
+    uint64_t hash;
+    uint32_t slot;  // uploaded by the loader
+} TextureLoadContent;
+
+typedef struct TextureLoadBatch
+{
+    uint64_t          value;  // timeline value signalled when the batch is done
+    Buffer            staging;
+    VkCommandBuffer   cmd;
+    TextureLoadItem** items;  // stb_ds
+} TextureLoadBatch;
+
+typedef struct TextureLoaderStats
+{
+    uint32_t requested;
+    uint32_t loaded;
+    uint32_t failed;
+    uint32_t duplicates;  // published as aliases, no upload of their own
+    uint32_t batches;
+    uint64_t bytes;      // staged: BC blocks as stored, RGBA8 with its mip chain
+    uint64_t gpu_bytes;  // image memory, mip chain included
+    double   seconds;  // first request to last texture published
+} TextureLoaderStats;
+
+typedef struct TextureLoader
+{
+    BindlessTextures*  bindless;
+    ResourceAllocator* allocator;
+    VkDevice           device;
+    VkQueue            queue;
+
+    JobPool    jobs;  // decode workers
+    JobCounter decodes;
+
+    pthread_t       submit_thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t  work_cond;  // decoded textures / shutdown, for the submit thread
+    pthread_cond_t  done_cond;  // textures ready to publish
+    bool            shutdown;
+
+    // guarded by mutex
+    TextureLoadItem** decoded;  // waiting for the submit thread
+    TextureLoadItem** finished; // batch done or decode failed, waiting for update
+    TextureLoadContent* contents;  // stb_ds
+    HashIndex           content_index;  // hash -> contents
+
+    // submit thread only
+    VkCommandPool     cmd_pool;
+    VkSemaphore       timeline;
+    uint64_t          next_value;
+    TextureLoadBatch* in_flight;  // stb_ds
+    VkDeviceSize      max_batch_bytes;
+
+    // owning thread only
+    uint32_t           pending;  // requested, not yet published
+    uint64_t           start_ns;
+    TextureLoaderStats stats;
+    TextureSlotMove*   moves;  // stb_ds, not yet handed out by texture_loader_update
+    bool               moves_taken;
+} TextureLoader;
+
+// queue_family is the family of queue, used for the loader's command pool.
+// max_batch_bytes caps the staging memory of one batch (0 = 64 MiB); a larger
+// texture still goes out alone. decode_threads == 0 picks job_pool_default_threads().
+bool texture_loader_init(TextureLoader* loader, BindlessTextures* bindless, ResourceAllocator* allocator, VkDevice device,
+                         VkQueue queue, uint32_t queue_family, VkDeviceSize max_batch_bytes, uint32_t decode_threads);
+
+// Waits for outstanding work, publishes it, then stops the threads.
+void texture_loader_destroy(TextureLoader* loader);
+
+// Reserves a slot, points it at the dummy and queues the decode. srgb filters
+// RGBA8 mips in linear light (color data). Returns false only when no slot is
+// left. A file that fails to decode keeps the dummy.
+bool texture_loader_request(TextureLoader* loader, const char* path, bool srgb, TextureHandle* out_handle);
+
+// Publishes finished textures into fresh slots. Returns the slot moves of
+// every texture published since the previous call with out_moves set (valid
+// until the next such call); the frame recorded next must sample `to`
+// wherever it sampled `from`. With out_moves NULL the moves stay queued.
+uint32_t texture_loader_update(TextureLoader* loader, const TextureSlotMove** out_moves);
+
+// Blocks until every requested texture is published (or failed). The moves
+// come with the next texture_loader_update.
+void texture_loader_wait(TextureLoader* loader);
+
+static inline bool texture_loader_idle(const TextureLoader* loader)
+{
+    return loader->pending == 0;
+}
+
+// "textures: N loaded (N failed, N duplicates) ... tex/s ... MB/s ... MB in VRAM"
+void texture_loader_print_stats(const TextureLoader* loader);
@@ -0,0 +1,274 @@
+#include "texture_mips.h"
+
+#include <math.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TEXTURE_MIPS_X86 1
+#endif
+
+#define SRGB_ENCODE_SIZE 4096u
+
+static int g_isa = -1;  // active ISA, resolved on first use
+
+static pthread_once_t g_tables_once = PTHREAD_ONCE_INIT;
+static float          g_srgb_decode[256];
+static uint32_t       g_srgb_encode[SRGB_ENCODE_SIZE];  // 32-bit entries for the AVX2 gather
+
+static void init_tables(void)
+{
+    for(uint32_t i = 0; i < 256; i++)
+    {
+        float c           = (float)i / 255.0f;
+        g_srgb_decode[i] = (c <= 0.04045f) ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+    }
+
+    for(uint32_t i = 0; i < SRGB_ENCODE_SIZE; i++)
+    {
+        float l           = (float)i / (float)(SRGB_ENCODE_SIZE - 1);
+        float c           = (l <= 0.0031308f) ? l * 12.92f : 1.055f * powf(l, 1.0f / 2.4f) - 0.055f;
+        g_srgb_encode[i] = (uint32_t)(c * 255.0f + 0.5f);
+    }
+}
+
+static inline uint32_t encode_index(float linear)
+{
+    return (uint32_t)(linear * (float)(SRGB_ENCODE_SIZE - 1) + 0.5f);
+}
+
+// ------------------------------------------------------------
+// Row kernels: one output row, texels [x, dw). The SIMD ones need sw > 1 (both
+// texels of every pair exist) and return where the scalar tail picks up.
+// ------------------------------------------------------------
+
+static void row_scalar(const uint8_t* r0, const uint8_t* r1, uint8_t* out, uint32_t x, uint32_t dw, uint32_t sw, bool srgb)
+{
+    for(; x < dw; x++)
+    {
+        uint32_t a = MIN(x * 2, sw - 1) * 4;
+        uint32_t b = MIN(x * 2 + 1, sw - 1) * 4;
+
+        uint32_t c = 0;
+        if(srgb)
+        {
+            for(; c < 3; c++)
+            {
+                float l = ((g_srgb_decode[r0[a + c]] + g_srgb_decode[r0[b + c]])
+                           + (g_srgb_decode[r1[a + c]] + g_srgb_decode[r1[b + c]]))
+                          * 0.25f;
+                out[x * 4 + c] = (uint8_t)g_srgb_encode[encode_index(l)];
+            }
+        }
+        for(; c < 4; c++)
+            out[x * 4 + c] = (uint8_t)((r0[a + c] + r0[b + c] + r1[a + c] + r1[b + c] + 2) >> 2);
+    }
+}
+
+#ifdef TEXTURE_MIPS_X86
+
+static uint32_t row_sse(const uint8_t* r0, const uint8_t* r1, uint8_t* out, uint32_t dw)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i two  = _mm_set1_epi16(2);
+
+    uint32_t x = 0;
+    for(; x + 4 <= dw; x += 4)
+    {
+        __m128i a0 = _mm_loadu_si128((const __m128i*)(r0 + x * 8));
+        __m128i a1 = _mm_loadu_si128((const __m128i*)(r0 + x * 8 + 16));
+        __m128i b0 = _mm_loadu_si128((const __m128i*)(r1 + x * 8));
+        __m128i b1 = _mm_loadu_si128((const __m128i*)(r1 + x * 8 + 16));
+
+        // column sums, two source texels per register
+        __m128i s0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+        __m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+        __m128i s2 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+        __m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+
+        // pair sums: [o0 o1], [o2 o3]
+        __m128i o01 = _mm_add_epi16(_mm_unpacklo_epi64(s0, s1), _mm_unpackhi_epi64(s0, s1));
+        __m128i o23 = _mm_add_epi16(_mm_unpacklo_epi64(s2, s3), _mm_unpackhi_epi64(s2, s3));
+        o01         = _mm_srli_epi16(_mm_add_epi16(o01, two), 2);
+        o23         = _mm_srli_epi16(_mm_add_epi16(o23, two), 2);
+
+        _mm_storeu_si128((__m128i*)(out + x * 4), _mm_packus_epi16(o01, o23));
+    }
+    return x;
+}
+
+__attribute__((target("avx2"))) static uint32_t row_avx2(const uint8_t* r0, const uint8_t* r1, uint8_t* out, uint32_t dw)
+{
+    const __m256i two   = _mm256_set1_epi16(2);
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    uint32_t x = 0;
+    for(; x + 8 <= dw; x += 8)
+    {
+        // column sums, [t0 t1 | t2 t3] of four source texels per register
+        __m256i s[4];
+        for(int i = 0; i < 4; i++)
+        {
+            __m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(r0 + x * 8 + i * 16)));
+            __m256i b = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(r1 + x * 8 + i * 16)));
+            s[i]      = _mm256_add_epi16(a, b);
+        }
+
+        // pair sums: [o0 o2 | o1 o3], [o4 o6 | o5 o7]
+        __m256i lo = _mm256_add_epi16(_mm256_unpacklo_epi64(s[0], s[1]), _mm256_unpackhi_epi64(s[0], s[1]));
+        __m256i hi = _mm256_add_epi16(_mm256_unpacklo_epi64(s[2], s[3]), _mm256_unpackhi_epi64(s[2], s[3]));
+        lo         = _mm256_srli_epi16(_mm256_add_epi16(lo, two), 2);
+        hi         = _mm256_srli_epi16(_mm256_add_epi16(hi, two), 2);
+
+        __m256i packed = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(lo, hi), order);
+        _mm256_storeu_si256((__m256i*)(out + x * 4), packed);
+    }
+    return x;
+}
+
+// Two output texels per step, one per 128-bit half: lanes [r g b a | r g b a].
+__attribute__((target("avx2"))) static uint32_t row_srgb_avx2(const uint8_t* r0, const uint8_t* r1, uint8_t* out, uint32_t dw)
+{
+    // 4 source texels -> [t0 t2 | t1 t3]: even texels in the low 8 bytes
+    const __m128i split = _mm_setr_epi8(0, 1, 2, 3, 8, 9, 10, 11, 4, 5, 6, 7, 12, 13, 14, 15);
+    const __m256  scale = _mm256_set1_ps((float)(SRGB_ENCODE_SIZE - 1));
+    const __m256  half  = _mm256_set1_ps(0.5f);
+    const __m256  quart = _mm256_set1_ps(0.25f);
+    const __m256i two   = _mm256_set1_epi32(2);
+
+    uint32_t x = 0;
+    for(; x + 2 <= dw; x += 2)
+    {
+        __m128i a = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(r0 + x * 8)), split);
+        __m128i b = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(r1 + x * 8)), split);
+
+        __m256i a0 = _mm256_cvtepu8_epi32(a);
+        __m256i a1 = _mm256_cvtepu8_epi32(_mm_srli_si128(a, 8));
+        __m256i b0 = _mm256_cvtepu8_epi32(b);
+        __m256i b1 = _mm256_cvtepu8_epi32(_mm_srli_si128(b, 8));
+
+        __m256 la = _mm256_add_ps(_mm256_i32gather_ps(g_srgb_decode, a0, 4), _mm256_i32gather_ps(g_srgb_decode, a1, 4));
+        __m256 lb = _mm256_add_ps(_mm256_i32gather_ps(g_srgb_decode, b0, 4), _mm256_i32gather_ps(g_srgb_decode, b1, 4));
+        __m256 l  = _mm256_mul_ps(_mm256_add_ps(la, lb), quart);
+
+        __m256i idx = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(l, scale), half));
+        __m256i rgb = _mm256_i32gather_epi32((const int*)g_srgb_encode, idx, 4);
+
+        __m256i sum   = _mm256_add_epi32(_mm256_add_epi32(a0, a1), _mm256_add_epi32(b0, b1));
+        __m256i alpha = _mm256_srli_epi32(_mm256_add_epi32(sum, two), 2);
+        __m256i texel = _mm256_blend_epi32(rgb, alpha, 0x88);
+
+        // values fit a byte: pack in place, then one dword per half
+        texel      = _mm256_packus_epi16(_mm256_packus_epi32(texel, texel), texel);
+        uint32_t t0 = (uint32_t)_mm_cvtsi128_si32(_mm256_castsi256_si128(texel));
+        uint32_t t1 = (uint32_t)_mm_cvtsi128_si32(_mm256_extracti128_si256(texel, 1));
+        memcpy(out + x * 4, &t0, 4);
+        memcpy(out + x * 4 + 4, &t1, 4);
+    }
+    return x;
+}
+
+#endif
+
+static TextureMipsIsa detect_isa(void)
+{
+#ifdef TEXTURE_MIPS_X86
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? TEXTURE_MIPS_ISA_AVX2 : TEXTURE_MIPS_ISA_SSE;
+#else
+    return TEXTURE_MIPS_ISA_SCALAR;
+#endif
+}
+
+TextureMipsIsa texture_mips_isa(void)
+{
+    if(g_isa < 0)
+        g_isa = (int)detect_isa();
+    return (TextureMipsIsa)g_isa;
+}
+
+TextureMipsIsa texture_mips_set_isa(TextureMipsIsa isa)
+{
+    g_isa = (int)MIN(isa, detect_isa());
+    return (TextureMipsIsa)g_isa;
+}
+
+typedef struct MipStep
+{
+    const uint8_t* src;
+    uint32_t       sw, sh;
+    uint8_t*       dst;
+    uint32_t       dw, dh;
+    bool           srgb;
+    TextureMipsIsa isa;
+} MipStep;
+
+static void step_rows(const MipStep* m, uint32_t y0, uint32_t y1)
+{
+    for(uint32_t y = y0; y < y1; y++)
+    {
+        const uint8_t* r0  = m->src + (size_t)MIN(y * 2, m->sh - 1) * m->sw * 4;
+        const uint8_t* r1  = m->src + (size_t)MIN(y * 2 + 1, m->sh - 1) * m->sw * 4;
+        uint8_t*       out = m->dst + (size_t)y * m->dw * 4;
+
+        uint32_t x = 0;
+#ifdef TEXTURE_MIPS_X86
+        if(m->sw > 1)
+        {
+            if(m->srgb)
+            {
+                if(m->isa >= TEXTURE_MIPS_ISA_AVX2)
+                    x = row_srgb_avx2(r0, r1, out, m->dw);
+            }
+            else if(m->isa >= TEXTURE_MIPS_ISA_AVX2)
+                x = row_avx2(r0, r1, out, m->dw);
+            else if(m->isa >= TEXTURE_MIPS_ISA_SSE)
+                x = row_sse(r0, r1, out, m->dw);
+        }
+#endif
+        row_scalar(r0, r1, out, x, m->dw, m->sw, m->srgb);
+    }
+}
+
+static void step_job(void* user, uint32_t index)
+{
+    const MipStep* m  = (const MipStep*)user;
+    uint32_t       y0 = index * TEXTURE_MIPS_JOB_ROWS;
+    step_rows(m, y0, MIN(y0 + TEXTURE_MIPS_JOB_ROWS, m->dh));
+}
+
+static void downsample(const uint8_t* src, uint32_t sw, uint32_t sh, uint8_t* dst, bool srgb, JobPool* pool)
+{
+    MipStep m = {
+        .src  = src,
+        .sw   = sw,
+        .sh   = sh,
+        .dst  = dst,
+        .dw   = (sw > 1) ? (sw >> 1) : 1,
+        .dh   = (sh > 1) ? (sh >> 1) : 1,
+        .srgb = srgb,
+        .isa  = texture_mips_isa(),
+    };
+
+    if(srgb)
+        pthread_once(&g_tables_once, init_tables);
+
+    if(pool && m.dh >= TEXTURE_MIPS_JOB_ROWS * 2)
+        job_pool_parallel_for(pool, (m.dh + TEXTURE_MIPS_JOB_ROWS - 1) / TEXTURE_MIPS_JOB_ROWS, step_job, &m);
+    else
+        step_rows(&m, 0, m.dh);
+}
+
+void texture_mips_downsample_rgba8(const uint8_t* src, uint32_t sw, uint32_t sh, uint8_t* dst, bool srgb)
+{
+    downsample(src, sw, sh, dst, srgb, NULL);
+}
+
+void texture_mips_build_rgba8(uint8_t* chain, const TextureFileLevel* levels, uint32_t level_count, bool srgb, JobPool* pool)
+{
+    for(uint32_t l = 1; l < level_count; l++)
+    {
+        const TextureFileLevel* src = &levels[l - 1];
+        downsample(chain + src->offset, src->width, src->height, chain + levels[l].offset, srgb, pool);
+    }
+}
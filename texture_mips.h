@@ -0,0 +1,36 @@
+#pragma once
+
+#include "texture_file.h"
+#include "job_pool.h"
+
+// CPU mip chains for RGBA8 textures.
+//
+// Every level is a 2x2 box filter of the one above, rounded to nearest; odd
+// edges drop their last row/column like the GPU's floor sizing, and 1-texel
+// dimensions repeat the texel. With srgb set, RGB is averaged in linear light
+// (256-entry decode table, 4096-entry encode table) and alpha stays linear.
+//
+// Linear filtering runs 8 output texels per step with AVX2, 4 with SSE2;
+// sRGB filtering gathers its table lookups with AVX2 and is scalar otherwise.
+// Levels of TEXTURE_MIPS_JOB_ROWS * 2 rows or more are split into row bands
+// on the JobPool; each level waits for the one above.
+
+#define TEXTURE_MIPS_JOB_ROWS 32u
+
+typedef enum TextureMipsIsa
+{
+    TEXTURE_MIPS_ISA_SCALAR = 0,
+    TEXTURE_MIPS_ISA_SSE,   // linear: 4 texels per step
+    TEXTURE_MIPS_ISA_AVX2,  // linear: 8 texels per step; sRGB: gathered table lookups
+} TextureMipsIsa;
+
+// One level: src sw x sh to dst max(sw/2,1) x max(sh/2,1).
+void texture_mips_downsample_rgba8(const uint8_t* src, uint32_t sw, uint32_t sh, uint8_t* dst, bool srgb);
+
+// Fills levels [1, level_count) of chain from level 0, at the offsets and
+// sizes in levels. pool may be NULL (calling thread only).
+void texture_mips_build_rgba8(uint8_t* chain, const TextureFileLevel* levels, uint32_t level_count, bool srgb, JobPool* pool);
+
+// Best ISA the CPU supports unless lowered with texture_mips_set_isa (benchmarks).
+TextureMipsIsa texture_mips_isa(void);
+TextureMipsIsa texture_mips_set_isa(TextureMipsIsa isa);
@@ -0,0 +1,689 @@
+#include "texture_streamer.h"
+
+#include "vk_barrier.h"
+#include "vk_cmd.h"
+#include "vk_queue.h"
+
+#define TEXTURE_STREAM_STAGING_ALIGN 16ull
+#define TEXTURE_STREAM_RETIRE_TIMEOUT_NS 2000000ull
+
+struct StreamedTexture
+{
+    uint32_t    slot;
+    char*       path;
+    TextureFile file;  // whole chain, streamer thread only
+    bool        srgb;
+    bool        loaded;
+    bool        failed;
+
+    uint32_t base_top;   // coarsest residency, uploaded first and never evicted
+    uint32_t top;        // first level of the installed image, file.level_count when none
+    uint32_t target;     // top once the rebuild in flight lands
+    uint32_t wanted;     // from feedback
+    uint32_t sampled_slot[TEXTURE_STREAM_MAX_FRAMES];  // slot and top each frame slot was recorded against
+    uint32_t sampled_top[TEXTURE_STREAM_MAX_FRAMES];
+    uint64_t last_seen;  // TextureStreamer.frame
+    bool     busy;       // rebuild in flight
+};
+
+typedef struct TextureStreamJob
+{
+    StreamedTexture* st;
+    uint32_t         top;
+    bool             evict;
+    TextureResource  tex;
+    VkDeviceSize     staging_offset;
+} TextureStreamJob;
+
+struct TextureStreamBatch
+{
+    uint64_t          value;
+    Buffer            staging;
+    VkCommandBuffer   cmd;
+    TextureStreamJob* jobs;  // stb_ds
+};
+
+// device memory of levels [top, last]
+static VkDeviceSize bytes_from(const StreamedTexture* st, uint32_t top)
+{
+    VkDeviceSize bytes = 0;
+    for(uint32_t l = top; l < st->file.level_count; l++)
+        bytes += st->file.levels[l].size;
+    return bytes;
+}
+
+// levels [top, last] of file as a file of their own, sharing its data
+static TextureFile file_from_level(const TextureFile* file, uint32_t top)
+{
+    VkDeviceSize base = file->levels[top].offset;
+    TextureFile  sub  = {
+          .format        = file->format,
+          .width         = file->levels[top].width,
+          .height        = file->levels[top].height,
+          .level_count   = file->level_count - top,
+          .generate_mips = false,
+          .data          = file->data + base,
+          .size          = file->size - base,
+    };
+    for(uint32_t l = 0; l < sub.level_count; l++)
+    {
+        sub.levels[l] = file->levels[top + l];
+        sub.levels[l].offset -= base;
+    }
+    return sub;
+}
+
+// What the streamed textures may hold: the configured budget, capped by
+// their own bytes plus what the device-local heaps have left (10% kept free).
+static VkDeviceSize effective_budget(TextureStreamer* s, VkDeviceSize resident)
+{
+    VkDeviceSize heap_budget = 0, heap_usage = 0;
+    res_device_local_budget(s->allocator, &heap_budget, &heap_usage);
+
+    VkDeviceSize keep = heap_budget - heap_budget / 10;
+    VkDeviceSize cap  = resident + (keep > heap_usage ? keep - heap_usage : 0);
+    return s->budget ? MIN(s->budget, cap) : cap;
+}
+
+static void add_job(TextureStreamJob** jobs, StreamedTexture* st, uint32_t top, bool evict)
+{
+    TextureStreamJob job = {.st = st, .top = top, .evict = evict};
+    arrpush(*jobs, job);
+    st->busy   = true;
+    st->target = top;
+}
+
+// Furthest above its wanted level, most recently sampled on ties.
+static StreamedTexture* pick_raise(TextureStreamer* s)
+{
+    StreamedTexture* best     = NULL;
+    uint32_t         best_gap = 0;
+    for(uint32_t i = 0; i < (uint32_t)arrlen(s->textures); i++)
+    {
+        StreamedTexture* st = s->textures[i];
+        if(!st->loaded || st->busy || st->target >= st->file.level_count || st->wanted >= st->target)
+            continue;
+
+        uint32_t gap = st->target - st->wanted;
+        if(!best || gap > best_gap || (gap == best_gap && st->last_seen > best->last_seen))
+        {
+            best     = st;
+            best_gap = gap;
+        }
+    }
+    return best;
+}
+
+// Unsampled the longest, and longer than `than` when given.
+static StreamedTexture* pick_evict(TextureStreamer* s, const StreamedTexture* than)
+{
+    StreamedTexture* best = NULL;
+    for(uint32_t i = 0; i < (uint32_t)arrlen(s->textures); i++)
+    {
+        StreamedTexture* st = s->textures[i];
+        if(!st->loaded || st->busy || st->target >= st->base_top)
+            continue;
+        if(than && st->last_seen >= than->last_seen)
+            continue;
+        if(!best || st->last_seen < best->last_seen)
+            best = st;
+    }
+    return best;
+}
+
+// Under the mutex: this round's rebuilds, all one level steps.
+static void plan(TextureStreamer* s, TextureStreamJob** jobs)
+{
+    VkDeviceSize resident = 0;
+    for(uint32_t i = 0; i < (uint32_t)arrlen(s->textures); i++)
+    {
+        const StreamedTexture* st = s->textures[i];
+        if(st->loaded)
+            resident += bytes_from(st, st->target);
+    }
+
+    VkDeviceSize budget = effective_budget(s, resident);
+    VkDeviceSize staged = 0;
+
+    // base levels first, whatever the budget says
+    for(uint32_t i = 0; i < (uint32_t)arrlen(s->textures) && staged < TEXTURE_STREAM_BATCH_BYTES; i++)
+    {
+        StreamedTexture* st = s->textures[i];
+        if(!st->loaded || st->busy || st->target < st->file.level_count)
+            continue;
+
+        VkDeviceSize bytes = bytes_from(st, st->base_top);
+        add_job(jobs, st, st->base_top, false);
+        resident += bytes;
+        staged += bytes;
+    }
+
+    while(staged < TEXTURE_STREAM_BATCH_BYTES)
+    {
+        StreamedTexture* st = pick_raise(s);
+        if(!st)
+            break;
+
+        VkDeviceSize extra = st->file.levels[st->target - 1].size;
+        while(resident + extra > budget)
+        {
+            StreamedTexture* victim = pick_evict(s, st);
+            if(!victim)
+                break;
+            resident -= victim->file.levels[victim->target].size;
+            add_job(jobs, victim, victim->target + 1, true);
+        }
+        if(resident + extra > budget)
+            break;
+
+        add_job(jobs, st, st->target - 1, false);
+        resident += extra;
+        staged += bytes_from(st, st->target);
+    }
+
+    // the budget shrank (other allocations grew): give levels back
+    while(resident > budget)
+    {
+        StreamedTexture* victim = pick_evict(s, NULL);
+        if(!victim)
+            break;
+        resident -= victim->file.levels[victim->target].size;
+        add_job(jobs, victim, victim->target + 1, true);
+    }
+
+    s->stats.budget_bytes = budget;
+}
+
+// Images, one staging buffer and one command buffer for the round.
+static void submit_batch(TextureStreamer* s, TextureStreamJob* jobs)
+{
+    TextureStreamBatch batch       = {0};
+    VkDeviceSize       staging_end = 0;
+
+    for(uint32_t i = 0; i < (uint32_t)arrlen(jobs); i++)
+    {
+        TextureStreamJob*  job  = &jobs[i];
+        const TextureFile* file = &job->st->file;
+        const TextureFileLevel* top = &file->levels[job->top];
+        if(!bindless_textures_create_image(s->allocator, s->device, file->format, top->width, top->height,
+                                           file->level_count - job->top, &job->tex))
+        {
+            pthread_mutex_lock(&s->mutex);
+            job->st->busy   = false;
+            job->st->target = job->st->top;
+            pthread_mutex_unlock(&s->mutex);
+            continue;
+        }
+
+        staging_end         = (staging_end + TEXTURE_STREAM_STAGING_ALIGN - 1) & ~(TEXTURE_STREAM_STAGING_ALIGN - 1);
+        job->staging_offset = staging_end;
+        staging_end += bytes_from(job->st, job->top);
+        arrpush(batch.jobs, *job);
+    }
+
+    if(arrlen(batch.jobs) == 0)
+        return;
+
+    res_create_buffer(s->allocator, staging_end, VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_AUTO,
+                      VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, 0, &batch.staging);
+
+    vk_cmd_alloc(s->device, s->cmd_pool, true, &batch.cmd);
+    vk_cmd_begin(batch.cmd, true);
+
+    for(uint32_t i = 0; i < (uint32_t)arrlen(batch.jobs); i++)
+    {
+        TextureStreamJob* job = &batch.jobs[i];
+        TextureFile       sub = file_from_level(&job->st->file, job->top);
+        memcpy(batch.staging.mapping + job->staging_offset, sub.data, (size_t)sub.size);
+        bindless_textures_cmd_upload_file(batch.cmd, &job->tex, &sub, batch.staging.buffer, job->staging_offset);
+    }
+
+    vk_cmd_end(batch.cmd);
+
+    batch.value = ++s->next_value;
+
+    VkCommandBufferSubmitInfo cmd_info = {
+        .sType         = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+        .commandBuffer = batch.cmd,
+    };
+
+    VkSemaphoreSubmitInfo signal = {
+        .sType     = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+        .semaphore = s->timeline,
+        .value     = batch.value,
+        .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+    };
+
+    VkSubmitInfo2 submit = {
+        .sType                    = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+        .commandBufferInfoCount   = 1,
+        .pCommandBufferInfos      = &cmd_info,
+        .signalSemaphoreInfoCount = 1,
+        .pSignalSemaphoreInfos    = &signal,
+    };
+
+    vk_queue_lock();
+    VK_CHECK(vkQueueSubmit2(s->queue, 1, &submit, VK_NULL_HANDLE));
+    vk_queue_unlock();
+
+    arrpush(s->in_flight, batch);
+}
+
+// Hands completed batches to texture_streamer_update. With wait set, blocks
+// briefly on the oldest batch so an idle thread does not spin.
+static void retire_batches(TextureStreamer* s, bool wait)
+{
+    if(arrlen(s->in_flight) == 0)
+        return;
+
+    uint64_t done = 0;
+    VK_CHECK(vkGetSemaphoreCounterValue(s->device, s->timeline, &done));
+
+    if(wait && done < s->in_flight[0].value)
+    {
+        VkSemaphoreWaitInfo wait_info = {
+            .sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .semaphoreCount = 1,
+            .pSemaphores    = &s->timeline,
+            .pValues        = &s->in_flight[0].value,
+        };
+        VkResult r = vkWaitSemaphores(s->device, &wait_info, TEXTURE_STREAM_RETIRE_TIMEOUT_NS);
+        if(r != VK_TIMEOUT)
+            VK_CHECK(r);
+        VK_CHECK(vkGetSemaphoreCounterValue(s->device, s->timeline, &done));
+    }
+
+    while(arrlen(s->in_flight) > 0 && s->in_flight[0].value <= done)
+    {
+        TextureStreamBatch batch = s->in_flight[0];
+        arrdel(s->in_flight, 0);
+
+        res_destroy_buffer(s->allocator, &batch.staging);
+        vkFreeCommandBuffers(s->device, s->cmd_pool, 1, &batch.cmd);
+
+        pthread_mutex_lock(&s->mutex);
+        arrpush(s->done, batch);
+        s->stats.batches++;
+        pthread_mutex_unlock(&s->mutex);
+    }
+}
+
+static void* streamer_main(void* arg)
+{
+    TextureStreamer*  s    = (TextureStreamer*)arg;
+    TextureStreamJob* jobs = NULL;
+
+    for(;;)
+    {
+        pthread_mutex_lock(&s->mutex);
+        while(!s->shutdown && !s->wake && arrlen(s->in_flight) == 0)
+            pthread_cond_wait(&s->work_cond, &s->mutex);
+
+        if(s->shutdown)
+        {
+            pthread_mutex_unlock(&s->mutex);
+            break;
+        }
+        s->wake = false;
+
+        // one file per round, so feedback keeps being served while a set loads
+        StreamedTexture* load = NULL;
+        for(uint32_t i = 0; i < (uint32_t)arrlen(s->textures) && !load; i++)
+        {
+            if(!s->textures[i]->loaded && !s->textures[i]->failed)
+                load = s->textures[i];
+        }
+        pthread_mutex_unlock(&s->mutex);
+
+        if(load)
+        {
+            TextureFile file = {0};
+            bool        ok   = texture_file_load(load->path, &file) && texture_file_build_mips(&file, load->srgb, NULL);
+            if(!ok)
+            {
+                log_warn("texture_streamer: failed to load %s", load->path);
+                texture_file_free(&file);
+            }
+
+            uint32_t base = 0;
+            while(ok && base + 1 < file.level_count
+                  && MAX(file.levels[base].width, file.levels[base].height) > TEXTURE_STREAM_BASE_SIZE)
+                base++;
+
+            pthread_mutex_lock(&s->mutex);
+            load->file     = file;
+            load->base_top = base;
+            load->top      = file.level_count;
+            load->target   = file.level_count;
+            load->wanted   = base;
+            load->loaded   = ok;
+            load->failed   = !ok;
+            s->wake        = true;  // more files may be waiting
+            for(uint32_t f = 0; f < TEXTURE_STREAM_MAX_FRAMES; f++)
+            {
+                load->sampled_slot[f] = load->slot;
+                load->sampled_top[f]  = file.level_count;
+            }
+            pthread_mutex_unlock(&s->mutex);
+        }
+
+        pthread_mutex_lock(&s->mutex);
+        plan(s, &jobs);
+        pthread_mutex_unlock(&s->mutex);
+
+        uint32_t planned = (uint32_t)arrlen(jobs);
+        if(planned > 0)
+            submit_batch(s, jobs);
+        arrsetlen(jobs, 0);
+
+        retire_batches(s, planned == 0 && !load);
+    }
+
+    // everything submitted lands before the thread goes
+    while(arrlen(s->in_flight) > 0)
+        retire_batches(s, true);
+
+    arrfree(jobs);
+    return NULL;
+}
+
+bool texture_streamer_init(TextureStreamer* streamer, BindlessTextures* bindless, ResourceAllocator* allocator,
+                           VkDevice device, VkQueue queue, uint32_t queue_family, VkDeviceSize budget, uint32_t frame_count)
+{
+    memset(streamer, 0, sizeof(*streamer));
+
+    streamer->bindless    = bindless;
+    streamer->allocator   = allocator;
+    streamer->device      = device;
+    streamer->queue       = queue;
+    streamer->budget      = budget;
+    streamer->frame_count = MIN(frame_count, (uint32_t)TEXTURE_STREAM_MAX_FRAMES);
+
+    VkDeviceSize feedback_size = (VkDeviceSize)bindless->max_textures * sizeof(uint32_t);
+    res_create_buffer(allocator, feedback_size, VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT,
+                      VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE, 0, 0, &streamer->feedback);
+    for(uint32_t f = 0; f < streamer->frame_count; f++)
+    {
+        res_create_buffer(allocator, feedback_size, VK_BUFFER_USAGE_2_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_AUTO,
+                          VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, 0,
+                          &streamer->readback[f]);
+        memset(streamer->readback[f].mapping, 0xFF, (size_t)feedback_size);
+    }
+
+    VkSemaphoreTypeCreateInfo type_info = {
+        .sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+        .initialValue  = 0,
+    };
+    VkSemaphoreCreateInfo sem_info = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &type_info,
+    };
+    VK_CHECK(vkCreateSemaphore(device, &sem_info, NULL, &streamer->timeline));
+
+    // the thread frees each command buffer on retire
+    vk_cmd_create_pool(device, queue_family, true, false, &streamer->cmd_pool);
+
+    // nothing sampled yet
+    VkCommandBuffer cmd = begin_one_time_cmd(device, streamer->cmd_pool);
+    vkCmdFillBuffer(cmd, streamer->feedback.buffer, 0, feedback_size, UINT32_MAX);
+    end_one_time_cmd(device, queue, streamer->cmd_pool, cmd);
+
+    pthread_mutex_init(&streamer->mutex, NULL);
+    pthread_cond_init(&streamer->work_cond, NULL);
+
+    if(pthread_create(&streamer->thread, NULL, streamer_main, streamer) != 0)
+    {
+        log_error("texture_streamer: failed to start the streamer thread");
+        pthread_cond_destroy(&streamer->work_cond);
+        pthread_mutex_destroy(&streamer->mutex);
+        vk_cmd_destroy_pool(device, streamer->cmd_pool);
+        vkDestroySemaphore(device, streamer->timeline, NULL);
+        for(uint32_t f = 0; f < streamer->frame_count; f++)
+            res_destroy_buffer(allocator, &streamer->readback[f]);
+        res_destroy_buffer(allocator, &streamer->feedback);
+        memset(streamer, 0, sizeof(*streamer));
+        return false;
+    }
+
+    return true;
+}
+
+void texture_streamer_destroy(TextureStreamer* streamer)
+{
+    if(!streamer || !streamer->device)
+        return;
+
+    pthread_mutex_lock(&streamer->mutex);
+    streamer->shutdown = true;
+    pthread_cond_signal(&streamer->work_cond);
+    pthread_mutex_unlock(&streamer->mutex);
+    pthread_join(streamer->thread, NULL);
+
+    // finished but never installed
+    for(uint32_t b = 0; b < (uint32_t)arrlen(streamer->done); b++)
+    {
+        for(uint32_t i = 0; i < (uint32_t)arrlen(streamer->done[b].jobs); i++)
+            bindless_textures_destroy_texture(streamer->allocator, streamer->device, &streamer->done[b].jobs[i].tex);
+        arrfree(streamer->done[b].jobs);
+    }
+    arrfree(streamer->done);
+    arrfree(streamer->in_flight);
+    arrfree(streamer->moves);
+
+    for(uint32_t i = 0; i < (uint32_t)arrlen(streamer->textures); i++)
+    {
+        texture_file_free(&streamer->textures[i]->file);
+        free(streamer->textures[i]->path);
+        free(streamer->textures[i]);
+    }
+    arrfree(streamer->textures);
+
+    pthread_cond_destroy(&streamer->work_cond);
+    pthread_mutex_destroy(&streamer->mutex);
+
+    vk_cmd_destroy_pool(streamer->device, streamer->cmd_pool);
+    vkDestroySemaphore(streamer->device, streamer->timeline, NULL);
+    for(uint32_t f = 0; f < streamer->frame_count; f++)
+        res_destroy_buffer(streamer->allocator, &streamer->readback[f]);
+    res_destroy_buffer(streamer->allocator, &streamer->feedback);
+
+    memset(streamer, 0, sizeof(*streamer));
+}
+
+bool texture_streamer_request(TextureStreamer* streamer, const char* path, bool srgb, TextureHandle* out_handle)
+{
+    if(!streamer || !path || !out_handle)
+        return false;
+
+    BindlessTextures* bt   = streamer->bindless;
+    uint32_t          slot = bindless_textures_alloc_slot(bt);
+    if(slot == 0)
+        return false;
+
+    // dummy until the base levels land
+    if(bt->textures[0].image.view && bt->textures[0].image.sampler)
+        bindless_textures_write(bt, streamer->device, slot, bt->textures[0].image.view, bt->textures[0].image.sampler,
+                                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    StreamedTexture* st  = (StreamedTexture*)calloc(1, sizeof(StreamedTexture));
+    size_t           len = strlen(path);
+    st->path             = (char*)malloc(len + 1);
+    memcpy(st->path, path, len + 1);
+    st->slot      = slot;
+    st->srgb      = srgb;
+    st->last_seen = streamer->frame;
+
+    pthread_mutex_lock(&streamer->mutex);
+    arrpush(streamer->textures, st);
+    streamer->stats.textures++;
+    streamer->wake = true;
+    pthread_cond_signal(&streamer->work_cond);
+    pthread_mutex_unlock(&streamer->mutex);
+
+    *out_handle = bindless_textures_handle(bt, slot);
+    return true;
+}
+
+uint32_t texture_streamer_update(TextureStreamer* streamer, uint32_t frame, const TextureSlotMove** out_moves)
+{
+    streamer->frame++;
+    arrsetlen(streamer->moves, 0);
+
+    Buffer* readback = &streamer->readback[frame];
+    vmaInvalidateAllocation(streamer->allocator->allocator, readback->allocation, 0, VK_WHOLE_SIZE);
+    const uint32_t* lods = (const uint32_t*)readback->mapping;
+
+    pthread_mutex_lock(&streamer->mutex);
+
+    // LODs are relative to the image the frame sampled, whose level 0 was
+    // the top recorded for this frame slot frame_count frames ago
+    for(uint32_t i = 0; i < (uint32_t)arrlen(streamer->textures); i++)
+    {
+        StreamedTexture* st = streamer->textures[i];
+        if(!st->loaded || st->sampled_top[frame] >= st->file.level_count)
+            continue;
+
+        uint32_t lod = lods[st->sampled_slot[frame]];
+        if(lod != UINT32_MAX)
+        {
+            int32_t level = (int32_t)st->sampled_top[frame] + (int32_t)lod - (int32_t)TEXTURE_STREAM_LOD_BIAS;
+            st->wanted    = MIN((uint32_t)MAX(level, 0), st->base_top);
+            st->last_seen = streamer->frame;
+        }
+        else if(streamer->frame - st->last_seen > TEXTURE_STREAM_IDLE_FRAMES)
+            st->wanted = st->base_top;
+    }
+
+    TextureStreamBatch* done = streamer->done;
+    streamer->done           = NULL;
+    for(uint32_t b = 0; b < (uint32_t)arrlen(done); b++)
+    {
+        for(uint32_t i = 0; i < (uint32_t)arrlen(done[b].jobs); i++)
+        {
+            TextureStreamJob* job  = &done[b].jobs[i];
+            uint32_t          slot = bindless_textures_replace(streamer->bindless, streamer->device, job->st->slot, &job->tex);
+            if(slot == 0)
+            {
+                // no slot left: the old image stays, the planner asks again
+                log_warn("texture_streamer: no free bindless slot to install %s", job->st->path);
+                bindless_textures_destroy_texture(streamer->allocator, streamer->device, &job->tex);
+                job->st->target = job->st->top;
+                job->st->busy   = false;
+                continue;
+            }
+
+            TextureSlotMove move = {.from = job->st->slot, .to = slot};
+            arrpush(streamer->moves, move);
+            job->st->slot = slot;
+
+            if(job->evict)
+                streamer->stats.evicted++;
+            else
+                streamer->stats.raised += job->st->top - job->top;  // top == level_count before the base upload
+
+            job->st->top  = job->top;
+            job->st->busy = false;
+        }
+    }
+
+    // what the frame recorded next samples, for its readback
+    for(uint32_t i = 0; i < (uint32_t)arrlen(streamer->textures); i++)
+    {
+        StreamedTexture* st = streamer->textures[i];
+        if(st->loaded)
+        {
+            st->sampled_slot[frame] = st->slot;
+            st->sampled_top[frame]  = st->top;
+        }
+    }
+
+    streamer->wake = true;
+    pthread_cond_signal(&streamer->work_cond);
+    pthread_mutex_unlock(&streamer->mutex);
+
+    for(uint32_t b = 0; b < (uint32_t)arrlen(done); b++)
+        arrfree(done[b].jobs);
+    arrfree(done);
+
+    *out_moves = streamer->moves;
+    return (uint32_t)arrlen(streamer->moves);
+}
+
+void texture_streamer_cmd_feedback(TextureStreamer* streamer, VkCommandBuffer cmd, uint32_t frame)
+{
+    VkBuffer     feedback = streamer->feedback.buffer;
+    VkDeviceSize size     = (VkDeviceSize)streamer->bindless->max_textures * sizeof(uint32_t);
+
+    cmd_buffer_barrier(cmd, &(BufferBarrierDesc){
+                                .buffer           = feedback,
+                                .offset           = 0,
+                                .size             = size,
+                                .src_stage        = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+                                .dst_stage        = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                                .src_access       = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                                .dst_access       = VK_ACCESS_2_TRANSFER_READ_BIT,
+                                .src_queue_family = VK_QUEUE_FAMILY_IGNORED,
+                                .dst_queue_family = VK_QUEUE_FAMILY_IGNORED,
+                            });
+
+    VkBufferCopy region = {.srcOffset = 0, .dstOffset = 0, .size = size};
+    vkCmdCopyBuffer(cmd, feedback, streamer->readback[frame].buffer, 1, &region);
+
+    // the fill must not overtake the copy
+    cmd_buffer_barrier(cmd, &(BufferBarrierDesc){
+                                .buffer           = feedback,
+                                .offset           = 0,
+                                .size             = size,
+                                .src_stage        = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                                .dst_stage        = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                                .src_access       = 0,
+                                .dst_access       = 0,
+                                .src_queue_family = VK_QUEUE_FAMILY_IGNORED,
+                                .dst_queue_family = VK_QUEUE_FAMILY_IGNORED,
+                            });
+    vkCmdFillBuffer(cmd, feedback, 0, size, UINT32_MAX);
+
+    // next frame's atomics and the host read after the fence
+    cmd_buffer_barrier(cmd, &(BufferBarrierDesc){
+                                .buffer           = feedback,
+                                .offset           = 0,
+                                .size             = size,
+                                .src_stage        = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                                .dst_stage        = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+                                .src_access       = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                                .dst_access       = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                                .src_queue_family = VK_QUEUE_FAMILY_IGNORED,
+                                .dst_queue_family = VK_QUEUE_FAMILY_IGNORED,
+                            });
+    cmd_buffer_barrier(cmd, &(BufferBarrierDesc){
+                                .buffer           = streamer->readback[frame].buffer,
+                                .offset           = 0,
+                                .size             = size,
+                                .src_stage        = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                                .dst_stage        = VK_PIPELINE_STAGE_2_HOST_BIT,
+                                .src_access       = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                                .dst_access       = VK_ACCESS_2_HOST_READ_BIT,
+                                .src_queue_family = VK_QUEUE_FAMILY_IGNORED,
+                                .dst_queue_family = VK_QUEUE_FAMILY_IGNORED,
+                            });
+}
+
+void texture_streamer_print_stats(TextureStreamer* streamer)
+{
+    pthread_mutex_lock(&streamer->mutex);
+    VkDeviceSize resident = 0;
+    for(uint32_t i = 0; i < (uint32_t)arrlen(streamer->textures); i++)
+    {
+        const StreamedTexture* st = streamer->textures[i];
+        if(st->loaded)
+            resident += bytes_from(st, st->top);
+    }
+    streamer->stats.resident_bytes = resident;
+    TextureStreamerStats s         = streamer->stats;
+    pthread_mutex_unlock(&streamer->mutex);
+
+    printf("streaming: %u textures, %.1f / %.1f MB resident, %u levels raised, %u evicted, %u batches\n", s.textures,
+           (double)s.resident_bytes / (1024.0 * 1024.0), (double)s.budget_bytes / (1024.0 * 1024.0), s.raised, s.evicted,
+           s.batches);
+}
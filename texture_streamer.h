@@ -0,0 +1,118 @@
+#pragma once
+
+#include "bindlesstextures.h"
+#include <pthread.h>
+
+// Texture streaming: mip residency per texture under a VRAM budget.
+//
+// texture_streamer_request() reserves a bindless slot (dummy until the first
+// upload) and hands the path to the streamer thread. The thread keeps the
+// whole mip chain in system memory (RGBA8 files get CPU mips) and first
+// uploads only the levels no larger than TEXTURE_STREAM_BASE_SIZE.
+//
+// GPU feedback drives the rest: the material shaders (texture_feedback.glsl),
+// built with specialization constant TEXTURE_STREAM_FEEDBACK_CONSTANT_ID set,
+// atomicMin the LOD they sample into one uint per bindless slot, relative to
+// the image in the slot and biased by TEXTURE_STREAM_LOD_BIAS so magnified
+// samples ask for levels above it. texture_streamer_cmd_feedback() copies
+// those to the frame's readback buffer and clears them;
+// texture_streamer_update() reads them back once the frame's fence has been
+// waited on and, with the top level the frame was recorded against, turns
+// them into a wanted level of the full chain per texture.
+//
+// A residency change rebuilds the image: the thread creates an image holding
+// levels [top, last] and uploads them from the system memory copy, so the
+// image being sampled is never touched. texture_streamer_update() installs the
+// new one in a fresh slot with bindless_textures_replace(), which retires the
+// old slot behind the frames in flight, and reports the move: the caller
+// repoints its materials before recording the frame.
+//
+// The thread raises the textures furthest above their wanted level first, one
+// level at a time. Streamed bytes stay under the budget: the configured one,
+// capped by what VK_EXT_memory_budget leaves free on the device-local heaps.
+// When a level does not fit, textures unsampled the longest lose their top
+// level first; base levels are never evicted.
+
+#define TEXTURE_STREAM_BASE_SIZE 64u
+#define TEXTURE_STREAM_IDLE_FRAMES 240u  // unsampled this long: wanted drops back to base
+#define TEXTURE_STREAM_BATCH_BYTES (32ull * 1024 * 1024)
+#define TEXTURE_STREAM_MAX_FRAMES 4
+#define TEXTURE_STREAM_LOD_BIAS 32u  // TEXTURE_FEEDBACK_LOD_BIAS in shaders/texture_feedback.glsl
+#define TEXTURE_STREAM_FEEDBACK_CONSTANT_ID 0u  // VkBool32 TEXTURE_FEEDBACK in shaders/texture_feedback.glsl
+
+typedef struct StreamedTexture StreamedTexture;
+
+typedef struct TextureStreamBatch TextureStreamBatch;
+
+typedef struct TextureStreamerStats
+{
+    uint32_t     textures;
+    uint32_t     raised;   // levels uploaded
+    uint32_t     evicted;  // levels dropped for the budget
+    uint32_t     batches;
+    VkDeviceSize resident_bytes;
+    VkDeviceSize budget_bytes;  // effective, last planning round
+} TextureStreamerStats;
+
+typedef struct TextureStreamer
+{
+    BindlessTextures*  bindless;
+    ResourceAllocator* allocator;
+    VkDevice           device;
+    VkQueue            queue;
+    VkDeviceSize       budget;  // configured
+
+    // feedback: one uint per bindless slot, UINT32_MAX = not sampled
+    Buffer   feedback;
+    Buffer   readback[TEXTURE_STREAM_MAX_FRAMES];
+    uint32_t frame_count;
+
+    pthread_t       thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t  work_cond;
+    bool            shutdown;
+
+    // guarded by mutex
+    StreamedTexture**   textures;  // stb_ds
+    TextureStreamBatch* done;      // stb_ds, waiting for update
+    bool                wake;      // new requests, feedback or loads to plan for
+    TextureStreamerStats stats;
+
+    // streamer thread only
+    VkCommandPool       cmd_pool;
+    VkSemaphore         timeline;
+    uint64_t            next_value;
+    TextureStreamBatch* in_flight;  // stb_ds
+
+    // owning thread only
+    uint64_t         frame;
+    TextureSlotMove* moves;  // stb_ds, last update's
+} TextureStreamer;
+
+// budget == 0 leaves only the VK_EXT_memory_budget cap. frame_count is the
+// number of frames in flight (readback buffers). queue is the graphics queue.
+bool texture_streamer_init(TextureStreamer* streamer, BindlessTextures* bindless, ResourceAllocator* allocator,
+                           VkDevice device, VkQueue queue, uint32_t queue_family, VkDeviceSize budget, uint32_t frame_count);
+
+// Stops the thread; the streamed images stay in their slots and go with the
+// BindlessTextures.
+void texture_streamer_destroy(TextureStreamer* streamer);
+
+// Reserves a slot pointing at the dummy and queues the load. srgb filters
+// RGBA8 mips in linear light. False when no slot is left. A file that fails
+// to load keeps the dummy. The handle goes stale with the first move
+// (texture_streamer_update); follow the moves from its slot.
+bool texture_streamer_request(TextureStreamer* streamer, const char* path, bool srgb, TextureHandle* out_handle);
+
+// After the frame's fence wait: reads frame's feedback (written frame_count
+// frames ago), updates wanted levels and installs finished rebuilds. Returns
+// the slot moves of the installs in *out_moves (valid until the next call);
+// the frame recorded next must sample `to` wherever it sampled `from`.
+uint32_t texture_streamer_update(TextureStreamer* streamer, uint32_t frame, const TextureSlotMove** out_moves);
+
+// After the last pass that samples streamed textures: copies the feedback to
+// frame's readback buffer and clears it for the next frame.
+void texture_streamer_cmd_feedback(TextureStreamer* streamer, VkCommandBuffer cmd, uint32_t frame);
+
+// "streaming: N textures, X / Y MB resident, N levels raised, N evicted, N batches"
+void texture_streamer_print_stats(TextureStreamer* streamer);
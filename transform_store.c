@@ -0,0 +1,426 @@
+#include "transform_store.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TRANSFORM_STORE_X86 1
+#endif
+
+#define TRANSFORM_FLOAT_FIELDS 8u
+#define TRANSFORM_UINT_FIELDS 4u
+
+static int g_isa = -1;  // active ISA, resolved on first use
+
+// ------------------------------------------------------------
+// Init / edit
+// ------------------------------------------------------------
+
+bool transform_store_init(TransformStore* store, uint32_t capacity)
+{
+    memset(store, 0, sizeof(*store));
+
+    capacity = (MAX(capacity, 1u) + 63u) & ~63u;
+
+    size_t lane  = (size_t)capacity * sizeof(float);
+    size_t bytes = lane * (TRANSFORM_FLOAT_FIELDS + TRANSFORM_UINT_FIELDS) + capacity / 8u;
+
+    void* block = NULL;
+    if(posix_memalign(&block, 64, bytes) != 0)
+        return false;
+    memset(block, 0, bytes);
+
+    uint8_t* p = (uint8_t*)block;
+
+    store->px            = (float*)(p + lane * 0);
+    store->py            = (float*)(p + lane * 1);
+    store->pz            = (float*)(p + lane * 2);
+    store->scale         = (float*)(p + lane * 3);
+    store->qx            = (float*)(p + lane * 4);
+    store->qy            = (float*)(p + lane * 5);
+    store->qz            = (float*)(p + lane * 6);
+    store->qw            = (float*)(p + lane * 7);
+    store->meshIndex     = (uint32_t*)(p + lane * 8);
+    store->postPass      = (uint32_t*)(p + lane * 9);
+    store->materialIndex = (uint32_t*)(p + lane * 10);
+    store->objectId      = (uint32_t*)(p + lane * 11);
+    store->dirty         = (uint64_t*)(p + lane * 12);
+
+    store->capacity = capacity;
+    store->block    = block;
+    return true;
+}
+
+void transform_store_destroy(TransformStore* store)
+{
+    free(store->block);
+    memset(store, 0, sizeof(*store));
+}
+
+static void store_write(TransformStore* s, uint32_t i, const float* position, const float* rotation, float scale)
+{
+    s->px[i]    = position[0];
+    s->py[i]    = position[1];
+    s->pz[i]    = position[2];
+    s->scale[i] = scale;
+    s->qx[i]    = rotation[0];
+    s->qy[i]    = rotation[1];
+    s->qz[i]    = rotation[2];
+    s->qw[i]    = rotation[3];
+    transform_store_mark_dirty(s, i);
+}
+
+uint32_t transform_store_push(TransformStore* store, const vec3 position, const versor rotation, float scale,
+                              uint32_t meshIndex, uint32_t postPass, uint32_t materialIndex)
+{
+    if(store->count >= store->capacity)
+        return UINT32_MAX;
+
+    uint32_t i = store->count++;
+    store->objectId[i]      = 0;
+    store->meshIndex[i]     = meshIndex;
+    store->postPass[i]      = postPass;
+    store->materialIndex[i] = materialIndex;
+    store_write(store, i, position, rotation, scale);
+    return i;
+}
+
+bool transform_store_from_draws(TransformStore* store, const MeshDraw* draws, uint32_t count)
+{
+    if(count > store->capacity)
+        return false;
+
+    memset(store->dirty, 0, store->capacity / 8u);
+    store->count = 0;
+
+    for(uint32_t i = 0; i < count; i++)
+        transform_store_push(store, draws[i].position, draws[i].orientation, draws[i].scale, draws[i].meshIndex,
+                             draws[i].postPass, draws[i].materialIndex);
+    return true;
+}
+
+void transform_store_set(TransformStore* store, uint32_t index, const vec3 position, const versor rotation, float scale)
+{
+    if(index < store->count)
+        store_write(store, index, position, rotation, scale);
+}
+
+bool transform_store_from_objects(TransformStore* store, const Scene* scene)
+{
+    uint32_t count      = (uint32_t)arrlen(scene->objects);
+    uint32_t draw_count = (uint32_t)arrlen(scene->draws);
+    if(count > store->capacity)
+        return false;
+
+    memset(store->dirty, 0, store->capacity / 8u);
+    store->count = 0;
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        const SceneObject* o        = &scene->objects[i];
+        uint32_t           postPass = o->templateIndex < draw_count ? scene->draws[o->templateIndex].postPass : 0u;
+
+        uint32_t e = transform_store_push(store, o->position, o->rotation, o->scale, o->meshIndex, postPass, o->materialIndex);
+        store->objectId[e] = o->id;
+    }
+    return true;
+}
+
+uint32_t transform_store_object_entry(const TransformStore* store, Scene* scene, uint32_t objectId)
+{
+    // the slot map resolves (and generation-checks) the handle to its dense
+    // index, which is the entry while the store mirrors scene->objects
+    SceneObject* obj = scene_object_get(scene, objectId);
+    if(!obj)
+        return UINT32_MAX;
+
+    uint32_t e = (uint32_t)(obj - scene->objects);
+    return (e < store->count && store->objectId[e] == objectId) ? e : UINT32_MAX;
+}
+
+bool transform_store_set_object(TransformStore* store, Scene* scene, uint32_t objectId, const vec3 position,
+                                const versor rotation, float scale)
+{
+    uint32_t e = transform_store_object_entry(store, scene, objectId);
+    if(e == UINT32_MAX)
+        return false;
+
+    scene_object_set_transform(scene, objectId, position, rotation, scale);
+    store_write(store, e, position, rotation, scale);
+    return true;
+}
+
+bool transform_store_remove_object(TransformStore* store, Scene* scene, uint32_t objectId)
+{
+    uint32_t e = transform_store_object_entry(store, scene, objectId);
+    if(e == UINT32_MAX || !scene_object_remove(scene, objectId))
+        return false;
+
+    // same swap-remove as scene_object_remove
+    uint32_t last = --store->count;
+    if(e != last)
+    {
+        store->meshIndex[e]     = store->meshIndex[last];
+        store->postPass[e]      = store->postPass[last];
+        store->materialIndex[e] = store->materialIndex[last];
+        store->objectId[e]      = store->objectId[last];
+
+        const float position[3] = {store->px[last], store->py[last], store->pz[last]};
+        const float rotation[4] = {store->qx[last], store->qy[last], store->qz[last], store->qw[last]};
+        store_write(store, e, position, rotation, store->scale[last]);
+    }
+    store->dirty[last >> 6] &= ~(1ull << (last & 63u));
+    store->objectId[last] = 0;
+    return true;
+}
+
+void transform_store_mark_all_dirty(TransformStore* store)
+{
+    uint32_t full = store->count / 64u;
+    uint32_t tail = store->count & 63u;
+
+    memset(store->dirty, 0xff, (size_t)full * sizeof(uint64_t));
+    if(tail)
+        store->dirty[full] = (1ull << tail) - 1ull;
+}
+
+// ------------------------------------------------------------
+// Flush
+// ------------------------------------------------------------
+
+// The writers convert entries i.. into out[0..]
+static void write_scalar(const TransformStore* s, uint32_t i, MeshDrawGpu* out)
+{
+    MeshDrawGpu* d = out;
+
+    d->position_scale[0] = s->px[i];
+    d->position_scale[1] = s->py[i];
+    d->position_scale[2] = s->pz[i];
+    d->position_scale[3] = s->scale[i];
+    d->orientation[0]    = s->qx[i];
+    d->orientation[1]    = s->qy[i];
+    d->orientation[2]    = s->qz[i];
+    d->orientation[3]    = s->qw[i];
+    d->meshIndex         = s->meshIndex[i];
+    d->postPass          = s->postPass[i];
+    d->materialIndex     = s->materialIndex[i];
+    d->pad               = 0;
+}
+
+#ifdef TRANSFORM_STORE_X86
+
+// Four entries: three 4x4 transposes (position+scale, rotation, meta), stored
+// in entry order so a write-combined destination sees sequential 16-byte writes.
+static void write_sse4(const TransformStore* s, uint32_t i, MeshDrawGpu* out)
+{
+    __m128 a0 = _mm_load_ps(s->px + i), a1 = _mm_load_ps(s->py + i);
+    __m128 a2 = _mm_load_ps(s->pz + i), a3 = _mm_load_ps(s->scale + i);
+    __m128 b0 = _mm_load_ps(s->qx + i), b1 = _mm_load_ps(s->qy + i);
+    __m128 b2 = _mm_load_ps(s->qz + i), b3 = _mm_load_ps(s->qw + i);
+    __m128 c0 = _mm_load_ps((const float*)(s->meshIndex + i));
+    __m128 c1 = _mm_load_ps((const float*)(s->postPass + i));
+    __m128 c2 = _mm_load_ps((const float*)(s->materialIndex + i));
+    __m128 c3 = _mm_setzero_ps();
+
+    _MM_TRANSPOSE4_PS(a0, a1, a2, a3);
+    _MM_TRANSPOSE4_PS(b0, b1, b2, b3);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+    float* d = (float*)out;
+    _mm_storeu_ps(d + 0, a0);
+    _mm_storeu_ps(d + 4, b0);
+    _mm_storeu_ps(d + 8, c0);
+    _mm_storeu_ps(d + 12, a1);
+    _mm_storeu_ps(d + 16, b1);
+    _mm_storeu_ps(d + 20, c1);
+    _mm_storeu_ps(d + 24, a2);
+    _mm_storeu_ps(d + 28, b2);
+    _mm_storeu_ps(d + 32, c2);
+    _mm_storeu_ps(d + 36, a3);
+    _mm_storeu_ps(d + 40, b3);
+    _mm_storeu_ps(d + 44, c3);
+}
+
+// In-lane 4x4 transpose of eight entries: the low 128 bits end up holding
+// entries 0..3, the high 128 bits entries 4..7.
+__attribute__((target("avx"))) static inline void transpose8(__m256* r0, __m256* r1, __m256* r2, __m256* r3)
+{
+    __m256 t0 = _mm256_unpacklo_ps(*r0, *r1);
+    __m256 t1 = _mm256_unpackhi_ps(*r0, *r1);
+    __m256 t2 = _mm256_unpacklo_ps(*r2, *r3);
+    __m256 t3 = _mm256_unpackhi_ps(*r2, *r3);
+
+    *r0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    *r1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    *r2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    *r3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+__attribute__((target("avx"))) static void write_avx8(const TransformStore* s, uint32_t i, MeshDrawGpu* out)
+{
+    __m256 a[4] = {_mm256_load_ps(s->px + i), _mm256_load_ps(s->py + i), _mm256_load_ps(s->pz + i),
+                   _mm256_load_ps(s->scale + i)};
+    __m256 b[4] = {_mm256_load_ps(s->qx + i), _mm256_load_ps(s->qy + i), _mm256_load_ps(s->qz + i),
+                   _mm256_load_ps(s->qw + i)};
+    __m256 c[4] = {_mm256_load_ps((const float*)(s->meshIndex + i)), _mm256_load_ps((const float*)(s->postPass + i)),
+                   _mm256_load_ps((const float*)(s->materialIndex + i)), _mm256_setzero_ps()};
+
+    transpose8(&a[0], &a[1], &a[2], &a[3]);
+    transpose8(&b[0], &b[1], &b[2], &b[3]);
+    transpose8(&c[0], &c[1], &c[2], &c[3]);
+
+    float* d = (float*)out;
+    for(int e = 0; e < 4; e++)
+    {
+        _mm_storeu_ps(d + e * 12 + 0, _mm256_castps256_ps128(a[e]));
+        _mm_storeu_ps(d + e * 12 + 4, _mm256_castps256_ps128(b[e]));
+        _mm_storeu_ps(d + e * 12 + 8, _mm256_castps256_ps128(c[e]));
+    }
+    for(int e = 0; e < 4; e++)
+    {
+        _mm_storeu_ps(d + 48 + e * 12 + 0, _mm256_extractf128_ps(a[e], 1));
+        _mm_storeu_ps(d + 48 + e * 12 + 4, _mm256_extractf128_ps(b[e], 1));
+        _mm_storeu_ps(d + 48 + e * 12 + 8, _mm256_extractf128_ps(c[e], 1));
+    }
+}
+
+#endif
+
+static TransformStoreIsa detect_isa(void)
+{
+#ifdef TRANSFORM_STORE_X86
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx") ? TRANSFORM_ISA_AVX : TRANSFORM_ISA_SSE;
+#else
+    return TRANSFORM_ISA_SCALAR;
+#endif
+}
+
+TransformStoreIsa transform_store_isa(void)
+{
+    if(g_isa < 0)
+        g_isa = (int)detect_isa();
+    return (TransformStoreIsa)g_isa;
+}
+
+TransformStoreIsa transform_store_set_isa(TransformStoreIsa isa)
+{
+    g_isa = (int)MIN(isa, detect_isa());
+    return (TransformStoreIsa)g_isa;
+}
+
+uint32_t transform_store_flush(TransformStore* store, MeshDrawGpu* dst)
+{
+    return transform_store_flush_range(store, 0, store->count, dst);
+}
+
+uint32_t transform_store_flush_range(TransformStore* store, uint32_t first, uint32_t count, MeshDrawGpu* dst)
+{
+    TransformStoreIsa isa     = transform_store_isa();
+    uint32_t          written = 0;
+    uint32_t          end     = MIN(first + count, store->count);
+    if(first >= end)
+        return 0;
+
+    uint32_t first_word = first / 64u;
+    uint32_t last_word  = (end - 1u) / 64u;
+
+    for(uint32_t w = first_word; w <= last_word; w++)
+    {
+        uint64_t mask = ~0ull;
+        if(w == first_word)
+            mask &= ~0ull << (first & 63u);
+        if(w == last_word && (end & 63u))
+            mask &= (1ull << (end & 63u)) - 1ull;
+
+        uint64_t bits = store->dirty[w] & mask;
+        if(!bits)
+            continue;
+
+        store->dirty[w] &= ~bits;
+        uint32_t base = w * 64u;
+
+        // aligned runs of 8 / 4 dirty entries take the SIMD path, the rest go one by one
+        while(bits)
+        {
+            uint32_t bit = (uint32_t)__builtin_ctzll(bits);
+            uint32_t i   = base + bit;
+
+#ifdef TRANSFORM_STORE_X86
+            if(isa >= TRANSFORM_ISA_AVX && (bit & 7u) == 0 && ((bits >> bit) & 0xffu) == 0xffu)
+            {
+                write_avx8(store, i, dst + (i - first));
+                bits &= ~(0xffull << bit);
+                written += 8;
+                continue;
+            }
+            if(isa >= TRANSFORM_ISA_SSE && (bit & 3u) == 0 && ((bits >> bit) & 0xfu) == 0xfu)
+            {
+                write_sse4(store, i, dst + (i - first));
+                bits &= ~(0xfull << bit);
+                written += 4;
+                continue;
+            }
+#else
+            (void)isa;
+#endif
+
+            write_scalar(store, i, dst + (i - first));
+            bits &= bits - 1ull;
+            written++;
+        }
+    }
+
+    return written;
+}
+
+static void mark_range_dirty(TransformStore* store, uint32_t first, uint32_t end)
+{
+    for(uint32_t i = first; i < end; i++)
+        transform_store_mark_dirty(store, i);
+}
+
+uint32_t transform_store_dirty_ranges(TransformStore* store, TransformRange* ranges, uint32_t max_ranges)
+{
+    uint32_t count = 0;
+    uint32_t words = (store->count + 63u) / 64u;
+    if(max_ranges == 0)
+        return 0;
+
+    for(uint32_t w = 0; w < words; w++)
+    {
+        uint64_t bits = store->dirty[w];
+        uint32_t base = w * 64u;
+
+        while(bits)
+        {
+            // next run of set bits within the word
+            uint32_t start = (uint32_t)__builtin_ctzll(bits);
+            uint64_t rest  = ~bits & (~0ull << start);
+            uint32_t stop  = rest ? (uint32_t)__builtin_ctzll(rest) : 64u;
+            bits &= (stop < 64u) ? ~0ull << stop : 0ull;
+
+            uint32_t first = base + start;
+            uint32_t end   = base + stop;
+
+            TransformRange* last = count ? &ranges[count - 1] : NULL;
+            if(last && last->first + last->count == first)
+            {
+                last->count = end - last->first;  // continues across a word boundary
+            }
+            else if(count == max_ranges)
+            {
+                // out of ranges: widen the last one over the gap
+                mark_range_dirty(store, last->first + last->count, first);
+                last->count = end - last->first;
+            }
+            else
+            {
+                ranges[count++] = (TransformRange){first, end - first};
+            }
+        }
+    }
+
+    return count;
+}
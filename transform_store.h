@@ -0,0 +1,118 @@
+#pragma once
+
+#include "scene.h"
+
+// GPU draw record, matches MeshDraw in cull.comp / meshlet_cull.comp (48 bytes).
+typedef struct MeshDrawGpu
+{
+    float    position_scale[4];
+    float    orientation[4];
+    uint32_t meshIndex;
+    uint32_t postPass;
+    uint32_t materialIndex;
+    uint32_t pad;
+} MeshDrawGpu;
+
+// Structure-of-arrays transforms with a dirty bitset. Writers touch the SoA
+// arrays (directly or through transform_store_set) and mark entries dirty;
+// transform_store_flush() then converts only the dirty entries into
+// MeshDrawGpu records. Frames in flight still read the GPU copy, so test.c
+// flushes the dirty runs (transform_store_dirty_ranges) into per-frame staging
+// and copies them into a device-local draws buffer.
+//
+// Entry i is written to dst[i], so the store index is the GPU draw index.
+// Arrays are 32-byte aligned and padded to a multiple of 64 entries.
+//
+// Built with transform_store_from_objects the store mirrors Scene.objects:
+// entry i is the object at dense index i and remembers its handle, so objects
+// are addressed by SceneObject handle through the scene's slot map. Create
+// objects before building; removals go through transform_store_remove_object,
+// which repeats the slot map's swap-remove (the last entry's draw index moves).
+
+typedef enum TransformStoreIsa
+{
+    TRANSFORM_ISA_SCALAR = 0,
+    TRANSFORM_ISA_SSE,  // 4 entries per block
+    TRANSFORM_ISA_AVX,  // 8 entries per block
+} TransformStoreIsa;
+
+typedef struct TransformStore
+{
+    float* px;
+    float* py;
+    float* pz;
+    float* scale;
+    float* qx;
+    float* qy;
+    float* qz;
+    float* qw;
+
+    uint32_t* meshIndex;
+    uint32_t* postPass;
+    uint32_t* materialIndex;
+    uint32_t* objectId;  // SceneObject handle, 0 for entries pushed directly
+
+    uint64_t* dirty;  // one bit per entry
+
+    uint32_t count;
+    uint32_t capacity;
+
+    void* block;  // single allocation backing every array above
+} TransformStore;
+
+bool transform_store_init(TransformStore* store, uint32_t capacity);
+void transform_store_destroy(TransformStore* store);
+
+// Appends one entry (marked dirty). Returns its index, or UINT32_MAX when full.
+uint32_t transform_store_push(TransformStore* store, const vec3 position, const versor rotation, float scale,
+                              uint32_t meshIndex, uint32_t postPass, uint32_t materialIndex);
+
+// Resets the store to draws[0..count); every entry is dirty afterwards.
+bool transform_store_from_draws(TransformStore* store, const MeshDraw* draws, uint32_t count);
+
+void transform_store_set(TransformStore* store, uint32_t index, const vec3 position, const versor rotation, float scale);
+
+// Resets the store to scene->objects in dense order; postPass comes from the
+// object's template draw. Every entry is dirty afterwards.
+bool transform_store_from_objects(TransformStore* store, const Scene* scene);
+
+// Entry of a live object handle, or UINT32_MAX (stale handle, or not in the store). O(1).
+uint32_t transform_store_object_entry(const TransformStore* store, Scene* scene, uint32_t objectId);
+
+// Sets the SceneObject and its entry together.
+bool transform_store_set_object(TransformStore* store, Scene* scene, uint32_t objectId, const vec3 position,
+                                const versor rotation, float scale);
+
+// Removes the object from the scene and the store. The last entry moves into
+// the freed one (marked dirty); count shrinks by one.
+bool transform_store_remove_object(TransformStore* store, Scene* scene, uint32_t objectId);
+
+static inline void transform_store_mark_dirty(TransformStore* store, uint32_t index)
+{
+    store->dirty[index >> 6] |= 1ull << (index & 63u);
+}
+
+void transform_store_mark_all_dirty(TransformStore* store);
+
+typedef struct TransformRange
+{
+    uint32_t first;
+    uint32_t count;
+} TransformRange;
+
+// Writes every dirty entry i to dst[i] and clears the dirty bits.
+// Returns the number of entries written.
+uint32_t transform_store_flush(TransformStore* store, MeshDrawGpu* dst);
+
+// Same for the dirty entries in [first, first + count), written to dst[i - first].
+uint32_t transform_store_flush_range(TransformStore* store, uint32_t first, uint32_t count, MeshDrawGpu* dst);
+
+// The dirty entries as runs, in index order. When there are more runs than
+// max_ranges, the last range is widened over the gaps and the entries in them
+// are marked dirty, so every entry of every range is dirty afterwards. Flushing
+// each range packed into staging gives one copy region per range.
+uint32_t transform_store_dirty_ranges(TransformStore* store, TransformRange* ranges, uint32_t max_ranges);
+
+// Best ISA the CPU supports unless lowered with transform_store_set_isa (benchmarks).
+TransformStoreIsa transform_store_isa(void);
+TransformStoreIsa transform_store_set_isa(TransformStoreIsa isa);
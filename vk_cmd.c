@@ -1,6 +1,7 @@
 
 #include "vk_cmd.h"
 #include "render_object.h"
+#include "vk_queue.h"
 #include <string.h>
 
 static VkCommandBufferLevel vk_cmd_level(bool primary)
@@ -93,7 +94,9 @@ void vk_cmd_submit_once(VkDevice device, VkQueue queue, VkCommandBuffer cmd)
     VkFence fence = VK_NULL_HANDLE;
 
     VK_CHECK(vkCreateFence(device, &fc, NULL, &fence));
+    vk_queue_lock();
     VK_CHECK(vkQueueSubmit(queue, 1, &submit, fence));
+    vk_queue_unlock();
     VK_CHECK(vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX));
 
     vkDestroyFence(device, fence, NULL);
@@ -125,8 +128,10 @@ void end_one_time_cmd(VkDevice device, VkQueue queue, VkCommandPool pool, VkComm
         .pCommandBufferInfos    = &cmdInfo,
     };
 
+    vk_queue_lock();
     VK_CHECK(vkQueueSubmit2(queue, 1, &submit, VK_NULL_HANDLE));
     VK_CHECK(vkQueueWaitIdle(queue));
+    vk_queue_unlock();
 
     vkFreeCommandBuffers(device, pool, 1, &cmd);
 }
@@ -12,6 +12,37 @@ uint32_t hash32_bytes(const void* data, size_t size);
 uint64_t hash64_bytes(const void* data, size_t size);
 size_t c99_strnlen(const char* s, size_t maxlen);
 
+// Monotonic clock, used for load/bench timings.
+uint64_t time_now_ns(void);
+static inline double time_ns_to_ms(uint64_t ns)
+{
+    return (double)ns * 1e-6;
+}
+
+// Open-addressing index from 64-bit key hashes to positions in a separate
+// entry array (the caches keep their stretchy buffers). Linear probing over a
+// power of two slot count, kept at most 3/4 full; insert only.
+typedef struct HashIndexSlot
+{
+    uint64_t hash;
+    uint32_t index;  // entry + 1, 0 = empty
+} HashIndexSlot;
+
+typedef struct HashIndex
+{
+    HashIndexSlot* slots;
+    uint32_t       capacity;
+    uint32_t       count;
+} HashIndex;
+
+#define HASH_INDEX_NONE UINT32_MAX
+
+// Next entry whose key hash equals hash, HASH_INDEX_NONE when there is none
+// left. *probe starts at 0; callers compare the full key of each candidate.
+uint32_t hash_index_next(const HashIndex* index, uint64_t hash, uint32_t* probe);
+void     hash_index_insert(HashIndex* index, uint64_t hash, uint32_t entry);
+void     hash_index_free(HashIndex* index);
+
 
 #define VK_IMAGE_VIEW_DEFAULT(img, fmt)                                                                          \
     (VkImageViewCreateInfo)                                                                                            \
@@ -103,6 +103,7 @@ void descriptor_layout_cache_destroy(DescriptorLayoutCache* cache)
         vkDestroyDescriptorSetLayout(cache->device, cache->entries[i].layout, NULL);
 
     arrfree(cache->entries);
+    hash_index_free(&cache->index);
     *cache = (DescriptorLayoutCache){0};
 }
 
@@ -147,7 +148,8 @@ VkDescriptorSetLayout descriptor_layout_cache_get(DescriptorLayoutCache* cache,
 
     key.hash = hash_layout_key(&key);
 
-    for(int i = 0; i < arrlen(cache->entries); i++)
+    uint32_t probe = 0;
+    for(uint32_t i; (i = hash_index_next(&cache->index, key.hash, &probe)) != HASH_INDEX_NONE;)
     {
         if(layout_key_equals(&cache->entries[i].key, &key))
             return cache->entries[i].layout;
@@ -160,6 +162,7 @@ VkDescriptorSetLayout descriptor_layout_cache_get(DescriptorLayoutCache* cache,
         .key    = key,
         .layout = layout,
     };
+    hash_index_insert(&cache->index, key.hash, (uint32_t)arrlen(cache->entries));
     arrpush(cache->entries, entry);
 
     return layout;
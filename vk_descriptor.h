@@ -37,6 +37,7 @@ typedef struct DescriptorLayoutCache
 {
     VkDevice               device;
     DescriptorLayoutEntry* entries;  // stretchy buffer
+    HashIndex              index;    // key.hash -> entries
 } DescriptorLayoutCache;
 
 // layout cache API
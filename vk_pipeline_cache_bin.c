@@ -0,0 +1,542 @@
+#include "vk_pipeline_cache_bin.h"
+
+#include <sched.h>
+
+// ------------------------------------------------------------
+// LZ codec
+// ------------------------------------------------------------
+
+// Byte-oriented LZ77 in the LZ4 block layout: a token with a literal length
+// (high nibble) and match length - 4 (low nibble), 15 meaning more length
+// bytes follow (255 = keep going), the literals, then a 16-bit little endian
+// offset. The last sequence stops after its literals. Driver cache blobs are
+// mostly headers, padding and repeated instruction patterns, which this gets
+// for a fraction of the save time.
+
+#define LZ_MIN_MATCH 4u
+#define LZ_HASH_BITS 14u
+#define LZ_MAX_OFFSET 0xFFFFu
+
+static uint32_t lz_read32(const uint8_t* p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint32_t lz_hash(uint32_t v)
+{
+    return (v * 2654435761u) >> (32u - LZ_HASH_BITS);
+}
+
+static uint8_t* lz_put_length(uint8_t* op, const uint8_t* oend, size_t len)
+{
+    for(; len >= 255; len -= 255)
+    {
+        if(op >= oend)
+            return NULL;
+        *op++ = 255;
+    }
+    if(op >= oend)
+        return NULL;
+    *op++ = (uint8_t)len;
+    return op;
+}
+
+static uint8_t* lz_put_sequence(uint8_t* op, const uint8_t* oend, const uint8_t* lit, size_t lit_len, size_t offset, size_t match_len)
+{
+    if(op >= oend)
+        return NULL;
+
+    uint8_t* token = op++;
+    *token         = (uint8_t)(MIN(lit_len, (size_t)15) << 4);
+    if(lit_len >= 15 && !(op = lz_put_length(op, oend, lit_len - 15)))
+        return NULL;
+
+    if(lit_len > (size_t)(oend - op))
+        return NULL;
+    memcpy(op, lit, lit_len);
+    op += lit_len;
+
+    if(match_len == 0)
+        return op;
+
+    if(oend - op < 2)
+        return NULL;
+    op[0] = (uint8_t)(offset & 0xFF);
+    op[1] = (uint8_t)(offset >> 8);
+    op += 2;
+
+    size_t ml = match_len - LZ_MIN_MATCH;
+    *token |= (uint8_t)MIN(ml, (size_t)15);
+    if(ml >= 15 && !(op = lz_put_length(op, oend, ml - 15)))
+        return NULL;
+    return op;
+}
+
+// Returns the compressed size, 0 if it would not fit in cap.
+static size_t lz_compress(const uint8_t* src, size_t size, uint8_t* dst, size_t cap)
+{
+    uint32_t* table = (uint32_t*)calloc(1u << LZ_HASH_BITS, sizeof(uint32_t));  // position + 1
+    if(!table)
+        return 0;
+
+    const uint8_t* ip     = src;
+    const uint8_t* anchor = src;
+    const uint8_t* end    = src + size;
+    uint8_t*       op     = dst;
+    const uint8_t* oend   = dst + cap;
+
+    while(op && end - ip >= (ptrdiff_t)LZ_MIN_MATCH)
+    {
+        uint32_t seq  = lz_read32(ip);
+        uint32_t h    = lz_hash(seq);
+        uint32_t cand = table[h];
+        table[h]      = (uint32_t)(ip - src) + 1u;
+
+        const uint8_t* ref = src + cand - 1u;
+        if(cand == 0 || (size_t)(ip - ref) > LZ_MAX_OFFSET || lz_read32(ref) != seq)
+        {
+            ip++;
+            continue;
+        }
+
+        size_t len = LZ_MIN_MATCH;
+        while(ip + len < end && ref[len] == ip[len])
+            len++;
+
+        op     = lz_put_sequence(op, oend, anchor, (size_t)(ip - anchor), (size_t)(ip - ref), len);
+        ip     = ip + len;
+        anchor = ip;
+    }
+
+    if(op)
+        op = lz_put_sequence(op, oend, anchor, (size_t)(end - anchor), 0, 0);
+
+    free(table);
+    return op ? (size_t)(op - dst) : 0;
+}
+
+// Bounds-checked; false unless src decodes to exactly size bytes.
+static bool lz_decompress(const uint8_t* src, size_t src_size, uint8_t* dst, size_t size)
+{
+    const uint8_t* ip   = src;
+    const uint8_t* iend = src + src_size;
+    uint8_t*       op   = dst;
+    uint8_t*       oend = dst + size;
+
+    while(ip < iend)
+    {
+        uint8_t token = *ip++;
+
+        size_t lit = token >> 4;
+        if(lit == 15)
+        {
+            uint8_t b;
+            do
+            {
+                if(ip >= iend)
+                    return false;
+                b = *ip++;
+                lit += b;
+            } while(b == 255);
+        }
+        if(lit > (size_t)(iend - ip) || lit > (size_t)(oend - op))
+            return false;
+        memcpy(op, ip, lit);
+        ip += lit;
+        op += lit;
+
+        if(ip == iend)
+            break;
+
+        if(iend - ip < 2)
+            return false;
+        size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        if(offset == 0 || offset > (size_t)(op - dst))
+            return false;
+
+        size_t len = token & 15u;
+        if(len == 15)
+        {
+            uint8_t b;
+            do
+            {
+                if(ip >= iend)
+                    return false;
+                b = *ip++;
+                len += b;
+            } while(b == 255);
+        }
+        len += LZ_MIN_MATCH;
+        if(len > (size_t)(oend - op))
+            return false;
+
+        // may overlap (offset < len repeats the tail)
+        const uint8_t* ref = op - offset;
+        for(size_t i = 0; i < len; i++)
+            op[i] = ref[i];
+        op += len;
+    }
+
+    return op == oend;
+}
+
+// ------------------------------------------------------------
+// File
+// ------------------------------------------------------------
+
+static int write_all(FILE* f, const void* data, size_t size)
+{
+    return fwrite(data, 1, size, f) == size;
+}
+
+static int read_all(FILE* f, void* data, size_t size)
+{
+    return fread(data, 1, size, f) == size;
+}
+
+static void get_device_props(VkPhysicalDevice phys, VkPhysicalDeviceProperties* out)
+{
+    vkGetPhysicalDeviceProperties(phys, out);
+}
+
+static int validate_header(const PipelineCachePrefixHeader* h, const VkPhysicalDeviceProperties* props)
+{
+    if(h->magic != PIPELINE_CACHE_MAGIC)
+        return 0;
+    if(h->version != PIPELINE_CACHE_VERSION)
+        return 0;
+    if(h->compressedSize == 0 || h->compressedSize > h->dataSize)
+        return 0;
+    if(h->driverABI != sizeof(void*))
+        return 0;
+    if(h->vendorID != props->vendorID)
+        return 0;
+    if(h->deviceID != props->deviceID)
+        return 0;
+    if(h->driverVersion != props->driverVersion)
+        return 0;
+    if(memcmp(h->uuid, props->pipelineCacheUUID, VK_UUID_SIZE) != 0)
+        return 0;
+    return 1;
+}
+
+// The validated, decompressed blob or NULL.
+static void* pipeline_cache_read_blob(VkPhysicalDevice phys, const char* path, size_t* out_size, size_t* out_file_size)
+{
+    FILE* f = fopen(path, "rb");
+    if(!f)
+        return NULL;
+
+    VkPhysicalDeviceProperties props;
+    get_device_props(phys, &props);
+
+    PipelineCachePrefixHeader hdr;
+    void*                     packed = NULL;
+    void*                     blob   = NULL;
+    bool                      ok     = read_all(f, &hdr, sizeof(hdr)) && validate_header(&hdr, &props);
+
+    if(ok)
+    {
+        packed = malloc(hdr.compressedSize);
+        blob   = (hdr.compressedSize == hdr.dataSize) ? packed : malloc(hdr.dataSize);
+        ok     = packed && blob && read_all(f, packed, hdr.compressedSize);
+    }
+    fclose(f);
+
+    if(ok && packed != blob)
+        ok = lz_decompress((const uint8_t*)packed, hdr.compressedSize, (uint8_t*)blob, hdr.dataSize);
+    ok = ok && hash64_bytes(blob, hdr.dataSize) == hdr.dataHash;
+
+    if(packed != blob)
+        free(packed);
+    if(!ok)
+    {
+        log_warn("pipeline cache: ignoring '%s' (stale or corrupt)", path);
+        free(blob);
+        return NULL;
+    }
+
+    *out_size      = hdr.dataSize;
+    *out_file_size = sizeof(hdr) + hdr.compressedSize;
+    return blob;
+}
+
+VkPipelineCache pipeline_cache_load_or_create(VkDevice device, VkPhysicalDevice phys, const char* path, PipelineCacheStats* out_stats)
+{
+    VkPipelineCache cache     = VK_NULL_HANDLE;
+    size_t          size      = 0;
+    size_t          file_size = 0;
+    void*           blob      = path ? pipeline_cache_read_blob(phys, path, &size, &file_size) : NULL;
+
+    if(blob)
+    {
+        VkPipelineCacheCreateInfo ci = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO, .initialDataSize = size, .pInitialData = blob};
+
+        VkResult res = vkCreatePipelineCache(device, &ci, NULL, &cache);
+        free(blob);
+
+        if(res == VK_SUCCESS)
+        {
+            if(out_stats)
+            {
+                out_stats->loaded_bytes = size;
+                out_stats->file_bytes   = file_size;
+            }
+            return cache;
+        }
+        // sigh… drivers
+        log_warn("pipeline cache: driver rejected '%s' (%d)", path, (int)res);
+        cache = VK_NULL_HANDLE;
+    }
+
+    // file missing or unusable, build empty cache
+    VkPipelineCacheCreateInfo empty = {.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+    VK_CHECK(vkCreatePipelineCache(device, &empty, NULL, &cache));
+    return cache;
+}
+
+bool pipeline_cache_save(VkDevice device, VkPhysicalDevice phys, VkPipelineCache cache, const char* path, PipelineCacheStats* out_stats)
+{
+    size_t size = 0;
+    vkGetPipelineCacheData(device, cache, &size, NULL);
+    if(size == 0 || size > UINT32_MAX)
+        return false;
+
+    void*    blob   = malloc(size);
+    uint8_t* packed = (uint8_t*)malloc(size);
+    if(!blob || !packed || vkGetPipelineCacheData(device, cache, &size, blob) != VK_SUCCESS)
+    {
+        free(blob);
+        free(packed);
+        return false;
+    }
+
+    // stored raw when compression does not win
+    size_t      packed_size = lz_compress((const uint8_t*)blob, size, packed, size - 1);
+    const void* payload     = packed_size ? (const void*)packed : blob;
+    if(!packed_size)
+        packed_size = size;
+
+    VkPhysicalDeviceProperties props;
+    get_device_props(phys, &props);
+
+    PipelineCachePrefixHeader hdr = {.magic          = PIPELINE_CACHE_MAGIC,
+                                     .version        = PIPELINE_CACHE_VERSION,
+                                     .dataSize       = (uint32_t)size,
+                                     .compressedSize = (uint32_t)packed_size,
+                                     .dataHash       = hash64_bytes(blob, size),
+                                     .vendorID       = props.vendorID,
+                                     .deviceID       = props.deviceID,
+                                     .driverVersion  = props.driverVersion,
+                                     .driverABI      = sizeof(void*)};
+    memcpy(hdr.uuid, props.pipelineCacheUUID, VK_UUID_SIZE);
+
+    char tmp[1024];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+    FILE* f  = fopen(tmp, "wb");
+    bool  ok = f != NULL;
+    if(ok)
+    {
+        ok = write_all(f, &hdr, sizeof(hdr)) && write_all(f, payload, packed_size);
+        ok = (fclose(f) == 0) && ok;
+    }
+    ok = ok && rename(tmp, path) == 0;
+    if(!ok)
+    {
+        log_warn("pipeline cache: failed to write '%s'", path);
+        remove(tmp);
+    }
+    else if(out_stats)
+    {
+        out_stats->saved_bytes = size;
+        out_stats->file_bytes  = sizeof(hdr) + packed_size;
+    }
+
+    free(blob);
+    free(packed);
+    return ok;
+}
+
+// ------------------------------------------------------------
+// PipelineCacheFile
+// ------------------------------------------------------------
+
+void pipeline_cache_file_open(PipelineCacheFile* file,
+                              VkDevice           device,
+                              VkPhysicalDevice   phys,
+                              const char*        path,
+                              uint32_t           slot_count,
+                              uint32_t           save_every)
+{
+    *file = (PipelineCacheFile){
+        .device     = device,
+        .phys       = phys,
+        .path       = path ? strdup(path) : NULL,
+        .slot_count = MAX(slot_count, 1u),
+        .save_every = save_every,
+    };
+
+    file->cache = pipeline_cache_load_or_create(device, phys, path, &file->stats);
+    file->warm  = file->stats.loaded_bytes > 0;
+
+    // a pipeline only looks in the cache it is created with, so every thread
+    // cache starts from the loaded data; merging drops the duplicates again
+    size_t size = 0;
+    void*  seed = NULL;
+    if(file->warm && vkGetPipelineCacheData(device, file->cache, &size, NULL) == VK_SUCCESS && size > 0)
+    {
+        seed = malloc(size);
+        if(seed && vkGetPipelineCacheData(device, file->cache, &size, seed) != VK_SUCCESS)
+        {
+            free(seed);
+            seed = NULL;
+        }
+    }
+
+    file->slots = (PipelineCacheSlot*)calloc(file->slot_count, sizeof(PipelineCacheSlot));
+    for(uint32_t i = 0; i < file->slot_count; i++)
+    {
+        VkPipelineCacheCreateInfo ci = {
+            .sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+            .initialDataSize = seed ? size : 0,
+            .pInitialData    = seed,
+        };
+        VK_CHECK(vkCreatePipelineCache(device, &ci, NULL, &file->slots[i].cache));
+    }
+    free(seed);
+
+    if(path)
+    {
+        log_info("pipeline cache: %s '%s' (%zu bytes, %zu on disk), %u thread caches", file->warm ? "loaded" : "new", path,
+                 file->stats.loaded_bytes, file->stats.file_bytes, file->slot_count);
+    }
+}
+
+void pipeline_cache_file_close(PipelineCacheFile* file)
+{
+    if(!file || !file->device)
+        return;
+
+    if(file->path && __atomic_load_n(&file->since_save, __ATOMIC_RELAXED) > 0)
+        pipeline_cache_file_save(file);
+
+    for(uint32_t i = 0; i < file->slot_count; i++)
+        vkDestroyPipelineCache(file->device, file->slots[i].cache, NULL);
+    vkDestroyPipelineCache(file->device, file->cache, NULL);
+
+    free(file->slots);
+    free(file->path);
+    *file = (PipelineCacheFile){0};
+}
+
+static bool slot_try_acquire(PipelineCacheSlot* slot)
+{
+    uint32_t expected = 0;
+    return __atomic_compare_exchange_n(&slot->busy, &expected, 1u, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+VkPipelineCache pipeline_cache_file_acquire(PipelineCacheFile* file, uint32_t* out_slot)
+{
+    for(;;)
+    {
+        for(uint32_t i = 0; i < file->slot_count; i++)
+        {
+            if(slot_try_acquire(&file->slots[i]))
+            {
+                *out_slot = i;
+                return file->slots[i].cache;
+            }
+        }
+        sched_yield();
+    }
+}
+
+void pipeline_cache_file_release(PipelineCacheFile* file, uint32_t slot)
+{
+    __atomic_store_n(&file->slots[slot].busy, 0u, __ATOMIC_RELEASE);
+}
+
+void pipeline_cache_file_record(PipelineCacheFile* file, const VkPipelineCreationFeedback* feedback)
+{
+    PipelineCacheStats* s = &file->stats;
+
+    if(!(feedback->flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT))
+        __atomic_add_fetch(&s->no_feedback, 1, __ATOMIC_RELAXED);
+    else if(feedback->flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT)
+    {
+        __atomic_add_fetch(&s->hits, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&s->hit_ns, feedback->duration, __ATOMIC_RELAXED);
+    }
+    else
+    {
+        __atomic_add_fetch(&s->misses, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&s->miss_ns, feedback->duration, __ATOMIC_RELAXED);
+    }
+
+    __atomic_add_fetch(&file->since_save, 1, __ATOMIC_RELAXED);
+}
+
+bool pipeline_cache_file_save(PipelineCacheFile* file)
+{
+    if(!file->path)
+        return false;
+
+    // a slot busy compiling keeps its pipelines until the next save
+    VkPipelineCache sources[64];
+    uint32_t        held[64];
+    uint32_t        count = 0;
+    for(uint32_t i = 0; i < file->slot_count && count < 64; i++)
+    {
+        if(slot_try_acquire(&file->slots[i]))
+        {
+            held[count]    = i;
+            sources[count] = file->slots[i].cache;
+            count++;
+        }
+    }
+
+    if(count > 0)
+        VK_CHECK(vkMergePipelineCaches(file->device, file->cache, count, sources));
+    for(uint32_t i = 0; i < count; i++)
+        pipeline_cache_file_release(file, held[i]);
+
+    __atomic_store_n(&file->since_save, 0u, __ATOMIC_RELAXED);
+
+    uint64_t t0 = time_now_ns();
+    bool     ok = pipeline_cache_save(file->device, file->phys, file->cache, file->path, &file->stats);
+    if(ok)
+    {
+        file->stats.saves++;
+        log_info("pipeline cache: saved '%s' (%zu bytes, %zu on disk, %u thread caches merged) in %.2f ms", file->path,
+                 file->stats.saved_bytes, file->stats.file_bytes, count, time_ns_to_ms(time_now_ns() - t0));
+    }
+    return ok;
+}
+
+void pipeline_cache_file_update(PipelineCacheFile* file)
+{
+    if(file->path && file->save_every > 0 && __atomic_load_n(&file->since_save, __ATOMIC_RELAXED) >= file->save_every)
+        pipeline_cache_file_save(file);
+}
+
+void pipeline_cache_file_print_stats(const PipelineCacheFile* file)
+{
+    const PipelineCacheStats* s = &file->stats;
+
+    uint32_t hits    = __atomic_load_n(&s->hits, __ATOMIC_RELAXED);
+    uint32_t misses  = __atomic_load_n(&s->misses, __ATOMIC_RELAXED);
+    uint64_t hit_ns  = __atomic_load_n(&s->hit_ns, __ATOMIC_RELAXED);
+    uint64_t miss_ns = __atomic_load_n(&s->miss_ns, __ATOMIC_RELAXED);
+    uint32_t total   = hits + misses;
+
+    printf("pipeline cache (%s start): %u hits, %u misses (%.0f%% hit), %u without feedback\n", file->warm ? "warm" : "cold",
+           hits, misses, total ? 100.0 * hits / total : 0.0, __atomic_load_n(&s->no_feedback, __ATOMIC_RELAXED));
+    printf("  creation %.2f ms/hit, %.2f ms/miss; loaded %zu bytes, %u saves, last file %zu bytes (%.0f%% of %zu)\n",
+           hits ? time_ns_to_ms(hit_ns) / hits : 0.0, misses ? time_ns_to_ms(miss_ns) / misses : 0.0, s->loaded_bytes,
+           s->saves, s->file_bytes, s->saved_bytes ? 100.0 * s->file_bytes / s->saved_bytes : 100.0, s->saved_bytes);
+}
@@ -1,19 +1,37 @@
 #ifndef VK_PIPELINE_CACHE_H_
 #define VK_PIPELINE_CACHE_H_
 
-// Single-file Vulkan pipeline cache utility.
+// Persistent Vulkan pipeline cache.
 // Loads a pipeline cache from disk (safely), validates it,
 // and falls back to empty cache if anything smells wrong.
 //
+// File: PipelineCachePrefixHeader, then the vkGetPipelineCacheData blob,
+// LZ compressed unless that did not make it smaller (compressedSize ==
+// dataSize). dataHash covers the uncompressed blob. Saves go through a .tmp
+// file and rename(), so a crash mid-save leaves the previous file intact.
+//
+// PipelineCacheFile wraps one file for the renderer:
+//   - a shared cache for main thread creation, loaded at start-up
+//   - one cache per compiler thread (pipeline_cache_file_acquire), so workers
+//     never contend on one cache; saves merge them into the shared one with
+//     vkMergePipelineCaches
+//   - hit/miss counts from VkPipelineCreationFeedback (core in Vulkan 1.3,
+//     VK_EXT_pipeline_creation_feedback before)
+//   - a save every save_every new pipelines from pipeline_cache_file_update,
+//     and one at pipeline_cache_file_close for the rest
+//
 #ifndef PIPELINE_CACHE_MAGIC
 #define PIPELINE_CACHE_MAGIC 0xCAFEBABE
 #endif
+#define PIPELINE_CACHE_VERSION 2u
 
 #include "vk_defaults.h"
 typedef struct PipelineCachePrefixHeader
 {
     uint32_t magic;
+    uint32_t version;
     uint32_t dataSize;
+    uint32_t compressedSize;
     uint64_t dataHash;
 
     uint32_t vendorID;
@@ -24,150 +42,78 @@ typedef struct PipelineCachePrefixHeader
     uint8_t uuid[VK_UUID_SIZE];
 } PipelineCachePrefixHeader;
 
-// very boring but reliable hash (FNV-1a)
-
-
-static int write_all(FILE* f, const void* data, size_t size)
+typedef struct PipelineCacheStats
 {
-    return fwrite(data, 1, size, f) == size;
-}
-
-static int read_all(FILE* f, void* data, size_t size)
+    // from creation feedback, updated with __atomic builtins
+    uint32_t hits;         // APPLICATION_PIPELINE_CACHE_HIT_BIT set
+    uint32_t misses;       // valid feedback without the hit bit
+    uint32_t no_feedback;  // driver left VALID_BIT clear
+    uint64_t hit_ns;
+    uint64_t miss_ns;
+
+    // main thread only
+    uint32_t saves;
+    size_t   loaded_bytes;  // uncompressed blob handed to vkCreatePipelineCache
+    size_t   file_bytes;    // size on disk of the last load or save
+    size_t   saved_bytes;   // uncompressed blob of the last save
+} PipelineCacheStats;
+
+typedef struct PipelineCacheSlot
 {
-    return fread(data, 1, size, f) == size;
-}
+    VkPipelineCache cache;
+    uint32_t        busy;  // __atomic; owned by one thread while set
+} PipelineCacheSlot;
 
-static void get_device_props(VkPhysicalDevice phys, VkPhysicalDeviceProperties* out)
+typedef struct PipelineCacheFile
 {
-    vkGetPhysicalDeviceProperties(phys, out);
-}
+    VkDevice         device;
+    VkPhysicalDevice phys;
+    char*            path;  // NULL: in memory only, never saved
 
-static int validate_header(const PipelineCachePrefixHeader* h, const VkPhysicalDeviceProperties* props)
-{
-    if(h->magic != PIPELINE_CACHE_MAGIC)
-        return 0;
-    if(h->driverABI != sizeof(void*))
-        return 0;
-    if(h->vendorID != props->vendorID)
-        return 0;
-    if(h->deviceID != props->deviceID)
-        return 0;
-    if(h->driverVersion != props->driverVersion)
-        return 0;
-    if(memcmp(h->uuid, props->pipelineCacheUUID, VK_UUID_SIZE) != 0)
-        return 0;
-    return 1;
-}
-
-VkPipelineCache pipeline_cache_load_or_create(VkDevice device, VkPhysicalDevice phys, const char* path)
-{
-    VkPhysicalDeviceProperties props;
-    get_device_props(phys, &props);
-
-    VkPipelineCache cache = VK_NULL_HANDLE;
-
-    FILE* f = fopen(path, "rb");
-    if(!f)
-    {
-        // file missing, build empty cache
-        VkPipelineCacheCreateInfo ci = {.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
-        vkCreatePipelineCache(device, &ci, NULL, &cache);
-        return cache;
-    }
-
-    PipelineCachePrefixHeader hdr;
-    if(!read_all(f, &hdr, sizeof(hdr)))
-    {
-        fclose(f);
-        goto fallback;
-    }
-
-    if(!validate_header(&hdr, &props))
-    {
-        fclose(f);.
-        goto fallback;
-    }
-
-    void* blob = malloc(hdr.dataSize);
-    if(!blob)
-    {
-        fclose(f);
-        goto fallback;
-    }
-
-    if(!read_all(f, blob, hdr.dataSize))
-    {
-        free(blob);
-        fclose(f);
-        goto fallback;
-    }
-
-    fclose(f);
-
-    if(hash64_bytes(blob, hdr.dataSize) != hdr.dataHash)
-    {
-        free(blob);
-        goto fallback;
-    }
-
-    VkPipelineCacheCreateInfo ci = {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO, .initialDataSize = hdr.dataSize, .pInitialData = blob};
-
-    VkResult res = vkCreatePipelineCache(device, &ci, NULL, &cache);
-    free(blob);
-
-    if(res != VK_SUCCESS)
-    {
-    fallback:
-        // sigh… drivers
-        VkPipelineCacheCreateInfo empty = {.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
-        vkCreatePipelineCache(device, &empty, NULL, &cache);
-    }
-
-    return cache;
-}
-
-void pipeline_cache_save(VkDevice device, VkPhysicalDevice phys, VkPipelineCache cache, const char* path)
-{
-    size_t size = 0;
-    vkGetPipelineCacheData(device, cache, &size, NULL);
-    if(size == 0)
-        return;
-
-    void* blob = malloc(size);
-    if(!blob)
-        return;
-
-    vkGetPipelineCacheData(device, cache, &size, blob);
-
-    VkPhysicalDeviceProperties props;
-    get_device_props(phys, &props);
-
-    PipelineCachePrefixHeader hdr = {.magic         = PIPELINE_CACHE_MAGIC,
-                                     .dataSize      = (uint32_t)size,
-                                     .dataHash      = hash64_bytes(blob, size),
-                                     .vendorID      = props.vendorID,
-                                     .deviceID      = props.deviceID,
-                                     .driverVersion = props.driverVersion,
-                                     .driverABI     = sizeof(void*)};
-    memcpy(hdr.uuid, props.pipelineCacheUUID, VK_UUID_SIZE);
-
-    char tmp[1024];
-    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
-
-    FILE* f = fopen(tmp, "wb");
-    if(!f)
-    {
-        free(blob);
-        return;
-    }
-
-    write_all(f, &hdr, sizeof(hdr));
-    write_all(f, blob, size);
-    fclose(f);
-
-    rename(tmp, path);
-    free(blob);
-}
-
-#endif // VK_PIPELINE_CACHE_H_
+    VkPipelineCache    cache;  // shared; main thread creation and merge target
+    PipelineCacheSlot* slots;
+    uint32_t           slot_count;
+
+    uint32_t save_every;  // 0: only save on close
+    uint32_t since_save;  // __atomic; pipelines recorded since the last save
+    bool     warm;        // started from a valid file
+
+    PipelineCacheStats stats;
+} PipelineCacheFile;
+
+// Low level: one validated load / one atomic save of a single cache.
+// out_stats (may be NULL) receives loaded_bytes/file_bytes or saved_bytes/file_bytes.
+VkPipelineCache pipeline_cache_load_or_create(VkDevice device, VkPhysicalDevice phys, const char* path, PipelineCacheStats* out_stats);
+bool pipeline_cache_save(VkDevice device, VkPhysicalDevice phys, VkPipelineCache cache, const char* path, PipelineCacheStats* out_stats);
+
+// slot_count: threads that create pipelines concurrently through
+// pipeline_cache_file_acquire (compiler workers plus the waiting thread).
+void pipeline_cache_file_open(PipelineCacheFile* file,
+                              VkDevice           device,
+                              VkPhysicalDevice   phys,
+                              const char*        path,
+                              uint32_t           slot_count,
+                              uint32_t           save_every);
+
+// Saves pipelines recorded since the last save (if it has a path) and destroys
+// every cache. No acquire may be outstanding.
+void pipeline_cache_file_close(PipelineCacheFile* file);
+
+// A cache only the calling thread uses until release. Spins while every slot
+// is taken, which only happens during a save's merge.
+VkPipelineCache pipeline_cache_file_acquire(PipelineCacheFile* file, uint32_t* out_slot);
+void            pipeline_cache_file_release(PipelineCacheFile* file, uint32_t slot);
+
+// Thread safe. Chain a VkPipelineCreationFeedbackCreateInfo into the create
+// info and pass its pPipelineCreationFeedback here.
+void pipeline_cache_file_record(PipelineCacheFile* file, const VkPipelineCreationFeedback* feedback);
+
+// Main thread: merges the per-thread caches that are idle and writes the file.
+bool pipeline_cache_file_save(PipelineCacheFile* file);
+
+// Main thread, once per frame: saves after save_every new pipelines.
+void pipeline_cache_file_update(PipelineCacheFile* file);
+
+void pipeline_cache_file_print_stats(const PipelineCacheFile* file);
+
+#endif  // VK_PIPELINE_CACHE_H_
@@ -0,0 +1,101 @@
+#include "vk_pipeline_compiler.h"
+
+static void compile_job(void* user, uint32_t index)
+{
+    (void)index;
+    PipelineFuture*   future   = (PipelineFuture*)user;
+    PipelineCompiler* compiler = future->compiler;
+
+    uint32_t        slot  = 0;
+    VkPipelineCache cache = pipeline_cache_file_acquire(compiler->caches, &slot);
+
+    uint64_t   t0       = time_now_ns();
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkResult   result   = future->fn(future->user, compiler->device, cache, &future->feedback, &pipeline);
+    uint64_t   ns       = time_now_ns() - t0;
+
+    pipeline_cache_file_release(compiler->caches, slot);
+
+    if(result != VK_SUCCESS && pipeline != VK_NULL_HANDLE)
+    {
+        vkDestroyPipeline(compiler->device, pipeline, NULL);
+        pipeline = VK_NULL_HANDLE;
+    }
+
+    future->pipeline   = pipeline;
+    future->result     = result;
+    future->compile_ns = ns;
+
+    if(pipeline != VK_NULL_HANDLE)
+    {
+        pipeline_cache_file_record(compiler->caches, &future->feedback);
+        __atomic_add_fetch(&compiler->stats.compiled, 1, __ATOMIC_RELAXED);
+    }
+    else
+        __atomic_add_fetch(&compiler->stats.failed, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&compiler->stats.compile_ns, ns, __ATOMIC_RELAXED);
+
+    uint64_t prev = __atomic_load_n(&compiler->stats.max_ns, __ATOMIC_RELAXED);
+    while(ns > prev && !__atomic_compare_exchange_n(&compiler->stats.max_ns, &prev, ns, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+    // JobPool publishes the future (release on the counter) after this returns
+}
+
+void pipeline_compiler_init(PipelineCompiler* compiler, VkDevice device, PipelineCacheFile* caches, uint32_t thread_count)
+{
+    *compiler = (PipelineCompiler){
+        .device = device,
+        .caches = caches,
+    };
+    job_pool_init(&compiler->jobs, thread_count);
+}
+
+void pipeline_compiler_destroy(PipelineCompiler* compiler)
+{
+    if(!compiler)
+        return;
+
+    // workers drain the queue before they exit
+    job_pool_destroy(&compiler->jobs);
+    *compiler = (PipelineCompiler){0};
+}
+
+void pipeline_compiler_submit(PipelineCompiler* compiler, PipelineFuture* future, PipelineBuildFunc fn, void* user)
+{
+    *future = (PipelineFuture){
+        .compiler = compiler,
+        .fn       = fn,
+        .user     = user,
+        .result   = VK_NOT_READY,
+    };
+
+    __atomic_add_fetch(&compiler->stats.submitted, 1, __ATOMIC_RELAXED);
+    job_pool_run(&compiler->jobs, compile_job, future, 0, &future->done);
+}
+
+void pipeline_compiler_print_stats(const PipelineCompiler* compiler)
+{
+    PipelineCompilerStats s = {
+        .submitted  = __atomic_load_n(&compiler->stats.submitted, __ATOMIC_RELAXED),
+        .compiled   = __atomic_load_n(&compiler->stats.compiled, __ATOMIC_RELAXED),
+        .failed     = __atomic_load_n(&compiler->stats.failed, __ATOMIC_RELAXED),
+        .compile_ns = __atomic_load_n(&compiler->stats.compile_ns, __ATOMIC_RELAXED),
+        .max_ns     = __atomic_load_n(&compiler->stats.max_ns, __ATOMIC_RELAXED),
+    };
+
+    printf("pipelines: %u compiled, %u failed of %u on %u workers, %.1f ms compiling (slowest %.1f ms)\n", s.compiled,
+           s.failed, s.submitted, compiler->jobs.thread_count, time_ns_to_ms(s.compile_ns), time_ns_to_ms(s.max_ns));
+}
+
+bool pipeline_future_ready(const PipelineFuture* future)
+{
+    return future->compiler == NULL || job_pool_is_done(&future->done);
+}
+
+VkPipeline pipeline_future_wait(PipelineFuture* future)
+{
+    if(future->compiler && !job_pool_is_done(&future->done))
+        job_pool_wait(&future->compiler->jobs, &future->done);
+    return future->pipeline;
+}
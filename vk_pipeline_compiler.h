@@ -0,0 +1,74 @@
+#pragma once
+
+#include "vk_defaults.h"
+#include "job_pool.h"
+#include "vk_pipeline_cache_bin.h"
+
+// Asynchronous pipeline compilation.
+//
+// The caller does everything that touches single-threaded state (shader
+// loading, reflection, the descriptor/pipeline layout caches) and hands the
+// expensive vkCreate*Pipelines call to a JobPool worker as a PipelineBuildFunc.
+// Each compile borrows one of the PipelineCacheFile's per-thread caches and
+// reports its creation feedback to it.
+//
+// Each submission fills a caller-owned PipelineFuture, which must stay at its
+// address until the job is done. Poll it once per frame with
+// pipeline_future_ready() (skip the pass until then) or block in
+// pipeline_future_wait(), which runs queued compiles on the calling thread.
+
+typedef struct PipelineCompiler PipelineCompiler;
+
+// Runs on a worker (or a waiting thread). Returns the vkCreate*Pipelines result
+// and chains a VkPipelineCreationFeedbackCreateInfo writing to feedback.
+typedef VkResult (*PipelineBuildFunc)(void*                       user,
+                                      VkDevice                    device,
+                                      VkPipelineCache             cache,
+                                      VkPipelineCreationFeedback* feedback,
+                                      VkPipeline*                 out_pipeline);
+
+typedef struct PipelineFuture
+{
+    PipelineCompiler* compiler;
+    PipelineBuildFunc fn;
+    void*             user;
+    JobCounter        done;
+
+    // valid once done
+    VkPipeline                 pipeline;  // VK_NULL_HANDLE on failure
+    VkResult                   result;
+    uint64_t                   compile_ns;
+    VkPipelineCreationFeedback feedback;
+} PipelineFuture;
+
+typedef struct PipelineCompilerStats
+{
+    uint32_t submitted;
+    uint32_t compiled;
+    uint32_t failed;
+    uint64_t compile_ns;  // summed over workers
+    uint64_t max_ns;      // slowest single pipeline
+} PipelineCompilerStats;
+
+struct PipelineCompiler
+{
+    VkDevice           device;
+    PipelineCacheFile* caches;
+    JobPool            jobs;
+
+    PipelineCompilerStats stats;  // updated with __atomic builtins
+};
+
+// thread_count == 0 picks job_pool_default_threads(). caches should have a
+// slot per worker plus one for the thread that waits.
+void pipeline_compiler_init(PipelineCompiler* compiler, VkDevice device, PipelineCacheFile* caches, uint32_t thread_count);
+
+// Finishes every queued compile first; the futures keep their results.
+void pipeline_compiler_destroy(PipelineCompiler* compiler);
+
+void pipeline_compiler_submit(PipelineCompiler* compiler, PipelineFuture* future, PipelineBuildFunc fn, void* user);
+
+void pipeline_compiler_print_stats(const PipelineCompiler* compiler);
+
+bool       pipeline_future_ready(const PipelineFuture* future);
+VkPipeline pipeline_future_wait(PipelineFuture* future);
@@ -11,9 +11,14 @@ static Hash64 hash_pipeline_layout_key(const PipelineLayoutKey* k)
     return h;
 }
 
+static Hash64 hash_layout_handle(VkPipelineLayout layout)
+{
+    return hash64_bytes(&layout, sizeof(layout));
+}
+
 void pipeline_layout_cache_init(PipelineLayoutCache* cache)
 {
-    cache->entries = NULL;
+    *cache = (PipelineLayoutCache){0};
 }
 
 VkPipelineLayout pipeline_layout_cache_get(VkDevice                     device,
@@ -34,7 +39,8 @@ VkPipelineLayout pipeline_layout_cache_get(VkDevice                     device,
 
     key.hash = hash_pipeline_layout_key(&key);
 
-    for(int i = 0; i < arrlen(cache->entries); i++)
+    uint32_t probe = 0;
+    for(uint32_t i; (i = hash_index_next(&cache->index, key.hash, &probe)) != HASH_INDEX_NONE;)
     {
         PipelineLayoutEntry* e = &cache->entries[i];
 
@@ -63,6 +69,9 @@ VkPipelineLayout pipeline_layout_cache_get(VkDevice                     device,
         .key = key,
         .layout = layout,
     };
+    uint32_t at = (uint32_t)arrlen(cache->entries);
+    hash_index_insert(&cache->index, key.hash, at);
+    hash_index_insert(&cache->by_layout, hash_layout_handle(layout), at);
     arrpush(cache->entries, entry);
 
     return layout;
@@ -74,6 +83,22 @@ void pipeline_layout_cache_destroy(VkDevice device, PipelineLayoutCache* cache)
         vkDestroyPipelineLayout(device, cache->entries[i].layout, NULL);
 
     arrfree(cache->entries);
+    hash_index_free(&cache->index);
+    hash_index_free(&cache->by_layout);
+}
+
+Hash64 pipeline_layout_hash(const PipelineLayoutCache* cache, VkPipelineLayout layout)
+{
+    Hash64   hash  = hash_layout_handle(layout);
+    uint32_t probe = 0;
+    for(uint32_t i; (i = hash_index_next(&cache->by_layout, hash, &probe)) != HASH_INDEX_NONE;)
+    {
+        if(cache->entries[i].layout == layout)
+            return cache->entries[i].key.hash;
+    }
+
+    // This should never happen if layouts only come from the cache
+    return 0;
 }
 
 // bindless-capable builder
@@ -35,7 +35,9 @@ typedef struct PipelineLayoutEntry
 
 typedef struct PipelineLayoutCache
 {
-    PipelineLayoutEntry* entries;  // stretchy buffer
+    PipelineLayoutEntry* entries;    // stretchy buffer
+    HashIndex            index;      // key.hash -> entries
+    HashIndex            by_layout;  // hash of the VkPipelineLayout handle -> entries
 } PipelineLayoutCache;
 
 void pipeline_layout_cache_init(PipelineLayoutCache* cache);
@@ -49,6 +51,9 @@ VkPipelineLayout pipeline_layout_cache_get(VkDevice                     device,
 
 void pipeline_layout_cache_destroy(VkDevice device, PipelineLayoutCache* cache);
 
+// Key hash of a layout the cache created, 0 for any other handle.
+Hash64 pipeline_layout_hash(const PipelineLayoutCache* cache, VkPipelineLayout layout);
+
 // bindless-capable builder
 VkPipelineLayout pipeline_layout_cache_build(VkDevice                                   device,
                                              DescriptorLayoutCache*                     desc_cache,
@@ -1,6 +1,7 @@
 #include "vk_pipeline_layout.h"
 #include "vk_pipelines.h"
 #include "render_object.h"
+#include "vk_queue.h"
 
 #include <errno.h>
 #include <stdint.h>
@@ -14,17 +15,6 @@
 // Internal helpers
 // ============================================================================
 
-uint64_t pipeline_layout_hash(PipelineLayoutCache* cache, VkPipelineLayout layout)
-{
-    for(int i = 0; i < arrlen(cache->entries); i++)
-    {
-        if(cache->entries[i].layout == layout)
-            return cache->entries[i].key.hash;
-    }
-
-    // This should never happen if layouts only come from the cache
-    return 0;
-}
 typedef struct DerivedVertexInput
 {
     uint32_t                          binding_count;
@@ -139,6 +129,70 @@ static char* str_dup(const char* s)
     return out;
 }
 
+// ============================================================================
+// Shader content hashes, memoized per path + mtime
+// ============================================================================
+
+typedef struct ShaderFileStamp
+{
+    char*    path;
+    uint64_t mtime;
+    uint64_t hash;  // XXH64 of the contents
+} ShaderFileStamp;
+
+static ShaderFileStamp* g_shader_stamps      = NULL;  // stretchy buffer
+static HashIndex        g_shader_stamp_index = {0};   // hash of path -> g_shader_stamps
+
+// Content hash of a SPIR-V file; only a stat unless the file changed since
+// the last call.
+static bool shader_file_hash(const char* path, uint64_t* out_hash)
+{
+    uint64_t mtime = file_mtime_ns(path);
+    if(mtime == 0)
+    {
+        log_error("Failed to stat '%s'", path ? path : "(null)");
+        return false;
+    }
+
+    uint64_t         path_hash = hash64_bytes(path, strlen(path));
+    ShaderFileStamp* stamp     = NULL;
+    uint32_t         probe     = 0;
+    for(uint32_t i; (i = hash_index_next(&g_shader_stamp_index, path_hash, &probe)) != HASH_INDEX_NONE;)
+    {
+        if(strcmp(g_shader_stamps[i].path, path) == 0)
+        {
+            stamp = &g_shader_stamps[i];
+            break;
+        }
+    }
+
+    if(stamp && stamp->mtime == mtime)
+    {
+        *out_hash = stamp->hash;
+        return true;
+    }
+
+    void*  code      = NULL;
+    size_t code_size = 0;
+    if(!read_file(path, &code, &code_size))
+        return false;
+
+    uint64_t hash = XXH64(code, code_size, 0xA1);
+    free(code);
+
+    if(!stamp)
+    {
+        hash_index_insert(&g_shader_stamp_index, path_hash, (uint32_t)arrlen(g_shader_stamps));
+        arrpush(g_shader_stamps, (ShaderFileStamp){.path = str_dup(path)});
+        stamp = &arrlast(g_shader_stamps);
+    }
+
+    stamp->mtime = mtime;
+    stamp->hash  = hash;
+    *out_hash    = hash;
+    return true;
+}
+
 static bool ends_with(const char* s, const char* suffix)
 {
     if(!s || !suffix)
@@ -210,7 +264,7 @@ static bool compile_glsl_to_spv(const char* src_path, const char* spv_path)
     // mkdir("compiledshaders", 0755);
 
     char cmd[2048];
-    snprintf(cmd, sizeof(cmd), "glslc \"%s\" -o \"%s\" 2> compiledshaders/shader_errors.txt", src_path, spv_path);
+    snprintf(cmd, sizeof(cmd), "glslc --target-env=vulkan1.3 \"%s\" -o \"%s\" 2> compiledshaders/shader_errors.txt", src_path, spv_path);
 
     int r = system(cmd);
     if(r != 0)
@@ -342,6 +396,35 @@ static bool compile_slang_program(const ShaderProgram* prog, CompiledShaderStage
     
     uint64_t total_mtime = file_mtime_ns(prog->source);
 
+    // All stages in one linked program through the bridge; slangc per stage otherwise
+    if (prog->stage_count <= VK_SLANG_MAX_ENTRIES)
+    {
+        const char* entries[VK_SLANG_MAX_ENTRIES];
+        int         stages[VK_SLANG_MAX_ENTRIES];
+        void*       codes[VK_SLANG_MAX_ENTRIES];
+        size_t      sizes[VK_SLANG_MAX_ENTRIES];
+        for (uint32_t i = 0; i < prog->stage_count; i++)
+        {
+            entries[i] = prog->stages[i].entry;
+            stages[i]  = (int)prog->stages[i].stage;
+        }
+
+        if (vk_slang_compile_entries(prog->source, entries, stages, prog->stage_count, codes, sizes))
+        {
+            for (uint32_t i = 0; i < prog->stage_count; i++)
+            {
+                out[i].stage = prog->stages[i].stage;
+                out[i].code  = codes[i];
+                out[i].size  = sizes[i];
+                out[i].entry = str_dup(prog->stages[i].entry);
+            }
+            *out_count = prog->stage_count;
+            *out_stamp = total_mtime;
+            return true;
+        }
+        log_warn("Slang in-process compile failed for %s, trying slangc", prog->source);
+    }
+
     for (uint32_t i = 0; i < prog->stage_count; i++)
     {
         const ShaderStageDesc* stage = &prog->stages[i];
@@ -967,9 +1050,6 @@ VkPipeline create_graphics_pipeline_from_spec(VkDevice                device,
 
 uint64_t hash_graphics_pipeline_config_xx(const GraphicsPipelineConfig* cfg)
 {
-    XXH64_state_t* h = XXH64_createState();
-    XXH64_reset(h, 0xC0FFEEULL);
-
     GraphicsPipelineConfig tmp = {0};
 
     tmp.cull_mode                = cfg->cull_mode;
@@ -991,15 +1071,10 @@ uint64_t hash_graphics_pipeline_config_xx(const GraphicsPipelineConfig* cfg)
     // - reloadable
     // - vertex bindings / attributes (derived)
 
-    XXH64_update(h, &tmp, sizeof(tmp));
-
-    for(uint32_t i = 0; i < cfg->color_attachment_count; i++)
-    {
-        XXH64_update(h, &cfg->color_formats[i], sizeof(VkFormat));
-    }
-
-    uint64_t out = XXH64_digest(h);
-    XXH64_freeState(h);
+    // runs on every PSO lookup: two one-shot hashes, no streaming state to allocate
+    uint64_t out = XXH64(&tmp, sizeof(tmp), 0xC0FFEEULL);
+    if(cfg->color_attachment_count)
+        out = XXH64(cfg->color_formats, cfg->color_attachment_count * sizeof(VkFormat), out);
     return out;
 }
 // ============================================================================
@@ -1063,72 +1138,52 @@ VkPipeline get_or_create_graphics_pipeline(GraphicsPipelineCache*        pso_cac
                                            VkPipelineLayout*             out_layout)
 {
     // --------------------------------------------------
-    // Load shaders
+    // Shader hashes (memoized, no file read unless changed)
     // --------------------------------------------------
-    void*  vert_code = NULL;
-    size_t vert_size = 0;
-    void*  frag_code = NULL;
-    size_t frag_size = 0;
+    uint64_t vert_hash = 0;
+    uint64_t frag_hash = 0;
 
-    if(!read_file(vert_path, &vert_code, &vert_size))
-        return VK_NULL_HANDLE;
-    if(!read_file(frag_path, &frag_code, &frag_size))
-    {
-        free(vert_code);
+    if(!shader_file_hash(vert_path, &vert_hash) || !shader_file_hash(frag_path, &frag_hash))
         return VK_NULL_HANDLE;
-    }
-
-
-    uint64_t shader_hash = XXH64(vert_code, vert_size, 0xA1) ^ (XXH64(frag_code, frag_size, 0xB2) * 0x9E3779B97F4A7C15ull);
-    // --------------------------------------------------
-    // Build / fetch pipeline layout (reflection)
-    // --------------------------------------------------
-    const void*  spirvs[2] = {vert_code, frag_code};
-    const size_t sizes[2]  = {vert_size, frag_size};
-
-    VkPipelineLayout layout = forced_layout;
-    if(layout == VK_NULL_HANDLE)
-        layout = shader_reflect_build_pipeline_layout(device, desc_cache, pipe_cache, spirvs, sizes, 2);
-
-    uint64_t layout_hash = pipeline_layout_hash(pipe_cache, layout);
-
-    if(out_layout)
-        *out_layout = layout;
 
     // --------------------------------------------------
     // Build PSO key
     // --------------------------------------------------
     GraphicsPipelineKey key = {
         .config_hash = hash_graphics_pipeline_config_xx(user_cfg),
-        .layout_hash = layout_hash,
-        .shader_hash = shader_hash,
+        .layout_hash = forced_layout != VK_NULL_HANDLE ? pipeline_layout_hash(pipe_cache, forced_layout) : 0,
+        .shader_hash = vert_hash ^ (frag_hash * 0x9E3779B97F4A7C15ull),
     };
+    uint64_t key_hash = XXH64(&key, sizeof(key), 0);
 
     // --------------------------------------------------
     // Lookup
     // --------------------------------------------------
-    for(size_t i = 0; i < pso_cache->count; i++)
+    uint32_t probe = 0;
+    for(uint32_t i; (i = hash_index_next(&pso_cache->index, key_hash, &probe)) != HASH_INDEX_NONE;)
     {
-        if(memcmp(&pso_cache->entries[i].key, &key, sizeof(key)) == 0)
+        GraphicsPipelineCacheEntry* e = &pso_cache->entries[i];
+        if(memcmp(&e->key, &key, sizeof(key)) == 0)
         {
-            free(vert_code);
-            free(frag_code);
-            return pso_cache->entries[i].pipeline;
+            if(out_layout)
+                *out_layout = e->layout;
+            return e->pipeline;
         }
     }
 
     // --------------------------------------------------
-    // Miss → create
+    // Miss → create (loads and reflects the shaders)
     // --------------------------------------------------
-    VkPipeline pipeline = create_graphics_pipeline(device, vk_cache, desc_cache, pipe_cache, vert_path, frag_path,
-                                                   (GraphicsPipelineConfig*)user_cfg, layout, NULL);
-
-    free(vert_code);
-    free(frag_code);
+    VkPipelineLayout layout   = VK_NULL_HANDLE;
+    VkPipeline       pipeline = create_graphics_pipeline(device, vk_cache, desc_cache, pipe_cache, vert_path, frag_path,
+                                                         (GraphicsPipelineConfig*)user_cfg, forced_layout, &layout);
 
     if(pipeline == VK_NULL_HANDLE)
         return VK_NULL_HANDLE;
 
+    if(out_layout)
+        *out_layout = layout;
+
     // --------------------------------------------------
     // Insert
     // --------------------------------------------------
@@ -1139,7 +1194,8 @@ VkPipeline get_or_create_graphics_pipeline(GraphicsPipelineCache*        pso_cac
         pso_cache->capacity = new_cap;
     }
 
-    pso_cache->entries[pso_cache->count++] = (GraphicsPipelineCacheEntry){key, pipeline};
+    hash_index_insert(&pso_cache->index, key_hash, (uint32_t)pso_cache->count);
+    pso_cache->entries[pso_cache->count++] = (GraphicsPipelineCacheEntry){key, pipeline, layout};
 
     return pipeline;
 }
@@ -1153,45 +1209,36 @@ VkPipeline get_or_create_compute_pipeline(ComputePipelineCache*  cache,
                                           const char*            comp_path,
                                           VkPipelineLayout*      out_layout)
 {
-    void*  code = NULL;
-    size_t size = 0;
-
-    if(!read_file(comp_path, &code, &size))
+    uint64_t shader_hash = 0;
+    if(!shader_file_hash(comp_path, &shader_hash))
         return VK_NULL_HANDLE;
 
-    uint64_t shader_hash = XXH64(code, size, 0xC0FFEEULL);
-
-    const void*  spirvs[1] = {code};
-    const size_t sizes[1]  = {size};
-
-    VkPipelineLayout layout = shader_reflect_build_pipeline_layout(device, desc_cache, pipe_cache, spirvs, sizes, 1);
-
-    uint64_t layout_hash = pipeline_layout_hash(pipe_cache, layout);
-
-    if(out_layout)
-        *out_layout = layout;
-
     ComputePipelineKey key = {
         .shader_hash = shader_hash,
-        .layout_hash = layout_hash,
     };
+    uint64_t key_hash = XXH64(&key, sizeof(key), 0);
 
-    for(size_t i = 0; i < cache->count; i++)
+    uint32_t probe = 0;
+    for(uint32_t i; (i = hash_index_next(&cache->index, key_hash, &probe)) != HASH_INDEX_NONE;)
     {
-        if(memcmp(&cache->entries[i].key, &key, sizeof(key)) == 0)
+        ComputePipelineCacheEntry* e = &cache->entries[i];
+        if(memcmp(&e->key, &key, sizeof(key)) == 0)
         {
-            free(code);
-            return cache->entries[i].pipeline;
+            if(out_layout)
+                *out_layout = e->layout;
+            return e->pipeline;
         }
     }
 
-    VkPipeline pipeline = create_compute_pipeline(device, vk_cache, desc_cache, pipe_cache, comp_path, NULL);
-
-    free(code);
+    VkPipelineLayout layout   = VK_NULL_HANDLE;
+    VkPipeline       pipeline = create_compute_pipeline(device, vk_cache, desc_cache, pipe_cache, comp_path, &layout);
 
     if(pipeline == VK_NULL_HANDLE)
         return VK_NULL_HANDLE;
 
+    if(out_layout)
+        *out_layout = layout;
+
     if(cache->count == cache->capacity)
     {
         size_t new_cap  = cache->capacity ? cache->capacity * 2 : 16;
@@ -1199,11 +1246,32 @@ VkPipeline get_or_create_compute_pipeline(ComputePipelineCache*  cache,
         cache->capacity = new_cap;
     }
 
-    cache->entries[cache->count++] = (ComputePipelineCacheEntry){key, pipeline};
+    hash_index_insert(&cache->index, key_hash, (uint32_t)cache->count);
+    cache->entries[cache->count++] = (ComputePipelineCacheEntry){key, pipeline, layout};
 
     return pipeline;
 }
 
+void graphics_pipeline_cache_destroy(VkDevice device, GraphicsPipelineCache* cache)
+{
+    for(size_t i = 0; i < cache->count; i++)
+        vkDestroyPipeline(device, cache->entries[i].pipeline, NULL);
+
+    free(cache->entries);
+    hash_index_free(&cache->index);
+    *cache = (GraphicsPipelineCache){0};
+}
+
+void compute_pipeline_cache_destroy(VkDevice device, ComputePipelineCache* cache)
+{
+    for(size_t i = 0; i < cache->count; i++)
+        vkDestroyPipeline(device, cache->entries[i].pipeline, NULL);
+
+    free(cache->entries);
+    hash_index_free(&cache->index);
+    *cache = (ComputePipelineCache){0};
+}
+
 
 // ============================================================================
 // Hot reload update
@@ -1242,7 +1310,9 @@ void pipeline_hot_reload_update(void)
 
             if(new_pipe != VK_NULL_HANDLE)
             {
+                vk_queue_lock();
                 vkDeviceWaitIdle(e->device);
+                vk_queue_unlock();
 
                 if(*e->pipeline)
                     vkDestroyPipeline(e->device, *e->pipeline, NULL);
@@ -1293,7 +1363,9 @@ void pipeline_hot_reload_update(void)
                                             e->vert_path, e->frag_path, &e->gfx_cfg, e->forced_layout, &new_layout);
         if(new_pipe != VK_NULL_HANDLE)
         {
+            vk_queue_lock();
             vkDeviceWaitIdle(e->device);
+            vk_queue_unlock();
 
             if(*e->pipeline)
                 vkDestroyPipeline(e->device, *e->pipeline, NULL);
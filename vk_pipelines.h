@@ -130,6 +130,11 @@ bool compile_shader_program(
     uint32_t*            out_count,
     uint64_t*            out_stamp);
 
+// PSO cache keys. shader_hash comes from the SPIR-V contents, memoized per
+// path and mtime, so a hit reads no file and reflects nothing. Reflected
+// layouts are a function of the shaders (layout_hash 0); a forced layout is
+// keyed by its PipelineLayoutCache hash. Use one PSO cache per pair of
+// layout caches.
 typedef struct GraphicsPipelineKey
 {
     uint64_t config_hash;
@@ -141,6 +146,7 @@ typedef struct GraphicsPipelineCacheEntry
 {
     GraphicsPipelineKey key;
     VkPipeline          pipeline;
+    VkPipelineLayout    layout;
 } GraphicsPipelineCacheEntry;
 
 typedef struct GraphicsPipelineCache
@@ -148,12 +154,12 @@ typedef struct GraphicsPipelineCache
     GraphicsPipelineCacheEntry* entries;
     size_t                      count;
     size_t                      capacity;
+    HashIndex                   index;  // hash of key -> entries
 } GraphicsPipelineCache;
 
 typedef struct ComputePipelineKey
 {
     uint64_t shader_hash;
-    uint64_t layout_hash;
 } ComputePipelineKey;
 
 
@@ -161,6 +167,7 @@ typedef struct ComputePipelineCacheEntry
 {
     ComputePipelineKey key;
     VkPipeline         pipeline;
+    VkPipelineLayout   layout;
 } ComputePipelineCacheEntry;
 
 typedef struct ComputePipelineCache
@@ -168,6 +175,7 @@ typedef struct ComputePipelineCache
     ComputePipelineCacheEntry* entries;
     size_t                     count;
     size_t                     capacity;
+    HashIndex                  index;  // hash of key -> entries
 } ComputePipelineCache;
 // ============================================================================
 // Graphics Pipeline Config - minimal, no shader module fields
@@ -307,5 +315,17 @@ VkPipeline get_or_create_graphics_pipeline(
     VkPipelineLayout              forced_layout,
     VkPipelineLayout*             out_layout);
 
+VkPipeline get_or_create_compute_pipeline(ComputePipelineCache*  cache,
+                                          VkDevice               device,
+                                          VkPipelineCache        vk_cache,
+                                          DescriptorLayoutCache* desc_cache,
+                                          PipelineLayoutCache*   pipe_cache,
+                                          const char*            comp_path,
+                                          VkPipelineLayout*      out_layout);
+
+// Destroys every cached pipeline (layouts belong to the PipelineLayoutCache).
+void graphics_pipeline_cache_destroy(VkDevice device, GraphicsPipelineCache* cache);
+void compute_pipeline_cache_destroy(VkDevice device, ComputePipelineCache* cache);
+
 
 #endif  // VK_PIPELINES_H_
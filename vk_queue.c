@@ -1,7 +1,20 @@
 
 #include "vk_queue.h"
+#include <pthread.h>
 #include <stdlib.h>
 
+static pthread_mutex_t g_queue_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+void vk_queue_lock(void)
+{
+    pthread_mutex_lock(&g_queue_mutex);
+}
+
+void vk_queue_unlock(void)
+{
+    pthread_mutex_unlock(&g_queue_mutex);
+}
+
 void find_queue_families(VkPhysicalDevice device, VkSurfaceKHR surface, queue_families* out)
 {
     // initialize everything
@@ -71,6 +84,19 @@ void find_queue_families(VkPhysicalDevice device, VkSurfaceKHR surface, queue_fa
         }
     }
 
+    // prefer a transfer-only family (a DMA engine) so uploads can run beside
+    // graphics; the loop above settles on the graphics family
+    for(uint32_t i = 0; i < count; i++)
+    {
+        VkQueueFlags flags = families[i].queueFlags;
+        if((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+        {
+            out->transfer_family = i;
+            out->has_transfer    = 1;
+            break;
+        }
+    }
+
     free(families);
 }
 
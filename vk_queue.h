@@ -35,6 +35,13 @@ void find_queue_families(VkPhysicalDevice device,
 // Uses the family indices already stored in queue_families.
 void init_device_queues(VkDevice device, queue_families* q);
 
+// VkQueue access (vkQueueSubmit*, vkQueuePresentKHR, vkQueueWaitIdle and
+// vkDeviceWaitIdle) must be externally synchronized. Every submit path takes
+// this process-wide lock so background submitters such as the texture loader
+// can share queues with the frame loop. Not recursive.
+void vk_queue_lock(void);
+void vk_queue_unlock(void);
+
 //
 //
 // queue_families q;
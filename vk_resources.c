@@ -20,7 +20,8 @@ static VmaPool res_get_small_buffer_pool(ResourceAllocator*                ra,
     if(vmaFindMemoryTypeIndexForBufferInfo(ra->allocator, buffer_info, alloc_info, &memory_type_index) != VK_SUCCESS)
         return VK_NULL_HANDLE;
 
-    if(ra->small_buffer_pools[memory_type_index] == VK_NULL_HANDLE)
+    VmaPool pool = __atomic_load_n(&ra->small_buffer_pools[memory_type_index], __ATOMIC_ACQUIRE);
+    if(pool == VK_NULL_HANDLE)
     {
         VmaPoolCreateInfo pool_info = {
             .memoryTypeIndex = memory_type_index,
@@ -29,10 +30,18 @@ static VmaPool res_get_small_buffer_pool(ResourceAllocator*                ra,
             .maxBlockCount   = 0,
             .flags           = 0,
         };
-        VK_CHECK(vmaCreatePool(ra->allocator, &pool_info, &ra->small_buffer_pools[memory_type_index]));
+        VmaPool created = VK_NULL_HANDLE;
+        VK_CHECK(vmaCreatePool(ra->allocator, &pool_info, &created));
+
+        // another thread may have created it meanwhile; keep the first one
+        if(__atomic_compare_exchange_n(&ra->small_buffer_pools[memory_type_index], &pool, created, false, __ATOMIC_ACQ_REL,
+                                       __ATOMIC_ACQUIRE))
+            pool = created;
+        else
+            vmaDestroyPool(ra->allocator, created);
     }
 
-    return ra->small_buffer_pools[memory_type_index];
+    return pool;
 }
 
 static VmaPool res_get_small_image_pool(ResourceAllocator*                ra,
@@ -46,7 +55,8 @@ static VmaPool res_get_small_image_pool(ResourceAllocator*                ra,
     if(vmaFindMemoryTypeIndexForImageInfo(ra->allocator, image_info, alloc_info, &memory_type_index) != VK_SUCCESS)
         return VK_NULL_HANDLE;
 
-    if(ra->small_image_pools[memory_type_index] == VK_NULL_HANDLE)
+    VmaPool pool = __atomic_load_n(&ra->small_image_pools[memory_type_index], __ATOMIC_ACQUIRE);
+    if(pool == VK_NULL_HANDLE)
     {
         VmaPoolCreateInfo pool_info = {
             .memoryTypeIndex = memory_type_index,
@@ -55,10 +65,18 @@ static VmaPool res_get_small_image_pool(ResourceAllocator*                ra,
             .maxBlockCount   = 0,
             .flags           = 0,
         };
-        VK_CHECK(vmaCreatePool(ra->allocator, &pool_info, &ra->small_image_pools[memory_type_index]));
+        VmaPool created = VK_NULL_HANDLE;
+        VK_CHECK(vmaCreatePool(ra->allocator, &pool_info, &created));
+
+        // another thread may have created it meanwhile; keep the first one
+        if(__atomic_compare_exchange_n(&ra->small_image_pools[memory_type_index], &pool, created, false, __ATOMIC_ACQ_REL,
+                                       __ATOMIC_ACQUIRE))
+            pool = created;
+        else
+            vmaDestroyPool(ra->allocator, created);
     }
 
-    return ra->small_image_pools[memory_type_index];
+    return pool;
 }
 void res_init(VkInstance instance, VkDevice device, VkPhysicalDevice physical_device, ResourceAllocator* ra, VmaAllocatorCreateInfo info)
 {
@@ -69,6 +87,21 @@ void res_init(VkInstance instance, VkDevice device, VkPhysicalDevice physical_de
     info.flags |= VMA_ALLOCATOR_CREATE_KHR_MAINTENANCE5_BIT;
     ra->physical_device = physical_device;
 
+    // create_device enables it when the device has it
+    uint32_t ext_count = 0;
+    vkEnumerateDeviceExtensionProperties(physical_device, NULL, &ext_count, NULL);
+    VkExtensionProperties* exts = (VkExtensionProperties*)malloc(sizeof(VkExtensionProperties) * ext_count);
+    vkEnumerateDeviceExtensionProperties(physical_device, NULL, &ext_count, exts);
+    ra->memory_budget = false;
+    for(uint32_t i = 0; i < ext_count; i++)
+    {
+        if(strcmp(exts[i].extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0)
+            ra->memory_budget = true;
+    }
+    free(exts);
+    if(ra->memory_budget)
+        info.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+
     VkPhysicalDeviceVulkan11Properties props11 = {.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_PROPERTIES};
 
     VkPhysicalDeviceProperties2 props = {.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, .pNext = &props11};
@@ -84,6 +117,10 @@ void res_init(VkInstance instance, VkDevice device, VkPhysicalDevice physical_de
     ra->small_buffer_threshold = 1024 * 1024; // 1MB
     ra->small_buffer_pool_block_size = 256 * 1024 * 1024; // 256MB
     ra->small_image_pool_block_size = 256 * 1024 * 1024; // 256MB
+
+    pthread_mutex_init(&ra->sampler_mutex, NULL);
+    ra->samplers         = NULL;
+    ra->sampler_requests = 0;
     //  use VMA_DYNAMIC_VULKAN_FUNCTIONS
     VmaVulkanFunctions vulkanFunctions = {
         .vkGetInstanceProcAddr                   = vkGetInstanceProcAddr,
@@ -167,6 +204,11 @@ void res_deinit(ResourceAllocator* ra)
         }
     }
 
+    for(uint32_t i = 0; i < (uint32_t)arrlen(ra->samplers); i++)
+        vkDestroySampler(ra->device, ra->samplers[i].sampler, NULL);
+    arrfree(ra->samplers);
+    pthread_mutex_destroy(&ra->sampler_mutex);
+
     vmaDestroyAllocator(ra->allocator);
 }
 
@@ -176,7 +218,7 @@ static uint64_t res_next_allocation_id(ResourceAllocator* ra)
     if(!ra)
         return 0;
 
-    uint64_t id = ra->allocation_counter++;
+    uint64_t id = __atomic_fetch_add(&ra->allocation_counter, 1, __ATOMIC_RELAXED);
     if(ra->leak_id == id)
     {
 #if defined(_WIN32)
@@ -360,6 +402,74 @@ void res_destroy_image(ResourceAllocator* ra, VkImage image, VmaAllocation alloc
     vmaDestroyImage(ra->allocator, image, allocation);
 }
 
+void res_device_local_budget(ResourceAllocator* ra, VkDeviceSize* out_budget, VkDeviceSize* out_usage)
+{
+    const VkPhysicalDeviceMemoryProperties* props = NULL;
+    vmaGetMemoryProperties(ra->allocator, &props);
+
+    VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+    vmaGetHeapBudgets(ra->allocator, budgets);
+
+    VkDeviceSize budget = 0, usage = 0;
+    for(uint32_t i = 0; i < props->memoryHeapCount; i++)
+    {
+        if(props->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+        {
+            budget += budgets[i].budget;
+            usage += budgets[i].usage;
+        }
+    }
+
+    *out_budget = budget;
+    *out_usage  = usage;
+}
+
+VkSampler res_get_sampler(ResourceAllocator* ra, const VkSamplerCreateInfo* info)
+{
+    // field by field into a zeroed key so padding never reaches the hash/compare
+    VkSamplerCreateInfo key;
+    memset(&key, 0, sizeof(key));
+    key.sType                   = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    key.flags                   = info->flags;
+    key.magFilter               = info->magFilter;
+    key.minFilter               = info->minFilter;
+    key.mipmapMode              = info->mipmapMode;
+    key.addressModeU            = info->addressModeU;
+    key.addressModeV            = info->addressModeV;
+    key.addressModeW            = info->addressModeW;
+    key.mipLodBias              = info->mipLodBias;
+    key.anisotropyEnable        = info->anisotropyEnable;
+    key.maxAnisotropy           = info->maxAnisotropy;
+    key.compareEnable           = info->compareEnable;
+    key.compareOp               = info->compareOp;
+    key.minLod                  = info->minLod;
+    key.maxLod                  = info->maxLod;
+    key.borderColor             = info->borderColor;
+    key.unnormalizedCoordinates = info->unnormalizedCoordinates;
+
+    uint64_t hash = XXH64(&key, sizeof(key), 0);
+
+    pthread_mutex_lock(&ra->sampler_mutex);
+    ra->sampler_requests++;
+
+    for(uint32_t i = 0; i < (uint32_t)arrlen(ra->samplers); i++)
+    {
+        SamplerCacheEntry* e = &ra->samplers[i];
+        if(e->hash == hash && memcmp(&e->key, &key, sizeof(key)) == 0)
+        {
+            VkSampler sampler = e->sampler;
+            pthread_mutex_unlock(&ra->sampler_mutex);
+            return sampler;
+        }
+    }
+
+    SamplerCacheEntry e = {.hash = hash, .key = key};
+    VK_CHECK(vkCreateSampler(ra->device, &key, NULL, &e.sampler));
+    arrpush(ra->samplers, e);
+    pthread_mutex_unlock(&ra->sampler_mutex);
+    return e.sampler;
+}
+
 void buffer_arena_init(ResourceAllocator* ra,
                        VkDeviceSize             size,
                        VkBufferUsageFlags2KHR   usageflags,
@@ -438,6 +548,12 @@ void buffer_arena_free(BufferArena* arena, BufferSlice* slice)
     oa_free(&arena->allocator, slice->allocation);
     *slice = (BufferSlice){0};
 }
+static bool upload_fill_copy(void* user, void* dst, VkDeviceSize size)
+{
+    memcpy(dst, user, (size_t)size);
+    return true;
+}
+
 void upload_to_gpu_buffer(ResourceAllocator* allocator,
                           VkQueue            queue,
                           VkCommandPool      pool,
@@ -447,6 +563,19 @@ void upload_to_gpu_buffer(ResourceAllocator* allocator,
                           VkDeviceSize       size)
 {
     assert(src_data && size > 0);
+    upload_to_gpu_buffer_fill(allocator, queue, pool, dst_buffer, dst_offset, size, upload_fill_copy, (void*)src_data);
+}
+
+bool upload_to_gpu_buffer_fill(ResourceAllocator* allocator,
+                               VkQueue            queue,
+                               VkCommandPool      pool,
+                               VkBuffer           dst_buffer,
+                               VkDeviceSize       dst_offset,
+                               VkDeviceSize       size,
+                               UploadFillFn       fill,
+                               void*              user)
+{
+    assert(fill && size > 0);
 
     Buffer staging = {0};
     res_create_buffer(allocator, (uint64_t)size,
@@ -454,7 +583,11 @@ void upload_to_gpu_buffer(ResourceAllocator* allocator,
                       VMA_MEMORY_USAGE_AUTO,
                       VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, 0, &staging);
 
-    memcpy(staging.mapping, src_data, (size_t)size);
+    if(!fill(user, staging.mapping, size))
+    {
+        res_destroy_buffer(allocator, &staging);
+        return false;
+    }
 
     VkCommandBuffer cmd = begin_one_time_cmd(allocator->device, pool);
 
@@ -464,4 +597,5 @@ void upload_to_gpu_buffer(ResourceAllocator* allocator,
     end_one_time_cmd(allocator->device, queue, pool, cmd);
 
     res_destroy_buffer(allocator, &staging);
+    return true;
 }
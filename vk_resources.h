@@ -3,6 +3,7 @@
 #include "vk_defaults.h"
 #include "offset_allocator.h"
 #include <vulkan/vulkan_core.h>
+#include <pthread.h>
 
 
 // buffer is a region of memory used to store vertex data, index data, uniform data, and other types of data.
@@ -212,6 +213,17 @@ typedef struct ImageViewPool
 // Indirection via index is faster than pointer chasing
 //
 // Lifetime is explicit
+//
+// res_create_* / res_destroy_* may be called from any thread: VMA locks
+// internally and the lazily created small pools are published atomically.
+// res_get_sampler too, the sampler cache has its own lock.
+typedef struct SamplerCacheEntry
+{
+    uint64_t            hash;
+    VkSamplerCreateInfo key;  // pNext dropped, padding zeroed
+    VkSampler           sampler;
+} SamplerCacheEntry;
+
 typedef struct ResourceAllocator
 {
     VkDevice         device;
@@ -229,6 +241,12 @@ typedef struct ResourceAllocator
     VmaPool      small_image_pools[VK_MAX_MEMORY_TYPES];
     VkDeviceSize small_image_pool_block_size;
 
+    bool memory_budget;  // VK_EXT_memory_budget enabled, heap budgets are the driver's
+
+    pthread_mutex_t    sampler_mutex;
+    SamplerCacheEntry* samplers;  // stb_ds
+    uint32_t           sampler_requests;
+
 } ResourceAllocator;
 
 
@@ -262,6 +280,14 @@ void res_create_image(ResourceAllocator*       ra,
 
 void res_destroy_image(ResourceAllocator* ra, VkImage image, VmaAllocation allocation);
 
+// Sum of vmaGetHeapBudgets over the device-local heaps. Without
+// VK_EXT_memory_budget VMA estimates the budget as 80% of the heap size.
+void res_device_local_budget(ResourceAllocator* ra, VkDeviceSize* out_budget, VkDeviceSize* out_usage);
+
+// Shared sampler for info (pNext chains are not supported). Samplers are owned
+// by the allocator and live until res_deinit; never destroy the result.
+VkSampler res_get_sampler(ResourceAllocator* ra, const VkSamplerCreateInfo* info);
+
 void        buffer_arena_init(ResourceAllocator*       ra,
                               VkDeviceSize             size,
                               VkBufferUsageFlags2KHR   usageflags,
@@ -275,7 +301,8 @@ void        buffer_arena_free(BufferArena* arena, BufferSlice* slice);
 
 
 // NOTE: This is a simple version: it waits for the queue to finish (vkQueueWaitIdle).
-// Good for startup uploads. For per-frame streaming, you'll want a ring-buffer staging system.
+// Good for one-off uploads. Start-up bulk uploads go through UploadBatch (vk_upload.h),
+// per-frame ones through StagingRing (vk_staging.h).
 
 void upload_to_gpu_buffer(ResourceAllocator* allocator,
                           VkQueue            queue,
@@ -284,3 +311,18 @@ void upload_to_gpu_buffer(ResourceAllocator* allocator,
                           VkDeviceSize       dst_offset,
                           const void*        src_data,
                           VkDeviceSize       size);
+
+// Same, but fill writes the staging memory directly (e.g. decodes into it)
+// instead of copying from src_data. The memory is write-combined on most
+// devices: write it sequentially, never read it back. Returns false, skipping the
+// copy, if fill fails.
+typedef bool (*UploadFillFn)(void* user, void* dst, VkDeviceSize size);
+
+bool upload_to_gpu_buffer_fill(ResourceAllocator* allocator,
+                               VkQueue            queue,
+                               VkCommandPool      pool,
+                               VkBuffer           dst_buffer,
+                               VkDeviceSize       dst_offset,
+                               VkDeviceSize       size,
+                               UploadFillFn       fill,
+                               void*              user);
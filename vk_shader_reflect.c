@@ -1,5 +1,9 @@
 #include "vk_shader_reflect.h"
 
+#include "external/SPIRV-Reflect/spirv_reflect.h"
+
+#include <stdio.h>
+
 // Convert SpvReflectDescriptorType to VkDescriptorType
 static VkDescriptorType spv_to_vk_descriptor_type(SpvReflectDescriptorType spv_type)
 {
@@ -117,19 +121,21 @@ static VkFormat spv_to_vk_format(SpvReflectFormat spv_format)
 }
 
 
-bool shader_reflect_create(ShaderReflection* reflection, const void* spirv_code, size_t spirv_size)
+// Runs SPIRV-Reflect. Names in reflection point into module, which the caller
+// destroys after packing them (on failure it is already destroyed).
+static bool reflect_spirv(ShaderReflection* reflection, SpvReflectShaderModule* module, const void* spirv_code, size_t spirv_size)
 {
     memset(reflection, 0, sizeof(*reflection));
 
-    SpvReflectResult result = spvReflectCreateShaderModule(spirv_size, spirv_code, &reflection->module);
+    SpvReflectResult result = spvReflectCreateShaderModule(spirv_size, spirv_code, module);
     if(result != SPV_REFLECT_RESULT_SUCCESS)
     {
         log_error("Failed to create shader reflection module: %d", result);
         return false;
     }
 
-    reflection->stage       = spv_to_vk_shader_stage(reflection->module.shader_stage);
-    reflection->entry_point = reflection->module.entry_point_name;
+    reflection->stage       = spv_to_vk_shader_stage(module->shader_stage);
+    reflection->entry_point = module->entry_point_name;
 
     log_info("[shader_reflect] stage=%s entry=%s size=%zu", shader_stage_name(reflection->stage),
              reflection->entry_point ? reflection->entry_point : "(null)", spirv_size);
@@ -137,7 +143,7 @@ bool shader_reflect_create(ShaderReflection* reflection, const void* spirv_code,
     // Get compute shader local size
     if(reflection->stage == VK_SHADER_STAGE_COMPUTE_BIT)
     {
-        const SpvReflectEntryPoint* entry = spvReflectGetEntryPoint(&reflection->module, reflection->entry_point);
+        const SpvReflectEntryPoint* entry = spvReflectGetEntryPoint(module, reflection->entry_point);
         if(entry)
         {
             reflection->local_size_x = entry->local_size.x;
@@ -148,11 +154,11 @@ bool shader_reflect_create(ShaderReflection* reflection, const void* spirv_code,
 
     // Enumerate descriptor sets
     uint32_t set_count = 0;
-    result             = spvReflectEnumerateDescriptorSets(&reflection->module, &set_count, NULL);
+    result             = spvReflectEnumerateDescriptorSets(module, &set_count, NULL);
     if(result != SPV_REFLECT_RESULT_SUCCESS)
     {
         log_error("Failed to enumerate descriptor sets: %d", result);
-        spvReflectDestroyShaderModule(&reflection->module);
+        spvReflectDestroyShaderModule(module);
         return false;
     }
 
@@ -161,11 +167,11 @@ bool shader_reflect_create(ShaderReflection* reflection, const void* spirv_code,
         SpvReflectDescriptorSet* sets[SHADER_REFLECT_MAX_SETS];
         set_count = MIN(set_count, SHADER_REFLECT_MAX_SETS);
 
-        result = spvReflectEnumerateDescriptorSets(&reflection->module, &set_count, sets);
+        result = spvReflectEnumerateDescriptorSets(module, &set_count, sets);
         if(result != SPV_REFLECT_RESULT_SUCCESS)
         {
             log_error("Failed to get descriptor sets: %d", result);
-            spvReflectDestroyShaderModule(&reflection->module);
+            spvReflectDestroyShaderModule(module);
             return false;
         }
 
@@ -209,13 +215,13 @@ bool shader_reflect_create(ShaderReflection* reflection, const void* spirv_code,
 
     // Enumerate push constants
     uint32_t push_count = 0;
-    result              = spvReflectEnumeratePushConstantBlocks(&reflection->module, &push_count, NULL);
+    result              = spvReflectEnumeratePushConstantBlocks(module, &push_count, NULL);
     if(result == SPV_REFLECT_RESULT_SUCCESS && push_count > 0)
     {
         SpvReflectBlockVariable* push_blocks[SHADER_REFLECT_MAX_PUSH];
         push_count = MIN(push_count, SHADER_REFLECT_MAX_PUSH);
 
-        result = spvReflectEnumeratePushConstantBlocks(&reflection->module, &push_count, push_blocks);
+        result = spvReflectEnumeratePushConstantBlocks(module, &push_count, push_blocks);
         if(result == SPV_REFLECT_RESULT_SUCCESS)
         {
             reflection->push_constant_count = push_count;
@@ -245,13 +251,13 @@ bool shader_reflect_create(ShaderReflection* reflection, const void* spirv_code,
     if(reflection->stage == VK_SHADER_STAGE_VERTEX_BIT)
     {
         uint32_t input_count = 0;
-        result               = spvReflectEnumerateInputVariables(&reflection->module, &input_count, NULL);
+        result               = spvReflectEnumerateInputVariables(module, &input_count, NULL);
         if(result == SPV_REFLECT_RESULT_SUCCESS && input_count > 0)
         {
             SpvReflectInterfaceVariable* inputs[SHADER_REFLECT_MAX_INPUTS];
             input_count = MIN(input_count, SHADER_REFLECT_MAX_INPUTS);
 
-            result = spvReflectEnumerateInputVariables(&reflection->module, &input_count, inputs);
+            result = spvReflectEnumerateInputVariables(module, &input_count, inputs);
             if(result == SPV_REFLECT_RESULT_SUCCESS)
             {
                 uint32_t valid_count = 0;
@@ -308,9 +314,461 @@ bool shader_reflect_create(ShaderReflection* reflection, const void* spirv_code,
 }
 
 
+// -------- Sidecar cache --------
+
+typedef struct ShaderReflectCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t spirv_hash;
+    uint64_t spirv_size;
+    uint32_t file_size;
+    uint32_t binding_stride;  // sizeof(ShaderReflectCacheBinding), catches layout changes without a version bump
+
+    uint32_t stage;
+    uint32_t entry_point;  // string offset; 0 is "no name"
+    uint32_t local_size[3];
+
+    // sections follow in this order, then string_bytes of names
+    uint32_t binding_count;  // over all sets
+    uint32_t set_count;
+    uint32_t push_constant_count;
+    uint32_t vertex_input_count;
+    uint32_t string_bytes;
+} ShaderReflectCacheHeader;
+
+typedef struct ShaderReflectCacheBinding
+{
+    uint64_t id;
+    uint32_t binding;
+    uint32_t descriptor_type;
+    uint32_t descriptor_count;
+    uint32_t tags;
+    uint32_t name;
+    uint32_t clean_name;
+} ShaderReflectCacheBinding;
+
+typedef struct ShaderReflectCacheSet
+{
+    uint32_t set_index;
+    uint32_t binding_count;
+} ShaderReflectCacheSet;
+
+typedef struct ShaderReflectCachePush
+{
+    uint32_t offset;
+    uint32_t size;
+    uint32_t name;
+} ShaderReflectCachePush;
+
+typedef struct ShaderReflectCacheInput
+{
+    uint32_t location;
+    uint32_t format;
+    uint32_t name;
+} ShaderReflectCacheInput;
+
+static bool g_reflect_cache_enabled = true;
+
+void shader_reflect_cache_set_enabled(bool enabled)
+{
+    g_reflect_cache_enabled = enabled;
+}
+
+bool shader_reflect_cache_enabled(void)
+{
+    return g_reflect_cache_enabled;
+}
+
+static bool str_contains_case(const char* s, const char* token)
+{
+    size_t token_len = strlen(token);
+    for(const char* p = s; *p; p++)
+    {
+        size_t i = 0;
+        while(i < token_len && p[i])
+        {
+            char c1 = p[i];
+            char c2 = token[i];
+            if(c1 >= 'A' && c1 <= 'Z')
+                c1 = (char)(c1 - 'A' + 'a');
+            if(c2 >= 'A' && c2 <= 'Z')
+                c2 = (char)(c2 - 'A' + 'a');
+            if(c1 != c2)
+                break;
+            i++;
+        }
+        if(i == token_len)
+            return true;
+    }
+    return false;
+}
+
+static uint32_t binding_name_tags(const char* name)
+{
+    uint32_t tags = 0;
+    if(str_contains_case(name, "bindless"))
+        tags |= SHADER_BINDING_TAG_BINDLESS;
+    if(str_contains_case(name, "@per_frame") || str_contains_case(name, "@perframe"))
+        tags |= SHADER_BINDING_TAG_PER_FRAME;
+    if(str_contains_case(name, "@update_after_bind") || str_contains_case(name, "@uabo"))
+        tags |= SHADER_BINDING_TAG_UPDATE_AFTER_BIND;
+    if(str_contains_case(name, "u_textures"))
+        tags |= SHADER_BINDING_TAG_TEXTURES;
+    return tags;
+}
+
+// Length of the name without its "@tag" suffix (a name starting with '@' is kept whole)
+static size_t binding_clean_len(const char* name)
+{
+    const char* cut = strchr(name, '@');
+    return (cut && cut != name) ? (size_t)(cut - name) : strlen(name);
+}
+
+static uint32_t pack_string(char* strings, uint32_t* cursor, const char* s, size_t len)
+{
+    if(!s)
+        return 0;
+
+    uint32_t offset = *cursor;
+    memcpy(strings + offset, s, len);
+    strings[offset + len] = 0;
+    *cursor += (uint32_t)len + 1;
+    return offset;
+}
+
+static size_t pack_string_bytes(const char* s)
+{
+    return s ? strlen(s) + 1 : 0;
+}
+
+// Flattens a reflection (names still in the SPIR-V module) into one sidecar image.
+static void* reflect_cache_pack(const ShaderReflection* r, uint64_t spirv_hash, uint64_t spirv_size, size_t* out_size)
+{
+    uint32_t binding_count = 0;
+    size_t   string_bytes  = 1 + pack_string_bytes(r->entry_point);
+    for(uint32_t s = 0; s < r->set_count; s++)
+    {
+        binding_count += r->sets[s].binding_count;
+        for(uint32_t b = 0; b < r->sets[s].binding_count; b++)
+        {
+            const char* name = r->sets[s].bindings[b].name;
+            string_bytes += name ? strlen(name) + 1 + binding_clean_len(name) + 1 : 0;
+        }
+    }
+    for(uint32_t i = 0; i < r->push_constant_count; i++)
+        string_bytes += pack_string_bytes(r->push_constants[i].name);
+    for(uint32_t i = 0; i < r->vertex_input_count; i++)
+        string_bytes += pack_string_bytes(r->vertex_inputs[i].name);
+
+    size_t size = sizeof(ShaderReflectCacheHeader) + binding_count * sizeof(ShaderReflectCacheBinding)
+                  + r->set_count * sizeof(ShaderReflectCacheSet) + r->push_constant_count * sizeof(ShaderReflectCachePush)
+                  + r->vertex_input_count * sizeof(ShaderReflectCacheInput) + string_bytes;
+
+    uint8_t* data = (uint8_t*)calloc(1, size);
+    if(!data)
+        return NULL;
+
+    ShaderReflectCacheHeader*  h        = (ShaderReflectCacheHeader*)data;
+    ShaderReflectCacheBinding* bindings = (ShaderReflectCacheBinding*)(h + 1);
+    ShaderReflectCacheSet*     sets     = (ShaderReflectCacheSet*)(bindings + binding_count);
+    ShaderReflectCachePush*    pushes   = (ShaderReflectCachePush*)(sets + r->set_count);
+    ShaderReflectCacheInput*   inputs   = (ShaderReflectCacheInput*)(pushes + r->push_constant_count);
+    char*                      strings  = (char*)(inputs + r->vertex_input_count);
+    uint32_t                   cursor   = 1;  // offset 0 is the empty "no name" string
+
+    *h = (ShaderReflectCacheHeader){
+        .magic               = SHADER_REFLECT_CACHE_MAGIC,
+        .version             = SHADER_REFLECT_CACHE_VERSION,
+        .spirv_hash          = spirv_hash,
+        .spirv_size          = spirv_size,
+        .file_size           = (uint32_t)size,
+        .binding_stride      = sizeof(ShaderReflectCacheBinding),
+        .stage               = r->stage,
+        .local_size          = {r->local_size_x, r->local_size_y, r->local_size_z},
+        .binding_count       = binding_count,
+        .set_count           = r->set_count,
+        .push_constant_count = r->push_constant_count,
+        .vertex_input_count  = r->vertex_input_count,
+        .string_bytes        = (uint32_t)string_bytes,
+    };
+    h->entry_point = pack_string(strings, &cursor, r->entry_point, r->entry_point ? strlen(r->entry_point) : 0);
+
+    ShaderReflectCacheBinding* dst = bindings;
+    for(uint32_t s = 0; s < r->set_count; s++)
+    {
+        const ReflectedDescriptorSet* set = &r->sets[s];
+        sets[s] = (ShaderReflectCacheSet){.set_index = set->set_index, .binding_count = set->binding_count};
+
+        for(uint32_t b = 0; b < set->binding_count; b++, dst++)
+        {
+            const ReflectedBinding* src = &set->bindings[b];
+            *dst = (ShaderReflectCacheBinding){
+                .binding          = src->binding,
+                .descriptor_type  = src->descriptor_type,
+                .descriptor_count = src->descriptor_count,
+            };
+            if(src->name)
+            {
+                size_t clean_len = binding_clean_len(src->name);
+                dst->tags        = binding_name_tags(src->name);
+                dst->id          = hash64_bytes(src->name, clean_len);
+                dst->name        = pack_string(strings, &cursor, src->name, strlen(src->name));
+                dst->clean_name  = pack_string(strings, &cursor, src->name, clean_len);
+            }
+        }
+    }
+
+    for(uint32_t i = 0; i < r->push_constant_count; i++)
+    {
+        const ReflectedPushConstant* src = &r->push_constants[i];
+        pushes[i] = (ShaderReflectCachePush){
+            .offset = src->offset,
+            .size   = src->size,
+            .name   = pack_string(strings, &cursor, src->name, src->name ? strlen(src->name) : 0),
+        };
+    }
+
+    for(uint32_t i = 0; i < r->vertex_input_count; i++)
+    {
+        const ReflectedVertexInput* src = &r->vertex_inputs[i];
+        inputs[i] = (ShaderReflectCacheInput){
+            .location = src->location,
+            .format   = src->format,
+            .name     = pack_string(strings, &cursor, src->name, src->name ? strlen(src->name) : 0),
+        };
+    }
+
+    *out_size = size;
+    return data;
+}
+
+static const char* cache_string(const char* strings, uint32_t string_bytes, uint32_t offset, bool* ok)
+{
+    if(offset == 0)
+        return NULL;
+    if(offset >= string_bytes)
+    {
+        *ok = false;
+        return NULL;
+    }
+    return strings + offset;
+}
+
+// Points reflection at a sidecar image and takes ownership of data. Fails on
+// any mismatch with the SPIR-V or an inconsistent file, leaving data to the caller.
+static bool reflect_cache_unpack(ShaderReflection* r, void* data, size_t size, uint64_t spirv_hash, uint64_t spirv_size)
+{
+    memset(r, 0, sizeof(*r));
+
+    const ShaderReflectCacheHeader* h = (const ShaderReflectCacheHeader*)data;
+    if(size < sizeof(*h) || h->magic != SHADER_REFLECT_CACHE_MAGIC || h->version != SHADER_REFLECT_CACHE_VERSION
+       || h->spirv_hash != spirv_hash || h->spirv_size != spirv_size || h->file_size != size
+       || h->binding_stride != sizeof(ShaderReflectCacheBinding))
+        return false;
+
+    if(h->set_count > SHADER_REFLECT_MAX_SETS || h->binding_count > SHADER_REFLECT_MAX_SETS * SHADER_REFLECT_MAX_BINDINGS
+       || h->push_constant_count > SHADER_REFLECT_MAX_PUSH || h->vertex_input_count > SHADER_REFLECT_MAX_INPUTS)
+        return false;
+
+    size_t expected = sizeof(*h) + (size_t)h->binding_count * sizeof(ShaderReflectCacheBinding)
+                      + (size_t)h->set_count * sizeof(ShaderReflectCacheSet)
+                      + (size_t)h->push_constant_count * sizeof(ShaderReflectCachePush)
+                      + (size_t)h->vertex_input_count * sizeof(ShaderReflectCacheInput) + h->string_bytes;
+    if(expected != size || h->string_bytes == 0)
+        return false;
+
+    const ShaderReflectCacheBinding* bindings = (const ShaderReflectCacheBinding*)(h + 1);
+    const ShaderReflectCacheSet*     sets     = (const ShaderReflectCacheSet*)(bindings + h->binding_count);
+    const ShaderReflectCachePush*    pushes   = (const ShaderReflectCachePush*)(sets + h->set_count);
+    const ShaderReflectCacheInput*   inputs   = (const ShaderReflectCacheInput*)(pushes + h->push_constant_count);
+    const char*                      strings  = (const char*)(inputs + h->vertex_input_count);
+    uint32_t                         nbytes   = h->string_bytes;
+    if(strings[0] != 0 || strings[nbytes - 1] != 0)
+        return false;
+
+    bool ok                 = true;
+    r->stage                = (VkShaderStageFlagBits)h->stage;
+    r->entry_point          = cache_string(strings, nbytes, h->entry_point, &ok);
+    r->local_size_x         = h->local_size[0];
+    r->local_size_y         = h->local_size[1];
+    r->local_size_z         = h->local_size[2];
+    r->set_count            = h->set_count;
+    r->push_constant_count  = h->push_constant_count;
+    r->vertex_input_count   = h->vertex_input_count;
+
+    const ShaderReflectCacheBinding* src = bindings;
+    uint32_t                         left = h->binding_count;
+    for(uint32_t s = 0; s < h->set_count && ok; s++)
+    {
+        ReflectedDescriptorSet* set = &r->sets[s];
+        set->set_index              = sets[s].set_index;
+        set->binding_count          = sets[s].binding_count;
+        if(set->binding_count > SHADER_REFLECT_MAX_BINDINGS || set->binding_count > left)
+        {
+            ok = false;
+            break;
+        }
+        left -= set->binding_count;
+
+        for(uint32_t b = 0; b < set->binding_count; b++, src++)
+        {
+            set->bindings[b] = (ReflectedBinding){
+                .binding          = src->binding,
+                .descriptor_type  = (VkDescriptorType)src->descriptor_type,
+                .descriptor_count = src->descriptor_count,
+                .stage_flags      = r->stage,
+                .name             = cache_string(strings, nbytes, src->name, &ok),
+                .clean_name       = cache_string(strings, nbytes, src->clean_name, &ok),
+                .id               = src->id,
+                .tags             = src->tags,
+            };
+        }
+    }
+    ok = ok && left == 0;
+
+    for(uint32_t i = 0; i < r->push_constant_count && ok; i++)
+    {
+        r->push_constants[i] = (ReflectedPushConstant){
+            .offset      = pushes[i].offset,
+            .size        = pushes[i].size,
+            .stage_flags = r->stage,
+            .name        = cache_string(strings, nbytes, pushes[i].name, &ok),
+        };
+    }
+
+    for(uint32_t i = 0; i < r->vertex_input_count && ok; i++)
+    {
+        r->vertex_inputs[i] = (ReflectedVertexInput){
+            .location = inputs[i].location,
+            .format   = (VkFormat)inputs[i].format,
+            .name     = cache_string(strings, nbytes, inputs[i].name, &ok),
+        };
+    }
+
+    if(!ok)
+    {
+        memset(r, 0, sizeof(*r));
+        return false;
+    }
+
+    r->data = data;
+    return true;
+}
+
+// SPIRV-Reflect, then the same packed form a sidecar load produces
+static bool reflect_and_pack(ShaderReflection* reflection, const void* spirv_code, size_t spirv_size, uint64_t spirv_hash)
+{
+    memset(reflection, 0, sizeof(*reflection));
+
+    SpvReflectShaderModule module;
+    ShaderReflection       raw;
+    if(!reflect_spirv(&raw, &module, spirv_code, spirv_size))
+        return false;
+
+    size_t size = 0;
+    void*  data = reflect_cache_pack(&raw, spirv_hash, spirv_size, &size);
+    spvReflectDestroyShaderModule(&module);
+
+    if(!data || !reflect_cache_unpack(reflection, data, size, spirv_hash, spirv_size))
+    {
+        log_error("Failed to pack shader reflection");
+        free(data);
+        return false;
+    }
+    return true;
+}
+
+static bool reflect_cache_read(const char* path, void** out_data, size_t* out_size)
+{
+    FILE* f = fopen(path, "rb");
+    if(!f)
+        return false;
+
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    rewind(f);
+
+    void* data = (len > 0) ? malloc((size_t)len) : NULL;
+    bool  ok   = data && fread(data, 1, (size_t)len, f) == (size_t)len;
+    fclose(f);
+
+    if(!ok)
+    {
+        free(data);
+        return false;
+    }
+
+    *out_data = data;
+    *out_size = (size_t)len;
+    return true;
+}
+
+static bool reflect_cache_write(const char* path, const void* data, size_t size)
+{
+    char tmp[1024];
+    if(snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp))
+        return false;
+
+    FILE* f = fopen(tmp, "wb");
+    if(!f)
+        return false;
+
+    bool ok = fwrite(data, 1, size, f) == size;
+    ok      = (fclose(f) == 0) && ok;
+    ok      = ok && rename(tmp, path) == 0;
+    if(!ok)
+        remove(tmp);
+    return ok;
+}
+
+bool shader_reflect_create(ShaderReflection* reflection, const void* spirv_code, size_t spirv_size)
+{
+    return reflect_and_pack(reflection, spirv_code, spirv_size, hash64_bytes(spirv_code, spirv_size));
+}
+
+bool shader_reflect_create_cached(ShaderReflection* reflection, const void* spirv_code, size_t spirv_size, const char* spv_path)
+{
+    uint64_t hash = hash64_bytes(spirv_code, spirv_size);
+
+    char path[1024];
+    bool use_cache = spv_path && g_reflect_cache_enabled
+                     && snprintf(path, sizeof(path), "%s%s", spv_path, SHADER_REFLECT_CACHE_EXT) < (int)sizeof(path);
+
+    if(use_cache)
+    {
+        void*  data = NULL;
+        size_t size = 0;
+        if(reflect_cache_read(path, &data, &size))
+        {
+            if(reflect_cache_unpack(reflection, data, size, hash, spirv_size))
+            {
+                log_info("[shader_reflect] %s: sidecar stage=%s sets=%u push=%u inputs=%u", spv_path,
+                         shader_stage_name(reflection->stage), reflection->set_count, reflection->push_constant_count,
+                         reflection->vertex_input_count);
+                return true;
+            }
+            free(data);
+            log_info("[shader_reflect] %s: stale sidecar, reflecting", spv_path);
+        }
+    }
+
+    if(!reflect_and_pack(reflection, spirv_code, spirv_size, hash))
+        return false;
+
+    if(use_cache)
+    {
+        const ShaderReflectCacheHeader* h = (const ShaderReflectCacheHeader*)reflection->data;
+        if(!reflect_cache_write(path, reflection->data, h->file_size))
+            log_warn("[shader_reflect] could not write %s", path);
+    }
+    return true;
+}
+
+
 void shader_reflect_destroy(ShaderReflection* reflection)
 {
-    spvReflectDestroyShaderModule(&reflection->module);
+    free(reflection->data);
     memset(reflection, 0, sizeof(*reflection));
 }
 
@@ -5,7 +5,22 @@
 #include "vk_descriptor.h"
 #include "vk_pipeline_layout.h"
 
-#include "external/SPIRV-Reflect/spirv_reflect.h"
+// Reflection sidecars: shader_reflect_create_cached() stores what SPIRV-Reflect
+// found in "<path>.refl" next to the .spv and reads it back on later runs
+// instead of parsing the module again. The file is keyed by the xxHash64 of the
+// SPIR-V, so recompiling a shader (or a hot reload) rewrites it.
+//
+// File: ShaderReflectCacheHeader, then fixed-size records (bindings, sets, push
+// constants, vertex inputs) and a string table of NUL-terminated names. Loading
+// is one read and a header check; names point into the file data, which the
+// ShaderReflection keeps until shader_reflect_destroy(). Binding names are
+// stored raw and sanitized (the "@tag" suffix cut off, tags kept as
+// SHADER_BINDING_TAG_* bits) together with their BindingId, so RenderObject
+// does no string work either. Writes go through a .tmp file and rename().
+
+#define SHADER_REFLECT_CACHE_MAGIC   0x4c464552u  // 'REFL'
+#define SHADER_REFLECT_CACHE_VERSION 1u
+#define SHADER_REFLECT_CACHE_EXT     ".refl"
 
 // Maximum limits for reflection
 #define SHADER_REFLECT_MAX_SETS      8
@@ -15,6 +30,15 @@
 
 // -------- Reflected shader data --------
 
+// Tags parsed from a binding name ("u_textures@bindless")
+enum
+{
+    SHADER_BINDING_TAG_BINDLESS          = 1u << 0,  // "@bindless", or "bindless" anywhere
+    SHADER_BINDING_TAG_PER_FRAME         = 1u << 1,  // "@per_frame", "@perframe"
+    SHADER_BINDING_TAG_UPDATE_AFTER_BIND = 1u << 2,  // "@update_after_bind", "@uabo"
+    SHADER_BINDING_TAG_TEXTURES          = 1u << 3,  // the shared "u_textures" array
+};
+
 typedef struct ReflectedBinding
 {
     uint32_t             binding;
@@ -22,6 +46,9 @@ typedef struct ReflectedBinding
     uint32_t             descriptor_count;
     VkShaderStageFlags   stage_flags;
     const char*          name;
+    const char*          clean_name;  // name without the "@tag" suffix
+    uint64_t             id;          // hash64_bytes(clean_name), i.e. render_bind_id()
+    uint32_t             tags;        // SHADER_BINDING_TAG_*
 } ReflectedBinding;
 
 typedef struct ReflectedDescriptorSet
@@ -49,7 +76,7 @@ typedef struct ReflectedVertexInput
 
 typedef struct ShaderReflection
 {
-    SpvReflectShaderModule  module;
+    void*                   data;  // sidecar image; owns every name below
     VkShaderStageFlagBits   stage;
 
     uint32_t                set_count;
@@ -91,6 +118,17 @@ bool shader_reflect_create(ShaderReflection* reflection,
                            const void*       spirv_code,
                            size_t            spirv_size);
 
+// Same, through the "<spv_path>.refl" sidecar: loaded when its hash matches
+// spirv_code, otherwise reflected and (re)written. spv_path may be NULL.
+bool shader_reflect_create_cached(ShaderReflection* reflection,
+                                  const void*       spirv_code,
+                                  size_t            spirv_size,
+                                  const char*       spv_path);
+
+// On by default. Off: shader_reflect_create_cached neither reads nor writes sidecars.
+void shader_reflect_cache_set_enabled(bool enabled);
+bool shader_reflect_cache_enabled(void);
+
 // Destroy shader reflection and free resources
 void shader_reflect_destroy(ShaderReflection* reflection);
 
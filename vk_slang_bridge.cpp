@@ -1,152 +1,599 @@
 #include "vk_slang_bridge.h"
 #include "shadercomp/slang/include/slang.h"
+#include <errno.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+
+// helpers.c
+extern "C" uint64_t hash64_bytes(const void* data, size_t size);
+extern "C" uint64_t time_now_ns(void);
 
 // Using Slang namespace
 using namespace slang;
 
-// Static global session to reuse across compiles (optional, but good for perf)
-static IGlobalSession* g_slangGlobalSession = nullptr;
+#define SLANG_MAX_SESSIONS 4
+#define SLANG_MAX_MODULES  64
+#define SLANG_MAX_DEPS     32
+#define SLANG_PATH_MAX     512
 
-extern "C" bool vk_compile_slang(const char* source_file, 
-                      const char* entry_point, 
-                      int stage, 
-                      void** out_spv, 
-                      size_t* out_size)
+#define SLANG_PROFILE "glsl_450"
+
+#define SLANG_DISK_MAGIC   0x43534c53u  // 'SLSC'
+#define SLANG_DISK_VERSION 1u
+
+struct SlangSessionEntry
 {
-    if (out_spv) *out_spv = nullptr;
-    if (out_size) *out_size = 0;
+    SlangCompileTarget format;
+    char               profile[32];
+    ISession*          session;  // owns every module loaded through it
+};
 
-    SlangResult res;
+struct SlangDep
+{
+    char     path[SLANG_PATH_MAX];
+    uint64_t mtime;
+};
 
-    // 1. Initialize Global Session
-    if (!g_slangGlobalSession)
+struct SlangModuleEntry
+{
+    char     path[SLANG_PATH_MAX];
+    uint32_t session;
+    IModule* module;  // borrowed from the session
+    uint32_t dep_count;
+    SlangDep deps[SLANG_MAX_DEPS];  // the module file and everything it imports
+};
+
+// On-disk cache: header, deps, entry sizes, then the SPIR-V of each entry
+struct SlangDiskHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t request_hash;  // source path, profile, entries and stages
+    uint32_t dep_count;
+    uint32_t entry_count;
+};
+
+struct SlangDiskDep
+{
+    uint64_t content_hash;
+    char     path[SLANG_PATH_MAX];
+};
+
+// Static global session to reuse across compiles
+static IGlobalSession*   g_slangGlobalSession = nullptr;
+static SlangSessionEntry g_slangSessions[SLANG_MAX_SESSIONS];
+static uint32_t          g_slangSessionCount = 0;
+static SlangModuleEntry  g_slangModules[SLANG_MAX_MODULES];
+static uint32_t          g_slangModuleCount = 0;
+static VkSlangStats      g_slangStats       = {};
+static pthread_mutex_t   g_slangLock        = PTHREAD_MUTEX_INITIALIZER;
+
+static uint64_t slang_file_mtime(const char* path)
+{
+    struct stat st;
+    if (stat(path, &st) != 0)
+        return 0;
+    return (uint64_t)st.st_mtim.tv_sec * 1000000000ull + (uint64_t)st.st_mtim.tv_nsec;
+}
+
+static bool slang_read_file(const char* path, void** out_data, size_t* out_size)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f)
+        return false;
+
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    rewind(f);
+
+    void* data = (len > 0) ? malloc((size_t)len) : nullptr;
+    bool  ok   = data && fread(data, 1, (size_t)len, f) == (size_t)len;
+    fclose(f);
+
+    if (!ok) {
+        free(data);
+        return false;
+    }
+
+    *out_data = data;
+    *out_size = (size_t)len;
+    return true;
+}
+
+static bool slang_hash_file(const char* path, uint64_t* out_hash)
+{
+    void*  data = nullptr;
+    size_t size = 0;
+    if (!slang_read_file(path, &data, &size))
+        return false;
+
+    *out_hash = hash64_bytes(data, size);
+    free(data);
+    return true;
+}
+
+static void slang_diagnostics(const char* what, IBlob* diagBlob)
+{
+    if (!diagBlob)
+        return;
+    fprintf(stderr, "Slang Diagnostics (%s): %s\n", what, (const char*)diagBlob->getBufferPointer());
+    diagBlob->release();
+}
+
+static SlangStage slang_stage_from_vk(int stage)
+{
+    switch (stage)
     {
-        res = createGlobalSession(&g_slangGlobalSession);
-        if (SLANG_FAILED(res)) {
-            fprintf(stderr, "Slang: Failed to create global session: %x\n", res);
-            return false;
+        case 0x00000001: return SLANG_STAGE_VERTEX;         // VK_SHADER_STAGE_VERTEX_BIT
+        case 0x00000008: return SLANG_STAGE_GEOMETRY;       // VK_SHADER_STAGE_GEOMETRY_BIT
+        case 0x00000010: return SLANG_STAGE_FRAGMENT;       // VK_SHADER_STAGE_FRAGMENT_BIT
+        case 0x00000020: return SLANG_STAGE_COMPUTE;        // VK_SHADER_STAGE_COMPUTE_BIT
+        case 0x00000040: return SLANG_STAGE_AMPLIFICATION;  // VK_SHADER_STAGE_TASK_BIT_EXT
+        case 0x00000080: return SLANG_STAGE_MESH;           // VK_SHADER_STAGE_MESH_BIT_EXT
+        default: return SLANG_STAGE_NONE;
+    }
+}
+
+// ------------------------------------------------------------
+// On-disk SPIR-V cache
+// ------------------------------------------------------------
+
+static uint64_t slang_request_hash(const char* source_file, const char* const* entry_points, const int* stages, uint32_t entry_count)
+{
+    char   key[2048];
+    size_t n = (size_t)snprintf(key, sizeof(key), "%s|%s", source_file, SLANG_PROFILE);
+    for (uint32_t i = 0; i < entry_count && n < sizeof(key); i++)
+        n += (size_t)snprintf(key + n, sizeof(key) - n, "|%s:%d", entry_points[i], stages ? stages[i] : 0);
+    return hash64_bytes(key, n < sizeof(key) ? n : sizeof(key) - 1);
+}
+
+static bool slang_disk_path(uint64_t request_hash, char* out_path, size_t out_cap)
+{
+    int n = snprintf(out_path, out_cap, "%s/%016llx.slc", VK_SLANG_CACHE_DIR, (unsigned long long)request_hash);
+    return n > 0 && (size_t)n < out_cap;
+}
+
+static bool slang_disk_load(uint64_t request_hash, uint32_t entry_count, void** out_spv, size_t* out_sizes)
+{
+    char path[1024];
+    if (!slang_disk_path(request_hash, path, sizeof(path)))
+        return false;
+
+    void*  data = nullptr;
+    size_t size = 0;
+    if (!slang_read_file(path, &data, &size))
+        return false;
+
+    const uint8_t*         p  = (const uint8_t*)data;
+    const SlangDiskHeader* h  = (const SlangDiskHeader*)p;
+    bool                   ok = size >= sizeof(*h) && h->magic == SLANG_DISK_MAGIC && h->version == SLANG_DISK_VERSION
+              && h->request_hash == request_hash && h->entry_count == entry_count && h->dep_count <= SLANG_MAX_DEPS;
+
+    size_t header_bytes = ok ? sizeof(*h) + h->dep_count * sizeof(SlangDiskDep) + entry_count * sizeof(uint64_t) : 0;
+    ok                  = ok && header_bytes <= size;
+
+    // every dependency must still hash the same
+    const SlangDiskDep* deps = (const SlangDiskDep*)(p + sizeof(*h));
+    for (uint32_t i = 0; ok && i < h->dep_count; i++)
+    {
+        uint64_t hash = 0;
+        ok            = memchr(deps[i].path, 0, SLANG_PATH_MAX) && slang_hash_file(deps[i].path, &hash) && hash == deps[i].content_hash;
+    }
+
+    const uint64_t* sizes = ok ? (const uint64_t*)(p + sizeof(*h) + h->dep_count * sizeof(SlangDiskDep)) : nullptr;
+    size_t          total = header_bytes;
+    for (uint32_t i = 0; ok && i < entry_count; i++)
+    {
+        ok = sizes[i] > 0 && sizes[i] <= size - total;
+        total += ok ? (size_t)sizes[i] : 0;
+    }
+    ok = ok && total == size;
+
+    uint32_t copied = 0;
+    size_t   offset = header_bytes;
+    for (; ok && copied < entry_count; copied++)
+    {
+        out_spv[copied] = malloc((size_t)sizes[copied]);
+        if (!out_spv[copied]) {
+            ok = false;
+            break;
         }
+        memcpy(out_spv[copied], p + offset, (size_t)sizes[copied]);
+        out_sizes[copied] = (size_t)sizes[copied];
+        offset += (size_t)sizes[copied];
+    }
+
+    if (!ok) {
+        for (uint32_t i = 0; i < copied; i++) {
+            free(out_spv[i]);
+            out_spv[i]   = nullptr;
+            out_sizes[i] = 0;
+        }
+    }
+
+    free(data);
+    return ok;
+}
+
+static void slang_disk_store(uint64_t request_hash, const SlangModuleEntry* module, uint32_t entry_count, void* const* spv, const size_t* sizes)
+{
+    char path[1024];
+    char tmp[1100];
+    if (!slang_disk_path(request_hash, path, sizeof(path)))
+        return;
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+    if (mkdir(VK_SLANG_CACHE_DIR, 0755) != 0 && errno != EEXIST)
+        return;
+
+    SlangDiskHeader header = {};
+    header.magic           = SLANG_DISK_MAGIC;
+    header.version         = SLANG_DISK_VERSION;
+    header.request_hash    = request_hash;
+    header.dep_count       = module->dep_count;
+    header.entry_count     = entry_count;
+
+    SlangDiskDep deps[SLANG_MAX_DEPS];
+    memset(deps, 0, sizeof(deps));
+    for (uint32_t i = 0; i < module->dep_count; i++)
+    {
+        memcpy(deps[i].path, module->deps[i].path, SLANG_PATH_MAX);
+        if (!slang_hash_file(deps[i].path, &deps[i].content_hash))
+            return;
+    }
+
+    FILE* f = fopen(tmp, "wb");
+    if (!f)
+        return;
+
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    ok      = ok && fwrite(deps, sizeof(SlangDiskDep), module->dep_count, f) == module->dep_count;
+    for (uint32_t i = 0; ok && i < entry_count; i++)
+    {
+        uint64_t sz = sizes[i];
+        ok          = fwrite(&sz, sizeof(sz), 1, f) == 1;
+    }
+    for (uint32_t i = 0; ok && i < entry_count; i++)
+        ok = fwrite(spv[i], 1, sizes[i], f) == sizes[i];
+    ok = (fclose(f) == 0) && ok;
+    ok = ok && rename(tmp, path) == 0;
+    if (!ok) {
+        remove(tmp);
+        fprintf(stderr, "Slang: could not write %s\n", path);
     }
+}
 
-    // 2. Create Session
+// ------------------------------------------------------------
+// Sessions and modules
+// ------------------------------------------------------------
+
+static bool slang_create_session(SlangSessionEntry* entry)
+{
     SessionDesc sessionDesc = {};
-    TargetDesc targetDesc = {};
-    targetDesc.format = SLANG_SPIRV;
-    targetDesc.profile = g_slangGlobalSession->findProfile("glsl_450");
-    targetDesc.flags = SLANG_TARGET_FLAG_GENERATE_SPIRV_DIRECTLY;
+    TargetDesc  targetDesc  = {};
+    targetDesc.format       = entry->format;
+    targetDesc.profile      = g_slangGlobalSession->findProfile(entry->profile);
+    targetDesc.flags        = SLANG_TARGET_FLAG_GENERATE_SPIRV_DIRECTLY;
 
-    sessionDesc.targets = &targetDesc;
+    sessionDesc.targets     = &targetDesc;
     sessionDesc.targetCount = 1;
 
-    ISession* session = nullptr;
-    res = g_slangGlobalSession->createSession(sessionDesc, &session);
-    if (SLANG_FAILED(res)) {
-        fprintf(stderr, "Slang: Failed to create session\n");
+    entry->session = nullptr;
+    SlangResult res = g_slangGlobalSession->createSession(sessionDesc, &entry->session);
+    if (SLANG_FAILED(res) || !entry->session) {
+        fprintf(stderr, "Slang: Failed to create session (%s)\n", entry->profile);
+        entry->session = nullptr;
         return false;
     }
 
-    // 3. Load Module
-    IModule* module = nullptr;
+    g_slangStats.sessions++;
+    return true;
+}
+
+static int slang_get_session(SlangCompileTarget format, const char* profile)
+{
+    if (!g_slangGlobalSession)
     {
-        // Read file content manually or use loadModule if path is correct relative to cwd
-        // Slang's loadModule relies on search paths. 
-        // We will try loading by path.
-        IBlob* diagBlob = nullptr;
-        module = session->loadModule(source_file, &diagBlob);
-        
-        if (diagBlob) {
-            fprintf(stderr, "Slang Diagnostics (Load): %s\n", (const char*)diagBlob->getBufferPointer());
-            diagBlob->release();
-        }
-        
-        if (!module) {
-            fprintf(stderr, "Slang: Failed to load module: %s\n", source_file);
-            session->release();
-            return false;
+        SlangResult res = createGlobalSession(&g_slangGlobalSession);
+        if (SLANG_FAILED(res)) {
+            fprintf(stderr, "Slang: Failed to create global session: %x\n", res);
+            g_slangGlobalSession = nullptr;
+            return -1;
         }
     }
 
-    // 4. Find Entry Point
-    IEntryPoint* entryPoint = nullptr;
-    {
-        IBlob* diagBlob = nullptr;
-        // SlangStage: 
-        // We need to map VkShaderStageFlagBits to SlangStage
-        // But for findEntryPointByName, we might not strictly need it if name is unique
-        // However, findEntryPointByName doc says "Note that this does not work..."
-        // Use findAndCheckEntryPoint if needed.
-        // Let's try findEntryPointByName first.
-        
-        res = module->findEntryPointByName(entry_point, &entryPoint);
-        if (SLANG_FAILED(res) || !entryPoint) {
-           fprintf(stderr, "Slang: Failed to find entry point '%s'\n", entry_point);
-           session->release();
-           return false;
+    for (uint32_t i = 0; i < g_slangSessionCount; i++)
+    {
+        SlangSessionEntry* s = &g_slangSessions[i];
+        if (s->format == format && strcmp(s->profile, profile) == 0)
+            return (s->session || slang_create_session(s)) ? (int)i : -1;
+    }
+
+    if (g_slangSessionCount == SLANG_MAX_SESSIONS)
+        return -1;
+
+    SlangSessionEntry* s = &g_slangSessions[g_slangSessionCount];
+    memset(s, 0, sizeof(*s));
+    s->format = format;
+    snprintf(s->profile, sizeof(s->profile), "%s", profile);
+    if (!slang_create_session(s))
+        return -1;
+    return (int)g_slangSessionCount++;
+}
+
+// Drops the session's modules; the next slang_get_session creates a fresh one
+static void slang_reset_session(uint32_t session)
+{
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < g_slangModuleCount; i++)
+    {
+        if (g_slangModules[i].session != session)
+            g_slangModules[kept++] = g_slangModules[i];
+    }
+    g_slangModuleCount = kept;
+
+    if (g_slangSessions[session].session)
+        g_slangSessions[session].session->release();
+    g_slangSessions[session].session = nullptr;
+}
+
+static bool slang_module_stale(const SlangModuleEntry* m)
+{
+    for (uint32_t i = 0; i < m->dep_count; i++)
+    {
+        if (slang_file_mtime(m->deps[i].path) != m->deps[i].mtime)
+            return true;
+    }
+    return false;
+}
+
+static void slang_add_dep(SlangModuleEntry* m, const char* path)
+{
+    if (!path || m->dep_count == SLANG_MAX_DEPS || strlen(path) >= SLANG_PATH_MAX)
+        return;
+
+    for (uint32_t i = 0; i < m->dep_count; i++)
+    {
+        if (strcmp(m->deps[i].path, path) == 0)
+            return;
+    }
+
+    SlangDep* d = &m->deps[m->dep_count++];
+    snprintf(d->path, sizeof(d->path), "%s", path);
+    d->mtime = slang_file_mtime(path);
+}
+
+static SlangModuleEntry* slang_get_module(const char* source_file)
+{
+    int session = slang_get_session(SLANG_SPIRV, SLANG_PROFILE);
+    if (session < 0)
+        return nullptr;
+
+    for (uint32_t i = 0; i < g_slangModuleCount; i++)
+    {
+        SlangModuleEntry* m = &g_slangModules[i];
+        if (m->session != (uint32_t)session || strcmp(m->path, source_file) != 0)
+            continue;
+
+        if (!slang_module_stale(m)) {
+            g_slangStats.module_hits++;
+            return m;
         }
+
+        // the session would hand back the old module (and its imports)
+        slang_reset_session((uint32_t)session);
+        session = slang_get_session(SLANG_SPIRV, SLANG_PROFILE);
+        if (session < 0)
+            return nullptr;
+        break;
+    }
+
+    if (g_slangModuleCount == SLANG_MAX_MODULES || strlen(source_file) >= SLANG_PATH_MAX) {
+        fprintf(stderr, "Slang: module cache full, skipping cache for %s\n", source_file);
+        return nullptr;
+    }
+
+    IBlob*   diagBlob = nullptr;
+    IModule* module   = g_slangSessions[session].session->loadModule(source_file, &diagBlob);
+    slang_diagnostics("Load", diagBlob);
+    g_slangStats.module_loads++;
+
+    if (!module) {
+        fprintf(stderr, "Slang: Failed to load module: %s\n", source_file);
+        return nullptr;
     }
 
-    // 5. Compose and Compile
-    // Create a composite component type with the module and entry point
-    IComponentType* components[] = { module, entryPoint };
-    IComponentType* program = nullptr;
+    SlangModuleEntry* m = &g_slangModules[g_slangModuleCount++];
+    memset(m, 0, sizeof(*m));
+    snprintf(m->path, sizeof(m->path), "%s", source_file);
+    m->session = (uint32_t)session;
+    m->module  = module;
+
+    slang_add_dep(m, source_file);
+    int32_t dep_count = module->getDependencyFileCount();
+    for (int32_t i = 0; i < dep_count; i++)
+        slang_add_dep(m, module->getDependencyFilePath(i));
+
+    return m;
+}
+
+// ------------------------------------------------------------
+// Compile
+// ------------------------------------------------------------
+
+static bool slang_compile_program(SlangModuleEntry*  m,
+                                  const char* const* entry_points,
+                                  const int*         stages,
+                                  uint32_t           entry_count,
+                                  void**             out_spv,
+                                  size_t*            out_sizes)
+{
+    ISession*        session = g_slangSessions[m->session].session;
+    IComponentType*  components[1 + VK_SLANG_MAX_ENTRIES] = {m->module};
+    IEntryPoint*     entries[VK_SLANG_MAX_ENTRIES]        = {};
+    IComponentType*  composite                            = nullptr;
+    IComponentType*  program                              = nullptr;
+    bool             success                              = true;
+
+    for (uint32_t i = 0; i < entry_count && success; i++)
     {
-        IBlob* diagBlob = nullptr;
-        res = session->createCompositeComponentType(components, 2, &program, &diagBlob);
-        if (diagBlob) {
-            fprintf(stderr, "Slang Diagnostics (Compose): %s\n", (const char*)diagBlob->getBufferPointer());
-            diagBlob->release();
+        SlangResult res = m->module->findEntryPointByName(entry_points[i], &entries[i]);
+        if (SLANG_FAILED(res) || !entries[i])
+        {
+            // no [shader(...)] attribute: look it up with the stage instead
+            SlangStage stage = stages ? slang_stage_from_vk(stages[i]) : SLANG_STAGE_NONE;
+            IBlob*     diagBlob = nullptr;
+            entries[i]          = nullptr;
+            if (stage != SLANG_STAGE_NONE)
+                res = m->module->findAndCheckEntryPoint(entry_points[i], stage, &entries[i], &diagBlob);
+            slang_diagnostics("Entry", diagBlob);
         }
-        if (SLANG_FAILED(res)) {
-            session->release();
-            return false;
+        if (SLANG_FAILED(res) || !entries[i]) {
+            fprintf(stderr, "Slang: Failed to find entry point '%s' in %s\n", entry_points[i], m->path);
+            success = false;
         }
+        components[1 + i] = entries[i];
     }
 
-    // 6. Get Code (SPIR-V)
-    IBlob* codeBlob = nullptr;
-    IBlob* diagBlob = nullptr;
-    res = program->getEntryPointCode(0, 0, &codeBlob, &diagBlob);
-    
-    if (diagBlob) {
-        fprintf(stderr, "Slang Diagnostics (Compile): %s\n", (const char*)diagBlob->getBufferPointer());
-        diagBlob->release();
+    // one program with every entry point: checked, linked and specialized once
+    if (success)
+    {
+        IBlob*      diagBlob = nullptr;
+        SlangResult res      = session->createCompositeComponentType(components, 1 + entry_count, &composite, &diagBlob);
+        slang_diagnostics("Compose", diagBlob);
+        success = SLANG_SUCCEEDED(res) && composite;
     }
-
-    bool success = SLANG_SUCCEEDED(res) && codeBlob;
-    
     if (success)
     {
-        size_t sz = codeBlob->getBufferSize();
-        void* mem = malloc(sz);
-        if (mem) {
-            memcpy(mem, codeBlob->getBufferPointer(), sz);
-            *out_spv = mem;
-            *out_size = sz;
-        } else {
-            success = false;
+        IBlob*      diagBlob = nullptr;
+        SlangResult res      = composite->link(&program, &diagBlob);
+        slang_diagnostics("Link", diagBlob);
+        success = SLANG_SUCCEEDED(res) && program;
+    }
+
+    uint32_t done = 0;
+    for (; success && done < entry_count; done++)
+    {
+        IBlob*      codeBlob = nullptr;
+        IBlob*      diagBlob = nullptr;
+        SlangResult res      = program->getEntryPointCode(done, 0, &codeBlob, &diagBlob);
+        slang_diagnostics("Compile", diagBlob);
+
+        success = SLANG_SUCCEEDED(res) && codeBlob;
+        if (success)
+        {
+            size_t sz  = codeBlob->getBufferSize();
+            void*  mem = malloc(sz);
+            if (mem) {
+                memcpy(mem, codeBlob->getBufferPointer(), sz);
+                out_spv[done]   = mem;
+                out_sizes[done] = sz;
+            } else {
+                success = false;
+            }
+        }
+        if (codeBlob) codeBlob->release();
+    }
+
+    if (!success) {
+        for (uint32_t i = 0; i < done; i++) {
+            free(out_spv[i]);
+            out_spv[i]   = nullptr;
+            out_sizes[i] = 0;
         }
     }
 
-    if (codeBlob) codeBlob->release();
+    // entry points and programs are ours; the module stays with the session
     if (program) program->release();
-    // EntryPoint and Module are owned by session/internalref? 
-    // Actually module is a component type, releasing program releases ref?
-    // Slang ref counting rules... usually safe to release if created.
-    // IModule and IEntryPoint are obtained from session/module. 
-    // We should probably NOT release them manually if they are weak refs, but they are COM pointers.
-    // Usually get... returns AddRef'd pointer.
-    // Documentation says "outEntryPoint...".
-    // We will release them.
-    // entryPoint->release(); // causes crash? verify docs. 
-    // Safe bet: release what we 'get' or 'create'.
-    // createCompositeComponentType -> program. Release program.
-    // loadModule -> module. Release module? No, module is managed by session cache?
-    // Let's release program and session.
-    
-    if (session) session->release(); // This should clean up
+    if (composite) composite->release();
+    for (uint32_t i = 0; i < entry_count; i++)
+        if (entries[i]) entries[i]->release();
+
+    return success;
+}
+
+extern "C" bool vk_slang_compile_entries(const char*        source_file,
+                                         const char* const* entry_points,
+                                         const int*         stages,
+                                         uint32_t           entry_count,
+                                         void**             out_spv,
+                                         size_t*            out_sizes)
+{
+    if (!source_file || !entry_points || !out_spv || !out_sizes || entry_count == 0 || entry_count > VK_SLANG_MAX_ENTRIES)
+        return false;
+
+    for (uint32_t i = 0; i < entry_count; i++) {
+        out_spv[i]   = nullptr;
+        out_sizes[i] = 0;
+    }
+
+    pthread_mutex_lock(&g_slangLock);
+
+    uint64_t request_hash = slang_request_hash(source_file, entry_points, stages, entry_count);
+    if (slang_disk_load(request_hash, entry_count, out_spv, out_sizes))
+    {
+        g_slangStats.disk_hits++;
+        pthread_mutex_unlock(&g_slangLock);
+        return true;
+    }
+
+    uint64_t          t0      = time_now_ns();
+    SlangModuleEntry* m       = slang_get_module(source_file);
+    bool              success = m && slang_compile_program(m, entry_points, stages, entry_count, out_spv, out_sizes);
+    g_slangStats.compile_ns += time_now_ns() - t0;
+
+    if (success) {
+        g_slangStats.programs++;
+        slang_disk_store(request_hash, m, entry_count, out_spv, out_sizes);
+    } else {
+        g_slangStats.failures++;
+    }
 
+    pthread_mutex_unlock(&g_slangLock);
     return success;
 }
+
+extern "C" bool vk_compile_slang(const char* source_file,
+                      const char* entry_point,
+                      int stage,
+                      void** out_spv,
+                      size_t* out_size)
+{
+    if (out_spv) *out_spv = nullptr;
+    if (out_size) *out_size = 0;
+    if (!out_spv || !out_size)
+        return false;
+
+    return vk_slang_compile_entries(source_file, &entry_point, &stage, 1, out_spv, out_size);
+}
+
+extern "C" void vk_slang_get_stats(VkSlangStats* out_stats)
+{
+    pthread_mutex_lock(&g_slangLock);
+    *out_stats = g_slangStats;
+    pthread_mutex_unlock(&g_slangLock);
+}
+
+extern "C" void vk_slang_print_stats(void)
+{
+    VkSlangStats s;
+    vk_slang_get_stats(&s);
+    printf("slang: %u programs compiled (%.1f ms), %u from disk cache, %u module loads, %u module hits, %u sessions, %u failed\n",
+           s.programs, (double)s.compile_ns * 1e-6, s.disk_hits, s.module_loads, s.module_hits, s.sessions, s.failures);
+}
+
+extern "C" void vk_slang_shutdown(void)
+{
+    pthread_mutex_lock(&g_slangLock);
+    for (uint32_t i = 0; i < g_slangSessionCount; i++)
+        slang_reset_session(i);
+    g_slangSessionCount = 0;
+    g_slangModuleCount  = 0;
+
+    if (g_slangGlobalSession) g_slangGlobalSession->release();
+    g_slangGlobalSession = nullptr;
+    pthread_mutex_unlock(&g_slangLock);
+}
@@ -7,13 +7,62 @@
 extern "C" {
 #endif
 
+// In-process Slang compiler.
+//
+// Sessions are long-lived, one per target and profile. Loaded IModules are
+// cached by path and stay valid while the module file and every file it
+// imports keep their mtime. A session cannot unload modules, so when a cached
+// module goes stale (editing or hot reload), its whole session is replaced.
+//
+// vk_slang_compile_entries() links every requested entry point of a module
+// into one program, so the vertex and fragment stages of a file are
+// parsed and checked once.
+//
+// Results also go to an on-disk SPIR-V cache (VK_SLANG_CACHE_DIR). There is
+// one file per source + entry list + profile. It records the xxHash64 of the
+// source and of every include dependency. While those hashes match, the
+// stored SPIR-V is returned without creating a Slang session at all. Delete
+// the directory after upgrading Slang.
+//
+// All functions are thread safe (one lock around the compiler).
+
+#define VK_SLANG_CACHE_DIR     "compiledshaders/slang_cache"
+#define VK_SLANG_MAX_ENTRIES   8
+
+typedef struct VkSlangStats
+{
+    uint32_t disk_hits;      // served from VK_SLANG_CACHE_DIR
+    uint32_t module_hits;    // cached IModule reused
+    uint32_t module_loads;   // loadModule calls
+    uint32_t sessions;       // sessions created (first use and stale resets)
+    uint32_t programs;       // linked programs compiled
+    uint32_t failures;
+    uint64_t compile_ns;     // inside Slang: load, link and codegen
+} VkSlangStats;
+
+// stages: VkShaderStageFlagBits per entry (may be NULL; used when an entry
+// has no [shader(...)] attribute). On success out_spv[i] (malloc, caller
+// frees) and out_sizes[i] hold the SPIR-V of entry_points[i].
+bool vk_slang_compile_entries(const char*        source_file,
+                              const char* const* entry_points,
+                              const int*         stages,
+                              uint32_t           entry_count,
+                              void**             out_spv,
+                              size_t*            out_sizes);
+
 // stage: matches VkShaderStageFlagBits
-bool vk_compile_slang(const char* source_file, 
-                      const char* entry_point, 
-                      int stage, 
-                      void** out_spv, 
+bool vk_compile_slang(const char* source_file,
+                      const char* entry_point,
+                      int stage,
+                      void** out_spv,
                       size_t* out_size);
 
+void vk_slang_get_stats(VkSlangStats* out_stats);
+void vk_slang_print_stats(void);
+
+// Releases the sessions (and with them every cached module) and the global session.
+void vk_slang_shutdown(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,305 @@
+#include "vk_staging.h"
+#include "vk_cmd.h"
+#include "vk_queue.h"
+
+static VkDeviceSize align_up(VkDeviceSize v, VkDeviceSize a)
+{
+    return (v + a - 1) & ~(a - 1);
+}
+
+void staging_ring_init(StagingRing* ring, ResourceAllocator* allocator, VkDeviceSize capacity, uint32_t frame_count)
+{
+    memset(ring, 0, sizeof(*ring));
+
+    assert(frame_count > 0 && frame_count <= STAGING_MAX_FRAMES);
+    ring->allocator   = allocator;
+    ring->capacity    = align_up(capacity, 256);
+    ring->frame_count = frame_count;
+    ring->src_family  = VK_QUEUE_FAMILY_IGNORED;
+    ring->dst_family  = VK_QUEUE_FAMILY_IGNORED;
+
+    res_create_buffer(allocator, ring->capacity, VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_AUTO,
+                      VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, 0, &ring->buffer);
+}
+
+void staging_ring_destroy(StagingRing* ring)
+{
+    if(!ring || !ring->allocator)
+        return;
+
+    if(ring->immediate)
+        staging_ring_end_immediate(ring);
+
+    res_destroy_buffer(ring->allocator, &ring->buffer);
+    arrfree(ring->acquire_buffers);
+    arrfree(ring->acquire_images);
+    memset(ring, 0, sizeof(*ring));
+}
+
+void staging_ring_begin_frame(StagingRing* ring, uint32_t frame, VkCommandBuffer cmd)
+{
+    assert(!ring->immediate && frame < ring->frame_count);
+
+    // frames retire in order, so once this slot's fence is done everything
+    // staged before its last recording ended is free
+    ring->frame_end[ring->frame] = ring->head;
+    ring->tail                   = MAX(ring->tail, ring->frame_end[frame]);
+    ring->frame                  = frame;
+    ring->cmd                    = cmd;
+}
+
+void staging_ring_begin_immediate(StagingRing* ring, VkQueue queue, VkCommandPool pool)
+{
+    assert(!ring->immediate);
+
+    ring->immediate = true;
+    ring->queue     = queue;
+    ring->pool      = pool;
+    ring->cmd       = VK_NULL_HANDLE;
+}
+
+void staging_ring_flush(StagingRing* ring)
+{
+    assert(ring->immediate);
+
+    if(ring->cmd)
+    {
+        end_one_time_cmd(ring->allocator->device, ring->queue, ring->pool, ring->cmd);
+        ring->cmd = VK_NULL_HANDLE;
+        ring->stats.flushes++;
+    }
+    else
+    {
+        // frames recorded before immediate mode may still be reading the ring
+        vk_queue_lock();
+        VK_CHECK(vkQueueWaitIdle(ring->queue));
+        vk_queue_unlock();
+    }
+    ring->tail = ring->head;
+}
+
+void staging_ring_end_immediate(StagingRing* ring)
+{
+    staging_ring_flush(ring);
+
+    ring->immediate = false;
+    ring->queue     = VK_NULL_HANDLE;
+    ring->pool      = VK_NULL_HANDLE;
+    for(uint32_t i = 0; i < ring->frame_count; i++)
+        ring->frame_end[i] = ring->head;
+}
+
+VkCommandBuffer staging_ring_cmd(StagingRing* ring)
+{
+    if(!ring->cmd && ring->immediate)
+        ring->cmd = begin_one_time_cmd(ring->allocator->device, ring->pool);
+    return ring->cmd;
+}
+
+static bool ring_try_alloc(StagingRing* ring, VkDeviceSize size, VkDeviceSize alignment, StagingAlloc* out)
+{
+    // empty: restart at offset 0 so a near-capacity allocation never has to wrap
+    if(ring->head == ring->tail)
+    {
+        ring->head = (ring->head + ring->capacity - 1) / ring->capacity * ring->capacity;
+        ring->tail = ring->head;
+    }
+
+    VkDeviceSize pos    = align_up(ring->head, alignment);
+    VkDeviceSize offset = pos % ring->capacity;
+    if(offset + size > ring->capacity)
+    {
+        pos += ring->capacity - offset;
+        offset = 0;
+    }
+
+    if(pos + size - ring->tail > ring->capacity)
+        return false;
+
+    ring->head   = pos + size;
+    out->buffer  = ring->buffer.buffer;
+    out->offset  = offset;
+    out->mapping = ring->buffer.mapping + offset;
+    return true;
+}
+
+bool staging_ring_alloc(StagingRing* ring, VkDeviceSize size, VkDeviceSize alignment, StagingAlloc* out)
+{
+    alignment = MAX(alignment, (VkDeviceSize)STAGING_ALIGNMENT);
+    if(size == 0 || size > ring->capacity)
+        return false;
+
+    if(ring_try_alloc(ring, size, alignment, out))
+        return true;
+
+    if(!ring->immediate)
+    {
+        ring->stats.full++;
+        return false;
+    }
+
+    staging_ring_flush(ring);
+    return ring_try_alloc(ring, size, alignment, out);
+}
+
+void staging_ring_commit(StagingRing* ring, const StagingAlloc* a, VkDeviceSize size)
+{
+    // no-op on HOST_COHERENT memory, which VMA picks for this usage on most devices
+    vmaFlushAllocation(ring->allocator->allocator, ring->buffer.allocation, a->offset, size);
+    ring->stats.bytes += size;
+}
+
+static bool ring_hands_off(const StagingRing* ring)
+{
+    return ring->src_family != VK_QUEUE_FAMILY_IGNORED && ring->src_family != ring->dst_family;
+}
+
+// Release on this queue; the acquire half waits in the ring for the receiver.
+// The receiver's semaphore wait orders the acquire, so its src stage is the
+// consumer stage rather than the copy.
+static void release_buffer(StagingRing* ring, VkCommandBuffer cmd, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size)
+{
+    VkBufferMemoryBarrier2 release = {
+        .sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+        .srcStageMask        = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+        .srcAccessMask       = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+        .srcQueueFamilyIndex = ring->src_family,
+        .dstQueueFamilyIndex = ring->dst_family,
+        .buffer              = buffer,
+        .offset              = offset,
+        .size                = size,
+    };
+    VkDependencyInfo dep = {
+        .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .bufferMemoryBarrierCount = 1,
+        .pBufferMemoryBarriers    = &release,
+    };
+    vkCmdPipelineBarrier2(cmd, &dep);
+
+    VkBufferMemoryBarrier2 acquire = release;
+    acquire.srcStageMask           = STAGING_ACQUIRE_STAGES;
+    acquire.srcAccessMask          = 0;
+    acquire.dstStageMask           = STAGING_ACQUIRE_STAGES;
+    acquire.dstAccessMask          = VK_ACCESS_2_MEMORY_READ_BIT;
+    arrpush(ring->acquire_buffers, acquire);
+}
+
+static void release_image(StagingRing* ring, VkCommandBuffer cmd, Image* img)
+{
+    VkImageMemoryBarrier2 release = {
+        .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+        .srcStageMask        = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+        .srcAccessMask       = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+        .oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        .newLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        .srcQueueFamilyIndex = ring->src_family,
+        .dstQueueFamilyIndex = ring->dst_family,
+        .image               = img->image,
+        .subresourceRange =
+            {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .levelCount = VK_REMAINING_MIP_LEVELS,
+                .layerCount = VK_REMAINING_ARRAY_LAYERS,
+            },
+    };
+    VkDependencyInfo dep = {
+        .sType                   = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .imageMemoryBarrierCount = 1,
+        .pImageMemoryBarriers    = &release,
+    };
+    vkCmdPipelineBarrier2(cmd, &dep);
+
+    VkImageMemoryBarrier2 acquire = release;
+    acquire.srcStageMask          = STAGING_ACQUIRE_STAGES;
+    acquire.srcAccessMask         = 0;
+    acquire.dstStageMask          = STAGING_ACQUIRE_STAGES;
+    acquire.dstAccessMask         = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+    arrpush(ring->acquire_images, acquire);
+
+    // what the receiving queue sees once it recorded the acquire
+    img->state.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    img->state.stage  = STAGING_ACQUIRE_STAGES;
+    img->state.access = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+}
+
+static void staging_write(StagingRing* ring, const StagingAlloc* a, const void* src, VkDeviceSize size)
+{
+    memcpy(a->mapping, src, (size_t)size);
+    staging_ring_commit(ring, a, size);
+}
+
+bool staging_upload_buffer(StagingRing* ring, VkBuffer dst, VkDeviceSize dst_offset, const void* src, VkDeviceSize size)
+{
+    assert(src && size > 0);
+
+    const uint8_t* bytes = (const uint8_t*)src;
+    if(!ring->immediate && size > ring->capacity)
+    {
+        ring->stats.full++;
+        return false;
+    }
+
+    // half the ring per chunk keeps the next chunk's flush from waiting on a
+    // ring that is only partly used
+    VkDeviceSize chunk_max = ring->immediate ? ring->capacity / 2 : size;
+    for(VkDeviceSize done = 0; done < size;)
+    {
+        VkDeviceSize chunk = MIN(size - done, chunk_max);
+        StagingAlloc a     = {0};
+        if(!staging_ring_alloc(ring, chunk, STAGING_ALIGNMENT, &a))
+            return false;
+
+        staging_write(ring, &a, bytes + done, chunk);
+
+        VkBufferCopy copy = {.srcOffset = a.offset, .dstOffset = dst_offset + done, .size = chunk};
+        vkCmdCopyBuffer(staging_ring_cmd(ring), a.buffer, dst, 1, &copy);
+        done += chunk;
+    }
+
+    if(ring_hands_off(ring))
+        release_buffer(ring, staging_ring_cmd(ring), dst, dst_offset, size);
+
+    ring->stats.uploads++;
+    return true;
+}
+
+bool staging_upload_image(StagingRing* ring, Image* dst, const void* src, VkDeviceSize size)
+{
+    assert(src && size > 0);
+
+    StagingAlloc a = {0};
+    if(!staging_ring_alloc(ring, size, STAGING_ALIGNMENT, &a))
+        return false;
+
+    staging_write(ring, &a, src, size);
+    staging_copy_to_image(ring, &a, dst);
+
+    ring->stats.uploads++;
+    return true;
+}
+
+void staging_copy_to_image(StagingRing* ring, const StagingAlloc* src, Image* dst)
+{
+    VkCommandBuffer cmd = staging_ring_cmd(ring);
+
+    // the old state belongs to the other queue family; its stages may not even
+    // exist on this queue
+    if(ring_hands_off(ring))
+        image_state_reset(dst);
+    image_to_transfer_dst(cmd, dst);
+
+    VkBufferImageCopy region = {
+        .bufferOffset      = src->offset,
+        .bufferRowLength   = 0,
+        .bufferImageHeight = 0,
+        .imageSubresource = {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .mipLevel = 0, .baseArrayLayer = 0, .layerCount = 1},
+        .imageOffset = {0, 0, 0},
+        .imageExtent = dst->extent,
+    };
+    vkCmdCopyBufferToImage(cmd, src->buffer, dst->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+    if(ring_hands_off(ring))
+        release_image(ring, cmd, dst);
+    else
+        image_to_sampled(cmd, dst);
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "vk_resources.h"
+
+// Persistent staging ring.
+//
+// One persistently mapped TRANSFER_SRC buffer, suballocated linearly. head and
+// tail are running byte positions (offset = pos % capacity); an allocation
+// that would straddle the end skips to the start of the buffer.
+//
+// Frame mode: staging_ring_begin_frame(frame, cmd) right after the frame's
+// fence wait. Everything that frame slot staged the last time it was recorded
+// is free again, and uploads until the next begin record their copies into
+// cmd. Nothing blocks: an upload that does not fit returns false and can be
+// retried next frame. The caller orders the copies against their consumers.
+//
+// Immediate mode: outside the frame loop (startup, tools, between frames)
+// uploads record into a one-time command buffer of the ring; when the ring is
+// full it is flushed (submit + queue idle) and the upload goes on, so any size
+// works for buffers.
+//
+// Queue hand-off: with src_family != dst_family (set by UploadEngine, see
+// vk_upload.h) the ring records on a transfer queue. Every upload ends in a
+// release barrier to dst_family and leaves the matching acquire barrier in
+// acquire_buffers / acquire_images for the receiving queue to record.
+
+#define STAGING_MAX_FRAMES 4
+#define STAGING_ALIGNMENT 16
+
+// Where handed-off uploads may first be used on the receiving queue.
+#define STAGING_ACQUIRE_STAGES (VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT)
+
+typedef struct StagingAlloc
+{
+    VkBuffer     buffer;
+    VkDeviceSize offset;
+    uint8_t*     mapping;
+} StagingAlloc;
+
+typedef struct StagingStats
+{
+    uint64_t bytes;
+    uint32_t uploads;
+    uint32_t flushes;  // immediate mode submits
+    uint32_t full;     // frame mode uploads refused for space
+} StagingStats;
+
+typedef struct StagingRing
+{
+    ResourceAllocator* allocator;
+    Buffer             buffer;
+    VkDeviceSize       capacity;
+
+    VkDeviceSize head;
+    VkDeviceSize tail;
+    VkDeviceSize frame_end[STAGING_MAX_FRAMES];  // head when the slot's last frame was done recording
+    uint32_t     frame_count;
+    uint32_t     frame;
+
+    VkCommandBuffer cmd;  // current frame's, or the immediate one (NULL until the first upload)
+
+    bool          immediate;
+    VkQueue       queue;
+    VkCommandPool pool;
+
+    uint32_t                src_family;  // VK_QUEUE_FAMILY_IGNORED: no ownership transfer
+    uint32_t                dst_family;
+    VkBufferMemoryBarrier2* acquire_buffers;  // stb_ds
+    VkImageMemoryBarrier2*  acquire_images;   // stb_ds
+
+    StagingStats stats;
+} StagingRing;
+
+void staging_ring_init(StagingRing* ring, ResourceAllocator* allocator, VkDeviceSize capacity, uint32_t frame_count);
+void staging_ring_destroy(StagingRing* ring);
+
+void staging_ring_begin_frame(StagingRing* ring, uint32_t frame, VkCommandBuffer cmd);
+
+void staging_ring_begin_immediate(StagingRing* ring, VkQueue queue, VkCommandPool pool);
+// Submits what was recorded, waits for it and frees the whole ring.
+void staging_ring_flush(StagingRing* ring);
+void staging_ring_end_immediate(StagingRing* ring);
+
+// Raw space for callers that write or decode straight into staging. Frame mode
+// returns false when size does not fit; immediate mode flushes first. Call
+// staging_ring_commit once written, before recording the copy.
+bool staging_ring_alloc(StagingRing* ring, VkDeviceSize size, VkDeviceSize alignment, StagingAlloc* out);
+void staging_ring_commit(StagingRing* ring, const StagingAlloc* alloc, VkDeviceSize size);
+
+// Command buffer the next copies go into (opens the immediate one on demand).
+VkCommandBuffer staging_ring_cmd(StagingRing* ring);
+
+// Copies src into staging and records the copy to dst. Immediate mode splits
+// uploads larger than the ring; frame mode stages all or nothing.
+bool staging_upload_buffer(StagingRing* ring, VkBuffer dst, VkDeviceSize dst_offset, const void* src, VkDeviceSize size);
+
+// Whole mip 0 of dst from tightly packed texels; leaves dst sampled.
+bool staging_upload_image(StagingRing* ring, Image* dst, const void* src, VkDeviceSize size);
+
+// Records the copy of a committed allocation into mip 0 of dst (single-level
+// images) and the transition to sampled. With a queue hand-off dst starts from
+// UNDEFINED (old contents discarded) and ends released to dst_family.
+void staging_copy_to_image(StagingRing* ring, const StagingAlloc* src, Image* dst);
@@ -158,6 +158,8 @@ RendererCaps default_caps(void)
         .robustness2               = false, // I’ll explain below
         .index_type_uint8          = true,
         .subgroup_size_control     = false, // enable later if you need it
+        .texture_compression_bc    = true,
+        .draw_indirect_first_instance = true,
     };
 }
 
@@ -215,9 +217,11 @@ TRY_ENABLE(sampler_anisotropy, f->core.features.samplerAnisotropy, "samplerAniso
     TRY_ENABLE(descriptor_indexing, f->v12.descriptorIndexing, "descriptor indexing (vulkan 1.2)");
     TRY_ENABLE(timeline_semaphores, f->v12.timelineSemaphore, "timeline semaphores");
     TRY_ENABLE(multi_draw_indirect, f->core.features.multiDrawIndirect, "multi-draw indirect");
+    TRY_ENABLE(draw_indirect_first_instance, f->core.features.drawIndirectFirstInstance, "drawIndirectFirstInstance");
     TRY_ENABLE(multi_draw_indirect_count, f->v12.drawIndirectCount, "multi-draw indirect count (v1.2)");
     TRY_ENABLE(buffer_device_address, f->v12.bufferDeviceAddress, "buffer device address");
     TRY_ENABLE(maintenance4, f->v13.maintenance4, "maintenance4");
+    TRY_ENABLE(texture_compression_bc, f->core.features.textureCompressionBC, "textureCompressionBC");
 
     if(caps->bindless_textures)
     {
@@ -235,6 +239,9 @@ TRY_ENABLE(sampler_anisotropy, f->core.features.samplerAnisotropy, "samplerAniso
 
         enable_desc_indexing_feature(&f->v12.descriptorBindingSampledImageUpdateAfterBind, "descriptorBindingSampledImageUpdateAfterBind");
 
+        // bindless slots are written while frames that do not use them are in flight
+        enable_desc_indexing_feature(&f->v12.descriptorBindingUpdateUnusedWhilePending, "descriptorBindingUpdateUnusedWhilePending");
+
         enable_desc_indexing_feature(&f->v12.shaderSampledImageArrayNonUniformIndexing, "shaderSampledImageArrayNonUniformIndexing");
     }
 
@@ -630,6 +637,17 @@ void create_device(VkPhysicalDevice physical, VkSurfaceKHR surface, renderer_con
         log_info("[extensions] unavailable: %s", VK_KHR_MAINTENANCE_5_EXTENSION_NAME);
     }
 
+    // optional memory budget: VMA reports real heap budgets (texture streaming)
+    if(device_has_extension(physical, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME))
+    {
+        exts[ext_count++] = VK_EXT_MEMORY_BUDGET_EXTENSION_NAME;
+        log_info("[extensions] enabled: %s", VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+    else
+    {
+        log_info("[extensions] unavailable: %s", VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+
     VkDeviceCreateInfo info = {.sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
                                .pNext                   = &features.core,
                                .queueCreateInfoCount    = uf_count,
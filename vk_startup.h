@@ -102,6 +102,8 @@ typedef struct RendererCaps {
     bool robustness2;          // NEW
     bool index_type_uint8;     // NEW
     bool subgroup_size_control;// NEW
+    bool texture_compression_bc; // DDS/KTX BC1-BC7 uploads (texture_file.c)
+    bool draw_indirect_first_instance; // instanced indirect commands (draw_batch.comp)
 } RendererCaps;
 
 //
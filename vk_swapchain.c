@@ -2,6 +2,7 @@
 #include "vk_sync.h"
 #include "vk_barrier.h"
 #include "vk_cmd.h"
+#include "vk_queue.h"
 #include <vulkan/vulkan_core.h>
 VkSurfaceCapabilities2KHR query_surface_capabilities(VkPhysicalDevice gpu, VkSurfaceKHR surface)
 {
@@ -207,7 +208,9 @@ bool vk_swapchain_present(VkQueue present_queue, FlowSwapchain* sc, const VkSema
         .pImageIndices      = &sc->current_image,
     };
 
+    vk_queue_lock();
     VkResult r = vkQueuePresentKHR(present_queue, &info);
+    vk_queue_unlock();
 
     if(r == VK_ERROR_OUT_OF_DATE_KHR || r == VK_SUBOPTIMAL_KHR)
     {
@@ -264,7 +267,9 @@ void vk_swapchain_recreate(VkDevice device, VkPhysicalDevice gpu, FlowSwapchain*
 {
     if(new_w == 0 || new_h == 0)
         return;
+    vk_queue_lock();
     vkDeviceWaitIdle(device);
+    vk_queue_unlock();
 
 
     forEach(i, sc->image_count)
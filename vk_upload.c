@@ -0,0 +1,379 @@
+#include "vk_upload.h"
+#include "vk_cmd.h"
+
+void upload_engine_init(UploadEngine* engine, ResourceAllocator* allocator, const queue_families* qf, VkDeviceSize ring_capacity)
+{
+    memset(engine, 0, sizeof(*engine));
+
+    engine->device    = allocator->device;
+    engine->dedicated = qf->has_transfer && qf->transfer_queue && qf->transfer_family != qf->graphics_family;
+    engine->queue     = engine->dedicated ? qf->transfer_queue : qf->graphics_queue;
+    engine->family    = engine->dedicated ? qf->transfer_family : qf->graphics_family;
+
+    staging_ring_init(&engine->ring, allocator, ring_capacity, UPLOAD_ENGINE_BATCHES);
+    if(engine->dedicated)
+    {
+        engine->ring.src_family = qf->transfer_family;
+        engine->ring.dst_family = qf->graphics_family;
+    }
+
+    VkSemaphoreTypeCreateInfo type_info = {
+        .sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+        .initialValue  = 0,
+    };
+    VkSemaphoreCreateInfo sem_info = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &type_info,
+    };
+    VK_CHECK(vkCreateSemaphore(engine->device, &sem_info, NULL, &engine->timeline));
+
+    vk_cmd_create_many_pools(engine->device, engine->family, true, false, UPLOAD_ENGINE_BATCHES, engine->pools);
+    for(uint32_t i = 0; i < UPLOAD_ENGINE_BATCHES; i++)
+        vk_cmd_alloc(engine->device, engine->pools[i], true, &engine->cmds[i]);
+
+    log_info("[upload] %s queue family %u", engine->dedicated ? "transfer" : "graphics", engine->family);
+}
+
+static void wait_value(UploadEngine* engine, uint64_t value)
+{
+    VkSemaphoreWaitInfo wait_info = {
+        .sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+        .semaphoreCount = 1,
+        .pSemaphores    = &engine->timeline,
+        .pValues        = &value,
+    };
+    VK_CHECK(vkWaitSemaphores(engine->device, &wait_info, UINT64_MAX));
+}
+
+void upload_engine_destroy(UploadEngine* engine)
+{
+    if(!engine || !engine->device)
+        return;
+
+    if(engine->recording)
+        upload_engine_submit(engine);
+    wait_value(engine, engine->submitted);
+
+    vk_cmd_destroy_many_pools(engine->device, UPLOAD_ENGINE_BATCHES, engine->pools);
+    vkDestroySemaphore(engine->device, engine->timeline, NULL);
+    staging_ring_destroy(&engine->ring);
+    arrfree(engine->acquire_buffers);
+    arrfree(engine->acquire_images);
+
+    memset(engine, 0, sizeof(*engine));
+}
+
+StagingRing* upload_engine_begin(UploadEngine* engine)
+{
+    if(engine->recording)
+        return &engine->ring;
+
+    uint32_t slot = engine->batch;
+
+    // the slot's command buffer and staging come back once its batch is done
+    uint64_t done = 0;
+    VK_CHECK(vkGetSemaphoreCounterValue(engine->device, engine->timeline, &done));
+    if(done < engine->batch_value[slot])
+    {
+        engine->stats.stalls++;
+        wait_value(engine, engine->batch_value[slot]);
+    }
+
+    vk_cmd_reset_pool(engine->device, engine->pools[slot]);
+    vk_cmd_begin(engine->cmds[slot], true);
+    staging_ring_begin_frame(&engine->ring, slot, engine->cmds[slot]);
+
+    engine->recording = true;
+    return &engine->ring;
+}
+
+uint64_t upload_engine_submit(UploadEngine* engine)
+{
+    if(!engine->recording)
+        return 0;
+
+    uint32_t        slot = engine->batch;
+    VkCommandBuffer cmd  = engine->cmds[slot];
+    vk_cmd_end(cmd);
+
+    uint64_t value = ++engine->submitted;
+
+    VkCommandBufferSubmitInfo cmd_info = {
+        .sType         = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+        .commandBuffer = cmd,
+    };
+
+    VkSemaphoreSubmitInfo signal = {
+        .sType     = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+        .semaphore = engine->timeline,
+        .value     = value,
+        .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+    };
+
+    VkSubmitInfo2 submit = {
+        .sType                    = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+        .commandBufferInfoCount   = 1,
+        .pCommandBufferInfos      = &cmd_info,
+        .signalSemaphoreInfoCount = 1,
+        .pSignalSemaphoreInfos    = &signal,
+    };
+
+    vk_queue_lock();
+    VK_CHECK(vkQueueSubmit2(engine->queue, 1, &submit, VK_NULL_HANDLE));
+    vk_queue_unlock();
+
+    // the acquires belong to this batch now, not to the next one being recorded
+    StagingRing* ring = &engine->ring;
+    for(uint32_t i = 0; i < (uint32_t)arrlen(ring->acquire_buffers); i++)
+        arrpush(engine->acquire_buffers, ring->acquire_buffers[i]);
+    for(uint32_t i = 0; i < (uint32_t)arrlen(ring->acquire_images); i++)
+        arrpush(engine->acquire_images, ring->acquire_images[i]);
+    arrsetlen(ring->acquire_buffers, 0);
+    arrsetlen(ring->acquire_images, 0);
+
+    engine->batch_value[slot] = value;
+    engine->batch             = (slot + 1) % UPLOAD_ENGINE_BATCHES;
+    engine->recording         = false;
+    engine->stats.batches++;
+    return value;
+}
+
+bool upload_engine_acquire(UploadEngine* engine, VkCommandBuffer cmd, VkSemaphoreSubmitInfo* out_wait)
+{
+    if(engine->acquired == engine->submitted)
+        return false;
+
+    uint32_t buffer_count = (uint32_t)arrlen(engine->acquire_buffers);
+    uint32_t image_count  = (uint32_t)arrlen(engine->acquire_images);
+    if(buffer_count + image_count > 0)
+    {
+        VkDependencyInfo dep = {
+            .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+            .bufferMemoryBarrierCount = buffer_count,
+            .pBufferMemoryBarriers    = engine->acquire_buffers,
+            .imageMemoryBarrierCount  = image_count,
+            .pImageMemoryBarriers     = engine->acquire_images,
+        };
+        vkCmdPipelineBarrier2(cmd, &dep);
+        arrsetlen(engine->acquire_buffers, 0);
+        arrsetlen(engine->acquire_images, 0);
+    }
+
+    // the acquires' src stages, so they run after the wait
+    *out_wait = (VkSemaphoreSubmitInfo){
+        .sType     = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+        .semaphore = engine->timeline,
+        .value     = engine->submitted,
+        .stageMask = STAGING_ACQUIRE_STAGES,
+    };
+    engine->acquired = engine->submitted;
+    return true;
+}
+
+#define UPLOAD_BATCH_ALIGN 16ull
+
+static bool batch_fill_copy(void* user, void* dst, VkDeviceSize size)
+{
+    memcpy(dst, user, (size_t)size);
+    return true;
+}
+
+static void batch_push(UploadBatch* batch, UploadBatchItem item)
+{
+    item.staging_offset = (batch->staging_size + UPLOAD_BATCH_ALIGN - 1) & ~(UPLOAD_BATCH_ALIGN - 1);
+    batch->staging_size = item.staging_offset + item.size;
+    arrpush(batch->items, item);
+}
+
+void upload_batch_begin(UploadBatch* batch, ResourceAllocator* allocator)
+{
+    memset(batch, 0, sizeof(*batch));
+    batch->allocator = allocator;
+}
+
+void upload_batch_buffer(UploadBatch* batch, VkBuffer dst, VkDeviceSize dst_offset, const void* src, VkDeviceSize size)
+{
+    assert(src && size > 0);
+    upload_batch_buffer_fill(batch, dst, dst_offset, size, batch_fill_copy, (void*)src);
+}
+
+void upload_batch_buffer_fill(UploadBatch* batch, VkBuffer dst, VkDeviceSize dst_offset, VkDeviceSize size, UploadFillFn fill, void* user)
+{
+    assert(fill && size > 0);
+    batch_push(batch, (UploadBatchItem){.buffer = dst, .dst_offset = dst_offset, .size = size, .fill = fill, .user = user});
+}
+
+void upload_batch_image(UploadBatch* batch, Image* dst, const void* src, VkDeviceSize size)
+{
+    assert(dst && src && size > 0);
+    batch_push(batch, (UploadBatchItem){.image = dst, .size = size, .fill = batch_fill_copy, .user = (void*)src});
+}
+
+static VkImageMemoryBarrier2 batch_image_barrier(Image* img, VkImageLayout layout, VkPipelineStageFlags2 stage, VkAccessFlags2 access)
+{
+    VkImageMemoryBarrier2 barrier = {
+        .sType         = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+        .srcStageMask  = img->state.stage,
+        .srcAccessMask = img->state.access,
+        .dstStageMask  = stage,
+        .dstAccessMask = access,
+        .oldLayout     = img->state.layout,
+        .newLayout     = layout,
+        .image         = img->image,
+        .subresourceRange =
+            {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .levelCount = VK_REMAINING_MIP_LEVELS,
+                .layerCount = VK_REMAINING_ARRAY_LAYERS,
+            },
+    };
+
+    img->state.layout = layout;
+    img->state.stage  = stage;
+    img->state.access = access;
+    return barrier;
+}
+
+bool upload_batch_submit(UploadBatch* batch, VkQueue queue, VkCommandPool pool, UploadBatchStats* out_stats)
+{
+    UploadBatchStats stats = {0};
+    uint32_t         count = (uint32_t)arrlen(batch->items);
+    bool             ok    = true;
+
+    if(count == 0)
+    {
+        if(out_stats)
+            *out_stats = stats;
+        return true;
+    }
+
+    uint64_t t0 = time_now_ns();
+
+    Buffer staging = {0};
+    res_create_buffer(batch->allocator, batch->staging_size, VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_AUTO,
+                      VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, 0, &staging);
+
+    for(uint32_t i = 0; i < count && ok; i++)
+    {
+        UploadBatchItem* item = &batch->items[i];
+        ok                    = item->fill(item->user, staging.mapping + item->staging_offset, item->size);
+
+        stats.bytes += item->size;
+        if(item->image)
+            stats.images++;
+        else
+            stats.buffers++;
+    }
+    if(ok)
+        vmaFlushAllocation(batch->allocator->allocator, staging.allocation, 0, VK_WHOLE_SIZE);
+
+    uint64_t t1   = time_now_ns();
+    stats.fill_ms = time_ns_to_ms(t1 - t0);
+
+    if(ok)
+    {
+        VkCommandBuffer cmd = begin_one_time_cmd(batch->allocator->device, pool);
+
+        VkImageMemoryBarrier2* image_barriers = NULL;  // stb_ds
+        VkBufferCopy*          regions        = NULL;  // stb_ds
+        bool*                  done           = (bool*)calloc(count, sizeof(bool));
+
+        for(uint32_t i = 0; i < count; i++)
+        {
+            if(batch->items[i].image)
+                arrpush(image_barriers, batch_image_barrier(batch->items[i].image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                                            VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT));
+        }
+        if(arrlen(image_barriers) > 0)
+        {
+            VkDependencyInfo dep = {
+                .sType                   = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+                .imageMemoryBarrierCount = (uint32_t)arrlen(image_barriers),
+                .pImageMemoryBarriers    = image_barriers,
+            };
+            vkCmdPipelineBarrier2(cmd, &dep);
+        }
+
+        // every region bound for the same buffer goes out in one call
+        for(uint32_t i = 0; i < count; i++)
+        {
+            UploadBatchItem* item = &batch->items[i];
+            if(done[i])
+                continue;
+
+            if(item->image)
+            {
+                VkBufferImageCopy region = {
+                    .bufferOffset     = item->staging_offset,
+                    .imageSubresource = {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .mipLevel = 0, .baseArrayLayer = 0, .layerCount = 1},
+                    .imageExtent      = item->image->extent,
+                };
+                vkCmdCopyBufferToImage(cmd, staging.buffer, item->image->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+                stats.copy_cmds++;
+                continue;
+            }
+
+            arrsetlen(regions, 0);
+            for(uint32_t k = i; k < count; k++)
+            {
+                UploadBatchItem* other = &batch->items[k];
+                if(done[k] || other->image || other->buffer != item->buffer)
+                    continue;
+                VkBufferCopy region = {.srcOffset = other->staging_offset, .dstOffset = other->dst_offset, .size = other->size};
+                arrpush(regions, region);
+                done[k] = true;
+            }
+            vkCmdCopyBuffer(cmd, staging.buffer, item->buffer, (uint32_t)arrlen(regions), regions);
+            stats.copy_cmds++;
+        }
+
+        // one barrier: images to sampled, buffer writes visible to whatever reads them next
+        arrsetlen(image_barriers, 0);
+        for(uint32_t i = 0; i < count; i++)
+        {
+            if(batch->items[i].image)
+                arrpush(image_barriers,
+                        batch_image_barrier(batch->items[i].image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                            VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                                            VK_ACCESS_2_SHADER_SAMPLED_READ_BIT));
+        }
+        VkMemoryBarrier2 memory = {
+            .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+            .srcStageMask  = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+            .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            .dstStageMask  = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            .dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT,
+        };
+        VkDependencyInfo dep = {
+            .sType                   = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+            .memoryBarrierCount      = stats.buffers > 0 ? 1u : 0u,
+            .pMemoryBarriers         = &memory,
+            .imageMemoryBarrierCount = (uint32_t)arrlen(image_barriers),
+            .pImageMemoryBarriers    = image_barriers,
+        };
+        vkCmdPipelineBarrier2(cmd, &dep);
+
+        end_one_time_cmd(batch->allocator->device, queue, pool, cmd);
+
+        free(done);
+        arrfree(regions);
+        arrfree(image_barriers);
+    }
+
+    stats.submit_ms = time_ns_to_ms(time_now_ns() - t1);
+
+    res_destroy_buffer(batch->allocator, &staging);
+    arrfree(batch->items);
+    batch->staging_size = 0;
+
+    if(out_stats)
+        *out_stats = stats;
+    return ok;
+}
+
+void upload_batch_print_stats(const char* label, const UploadBatchStats* s)
+{
+    printf("uploads %s: %u buffers, %u images, %.2f MB in %u copies, fill %.2f ms, submit %.2f ms\n", label, s->buffers,
+           s->images, (double)s->bytes / (1024.0 * 1024.0), s->copy_cmds, s->fill_ms, s->submit_ms);
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "vk_queue.h"
+#include "vk_staging.h"
+
+// Upload engine: streaming uploads on the dedicated transfer queue.
+//
+// Uploads are recorded into batches, each a StagingRing frame (vk_staging.h)
+// with its own command buffer. upload_engine_submit() puts the batch on the
+// transfer queue and signals the engine's timeline semaphore with the batch
+// number. Every upload ends in a queue-family release to graphics; the frame
+// loop calls upload_engine_acquire() on its command buffer, which records the
+// matching acquires and hands back the timeline wait for the graphics submit.
+// The copies therefore run beside rendering instead of in front of it.
+//
+// Without a separate transfer family the same batches go to the graphics
+// queue: no ownership transfer, images end sampled, the timeline wait stays.
+//
+// Destinations must not be in use by GPU work still queued on other queues;
+// the transfer queue is not ordered against them.
+
+#define UPLOAD_ENGINE_BATCHES STAGING_MAX_FRAMES
+
+typedef struct UploadEngineStats
+{
+    uint32_t batches;
+    uint32_t stalls;  // batch slot still in flight when reopened
+} UploadEngineStats;
+
+typedef struct UploadEngine
+{
+    VkDevice device;
+    VkQueue  queue;
+    uint32_t family;
+    bool     dedicated;  // separate transfer family, ownership transfers on
+
+    StagingRing ring;
+
+    VkSemaphore timeline;
+    uint64_t    submitted;  // last value signalled by a batch
+    uint64_t    acquired;   // last value handed to the graphics side
+
+    VkCommandPool   pools[UPLOAD_ENGINE_BATCHES];
+    VkCommandBuffer cmds[UPLOAD_ENGINE_BATCHES];
+    uint64_t        batch_value[UPLOAD_ENGINE_BATCHES];
+    uint32_t        batch;
+    bool            recording;
+
+    // released by submitted batches, not yet acquired (stb_ds)
+    VkBufferMemoryBarrier2* acquire_buffers;
+    VkImageMemoryBarrier2*  acquire_images;
+
+    UploadEngineStats stats;
+} UploadEngine;
+
+// Picks qf->transfer_queue when its family differs from graphics, the
+// graphics queue otherwise. ring_capacity is shared by the in-flight batches.
+void upload_engine_init(UploadEngine* engine, ResourceAllocator* allocator, const queue_families* qf, VkDeviceSize ring_capacity);
+
+// Waits for every batch.
+void upload_engine_destroy(UploadEngine* engine);
+
+// Opens a batch (or returns the open one). Record with the staging_* calls;
+// an upload that does not fit returns false and can go into the next batch.
+StagingRing* upload_engine_begin(UploadEngine* engine);
+
+// Submits the open batch. Returns its timeline value, 0 if none was open.
+uint64_t upload_engine_submit(UploadEngine* engine);
+
+// Records the acquires of everything submitted since the last call into the
+// graphics command buffer and fills out_wait with the timeline wait its submit
+// needs. Returns false when there is nothing new to wait for.
+bool upload_engine_acquire(UploadEngine* engine, VkCommandBuffer cmd, VkSemaphoreSubmitInfo* out_wait);
+
+// Upload batch: start-up style bulk uploads, one staging buffer, one command
+// buffer, one submit.
+//
+// upload_batch_buffer* / upload_batch_image only record what to copy; sources
+// (and fill users) must stay valid until upload_batch_submit, which sizes a
+// single staging buffer for everything, writes it, records the copies (one
+// vkCmdCopyBuffer per destination buffer, one barrier before and one after)
+// and waits for the queue.
+
+typedef struct UploadBatchItem
+{
+    VkBuffer     buffer;  // or image
+    Image*       image;
+    VkDeviceSize dst_offset;
+    VkDeviceSize size;
+    VkDeviceSize staging_offset;
+    UploadFillFn fill;
+    void*        user;
+} UploadBatchItem;
+
+typedef struct UploadBatchStats
+{
+    uint64_t bytes;
+    uint32_t buffers;
+    uint32_t images;
+    uint32_t copy_cmds;   // vkCmdCopy* after merging regions per destination
+    double   fill_ms;     // writing staging (copies, decodes)
+    double   submit_ms;   // record + submit + wait
+} UploadBatchStats;
+
+typedef struct UploadBatch
+{
+    ResourceAllocator* allocator;
+    UploadBatchItem*   items;  // stb_ds
+    VkDeviceSize       staging_size;
+} UploadBatch;
+
+void upload_batch_begin(UploadBatch* batch, ResourceAllocator* allocator);
+
+void upload_batch_buffer(UploadBatch* batch, VkBuffer dst, VkDeviceSize dst_offset, const void* src, VkDeviceSize size);
+void upload_batch_buffer_fill(UploadBatch* batch, VkBuffer dst, VkDeviceSize dst_offset, VkDeviceSize size, UploadFillFn fill, void* user);
+
+// Whole mip 0 of dst from tightly packed texels; leaves dst sampled.
+void upload_batch_image(UploadBatch* batch, Image* dst, const void* src, VkDeviceSize size);
+
+// Returns false, submitting nothing, if a fill fails. The batch is empty
+// afterwards either way and can be reused or dropped.
+bool upload_batch_submit(UploadBatch* batch, VkQueue queue, VkCommandPool pool, UploadBatchStats* out_stats);
+
+// "uploads <label>: N buffers, N images, X MB in N copies, fill X ms, submit X ms"
+void upload_batch_print_stats(const char* label, const UploadBatchStats* stats);